@@ -0,0 +1,236 @@
+// audio-input.cpp
+// Capture callback, sample ring and the per-frame FFT band analysis.
+
+#include "audio-input.h"
+#include "frame-params.h"
+#include "telemetry.h"
+#include <SDL2/SDL.h>
+#include <atomic>
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+
+static const uint32_t ringSize = 1u << 15;  // samples, ~0.7 s at 48 kHz
+static const int fftSize = 1024;            // ~21 ms window at 48 kHz
+static const float minHz = 40.0f, maxHz = 16000.0f;
+static const float rangeDb = 48.0f;         // a band spans this far below its reference
+static const float spreadDb = 30.0f;        // a band's reference is at least the loudest peak minus this
+static const float gateDb = -90.0f;         // peaks under this read as silence
+static const float peakFallDb = 6.0f;       // per second
+static const float attackSeconds = 0.02f, releaseSeconds = 0.25f;
+
+// The callback is the only writer of head, the render thread the only writer of tail
+static struct {
+    float data[ringSize];
+    std::atomic<uint32_t> head{0};
+    std::atomic<uint32_t> tail{0};
+    std::atomic<uint32_t> dropped{0};
+} ring;
+
+static struct {
+    SDL_AudioDeviceID device = 0;
+    float rate = 48000.0f;
+    std::vector<AudioMapping> mappings;
+    std::vector<float> window;       // newest fftSize samples, oldest first
+    std::vector<float> hann;
+    std::vector<float> re, im;
+    std::vector<int> bitReverse;
+    std::vector<float> cosTable, sinTable;
+    int bandBins[audioBands + 1] = {};
+    float peakDb[audioBands] = {};
+    float levels[audioBands] = {};
+    uint32_t reportedDrops = 0;
+} au;
+
+static const char* targetNames[] = { "warp", "thickness", "colorShift" };
+
+bool parseAudioMapping(const char* spec, AudioMapping& mapping) {
+    char name[16] = {};
+    int band = 0;
+    float gain = 0.0f;
+    if (std::sscanf(spec, "%15[^:]:%d:%f", name, &band, &gain) != 3) return false;
+    if (band < 0 || band >= audioBands) return false;
+    for (int i = 0; i < 3; ++i) {
+        if (std::strcmp(name, targetNames[i]) == 0) {
+            mapping = { (AudioTarget)i, band, gain };
+            return true;
+        }
+    }
+    return false;
+}
+
+// Audio thread: copy what fits and return; a full ring drops the excess
+static void SDLCALL captureCallback(void*, Uint8* stream, int len) {
+    const float* in = (const float*)stream;
+    uint32_t n = (uint32_t)len / sizeof(float);
+    uint32_t head = ring.head.load(std::memory_order_relaxed);
+    uint32_t tail = ring.tail.load(std::memory_order_acquire);
+    uint32_t space = ringSize - (head - tail);
+    if (n > space) {
+        ring.dropped.fetch_add(n - space, std::memory_order_relaxed);
+        n = space;
+    }
+    uint32_t at = head & (ringSize - 1);
+    uint32_t first = std::min(n, ringSize - at);
+    std::memcpy(ring.data + at, in, first * sizeof(float));
+    std::memcpy(ring.data, in + first, (n - first) * sizeof(float));
+    ring.head.store(head + n, std::memory_order_release);
+}
+
+static void buildTables() {
+    au.window.assign(fftSize, 0.0f);
+    au.re.resize(fftSize);
+    au.im.resize(fftSize);
+    au.hann.resize(fftSize);
+    au.bitReverse.resize(fftSize);
+    au.cosTable.resize(fftSize / 2);
+    au.sinTable.resize(fftSize / 2);
+    const float twoPi = 6.28318531f;
+    int bits = 0;
+    while ((1 << bits) < fftSize) ++bits;
+    for (int i = 0; i < fftSize; ++i) {
+        au.hann[i] = 0.5f - 0.5f * std::cos(twoPi * i / (fftSize - 1));
+        int r = 0;
+        for (int b = 0; b < bits; ++b) r |= ((i >> b) & 1) << (bits - 1 - b);
+        au.bitReverse[i] = r;
+    }
+    for (int i = 0; i < fftSize / 2; ++i) {
+        au.cosTable[i] = std::cos(twoPi * i / fftSize);
+        au.sinTable[i] = -std::sin(twoPi * i / fftSize);
+    }
+
+    // log-spaced bands, each at least one bin wide
+    float binHz = au.rate / fftSize;
+    int prev = 1;  // bin 0 is DC
+    for (int k = 0; k <= audioBands; ++k) {
+        float hz = minHz * std::pow(maxHz / minHz, (float)k / audioBands);
+        int bin = std::clamp((int)std::lround(hz / binHz), 1, fftSize / 2);
+        if (k > 0) bin = std::max(bin, prev + 1);
+        au.bandBins[k] = std::min(bin, fftSize / 2);
+        prev = au.bandBins[k];
+    }
+    for (float& p : au.peakDb) p = gateDb;
+}
+
+bool initAudio(const char* device, const std::vector<AudioMapping>& mappings) {
+    if (SDL_InitSubSystem(SDL_INIT_AUDIO) != 0) {
+        std::cerr << "Audio: SDL audio init failed: " << SDL_GetError() << "\n";
+        return false;
+    }
+    SDL_AudioSpec want = {}, have = {};
+    want.freq = 48000;
+    want.format = AUDIO_F32SYS;
+    want.channels = 1;
+    want.samples = 512;
+    want.callback = captureCallback;
+    au.device = SDL_OpenAudioDevice(device, 1, &want, &have, SDL_AUDIO_ALLOW_FREQUENCY_CHANGE);
+    if (!au.device) {
+        std::cerr << "Audio: cannot open capture device" << (device ? std::string(" '") + device + "'" : std::string())
+                  << ": " << SDL_GetError() << "\nCapture devices:";
+        for (int i = 0; i < SDL_GetNumAudioDevices(1); ++i) std::cerr << " '" << SDL_GetAudioDeviceName(i, 1) << "'";
+        std::cerr << "\n";
+        SDL_QuitSubSystem(SDL_INIT_AUDIO);
+        return false;
+    }
+    au.rate = (float)have.freq;
+    au.mappings = mappings;
+    buildTables();
+    std::cout << "Audio: " << (device ? device : "default capture device") << ", " << have.freq << " Hz, "
+              << audioBands << " bands " << minHz << ".." << maxHz << " Hz\n";
+    SDL_PauseAudioDevice(au.device, 0);
+    return true;
+}
+
+void shutdownAudio() {
+    if (!au.device) return;
+    SDL_CloseAudioDevice(au.device);
+    au.device = 0;
+    SDL_QuitSubSystem(SDL_INIT_AUDIO);
+    std::memset(au.levels, 0, sizeof(au.levels));
+}
+
+// In-place radix-2 FFT over au.re / au.im, input already in bit-reversed order
+static void fft() {
+    for (int size = 2; size <= fftSize; size <<= 1) {
+        int half = size / 2, step = fftSize / size;
+        for (int start = 0; start < fftSize; start += size) {
+            for (int k = 0; k < half; ++k) {
+                float wr = au.cosTable[k * step], wi = au.sinTable[k * step];
+                int a = start + k, b = a + half;
+                float tr = au.re[b] * wr - au.im[b] * wi;
+                float ti = au.re[b] * wi + au.im[b] * wr;
+                au.re[b] = au.re[a] - tr; au.im[b] = au.im[a] - ti;
+                au.re[a] += tr; au.im[a] += ti;
+            }
+        }
+    }
+}
+
+void updateAudio() {
+    if (!au.device) return;
+    uint32_t head = ring.head.load(std::memory_order_acquire);
+    uint32_t tail = ring.tail.load(std::memory_order_relaxed);
+    uint32_t fresh = head - tail;
+    // only the newest window's worth matters
+    if (fresh > (uint32_t)fftSize) {
+        tail = head - fftSize;
+        fresh = fftSize;
+    }
+    if (fresh > 0) {
+        std::memmove(au.window.data(), au.window.data() + fresh, (fftSize - fresh) * sizeof(float));
+        for (uint32_t i = 0; i < fresh; ++i)
+            au.window[fftSize - fresh + i] = ring.data[(tail + i) & (ringSize - 1)];
+    }
+    ring.tail.store(head, std::memory_order_release);
+
+    uint32_t dropped = ring.dropped.load(std::memory_order_relaxed);
+    if (dropped != au.reportedDrops) {
+        au.reportedDrops = dropped;
+        telemetryLog(LogLevel::Warn, "Audio: ring full, %u samples dropped so far", dropped);
+    }
+    if (fresh == 0) return;
+
+    for (int i = 0; i < fftSize; ++i) {
+        int r = au.bitReverse[i];
+        au.re[r] = au.window[i] * au.hann[i];
+        au.im[r] = 0.0f;
+    }
+    fft();
+
+    // smoothing follows the audio time consumed, not the frame rate
+    float dt = fresh / au.rate;
+    float attack = 1.0f - std::exp(-dt / attackSeconds);
+    float release = 1.0f - std::exp(-dt / releaseSeconds);
+    float db[audioBands];
+    float loudest = gateDb;
+    for (int k = 0; k < audioBands; ++k) {
+        float energy = 0.0f;
+        for (int b = au.bandBins[k]; b < au.bandBins[k + 1]; ++b)
+            energy += au.re[b] * au.re[b] + au.im[b] * au.im[b];
+        energy /= (float)std::max(1, au.bandBins[k + 1] - au.bandBins[k]);
+        db[k] = 10.0f * std::log10(energy + 1e-12f);
+        au.peakDb[k] = std::max(db[k], au.peakDb[k] - peakFallDb * dt);
+        loudest = std::max(loudest, au.peakDb[k]);
+    }
+    for (int k = 0; k < audioBands; ++k) {
+        // per-band gain, but a band that only ever sees leakage stays dark
+        float ref = std::max(au.peakDb[k], loudest - spreadDb);
+        float target = loudest > gateDb ? std::clamp((db[k] - (ref - rangeDb)) / rangeDb, 0.0f, 1.0f) : 0.0f;
+        float& level = au.levels[k];
+        level += (target - level) * (target > level ? attack : release);
+    }
+}
+
+const float* audioLevels() {
+    return au.levels;
+}
+
+float audioOffset(AudioTarget target) {
+    float offset = 0.0f;
+    for (const AudioMapping& m : au.mappings)
+        if (m.target == target) offset += m.gain * au.levels[m.band];
+    return offset;
+}
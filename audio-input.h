@@ -0,0 +1,42 @@
+// audio-input.h
+// Live audio for audio-reactive shows. SDL's capture callback copies samples
+// into a preallocated single-producer/single-consumer ring and returns; it
+// never locks, waits or allocates. Once per frame the render thread drains
+// the ring, runs a Hann-windowed FFT over the newest samples and reduces it
+// to audioBands log-spaced band levels in 0..1 (frame-params.h iAudio), with
+// attack/release smoothing and a slow auto gain so quiet and loud rooms both
+// use the full range. Bands can also drive effect parameters.
+#pragma once
+#include <vector>
+
+// Parameters a band can modulate. speed is left out: the shaders multiply it
+// by iTime, so changing it moves the camera instead of speeding it up.
+enum class AudioTarget {
+    Warp,
+    Thickness,
+    ColorShift,
+};
+
+// target += gain * level(band), on top of the value the keys set
+struct AudioMapping {
+    AudioTarget target;
+    int band;
+    float gain;
+};
+
+// "warp:2:0.5" -> warp follows band 2 with gain 0.5
+bool parseAudioMapping(const char* spec, AudioMapping& mapping);
+
+// Opens the capture device (null: the system default). Returns false, after
+// printing why, if there is none; the bands then stay at 0.
+bool initAudio(const char* device, const std::vector<AudioMapping>& mappings);
+void shutdownAudio();
+
+// Render thread, once per frame: consumes what the callback captured and
+// updates the band levels
+void updateAudio();
+
+// audioBands levels, 0 while no audio is open
+const float* audioLevels();
+// Sum of the mapped offsets for a parameter this frame
+float audioOffset(AudioTarget target);
@@ -0,0 +1,115 @@
+// bare-host.cpp
+// Event loop, effect programs and frame timing for the bare host.
+
+#include "bare-host.h"
+#include "effects.h"
+#include "effect-library.h"
+#include "host-input.h"
+#include "shader-variants.h"
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+int runBareHost(const BareHostOptions& opts) {
+    const RenderBackend& backend = *opts.backend;
+    if (SDL_Init(SDL_INIT_VIDEO) != 0) {
+        std::cerr << "SDL_Init failed: " << SDL_GetError() << "\n";
+        return 1;
+    }
+    std::vector<const EffectDesc*> descs = effectRegistry();
+    for (const EffectDesc* desc : libraryEffects()) descs.push_back(desc);
+    int current = 0;
+    if (opts.effect) {
+        current = -1;
+        for (size_t i = 0; i < descs.size(); ++i)
+            if (std::strcmp(descs[i]->name, opts.effect) == 0) current = (int)i;
+        if (current < 0) {
+            std::cerr << "Unknown effect '" << opts.effect << "'\n";
+            return 1;
+        }
+    }
+
+    int w = 1280, h = 720;
+    SDL_Window* win = backend.init(descs[current]->title, w, h, opts.backendOpts);
+    if (!win) return 1;
+
+    // every program up front (the GL binary cache or the SPIR-V and pipeline
+    // caches make later launches quick); the effect keys skip the ones that fail
+    auto buildStart = std::chrono::steady_clock::now();
+    std::vector<int> programs;
+    initSkippedEffects((int)descs.size());
+    for (const EffectDesc* desc : descs) {
+        ShaderVariant v;
+        if (desc->features & featureNoiseTex) v.noiseTex = 0;
+        int program = backend.createProgram(desc->name, desc->fragmentSrc, shaderVariantDefines(v));
+        if (program < 0) {
+            std::cerr << backend.name << ": skipping effect '" << desc->name << "'\n";
+            setEffectSkipped((int)programs.size(), true);
+        }
+        programs.push_back(program);
+    }
+    std::chrono::duration<double, std::milli> buildMs = std::chrono::steady_clock::now() - buildStart;
+    std::cout << backend.name << ": " << descs.size() << " effects built in " << buildMs.count() << " ms\n";
+    int bloomed = 0;
+    for (const EffectDesc* desc : descs) bloomed += desc->tone.bloom > 0.0f;
+    if (bloomed)
+        std::cout << backend.name << ": drawing without bloom, so " << bloomed
+                  << " effect(s) look flatter than in the full host\n";
+    if (effectSkipped(current)) current = selectableEffect(current, 1, (int)descs.size());
+    if (current < 0) {
+        std::cerr << backend.name << ": no effect could be built\n";
+        backend.shutdown();
+        SDL_Quit();
+        return 1;
+    }
+    SDL_SetWindowTitle(win, descs[current]->title);
+
+    InputSnapshot input;
+    input.current = current;
+    for (const EffectDesc* desc : descs) input.params.push_back(desc->defaults);
+    input.w = w; input.h = h;
+
+    auto start = std::chrono::steady_clock::now();
+    auto last = start;
+    double frameMsSum = 0.0;
+    int frame = 0;
+    while (input.running) {
+        SDL_Event e;
+        while (SDL_PollEvent(&e)) applyInputEvent(e, input, true, descs);
+        if (input.w != w || input.h != h) {
+            w = input.w; h = input.h;
+            backend.resize(w, h);
+        }
+        if (input.current != current) {
+            current = input.current;
+            SDL_SetWindowTitle(win, descs[current]->title);
+        }
+
+        auto now = std::chrono::steady_clock::now();
+        double t = std::chrono::duration<double>(now - start).count();
+        if (opts.seconds > 0.0 && t >= opts.seconds) break;
+        if (frame > 0) frameMsSum += std::chrono::duration<double, std::milli>(now - last).count();
+        last = now;
+
+        const EffectDesc& desc = *descs[current];
+        FrameParams params = effectFrameParams(desc, input.params[current], t + input.timeOffset, w, h);
+        params.iFrame = frame;
+        // no bloom chain on either backend here, so GL draws what Vulkan can
+        ToneDesc tone = desc.tone;
+        tone.bloom = 0.0f;
+        if (!backend.drawFrame(programs[current], params, tone, frame)) {
+            std::cerr << backend.name << ": the window can't be drawn any more\n";
+            break;
+        }
+        ++frame;
+    }
+    if (frame > 1) {
+        double mean = frameMsSum / (frame - 1);
+        std::cout << backend.name << ": " << frame << " frames, " << mean << " ms mean, " << 1000.0 / mean << " fps ("
+                  << presentModeName(opts.backendOpts.present) << ")\n";
+    }
+    backend.shutdown();
+    SDL_Quit();
+    return 0;
+}
@@ -0,0 +1,22 @@
+// bare-host.h
+// The effects alone through a RenderBackend (render-backend.h): one window,
+// the keys of the full host that make sense without post passes (effect
+// selection, params, [ ] scrub, ESC), the effect pass and the tonemap, and
+// nothing else: no bloom, aberration, temporal, compute, transitions or
+// overlay, and ALU noise instead of the noise texture. That is the part both
+// backends implement, so --bare on GL and --backend vulkan draw the same
+// frames and their frame times compare API overhead rather than features.
+// They are not the full host's frames: effects with tone.bloom > 0 lose their
+// glow here on either API (runBareHost says how many at startup).
+#pragma once
+#include "render-backend.h"
+
+struct BareHostOptions {
+    const RenderBackend* backend = nullptr;
+    BackendOptions backendOpts;
+    const char* effect = nullptr;  // start on this effect
+    double seconds = 0.0;          // quit after this long; 0 runs until ESC
+};
+
+// Returns the process exit code; prints the mean frame time at exit
+int runBareHost(const BareHostOptions& opts);
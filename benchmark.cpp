@@ -0,0 +1,149 @@
+// benchmark.cpp
+// Offline benchmark of every registered effect.
+
+#include "benchmark.h"
+#include "effects.h"
+#include "gl-util.h"
+#include "noise-texture.h"
+#include "chromatic-aberration.h"
+#include "tonemap.h"
+#include "bloom.h"
+#include "frame-params.h"
+#include "shader-compiler.h"
+#include <iostream>
+#include <fstream>
+#include <chrono>
+#include <vector>
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+
+// Fixed animation step so every run renders exactly the same frames
+static const double frameStep = 1.0 / 60.0;
+
+static const struct { int w, h; } benchSizes[] = {
+    { 1280, 720 },
+    { 1920, 1080 },
+    { 2560, 1440 },
+    { 3840, 2160 },
+};
+
+int runBenchmark(const BenchmarkOptions& opts) {
+    if (SDL_Init(SDL_INIT_VIDEO) != 0) {
+        std::cerr << "SDL_Init failed: " << SDL_GetError() << "\n";
+        return 1;
+    }
+    SDL_GLContext ctx = nullptr;
+    SDL_Window* win = createGLWindow("timewarp benchmark", 64, 64, SDL_WINDOW_HIDDEN, &ctx);
+    if (!win) return 1;
+    SDL_GL_SetSwapInterval(0);
+
+    std::ofstream file;
+    if (opts.output) {
+        file.open(opts.output);
+        if (!file) { std::cerr << "Cannot write " << opts.output << "\n"; return 1; }
+    }
+    std::ostream& out = opts.output ? file : std::cout;
+
+    initShaderCompiler(win, ctx, opts.shaderCache);
+    std::vector<Effect> effects;
+    registerEffects(effects);
+    FullscreenTriangle tri;
+    createFullscreenTriangle(tri);
+    initNoiseTexture();
+    initFrameParams();
+    for (Effect& fx : effects) requestEffect(fx);
+    while (updateEffects(effects, tri) > 0) finishShaderCompiler();
+
+    std::vector<GLuint> queries(opts.frames);
+    glGenQueries(opts.frames, queries.data());
+    std::vector<double> gpu(opts.frames);
+
+    out << "# timewarp benchmark: " << (const char*)glGetString(GL_RENDERER)
+        << " | " << (const char*)glGetString(GL_VERSION) << "\n";
+    out << "effect,width,height,frames,wall_ms,gpu_mean_ms,gpu_p50_ms,gpu_p95_ms,gpu_min_ms,gpu_max_ms,gpu_variance,mpix_per_s\n";
+
+    int failures = 0;
+    initChromaticAberration(benchSizes[0].w, benchSizes[0].h);
+    initTonemap(benchSizes[0].w, benchSizes[0].h, false);
+    initBloom(benchSizes[0].w, benchSizes[0].h);
+    for (const auto& size : benchSizes) {
+        RenderTarget rt;
+        if (!createRenderTarget(rt, size.w, size.h)) { ++failures; continue; }
+        resizeChromaticAberration(size.w, size.h);
+        resizeTonemap(size.w, size.h);
+        resizeBloom(size.w, size.h);
+        glBindFramebuffer(GL_FRAMEBUFFER, rt.fbo);
+        glViewport(0, 0, size.w, size.h);
+
+        for (const Effect& fx : effects) {
+            if (opts.effect && std::strcmp(opts.effect, fx.desc->name) != 0) continue;
+            if (!fx.prog) { ++failures; continue; }
+            float aberration = effectAberration(fx);
+            // the host's whole chain: HDR scene, aberration, bloom, tonemap
+            auto drawFrame = [&](int i) {
+                beginTonemap(size.w, size.h);
+                if (aberration > 0.0f) beginChromaticAberration(size.w, size.h);
+                updateEffectFrame(fx, i * frameStep, size.w, size.h, i);
+                useEffect(fx);
+                drawFullscreenTriangle(tri);
+                if (aberration > 0.0f) endChromaticAberration(tri, aberration);
+                endTonemap(tri, fx.desc->tone, i);
+            };
+
+            for (int i = 0; i < opts.warmup; ++i) drawFrame(i);
+            glFinish();
+
+            auto start = std::chrono::high_resolution_clock::now();
+            for (int i = 0; i < opts.frames; ++i) {
+                glBeginQuery(GL_TIME_ELAPSED, queries[i]);
+                drawFrame(opts.warmup + i);
+                glEndQuery(GL_TIME_ELAPSED);
+            }
+            glFinish();
+            std::chrono::duration<double, std::milli> wall = std::chrono::high_resolution_clock::now() - start;
+
+            double sum = 0.0;
+            for (int i = 0; i < opts.frames; ++i) {
+                GLuint64 ns = 0;
+                glGetQueryObjectui64v(queries[i], GL_QUERY_RESULT, &ns);
+                gpu[i] = ns / 1.0e6;
+                sum += gpu[i];
+            }
+            double mean = sum / opts.frames;
+            double var = 0.0;
+            for (double g : gpu) var += (g - mean) * (g - mean);
+            var /= opts.frames;
+            std::vector<double> sorted = gpu;
+            std::sort(sorted.begin(), sorted.end());
+            double p50 = sorted[(size_t)(0.50 * (opts.frames - 1))];
+            double p95 = sorted[(size_t)(0.95 * (opts.frames - 1))];
+            double mpix = mean > 0.0 ? (double)size.w * size.h / (mean * 1000.0) : 0.0;
+
+            char line[256];
+            snprintf(line, sizeof(line), "%s,%d,%d,%d,%.4f,%.4f,%.4f,%.4f,%.4f,%.4f,%.6f,%.1f\n",
+                fx.desc->name, size.w, size.h, opts.frames, wall.count() / opts.frames,
+                mean, p50, p95, sorted.front(), sorted.back(), var, mpix);
+            out << line << std::flush;
+            if (opts.output) std::cout << line;
+        }
+
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        destroyRenderTarget(rt);
+    }
+
+    glDeleteQueries(opts.frames, queries.data());
+    shutdownBloom();
+    shutdownTonemap();
+    shutdownChromaticAberration();
+    shutdownFrameParams();
+    shutdownNoiseTexture();
+    shutdownShaderCompiler();
+    destroyFullscreenTriangle(tri);
+    destroyEffects(effects);
+    SDL_GL_DeleteContext(ctx);
+    SDL_DestroyWindow(win);
+    SDL_Quit();
+    return failures ? 2 : 0;
+}
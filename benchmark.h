@@ -0,0 +1,15 @@
+// benchmark.h
+// Offline benchmark: renders every effect into an offscreen framebuffer at a
+// set of fixed resolutions with a hidden window, vsync off and a
+// deterministic time sequence, and writes one CSV row per effect and size.
+#pragma once
+
+struct BenchmarkOptions {
+    int frames = 300;                 // timed frames per effect and resolution
+    int warmup = 30;                  // untimed frames before that
+    const char* output = nullptr;     // CSV file; stdout if null
+    const char* shaderCache = nullptr;
+    const char* effect = nullptr;     // only this effect if set
+};
+
+int runBenchmark(const BenchmarkOptions& opts);
@@ -0,0 +1,147 @@
+// bloom.cpp
+// Bright pass, dual-filter downsample chain and additive upsample.
+
+#include "bloom.h"
+#include <algorithm>
+
+static const char* bloomFragmentSrc = R"glsl(
+#version 330 core
+in vec2 uv;
+out vec4 fragColor;
+uniform sampler2D uSource;
+uniform vec2 uUvScale;    // part of the source the last pass wrote
+uniform vec2 uTexel;      // 1 / source texture size
+uniform int uMode;        // 0 bright pass + down, 1 down, 2 up
+uniform float uThreshold;
+
+vec3 tap(vec2 st){
+    return texture(uSource, clamp(st, 0.5 * uTexel, uUvScale - 0.5 * uTexel)).rgb;
+}
+
+// soft knee: brightness above the threshold, easing in over half of it
+vec3 bright(vec3 c){
+    float b = max(c.r, max(c.g, c.b));
+    float knee = 0.5 * uThreshold;
+    float soft = clamp(b - uThreshold + knee, 0.0, 2.0 * knee);
+    soft = soft * soft / (4.0 * knee + 1e-4);
+    return c * max(soft, b - uThreshold) / max(b, 1e-4);
+}
+
+vec3 down(vec2 st){
+    vec2 d = uTexel;
+    vec3 s = tap(st) * 4.0;
+    s += tap(st + vec2(-d.x, -d.y)) + tap(st + vec2(d.x, -d.y));
+    s += tap(st + vec2(-d.x, d.y)) + tap(st + vec2(d.x, d.y));
+    return s * 0.125;
+}
+
+vec3 up(vec2 st){
+    vec2 d = uTexel * 0.5;
+    vec3 s = tap(st + vec2(-2.0 * d.x, 0.0)) + tap(st + vec2(2.0 * d.x, 0.0));
+    s += tap(st + vec2(0.0, -2.0 * d.y)) + tap(st + vec2(0.0, 2.0 * d.y));
+    s += 2.0 * (tap(st + vec2(-d.x, -d.y)) + tap(st + vec2(d.x, -d.y)));
+    s += 2.0 * (tap(st + vec2(-d.x, d.y)) + tap(st + vec2(d.x, d.y)));
+    return s / 12.0;
+}
+
+void main(){
+    vec2 st = uv * uUvScale;
+    vec3 c = uMode == 2 ? up(st) : down(st);
+    // after the filter, so single hot pixels don't sparkle
+    if (uMode == 0) c = bright(c);
+    fragColor = vec4(c, 1.0);
+}
+)glsl";
+
+static struct {
+    bool initialized = false;
+    RenderTarget levels[bloomMaxLevels];
+    GLuint prog = 0;
+    GLint locSource = -1, locUvScale = -1, locTexel = -1, locMode = -1, locThreshold = -1;
+    int lw[bloomMaxLevels] = {}, lh[bloomMaxLevels] = {};  // size drawn this frame
+} bl;
+
+static int levelSize(int size, int level) {
+    return std::max(1, size >> (level + 1));
+}
+
+bool initBloom(int w, int h) {
+    GLuint vs = compileShader(GL_VERTEX_SHADER, vertexShaderSrc);
+    GLuint fs = compileShader(GL_FRAGMENT_SHADER, bloomFragmentSrc);
+    if (!vs || !fs) return false;
+    bl.prog = linkProgram(vs, fs);
+    glDeleteShader(vs); glDeleteShader(fs);
+    if (!bl.prog) return false;
+    bl.locSource = glGetUniformLocation(bl.prog, "uSource");
+    bl.locUvScale = glGetUniformLocation(bl.prog, "uUvScale");
+    bl.locTexel = glGetUniformLocation(bl.prog, "uTexel");
+    bl.locMode = glGetUniformLocation(bl.prog, "uMode");
+    bl.locThreshold = glGetUniformLocation(bl.prog, "uThreshold");
+
+    for (int i = 0; i < bloomMaxLevels; ++i) {
+        if (!createRenderTarget(bl.levels[i], levelSize(w, i), levelSize(h, i), GL_RGBA16F)) {
+            bl.initialized = true;  // releases what was made
+            shutdownBloom();
+            return false;
+        }
+    }
+    bl.initialized = true;
+    return true;
+}
+
+void shutdownBloom() {
+    if (!bl.initialized) return;
+    for (RenderTarget& rt : bl.levels)
+        if (rt.fbo) destroyRenderTarget(rt);
+    glDeleteProgram(bl.prog);
+    bl.prog = 0;
+    bl.initialized = false;
+}
+
+void resizeBloom(int w, int h) {
+    if (!bl.initialized) return;
+    for (int i = 0; i < bloomMaxLevels; ++i) resizeRenderTarget(bl.levels[i], levelSize(w, i), levelSize(h, i));
+}
+
+// One pass from src (drawn over sw x sh of it) into level dst
+static void filterPass(const FullscreenTriangle& tri, const RenderTarget& src, int sw, int sh, int dst, int mode) {
+    glBindFramebuffer(GL_FRAMEBUFFER, bl.levels[dst].fbo);
+    glViewport(0, 0, bl.lw[dst], bl.lh[dst]);
+    glBindTexture(GL_TEXTURE_2D, src.tex);
+    glUniform2f(bl.locUvScale, (float)sw / src.w, (float)sh / src.h);
+    glUniform2f(bl.locTexel, 1.0f / src.w, 1.0f / src.h);
+    glUniform1i(bl.locMode, mode);
+    drawFullscreenTriangle(tri);
+}
+
+BloomImage buildBloom(const FullscreenTriangle& tri, const RenderTarget& scene, int rw, int rh, float threshold) {
+    BloomImage image;
+    if (!bl.initialized) return image;
+    // stop where a level would be too small to blur
+    int levels = 0;
+    for (; levels < bloomMaxLevels; ++levels) {
+        bl.lw[levels] = std::min(levelSize(rw, levels), bl.levels[levels].w);
+        bl.lh[levels] = std::min(levelSize(rh, levels), bl.levels[levels].h);
+        if (levels > 0 && (bl.lw[levels] < 4 || bl.lh[levels] < 4)) break;
+    }
+
+    glUseProgram(bl.prog);
+    glActiveTexture(GL_TEXTURE0);
+    glUniform1i(bl.locSource, 0);
+    glUniform1f(bl.locThreshold, std::max(threshold, 0.0f));
+    filterPass(tri, scene, rw, rh, 0, 0);
+    for (int i = 1; i < levels; ++i) filterPass(tri, bl.levels[i - 1], bl.lw[i - 1], bl.lh[i - 1], i, 1);
+    // each level adds the blurred one below it, so level 0 ends up with all of them
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_ONE, GL_ONE);
+    for (int i = levels - 1; i > 0; --i) filterPass(tri, bl.levels[i], bl.lw[i], bl.lh[i], i - 1, 2);
+    glDisable(GL_BLEND);
+
+    image.tex = bl.levels[0].tex;
+    image.uvScale[0] = (float)bl.lw[0] / bl.levels[0].w;
+    image.uvScale[1] = (float)bl.lh[0] / bl.levels[0].h;
+    image.texel[0] = 1.0f / bl.levels[0].w;
+    image.texel[1] = 1.0f / bl.levels[0].h;
+    image.gain = 1.0f / levels;
+    return image;
+}
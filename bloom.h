@@ -0,0 +1,33 @@
+// bloom.h
+// Bloom from the HDR scene (tonemap.h): a bright pass folded into the first
+// downsample, a chain of half-size levels down to a few dozen pixels, and
+// the way back up, each level blurred by the dual filter (Kawase's
+// downsample / upsample taps, four and eight bilinear fetches). Every pass
+// but the first runs at half resolution or below, so the cost is a small,
+// fixed share of the frame whatever the effect's raymarch costs. The
+// tonemap pass adds the result; each effect sets how much and from which
+// brightness in its ToneDesc.
+#pragma once
+#include "gl-util.h"
+
+static const int bloomMaxLevels = 6;   // 1/2 .. 1/64 of the render size
+
+bool initBloom(int w, int h);
+void shutdownBloom();
+
+// Window resize: reallocates the levels
+void resizeBloom(int w, int h);
+
+// The half-size result: tex covers uvScale of itself and holds the sum of
+// the levels used; gain averages them, so small windows with fewer levels
+// don't bloom less
+struct BloomImage {
+    GLuint tex = 0;          // 0 when bloom is unavailable
+    float uvScale[2] = {};
+    float texel[2] = {};     // 1 / texture size
+    float gain = 0.0f;
+};
+
+// Blurs what is brighter than threshold in the rw x rh corner of scene.
+// Leaves the framebuffer binding and viewport to the caller.
+BloomImage buildBloom(const FullscreenTriangle& tri, const RenderTarget& scene, int rw, int rh, float threshold);
@@ -0,0 +1,93 @@
+// chromatic-aberration.cpp
+// Three-tap chromatic aberration resolve.
+
+#include "chromatic-aberration.h"
+#include <algorithm>
+
+static const char* resolveFragmentSrc = R"glsl(
+#version 330 core
+in vec2 uv;
+out vec4 fragColor;
+uniform sampler2D uScene;
+uniform vec2 uUvScale; // part of the texture the effect rendered into
+uniform vec2 uTexel;   // 1 / texture size
+uniform float uShift;  // red/blue displacement in texture coordinates
+
+vec4 tap(vec2 st){
+    return texture(uScene, clamp(st, 0.5 * uTexel, uUvScale - 0.5 * uTexel));
+}
+
+void main(){
+    vec2 st = uv * uUvScale;
+    vec4 g = tap(st);
+    float r = tap(st + vec2(uShift, 0.0)).r;
+    float b = tap(st - vec2(uShift, 0.0)).b;
+    fragColor = vec4(r, g.g, b, g.a);
+}
+)glsl";
+
+static struct {
+    bool initialized = false;
+    RenderTarget target;
+    GLuint prog = 0;
+    GLint locScene = -1, locUvScale = -1, locTexel = -1, locShift = -1;
+    GLint prevFbo = 0;
+    GLint prevViewport[4] = {};
+    int rw = 0, rh = 0;
+} ca;
+
+bool initChromaticAberration(int w, int h) {
+    GLuint vs = compileShader(GL_VERTEX_SHADER, vertexShaderSrc);
+    GLuint fs = compileShader(GL_FRAGMENT_SHADER, resolveFragmentSrc);
+    if (!vs || !fs) return false;
+    ca.prog = linkProgram(vs, fs);
+    glDeleteShader(vs); glDeleteShader(fs);
+    if (!ca.prog) return false;
+    ca.locScene = glGetUniformLocation(ca.prog, "uScene");
+    ca.locUvScale = glGetUniformLocation(ca.prog, "uUvScale");
+    ca.locTexel = glGetUniformLocation(ca.prog, "uTexel");
+    ca.locShift = glGetUniformLocation(ca.prog, "uShift");
+
+    if (!createRenderTarget(ca.target, w, h, GL_RGBA16F)) return false;
+    ca.initialized = true;
+    return true;
+}
+
+void shutdownChromaticAberration() {
+    if (!ca.initialized) return;
+    destroyRenderTarget(ca.target);
+    glDeleteProgram(ca.prog);
+    ca.prog = 0;
+    ca.initialized = false;
+}
+
+void resizeChromaticAberration(int w, int h) {
+    if (!ca.initialized) return;
+    resizeRenderTarget(ca.target, w, h);
+}
+
+void beginChromaticAberration(int rw, int rh) {
+    if (!ca.initialized) return;
+    glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &ca.prevFbo);
+    glGetIntegerv(GL_VIEWPORT, ca.prevViewport);
+    ca.rw = std::min(rw, ca.target.w);
+    ca.rh = std::min(rh, ca.target.h);
+    glBindFramebuffer(GL_FRAMEBUFFER, ca.target.fbo);
+    glViewport(0, 0, ca.rw, ca.rh);
+}
+
+void endChromaticAberration(const FullscreenTriangle& tri, float offset) {
+    if (!ca.initialized) return;
+    glBindFramebuffer(GL_FRAMEBUFFER, (GLuint)ca.prevFbo);
+    glViewport(ca.prevViewport[0], ca.prevViewport[1], ca.prevViewport[2], ca.prevViewport[3]);
+
+    glUseProgram(ca.prog);
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, ca.target.tex);
+    glUniform1i(ca.locScene, 0);
+    glUniform2f(ca.locUvScale, (float)ca.rw / ca.target.w, (float)ca.rh / ca.target.h);
+    glUniform2f(ca.locTexel, 1.0f / ca.target.w, 1.0f / ca.target.h);
+    // half the render height is one unit of offset
+    glUniform1f(ca.locShift, offset * 0.5f * ca.rh / ca.target.w);
+    drawFullscreenTriangle(tri);
+}
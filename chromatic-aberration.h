@@ -0,0 +1,20 @@
+// chromatic-aberration.h
+// Post pass that splits red and blue by sampling one rendered image three
+// times, so effects shade a single material per pixel instead of one per
+// channel. Strength comes from the effect's ChromaDesc and its warp (see
+// effectAberration in effects.h).
+#pragma once
+#include "gl-util.h"
+
+bool initChromaticAberration(int w, int h);
+void shutdownChromaticAberration();
+
+// Window resize: reallocates the intermediate target
+void resizeChromaticAberration(int w, int h);
+
+// Redirects the effect into the intermediate target. rw/rh is the size the
+// effect renders at, which may be below the window (see dynamic-res.h).
+void beginChromaticAberration(int rw, int rh);
+// Resolves into whatever framebuffer was bound at begin. offset is in the
+// effects' coordinates, where the render height spans 2.
+void endChromaticAberration(const FullscreenTriangle& tri, float offset);
@@ -0,0 +1,422 @@
+// clock-sync.cpp
+// Leader/follower timestamp exchange, the follower's clock servo and the
+// swap group hooks.
+
+#ifdef _WIN32
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#pragma comment(lib, "ws2_32.lib")
+typedef SOCKET socket_t;
+typedef int socklen_t;
+static const socket_t noSocket = INVALID_SOCKET;
+static void closeSocket(socket_t s) { closesocket(s); }
+#else
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <netdb.h>
+#include <unistd.h>
+typedef int socket_t;
+static const socket_t noSocket = -1;
+static void closeSocket(socket_t s) { close(s); }
+#endif
+
+#include "clock-sync.h"
+#include "telemetry.h"
+#include "triple-buffer.h"
+#include <SDL2/SDL.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+
+static const int receiveTimeoutMs = 20;
+static const int sampleWindow = 8;         // exchanges the shortest round trip is picked from
+static const int lockSamples = 4;          // exchanges before the first estimate is trusted
+static const double servoGain = 0.2;       // share of the offset error corrected per exchange
+static const double driftGain = 0.01;      // share of it folded into the drift, per second
+static const double maxDrift = 500e-6;     // 500 ppm: anything more is a bad sample
+static const uint32_t protocolVersion = 1;
+
+enum : uint32_t { requestType = 1, replyType = 2 };
+
+// On the wire, all big-endian
+//   request: 'TWCS' version type seq t1
+//   reply:   'TWCS' version type seq t1 t2 t3 origin offset period
+// t1 follower sent, t2 leader received, t3 leader replied; origin is the
+// leader's show time 0 on its steady clock, or negative before its first frame.
+static const size_t requestBytes = 16 + 8;
+static const size_t replyBytes = 16 + 6 * 8;
+
+// The leader's clock as seen from here: leader = local + offset + drift * (local - ref)
+struct LeaderModel {
+    double offset = 0.0;
+    double drift = 0.0;
+    double ref = 0.0;
+    double origin = -1.0;
+    double timeOffset = 0.0;
+    double period = 1.0 / 60.0;
+    bool locked = false;
+};
+
+struct SyncSample {
+    double offset;
+    double rtt;
+};
+
+static struct {
+    std::atomic<bool> running{false};
+    std::thread thread;
+    socket_t sock = noSocket;
+    ClockSyncOptions opts;
+    sockaddr_in leaderAddr = {};
+    // render thread: vblanks are locked across nodes, so the frame grid holds
+    bool swapGrouped = false;
+    // set by the render thread; the leader's exchange thread sends them
+    std::atomic<double> origin{-1.0};
+    std::atomic<double> timeOffset{0.0};
+    // follower, exchange thread only
+    LeaderModel model;
+    SyncSample samples[sampleWindow] = {};
+    int sampleCount = 0;
+    uint32_t seq = 0;
+    double lastHeard = 0.0;
+    bool lost = false;
+    int offsetCounter = -1, rttCounter = -1;
+    // follower: written by the exchange thread, read by the render thread
+    TripleBuffer<LeaderModel> published{ LeaderModel{} };
+} cs;
+
+double syncSteadySeconds() {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// ---- packing ----
+
+static void putWord(unsigned char*& p, uint32_t v) {
+    for (int i = 3; i >= 0; --i) *p++ = (unsigned char)(v >> (i * 8));
+}
+
+static void putDouble(unsigned char*& p, double d) {
+    uint64_t v;
+    std::memcpy(&v, &d, sizeof(v));
+    putWord(p, (uint32_t)(v >> 32));
+    putWord(p, (uint32_t)v);
+}
+
+static uint32_t getWord(const unsigned char*& p) {
+    uint32_t v = (uint32_t)p[0] << 24 | (uint32_t)p[1] << 16 | (uint32_t)p[2] << 8 | p[3];
+    p += 4;
+    return v;
+}
+
+static double getDouble(const unsigned char*& p) {
+    uint64_t v = (uint64_t)getWord(p) << 32;
+    v |= getWord(p);
+    double d;
+    std::memcpy(&d, &v, sizeof(d));
+    return d;
+}
+
+static void putHeader(unsigned char*& p, uint32_t type, uint32_t seq) {
+    std::memcpy(p, "TWCS", 4);
+    p += 4;
+    putWord(p, protocolVersion);
+    putWord(p, type);
+    putWord(p, seq);
+}
+
+// Checks magic, version and type; leaves p after the sequence number
+static bool readHeader(const unsigned char*& p, size_t size, uint32_t type, size_t expected, uint32_t& seq) {
+    if (size != expected || std::memcmp(p, "TWCS", 4) != 0) return false;
+    p += 4;
+    if (getWord(p) != protocolVersion || getWord(p) != type) return false;
+    seq = getWord(p);
+    return true;
+}
+
+// ---- leader ----
+
+static void serveRequests() {
+    unsigned char packet[64];
+    sockaddr_in from = {};
+    socklen_t fromLen = sizeof(from);
+    int n = (int)recvfrom(cs.sock, (char*)packet, (int)sizeof(packet), 0, (sockaddr*)&from, &fromLen);
+    double received = syncSteadySeconds();
+    if (n <= 0) return;
+    const unsigned char* r = packet;
+    uint32_t seq;
+    if (!readHeader(r, (size_t)n, requestType, requestBytes, seq)) return;
+    double sent = getDouble(r);
+
+    unsigned char reply[replyBytes];
+    unsigned char* w = reply;
+    putHeader(w, replyType, seq);
+    putDouble(w, sent);
+    putDouble(w, received);
+    unsigned char* replied = w;
+    w += 8;
+    putDouble(w, cs.origin.load(std::memory_order_relaxed));
+    putDouble(w, cs.timeOffset.load(std::memory_order_relaxed));
+    putDouble(w, 1.0 / cs.opts.fps);
+    // stamped last, as close to the send as the packet allows
+    putDouble(replied, syncSteadySeconds());
+    sendto(cs.sock, (const char*)reply, (int)replyBytes, 0, (const sockaddr*)&from, fromLen);
+}
+
+// ---- follower ----
+
+static double modelAt(const LeaderModel& m, double local) {
+    return local + m.offset + m.drift * (local - m.ref);
+}
+
+static void sendRequest() {
+    unsigned char packet[requestBytes];
+    unsigned char* w = packet;
+    putHeader(w, requestType, ++cs.seq);
+    putDouble(w, syncSteadySeconds());
+    send(cs.sock, (const char*)packet, (int)requestBytes, 0);
+}
+
+// Folds one exchange into the model; true if it changed
+static bool discipline(double offset, double rtt, double now) {
+    cs.samples[cs.sampleCount % sampleWindow] = { offset, rtt };
+    ++cs.sampleCount;
+    if (cs.sampleCount < lockSamples) return false;
+    // queueing only ever adds delay, so the quickest exchange is the most symmetric
+    int n = std::min(cs.sampleCount, sampleWindow);
+    const SyncSample* best = std::min_element(cs.samples, cs.samples + n,
+        [](const SyncSample& a, const SyncSample& b) { return a.rtt < b.rtt; });
+
+    LeaderModel& m = cs.model;
+    double error = best->offset - (modelAt(m, now) - now);
+    if (!m.locked || std::fabs(error) > syncStepSeconds) {
+        if (m.locked) telemetryLog(LogLevel::Warn, "Clock sync: stepped %.1f ms", error * 1000.0);
+        else telemetryLog(LogLevel::Info, "Clock sync: locked, offset %.3f s, round trip %.2f ms", best->offset, best->rtt * 1000.0);
+        m.offset = best->offset;
+        m.drift = 0.0;
+        m.ref = now;
+        m.locked = true;
+    } else {
+        m.offset = modelAt(m, now) - now + servoGain * error;
+        m.drift = std::clamp(m.drift + driftGain * error / syncPollSeconds, -maxDrift, maxDrift);
+        m.ref = now;
+    }
+    setTelemetryCounter(cs.offsetCounter, error * 1000.0);
+    setTelemetryCounter(cs.rttCounter, best->rtt * 1000.0);
+    return true;
+}
+
+static void receiveReply() {
+    unsigned char packet[128];
+    // the socket is connected to the leader, so the stack drops datagrams
+    // from anyone else; the sequence number, random from the start, has to
+    // match as well
+    int n = (int)recv(cs.sock, (char*)packet, (int)sizeof(packet), 0);
+    double back = syncSteadySeconds();
+    if (n <= 0) return;
+    const unsigned char* r = packet;
+    uint32_t seq;
+    // a late reply to an older request would pair with the wrong send time
+    if (!readHeader(r, (size_t)n, replyType, replyBytes, seq) || seq != cs.seq) return;
+    double sent = getDouble(r), received = getDouble(r), replied = getDouble(r);
+    double origin = getDouble(r), timeOffset = getDouble(r), period = getDouble(r);
+    if (!(period > 0.0)) return;
+
+    double offset = ((received - sent) + (replied - back)) * 0.5;
+    double rtt = (back - sent) - (replied - received);
+    if (rtt < 0.0) return;
+    cs.lastHeard = back;
+    if (cs.lost) telemetryLog(LogLevel::Info, "Clock sync: leader back");
+    cs.lost = false;
+
+    bool changed = discipline(offset, rtt, back);
+    LeaderModel& m = cs.model;
+    changed = changed || m.origin != origin || m.timeOffset != timeOffset || m.period != period;
+    m.origin = origin;
+    m.timeOffset = timeOffset;
+    m.period = period;
+    if (changed) {
+        cs.published.back() = m;
+        cs.published.publish();
+    }
+}
+
+static void syncThread() {
+    double nextPoll = 0.0;
+    while (cs.running.load(std::memory_order_acquire)) {
+        if (cs.opts.role == SyncRole::Leader) {
+            serveRequests();
+            continue;
+        }
+        double now = syncSteadySeconds();
+        if (now >= nextPoll) {
+            nextPoll = now + syncPollSeconds;
+            sendRequest();
+            // the model keeps running open loop meanwhile
+            if (!cs.lost && cs.lastHeard > 0.0 && now - cs.lastHeard > syncLostSeconds) {
+                telemetryLog(LogLevel::Warn, "Clock sync: no reply from the leader for %g s", syncLostSeconds);
+                cs.lost = true;
+            }
+        }
+        receiveReply();
+    }
+}
+
+bool parseSyncLeader(const char* text, ClockSyncOptions& opts) {
+    static std::string host;
+    host = text;
+    size_t colon = host.rfind(':');
+    if (colon != std::string::npos) {
+        int port = std::atoi(host.c_str() + colon + 1);
+        if (port <= 0 || port > 65535) return false;
+        opts.port = port;
+        host.resize(colon);
+    }
+    if (host.empty()) return false;
+    opts.leader = host.c_str();
+    return true;
+}
+
+static bool resolveLeader(const ClockSyncOptions& opts) {
+    addrinfo hints = {}, *found = nullptr;
+    hints.ai_family = AF_INET;
+    hints.ai_socktype = SOCK_DGRAM;
+    if (getaddrinfo(opts.leader, nullptr, &hints, &found) != 0 || !found) return false;
+    std::memcpy(&cs.leaderAddr, found->ai_addr, sizeof(cs.leaderAddr));
+    cs.leaderAddr.sin_port = htons((unsigned short)opts.port);
+    freeaddrinfo(found);
+    return true;
+}
+
+bool startClockSync(const ClockSyncOptions& opts) {
+    if (opts.role == SyncRole::Off) return false;
+#ifdef _WIN32
+    WSADATA wsa;
+    if (WSAStartup(MAKEWORD(2, 2), &wsa) != 0) return false;
+#endif
+    bool ok = false;
+    cs.sock = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    if (cs.sock != noSocket && opts.role == SyncRole::Leader) {
+        sockaddr_in addr = {};
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons((unsigned short)opts.port);
+        addr.sin_addr.s_addr = htonl(INADDR_ANY);
+        ok = bind(cs.sock, (const sockaddr*)&addr, sizeof(addr)) == 0;
+        if (!ok) std::cerr << "Clock sync: cannot listen on UDP port " << opts.port << "\n";
+    } else if (cs.sock != noSocket) {
+        ok = resolveLeader(opts);
+        if (!ok) std::cerr << "Clock sync: cannot resolve leader " << opts.leader << "\n";
+        ok = ok && connect(cs.sock, (const sockaddr*)&cs.leaderAddr, sizeof(cs.leaderAddr)) == 0;
+        cs.seq = std::random_device{}();
+    }
+    if (!ok) {
+        if (cs.sock != noSocket) closeSocket(cs.sock);
+        cs.sock = noSocket;
+#ifdef _WIN32
+        WSACleanup();
+#endif
+        return false;
+    }
+#ifdef _WIN32
+    DWORD timeout = receiveTimeoutMs;
+#else
+    timeval timeout = { 0, receiveTimeoutMs * 1000 };
+#endif
+    setsockopt(cs.sock, SOL_SOCKET, SO_RCVTIMEO, (const char*)&timeout, sizeof(timeout));
+
+    cs.opts = opts;
+    if (!(cs.opts.fps > 0.0)) cs.opts.fps = 60.0;
+    cs.offsetCounter = telemetryCounter("sync_error_ms");
+    cs.rttCounter = telemetryCounter("sync_rtt_ms");
+    cs.running.store(true, std::memory_order_release);
+    cs.thread = std::thread(syncThread);
+    if (opts.role == SyncRole::Leader) std::cout << "Clock sync: leading on UDP port " << opts.port << ", " << cs.opts.fps << " fps grid\n";
+    else std::cout << "Clock sync: following " << opts.leader << ":" << opts.port << "\n";
+    return true;
+}
+
+void stopClockSync() {
+    if (!cs.running.load()) return;
+    cs.running.store(false, std::memory_order_release);
+    cs.thread.join();
+    closeSocket(cs.sock);
+    cs.sock = noSocket;
+#ifdef _WIN32
+    WSACleanup();
+#endif
+}
+
+bool clockSyncActive() {
+    return cs.running.load(std::memory_order_relaxed);
+}
+
+double syncShowTime(double display, double timeOffset) {
+    // show time starts at the first frame, as it does without sync; on a
+    // follower this only holds until the leader is heard
+    double origin = cs.origin.load(std::memory_order_relaxed);
+    if (origin < 0.0) {
+        origin = display;
+        cs.origin.store(origin, std::memory_order_relaxed);
+    }
+    double show = display - origin + timeOffset, period = 1.0 / cs.opts.fps;
+    if (cs.opts.role == SyncRole::Leader) {
+        cs.timeOffset.store(timeOffset, std::memory_order_relaxed);
+    } else {
+        cs.published.update();
+        const LeaderModel& m = cs.published.front();
+        if (m.locked && m.origin >= 0.0) {
+            show = modelAt(m, display) - m.origin + m.timeOffset;
+            period = m.period;
+        }
+    }
+    // Rounding to the leader's grid only helps when every node swaps on the
+    // same vblank; against a free-running local vblank it would repeat or
+    // skip grid steps, so without a swap group each node shows its own
+    // predicted instant, which is off by at most the vblank phase difference
+    if (!cs.swapGrouped) return show;
+    return std::round(show / period) * period;
+}
+
+// ---- swap groups ----
+
+#ifdef _WIN32
+typedef BOOL (WINAPI* JoinSwapGroupFn)(HDC dc, unsigned group);
+typedef BOOL (WINAPI* BindSwapBarrierFn)(unsigned group, unsigned barrier);
+#else
+// GLX types as opaque handles, so no X11 headers are needed
+typedef void* (*GetCurrentDisplayFn)();
+typedef unsigned long (*GetCurrentDrawableFn)();
+typedef int (*JoinSwapGroupFn)(void* display, unsigned long drawable, unsigned group);
+typedef int (*BindSwapBarrierFn)(void* display, unsigned group, unsigned barrier);
+#endif
+
+bool joinSwapGroup(unsigned group) {
+#ifdef _WIN32
+    auto join = (JoinSwapGroupFn)SDL_GL_GetProcAddress("wglJoinSwapGroupNV");
+    auto bind = (BindSwapBarrierFn)SDL_GL_GetProcAddress("wglBindSwapBarrierNV");
+    if (!join || !bind || !join(wglGetCurrentDC(), group)) return false;
+    cs.swapGrouped = bind(group, 1) != FALSE;
+    return cs.swapGrouped;
+#elif defined(__linux__)
+    auto display = (GetCurrentDisplayFn)SDL_GL_GetProcAddress("glXGetCurrentDisplay");
+    auto drawable = (GetCurrentDrawableFn)SDL_GL_GetProcAddress("glXGetCurrentDrawable");
+    auto join = (JoinSwapGroupFn)SDL_GL_GetProcAddress("glXJoinSwapGroupNV");
+    auto bind = (BindSwapBarrierFn)SDL_GL_GetProcAddress("glXBindSwapBarrierNV");
+    if (!display || !drawable || !join || !bind || !display()) return false;
+    if (!join(display(), drawable(), group)) return false;
+    cs.swapGrouped = bind(display(), group, 1) != 0;
+    return cs.swapGrouped;
+#else
+    (void)group;
+    return false;
+#endif
+}
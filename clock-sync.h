@@ -0,0 +1,52 @@
+// clock-sync.h
+// One show clock across several machines driving adjacent parts of a wall.
+// A leader answers timestamp requests on UDP; each follower polls it, and
+// from the four stamps of every exchange (sent, leader received, leader
+// replied, back) measures its offset to the leader's clock with the network
+// delay cancelled, as PTP does. The sample with the shortest round trip of
+// the last few wins, and a PI servo slews a local model of the leader's
+// clock (offset plus drift) towards it, so the show time never jumps unless
+// the error is past syncStepSeconds. The leader also sends its show origin,
+// its scrub offset ([ and ]) and its frame period; every node turns the
+// predicted display time of a frame into show time on the leader's clock.
+// Once joinSwapGroup has bound the NV swap group/barrier extensions (a sync
+// board and genlocked displays), every node also rounds it to the leader's
+// frame grid, so frame N shows the same instant everywhere. Without one the
+// local vblanks drift against that grid, so show times stay unrounded and
+// the nodes agree to within a vblank's phase instead of repeating or
+// dropping frames.
+#pragma once
+
+enum class SyncRole { Off, Leader, Follower };
+
+static const double syncPollSeconds = 0.1;
+static const double syncStepSeconds = 0.05;  // larger errors step instead of slewing
+static const double syncLostSeconds = 2.0;   // silence before a follower reports the leader lost
+
+struct ClockSyncOptions {
+    SyncRole role = SyncRole::Off;
+    const char* leader = nullptr; // follower: leader host name or address
+    int port = 7010;              // leader: listen port; follower: leader's port
+    double fps = 60.0;            // leader: the frame grid every node rounds to
+};
+
+// "host:port", or just a host for the default port
+bool parseSyncLeader(const char* text, ClockSyncOptions& opts);
+
+// Starts the exchange thread; false (with a message) if the socket fails
+bool startClockSync(const ClockSyncOptions& opts);
+void stopClockSync();
+bool clockSyncActive();
+
+// Seconds on the steady clock that frame-pacing.h times against
+double syncSteadySeconds();
+
+// Render thread, once per frame: show time for a frame displayed at
+// steady-clock second display, on the frame grid when swap-grouped. The leader applies timeOffset and shares it;
+// followers use the leader's instead of their own.
+double syncShowTime(double display, double timeOffset);
+
+// Render thread with the context current: joins swap group group and binds
+// it to barrier 1 (WGL_NV_swap_group / GLX_NV_swap_group). False where the
+// extension or the barrier hardware is missing.
+bool joinSwapGroup(unsigned group);
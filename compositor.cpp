@@ -0,0 +1,207 @@
+// compositor.cpp
+// Transition state, its two pooled layers and the blend pass.
+
+#include "compositor.h"
+#include "render-pool.h"
+#include <algorithm>
+#include <cstring>
+
+static const char* modeNames[transitionModeCount] = { "cut", "crossfade", "wipe" };
+
+// Units 1..3 belong to the effects (noise-texture.h, temporal.h)
+static const int outgoingUnit = 0;
+static const int incomingUnit = 4;
+
+static const char* blendFragmentSrc = R"glsl(
+#version 330 core
+in vec2 uv;
+out vec4 fragColor;
+uniform sampler2D uOutgoing;
+uniform sampler2D uIncoming;
+uniform vec2 uOutgoingScale; // part of each texture its layer rendered into
+uniform vec2 uIncomingScale;
+uniform float uProgress;     // 0..1, eased
+uniform int uWipe;
+
+// width of the wipe's soft edge across the view
+#define WIPE_EDGE 0.08
+
+// kept half a texel inside the rendered part, which is all that's valid
+vec4 layer(sampler2D tex, vec2 scale){
+    vec2 halfTexel = 0.5 / vec2(textureSize(tex, 0));
+    return texture(tex, clamp(uv * scale, halfTexel, scale - halfTexel));
+}
+
+void main(){
+    vec4 a = layer(uOutgoing, uOutgoingScale);
+    vec4 b = layer(uIncoming, uIncomingScale);
+    float k = uProgress;
+    if(uWipe != 0){
+        // the edge sweeps left to right, entirely off the view at 0 and 1
+        float x0 = uProgress * (1.0 + WIPE_EDGE) - WIPE_EDGE;
+        k = 1.0 - smoothstep(x0, x0 + WIPE_EDGE, uv.x);
+    }
+    fragColor = mix(a, b, k);
+}
+)glsl";
+
+static struct {
+    bool initialized = false;
+    TransitionMode mode = TransitionMode::Crossfade;
+    double seconds = 0.8;
+    GLuint prog = 0;
+    GLint locOutgoing = -1, locIncoming = -1, locOutgoingScale = -1, locIncomingScale = -1;
+    GLint locProgress = -1, locWipe = -1;
+    int w = 0, h = 0;
+    RenderTarget* layers[2] = {};  // Outgoing, Incoming; held while a transition runs
+    int lw[2] = {}, lh[2] = {};    // size each layer rendered at this frame
+    bool active = false;
+    bool started = false;          // clock started by transitionActive
+    double start = 0.0;
+    float progress = 0.0f;
+    int from = -1;
+    GLint prevFbo = 0;
+    GLint prevViewport[4] = {};
+} cp;
+
+bool parseTransitionMode(const char* name, TransitionMode& mode) {
+    for (int i = 0; i < transitionModeCount; ++i) {
+        if (std::strcmp(name, modeNames[i]) == 0) {
+            mode = (TransitionMode)i;
+            return true;
+        }
+    }
+    return false;
+}
+
+const char* transitionModeName(TransitionMode mode) {
+    return modeNames[(int)mode];
+}
+
+static int outgoingSize(int size) {
+    return std::max(1, (int)(size * transitionOutgoingScale + 0.5f));
+}
+
+static void releaseLayers() {
+    for (RenderTarget*& rt : cp.layers) {
+        if (rt) releaseRenderTarget(rt);
+        rt = nullptr;
+    }
+}
+
+// Both layers or neither
+static bool acquireLayers() {
+    // HDR like the scene they are blended into (tonemap.h)
+    if (!cp.layers[0]) cp.layers[0] = acquireRenderTarget(outgoingSize(cp.w), outgoingSize(cp.h), GL_RGBA16F);
+    if (!cp.layers[1]) cp.layers[1] = acquireRenderTarget(cp.w, cp.h, GL_RGBA16F);
+    if (cp.layers[0] && cp.layers[1]) return true;
+    releaseLayers();
+    return false;
+}
+
+bool initCompositor(TransitionMode mode, double seconds, int w, int h) {
+    cp.mode = mode;
+    cp.seconds = std::max(0.01, seconds);
+    cp.w = w; cp.h = h;
+    if (mode == TransitionMode::Cut) return true;
+    GLuint vs = compileShader(GL_VERTEX_SHADER, vertexShaderSrc);
+    GLuint fs = compileShader(GL_FRAGMENT_SHADER, blendFragmentSrc);
+    if (!vs || !fs) return false;
+    cp.prog = linkProgram(vs, fs);
+    glDeleteShader(vs); glDeleteShader(fs);
+    if (!cp.prog) return false;
+    cp.locOutgoing = glGetUniformLocation(cp.prog, "uOutgoing");
+    cp.locIncoming = glGetUniformLocation(cp.prog, "uIncoming");
+    cp.locOutgoingScale = glGetUniformLocation(cp.prog, "uOutgoingScale");
+    cp.locIncomingScale = glGetUniformLocation(cp.prog, "uIncomingScale");
+    cp.locProgress = glGetUniformLocation(cp.prog, "uProgress");
+    cp.locWipe = glGetUniformLocation(cp.prog, "uWipe");
+    cp.initialized = true;
+    return true;
+}
+
+void shutdownCompositor() {
+    releaseLayers();
+    cp.active = false;
+    if (!cp.initialized) return;
+    glDeleteProgram(cp.prog);
+    cp.prog = 0;
+    cp.initialized = false;
+}
+
+void resizeCompositor(int w, int h) {
+    cp.w = w; cp.h = h;
+    if (!cp.active) return;
+    // released first, so the pool can hand the same slots back at the new size
+    releaseLayers();
+    if (!acquireLayers()) cp.active = false;
+}
+
+void startTransition(int from) {
+    if (!cp.initialized) return;
+    if (!acquireLayers()) {
+        cp.active = false;
+        return;
+    }
+    cp.from = from;
+    cp.active = true;
+    cp.started = false;
+    cp.progress = 0.0f;
+}
+
+bool transitionActive(double time) {
+    if (!cp.active) return false;
+    if (!cp.started) {
+        cp.start = time;
+        cp.started = true;
+    }
+    double s = (time - cp.start) / cp.seconds;
+    // done, or the clock was scrubbed back past the switch
+    if (s >= 1.0 || s < 0.0) {
+        releaseLayers();
+        cp.active = false;
+        return false;
+    }
+    float e = (float)s;
+    cp.progress = e * e * (3.0f - 2.0f * e);
+    return true;
+}
+
+int transitionFrom() { return cp.from; }
+
+float transitionProgress() { return cp.active ? cp.progress : 1.0f; }
+
+void beginTransitionLayer(TransitionLayer layer, int rw, int rh, int& lw, int& lh) {
+    int i = (int)layer;
+    RenderTarget& rt = *cp.layers[i];
+    glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &cp.prevFbo);
+    glGetIntegerv(GL_VIEWPORT, cp.prevViewport);
+    lw = std::min(layer == TransitionLayer::Outgoing ? outgoingSize(rw) : rw, rt.w);
+    lh = std::min(layer == TransitionLayer::Outgoing ? outgoingSize(rh) : rh, rt.h);
+    cp.lw[i] = lw; cp.lh[i] = lh;
+    glBindFramebuffer(GL_FRAMEBUFFER, rt.fbo);
+    glViewport(0, 0, lw, lh);
+    glClear(GL_COLOR_BUFFER_BIT);
+}
+
+void endTransitionLayer() {
+    glBindFramebuffer(GL_FRAMEBUFFER, (GLuint)cp.prevFbo);
+    glViewport(cp.prevViewport[0], cp.prevViewport[1], cp.prevViewport[2], cp.prevViewport[3]);
+}
+
+void compositeTransition(const FullscreenTriangle& tri) {
+    const RenderTarget& a = *cp.layers[0];
+    const RenderTarget& b = *cp.layers[1];
+    glUseProgram(cp.prog);
+    glActiveTexture(GL_TEXTURE0 + incomingUnit);
+    glBindTexture(GL_TEXTURE_2D, b.tex);
+    glActiveTexture(GL_TEXTURE0 + outgoingUnit);
+    glBindTexture(GL_TEXTURE_2D, a.tex);
+    glUniform1i(cp.locOutgoing, outgoingUnit);
+    glUniform1i(cp.locIncoming, incomingUnit);
+    glUniform2f(cp.locOutgoingScale, (float)cp.lw[0] / a.w, (float)cp.lh[0] / a.h);
+    glUniform2f(cp.locIncomingScale, (float)cp.lw[1] / b.w, (float)cp.lh[1] / b.h);
+    glUniform1f(cp.locProgress, cp.progress);
+    glUniform1i(cp.locWipe, cp.mode == TransitionMode::Wipe ? 1 : 0);
+    drawFullscreenTriangle(tri);
+}
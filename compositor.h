@@ -0,0 +1,48 @@
+// compositor.h
+// Transitions between effects. On a switch the host draws the outgoing and
+// the incoming effect into two targets from the render pool (render-pool.h)
+// and blends them into the frame in one pass: a crossfade or a soft-edged
+// wipe. The outgoing effect renders at transitionOutgoingScale of the size
+// in each direction, so a transition costs about 1.25 effects rather than
+// two full raymarches. The targets are keyed by the window size, so dynamic
+// resolution renders into a part of them and nothing is reallocated until
+// the window changes.
+#pragma once
+#include "gl-util.h"
+
+enum class TransitionMode { Cut, Crossfade, Wipe };
+static const int transitionModeCount = 3;
+
+bool parseTransitionMode(const char* name, TransitionMode& mode);
+const char* transitionModeName(TransitionMode mode);
+
+enum class TransitionLayer { Outgoing, Incoming };
+
+// Size of the outgoing layer relative to the incoming one
+static const float transitionOutgoingScale = 0.5f;
+
+bool initCompositor(TransitionMode mode, double seconds, int w, int h);
+void shutdownCompositor();
+// Window resize: a running transition moves to targets of the new size
+void resizeCompositor(int w, int h);
+
+// The host switched away from effect index from; the transition's clock
+// starts at the next transitionActive. A switch during a transition starts
+// over from the effect that was coming in. With Cut, or when the pool has no
+// targets left, the switch stays a cut.
+void startTransition(int from);
+// Advances the running transition to time; false once it has finished (or
+// if none runs), after which the host draws the current effect alone
+bool transitionActive(double time);
+// Effect index the running transition leaves
+int transitionFrom();
+// Eased share of the incoming effect, 0..1; 1 when none runs
+float transitionProgress();
+
+// Redirects drawing into the layer's target, cleared to black. rw/rh is the
+// size of the composite; lw/lh receive the size to render the layer at.
+void beginTransitionLayer(TransitionLayer layer, int rw, int rh, int& lw, int& lh);
+// Back to the framebuffer and viewport bound at begin
+void endTransitionLayer();
+// Blends both layers into the bound framebuffer's viewport
+void compositeTransition(const FullscreenTriangle& tri);
@@ -0,0 +1,120 @@
+// compute-march.cpp
+// Output and tile images for the compute march, and its two dispatches.
+
+#include "compute-march.h"
+#include <SDL2/SDL.h>
+#include <iostream>
+
+// Not every glad build carries these (GL 4.2 / 4.3)
+#ifndef GL_READ_WRITE
+#define GL_READ_WRITE 0x88BA
+#endif
+#ifndef GL_WRITE_ONLY
+#define GL_WRITE_ONLY 0x88B9
+#endif
+#ifndef GL_SHADER_IMAGE_ACCESS_BARRIER_BIT
+#define GL_SHADER_IMAGE_ACCESS_BARRIER_BIT 0x00000020
+#endif
+#ifndef GL_FRAMEBUFFER_BARRIER_BIT
+#define GL_FRAMEBUFFER_BARRIER_BIT 0x00000400
+#endif
+
+typedef void (APIENTRY* PFNDISPATCHCOMPUTE)(GLuint x, GLuint y, GLuint z);
+typedef void (APIENTRY* PFNBINDIMAGETEXTURE)(GLuint unit, GLuint texture, GLint level, GLboolean layered, GLint layer, GLenum access, GLenum format);
+typedef void (APIENTRY* PFNMEMORYBARRIER)(GLbitfield barriers);
+
+// location of iComputePass in the shaders
+static const GLint passLocation = 0;
+
+static struct {
+    bool available = false;
+    PFNDISPATCHCOMPUTE dispatchCompute = nullptr;
+    PFNBINDIMAGETEXTURE bindImageTexture = nullptr;
+    PFNMEMORYBARRIER memoryBarrier = nullptr;
+    RenderTarget output;     // RGBA16F, the image pass 1 writes
+    GLuint tiles = 0;        // RG32F, one texel per tile
+    int w = 0, h = 0;
+} cm;
+
+static int tileCount(int size) {
+    return (size + computeTileSize - 1) / computeTileSize;
+}
+
+static void allocTiles(int w, int h) {
+    glBindTexture(GL_TEXTURE_2D, cm.tiles);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RG32F, tileCount(w), tileCount(h), 0, GL_RG, GL_FLOAT, nullptr);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glBindTexture(GL_TEXTURE_2D, 0);
+}
+
+bool initComputeMarch(int w, int h) {
+    GLint major = 0, minor = 0;
+    glGetIntegerv(GL_MAJOR_VERSION, &major);
+    glGetIntegerv(GL_MINOR_VERSION, &minor);
+    if (major * 10 + minor < 43) {
+        std::cerr << "Compute march: needs GL 4.3, context is " << major << "." << minor << "; using the fragment path\n";
+        return false;
+    }
+    cm.dispatchCompute = (PFNDISPATCHCOMPUTE)SDL_GL_GetProcAddress("glDispatchCompute");
+    cm.bindImageTexture = (PFNBINDIMAGETEXTURE)SDL_GL_GetProcAddress("glBindImageTexture");
+    cm.memoryBarrier = (PFNMEMORYBARRIER)SDL_GL_GetProcAddress("glMemoryBarrier");
+    if (!cm.dispatchCompute || !cm.bindImageTexture || !cm.memoryBarrier || !createRenderTarget(cm.output, w, h, GL_RGBA16F)) {
+        std::cerr << "Compute march: entry points or output image unavailable; using the fragment path\n";
+        return false;
+    }
+    glGenTextures(1, &cm.tiles);
+    allocTiles(w, h);
+    cm.w = w; cm.h = h;
+    cm.available = true;
+    std::cout << "Compute march: GL " << major << "." << minor << ", " << computeTileSize << "x" << computeTileSize << " tiles\n";
+    return true;
+}
+
+void shutdownComputeMarch() {
+    if (!cm.available) return;
+    destroyRenderTarget(cm.output);
+    glDeleteTextures(1, &cm.tiles);
+    cm.tiles = 0;
+    cm.available = false;
+}
+
+bool computeMarchAvailable() { return cm.available; }
+
+void resizeComputeMarch(int w, int h) {
+    if (!cm.available) return;
+    cm.w = w; cm.h = h;
+    resizeRenderTarget(cm.output, w, h);
+    allocTiles(w, h);
+}
+
+std::string computeShaderSource(const std::string& fragmentSource) {
+    std::string s = fragmentSource;
+    size_t at = s.find("#version 330");
+    if (at != std::string::npos) s.replace(at, 12, "#version 430");
+    return s;
+}
+
+void dispatchComputeMarch(int rw, int rh) {
+    int tx = tileCount(rw), ty = tileCount(rh);
+    cm.bindImageTexture(computeOutputUnit, cm.output.tex, 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_RGBA16F);
+    cm.bindImageTexture(computeTileUnit, cm.tiles, 0, GL_FALSE, 0, GL_READ_WRITE, GL_RG32F);
+
+    // pass 0: a thread per tile
+    glUniform1i(passLocation, 0);
+    cm.dispatchCompute((GLuint)tileCount(tx), (GLuint)tileCount(ty), 1);
+    cm.memoryBarrier(GL_SHADER_IMAGE_ACCESS_BARRIER_BIT);
+
+    // pass 1: a work group per tile
+    glUniform1i(passLocation, 1);
+    cm.dispatchCompute((GLuint)tx, (GLuint)ty, 1);
+    cm.memoryBarrier(GL_FRAMEBUFFER_BARRIER_BIT);
+
+    GLint drawFbo = 0;
+    glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &drawFbo);
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, cm.output.fbo);
+    glReadBuffer(GL_COLOR_ATTACHMENT0);
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, (GLuint)drawFbo);
+    glBlitFramebuffer(0, 0, rw, rh, 0, 0, rw, rh, GL_COLOR_BUFFER_BIT, GL_NEAREST);
+    glBindFramebuffer(GL_FRAMEBUFFER, (GLuint)drawFbo);
+}
@@ -0,0 +1,37 @@
+// compute-march.h
+// Compute backend for the raymarching effects (circles, twirl). Built with
+// COMPUTE 1 (shader-variants.h) an effect's source becomes a GL 4.3 compute
+// shader with two passes. The first marches one ray per 8x8 tile, from the
+// tile's centre, for as long as no ray of the tile can be near the tunnel
+// surface (where a step adds next to nothing), and stores that distance and
+// the steps it took. The second runs one work group per tile: each pixel
+// starts its march there with those steps already spent, and the per-frame
+// constants (camera centre, focal length, palette base) are worked out once
+// per group into shared memory. The result is blitted into the framebuffer
+// bound at dispatch, like a fragment draw would have filled it.
+//
+// Without a 4.3 context (the 3.3 core fallback, macOS) init fails and the
+// fragment path draws as before.
+#pragma once
+#include <string>
+
+#include "gl-util.h"
+
+// Image units of the compute passes (layout(binding) in the shaders)
+static const int computeOutputUnit = 0;   // iOutput: RGBA16F linear colour
+static const int computeTileUnit = 1;     // iTileStart: RG32F start t, steps
+static const int computeTileSize = 8;
+
+// False when compute isn't available; nothing else here may be called then
+bool initComputeMarch(int w, int h);
+void shutdownComputeMarch();
+bool computeMarchAvailable();
+void resizeComputeMarch(int w, int h);
+
+// An effect's fragment source as compute source: the same text built as
+// #version 430 core
+std::string computeShaderSource(const std::string& fragmentSource);
+
+// With the COMPUTE program current: runs both passes at rw x rh and blits
+// the result into the bound framebuffer
+void dispatchComputeMarch(int rw, int rh);
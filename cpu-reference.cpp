@@ -0,0 +1,179 @@
+// cpu-reference.cpp
+// CPU renders to PNG, optionally diffed against a GPU readback of the same frame.
+
+#include "cpu-reference.h"
+#include "cpu-renderer.h"
+#include "thread-pool.h"
+#include "simd.h"
+#include "png-writer.h"
+#include "effects.h"
+#include "gl-util.h"
+#include "shader-compiler.h"
+#include "noise-texture.h"
+#include "chromatic-aberration.h"
+#include "tonemap.h"
+#include "frame-params.h"
+#include <iostream>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <algorithm>
+#include <cstdlib>
+#include <cstdint>
+
+// Raymarched effects amplify float differences (a step lands on the other
+// side of a surface), so a few pixels are allowed past the tolerance
+static const double maxOverFraction = 0.01;
+
+static std::string outputPath(const char* pattern, const char* name) {
+    std::string path = pattern;
+    size_t at = path.find("%s");
+    if (at != std::string::npos) path.replace(at, 2, name);
+    return path;
+}
+
+// GPU side of --cpu-compare: the export path's draw, into one render target
+struct GpuReference {
+    bool ready = false;
+    SDL_Window* win = nullptr;
+    SDL_GLContext ctx = nullptr;
+    std::vector<Effect> effects;
+    FullscreenTriangle tri;
+    RenderTarget rt;
+};
+
+static bool initGpuReference(GpuReference& gpu, const CpuRenderOptions& opts) {
+    if (SDL_Init(SDL_INIT_VIDEO) != 0) {
+        std::cerr << "SDL_Init failed: " << SDL_GetError() << "\n";
+        return false;
+    }
+    gpu.win = createGLWindow("timewarp reference", 64, 64, SDL_WINDOW_HIDDEN, &gpu.ctx);
+    if (!gpu.win) return false;
+    initShaderCompiler(gpu.win, gpu.ctx, opts.shaderCache);
+    registerEffects(gpu.effects);
+    createFullscreenTriangle(gpu.tri);
+    initNoiseTexture();
+    initFrameParams();
+    initChromaticAberration(opts.width, opts.height);
+    // no initBloom: the CPU renderer has no bloom, so neither does its reference
+    initTonemap(opts.width, opts.height, false);
+    while (updateEffects(gpu.effects, gpu.tri) > 0) finishShaderCompiler();
+    gpu.ready = createRenderTarget(gpu.rt, opts.width, opts.height);
+    return gpu.ready;
+}
+
+static void shutdownGpuReference(GpuReference& gpu) {
+    if (!gpu.win) return;
+    if (gpu.rt.fbo) destroyRenderTarget(gpu.rt);
+    shutdownTonemap();
+    shutdownChromaticAberration();
+    shutdownFrameParams();
+    shutdownNoiseTexture();
+    shutdownShaderCompiler();
+    destroyFullscreenTriangle(gpu.tri);
+    destroyEffects(gpu.effects);
+    SDL_GL_DeleteContext(gpu.ctx);
+    SDL_DestroyWindow(gpu.win);
+    SDL_Quit();
+}
+
+static bool renderGpu(GpuReference& gpu, const EffectDesc& desc, float time, int w, int h, std::vector<uint8_t>& rgba) {
+    int index = findEffect(gpu.effects, desc.name);
+    if (index < 0 || !gpu.effects[index].prog) return false;
+    const Effect& fx = gpu.effects[index];
+    float aberration = effectAberration(fx);
+    glBindFramebuffer(GL_FRAMEBUFFER, gpu.rt.fbo);
+    glViewport(0, 0, w, h);
+    updateEffectFrame(fx, time, w, h, 0);
+    beginTonemap(w, h);
+    if (aberration > 0.0f) beginChromaticAberration(w, h);
+    useEffect(fx);
+    drawFullscreenTriangle(gpu.tri);
+    if (aberration > 0.0f) endChromaticAberration(gpu.tri, aberration);
+    endTonemap(gpu.tri, fx.desc->tone, 0);
+    rgba.resize((size_t)w * h * 4);
+    glPixelStorei(GL_PACK_ALIGNMENT, 4);
+    glReadPixels(0, 0, w, h, GL_RGBA, GL_UNSIGNED_BYTE, rgba.data());
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    return true;
+}
+
+// Prints the difference; true if it is within the tolerance
+static bool compareImages(const char* name, const std::vector<uint8_t>& cpu, const std::vector<uint8_t>& gpu, int tolerance) {
+    size_t channels = 0, over = 0;
+    int maxDiff = 0;
+    double sum = 0.0;
+    for (size_t i = 0; i < cpu.size(); ++i) {
+        if (i % 4 == 3) continue; // alpha is always 1
+        int d = std::abs((int)cpu[i] - (int)gpu[i]);
+        maxDiff = std::max(maxDiff, d);
+        sum += d;
+        if (d > tolerance) ++over;
+        ++channels;
+    }
+    double fraction = channels ? (double)over / channels : 0.0;
+    bool ok = fraction <= maxOverFraction;
+    std::cout << "CPU/GPU '" << name << "': max " << maxDiff << ", mean " << (channels ? sum / channels : 0.0)
+        << ", " << fraction * 100.0 << "% of channels over " << tolerance << (ok ? "" : "  FAILED") << "\n";
+    return ok;
+}
+
+int runCpuRender(const CpuRenderOptions& opts) {
+    if (opts.width <= 0 || opts.height <= 0) {
+        std::cerr << "CPU render: bad size " << opts.width << "x" << opts.height << "\n";
+        return 1;
+    }
+    std::vector<const EffectDesc*> selected;
+    for (const EffectDesc* desc : effectRegistry())
+        if (!opts.effect || std::string(opts.effect) == desc->name) selected.push_back(desc);
+    if (selected.empty()) {
+        std::cerr << "Unknown effect '" << opts.effect << "'\n";
+        return 1;
+    }
+    if (selected.size() > 1 && std::string(opts.output).find("%s") == std::string::npos) {
+        std::cerr << "CPU render: rendering every effect needs %s in the output name, or pick one with --effect\n";
+        return 1;
+    }
+
+    GpuReference gpu;
+    if (opts.compare && !initGpuReference(gpu, opts)) {
+        std::cerr << "CPU render: no GPU to compare against\n";
+        shutdownGpuReference(gpu);
+        return 1;
+    }
+    initThreadPool(opts.threads);
+    std::cout << "CPU render: " << opts.width << "x" << opts.height << " on " << threadPoolSize()
+        << " threads, " << simd::lanes << " pixels per batch\n";
+
+    int failures = 0;
+    std::vector<uint8_t> cpu, reference;
+    for (const EffectDesc* desc : selected) {
+        if (!cpuRendererSupports(*desc)) {
+            std::cerr << "CPU render: no CPU port of '" << desc->name << "'\n";
+            ++failures;
+            continue;
+        }
+        auto t0 = std::chrono::high_resolution_clock::now();
+        renderEffectCpu(*desc, desc->defaults, opts.time, opts.width, opts.height, cpu);
+        double ms = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - t0).count();
+
+        std::string path = outputPath(opts.output, desc->name);
+        bool ok = writePng(path.c_str(), cpu.data(), opts.width, opts.height);
+        std::cout << "CPU render: '" << desc->name << "' in " << ms << " ms ("
+            << (double)opts.width * opts.height / (ms * 1000.0) << " Mpixels/s) -> " << path << "\n";
+
+        if (ok && opts.compare) {
+            if (!renderGpu(gpu, *desc, opts.time, opts.width, opts.height, reference)) {
+                std::cerr << "CPU render: '" << desc->name << "' did not build on the GPU\n";
+                ok = false;
+            } else {
+                ok = compareImages(desc->name, cpu, reference, opts.tolerance);
+            }
+        }
+        if (!ok) ++failures;
+    }
+
+    shutdownThreadPool();
+    shutdownGpuReference(gpu);
+    return failures ? 2 : 0;
+}
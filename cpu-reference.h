@@ -0,0 +1,21 @@
+// cpu-reference.h
+// Renders effects on the CPU (cpu-renderer.h) to PNG, without creating a GL
+// context, for thumbnails and regression images. With compare set, the same
+// frame is also drawn on the GPU through the normal path and read back, and
+// the two are checked against a per-channel tolerance.
+#pragma once
+
+struct CpuRenderOptions {
+    const char* output = nullptr;     // PNG; %s is replaced by the effect name
+    const char* effect = nullptr;     // every effect if null (output needs %s)
+    int width = 1280;
+    int height = 720;
+    float time = 10.0f;               // effect time of the frame
+    int threads = 0;                  // 0: one per hardware thread
+    bool compare = false;             // also render on the GPU and diff
+    int tolerance = 8;                // per channel, out of 255
+    const char* shaderCache = nullptr;
+};
+
+// 0 if every image was written (and matched, with compare), else non-zero
+int runCpuRender(const CpuRenderOptions& opts);
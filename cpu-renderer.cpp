@@ -0,0 +1,448 @@
+// cpu-renderer.cpp
+// Ports of the effect fragment shaders to simd::vfloat, 8 pixels of a row at
+// a time. Each kernel follows its GLSL line by line; values that are uniform
+// across the frame (camera path, banking) stay scalar, and those the GPU gets
+// in iConsts come from the same EffectDesc::frameConsts.
+
+#include "cpu-renderer.h"
+#include "simd.h"
+#include "thread-pool.h"
+#include "noise-texture.h"
+#include "shader-variants.h"
+#include "tonemap.h"
+#include <algorithm>
+#include <cmath>
+#include <mutex>
+
+using simd::vfloat;
+
+static const int tileW = 64; // multiple of simd::lanes
+static const int tileH = 32;
+
+struct Frame {
+    float time;
+    float resX, resY;
+    float speed, warp, thickness, colorShift;
+    const float* phase;  // FrameParams::iPhase
+    const float* k;      // FrameParams::iConsts
+};
+
+struct vec3 {
+    vfloat r, g, b;
+};
+
+static vec3 operator+(vec3 a, vec3 b) { return vec3{ a.r + b.r, a.g + b.g, a.b + b.b }; }
+static vec3 operator*(vec3 a, vfloat s) { return vec3{ a.r * s, a.g * s, a.b * s }; }
+static vec3 mix(vec3 a, vec3 b, vfloat t) { return vec3{ mix(a.r, b.r, t), mix(a.g, b.g, t), mix(a.b, b.b, t) }; }
+static vec3 clamp01(vec3 c) { return vec3{ clamp(c.r, 0.0f, 1.0f), clamp(c.g, 0.0f, 1.0f), clamp(c.b, 0.0f, 1.0f) }; }
+static vec3 pow(vec3 c, float e) { return vec3{ pow(c.r, e), pow(c.g, e), pow(c.b, e) }; }
+
+// mat3(iConsts[3].xyz, iConsts[4].xyz, iConsts[5].xyz) * c, the hue
+// matrices of the tunnel shaders
+static vec3 mulConsts(const float* k, vec3 c) {
+    const float* m = k + 12;
+    return vec3{ c.r * m[0] + c.g * m[4] + c.b * m[8],
+                 c.r * m[1] + c.g * m[5] + c.b * m[9],
+                 c.r * m[2] + c.g * m[6] + c.b * m[10] };
+}
+
+// ---- scalar GLSL helpers; the per-frame values come from frameConsts ----
+
+static float mix(float a, float b, float t) { return a + (b - a) * t; }
+
+// ---- noise: the NOISE_TEX 1 path, a bilinear fetch from the lattice texture ----
+
+static uint8_t lattice[noiseTextureSize * noiseTextureSize];
+static std::once_flag latticeOnce;
+
+static float texel(int x, int y) {
+    const int m = noiseTextureSize - 1; // GL_REPEAT
+    return lattice[(y & m) * noiseTextureSize + (x & m)] * (1.0f / 255.0f);
+}
+
+static float bilinear(float ix, float iy, float fx, float fy) {
+    int x = (int)ix, y = (int)iy;
+    float a = texel(x, y), b = texel(x + 1, y);
+    float c = texel(x, y + 1), d = texel(x + 1, y + 1);
+    return mix(mix(a, b, fx), mix(c, d, fx), fy);
+}
+
+static vfloat noise(vfloat x, vfloat y) {
+    vfloat ix = floor(x), iy = floor(y);
+    vfloat fx = x - ix, fy = y - iy;
+    fx = fx * fx * (3.0f - 2.0f * fx);
+    fy = fy * fy * (3.0f - 2.0f * fy);
+    // the lookups are a gather; the arithmetic around them stays in lanes
+    float lx[simd::lanes], ly[simd::lanes], lfx[simd::lanes], lfy[simd::lanes], out[simd::lanes];
+    ix.store(lx); iy.store(ly); fx.store(lfx); fy.store(lfy);
+    for (int k = 0; k < simd::lanes; ++k) out[k] = bilinear(lx[k], ly[k], lfx[k], lfy[k]);
+    return vfloat::load(out);
+}
+
+// ---- shader1-circles.cpp / shader2-twirl.cpp ----
+
+static vec3 plasmaPalette(vfloat t, float colorShift) {
+    const float tau = 6.28318f;
+    return vec3{ 0.5f + 0.5f * sin(tau * (t + (0.00f + colorShift))),
+                 0.5f + 0.5f * sin(tau * (t + (0.33f + colorShift))),
+                 0.5f + 0.5f * sin(tau * (t + (0.66f + colorShift))) };
+}
+
+static vfloat plasmaTunnelSDF(vfloat x, vfloat y, vfloat z, float time, float waveAmp, float ringAmp, float ringWobble) {
+    vfloat r = simd::length(x, y);
+    vfloat wave = waveAmp * sin(6.0f * z + 2.0f * sin(3.0f * z + time * 0.6f));
+    vfloat rings = ringAmp * sin(40.0f * (r + ringWobble * sin(2.0f * z + time)));
+    vfloat radius = 1.0f + wave + rings;
+    return r - radius;
+}
+
+static const vfloat allLanes = vfloat(0.0f) == vfloat(0.0f);
+
+static vec3 shadeCircles(const Frame& f, vfloat fx, vfloat fy) {
+    const float T = f.time;
+    vfloat px = (fx / f.resX * 2.0f - 1.0f) * (f.resX / f.resY);
+    vfloat py = fy / f.resY * 2.0f - 1.0f;
+
+    float roz = T * f.speed;
+    float dz = -1.5f + 0.3f * std::sin(T * 0.2f);
+    vfloat len = sqrt(px * px + py * py + dz * dz);
+    vfloat rdx = px / len, rdy = py / len, rdz = vfloat(dz) / len;
+
+    vfloat t = 0.0f, glow = 0.0f, accum = 0.0f;
+    vfloat active = allLanes;
+    for (int i = 0; i < 120 && any(active); i++) {
+        vfloat posx = rdx * t, posy = rdy * t, posz = roz + rdz * t;
+        vfloat zWrapped = mod(posz, vfloat(12.566370f));
+        vfloat d = plasmaTunnelSDF(posx, posy, zWrapped, T, 0.3f, 0.2f, 0.5f);
+        vfloat ad = abs(d);
+        vfloat hit = exp(-20.0f * ad);
+        vfloat n = noise(posx * 1.3f + T * 0.5f, posy * 1.3f - T * 0.3f);
+        vfloat layer = 0.5f + 0.5f * sin(8.0f * posz + 3.0f * n + T * 2.0f);
+        accum += active & (hit * layer);
+        glow += active & (hit * (1.0f - smoothstep(vfloat(0.0f), vfloat(f.thickness), ad)));
+        // lanes that broke out keep their t
+        t = select(active, t + max(vfloat(0.02f), 0.5f * ad), t);
+        active = active & (t <= 100.0f);
+    }
+
+    vfloat depth = clamp(exp(-0.02f * t), 0.0f, 1.0f);
+    vfloat intensity = clamp(accum * 0.6f + glow * 0.8f, 0.0f, 2.5f);
+    vfloat palettePos = fract((T * 0.1f * f.warp) + (t * 0.02f) + accum * 0.1f);
+    vec3 col = plasmaPalette(palettePos, f.colorShift) * intensity;
+
+    vfloat plen = simd::length(px, py);
+    vfloat veins = 0.5f + 0.5f * sin(20.0f * plen - T * 2.5f + noise(px * 10.0f, py * 10.0f));
+    col = col + plasmaPalette(palettePos + 0.2f, f.colorShift) * (0.15f * veins);
+
+    vfloat vig = smoothstep(vfloat(1.2f), vfloat(0.2f), plen);
+    col = col * vig;
+    col = mix(vec3{ 0.02f, 0.02f, 0.03f }, col, depth);
+    return col;
+}
+
+static vec3 shadeTwirl(const Frame& f, vfloat fx, vfloat fy) {
+    const float T = f.time;
+    vfloat uvx = fx / f.resX, uvy = fy / f.resY;
+    vfloat px = (uvx * 2.0f - 1.0f) * (f.resX / f.resY);
+    vfloat py = uvy * 2.0f - 1.0f;
+
+    float cmx = f.k[0], cmy = f.k[1];
+    px -= cmx * 0.6f;
+    py -= cmy * 0.6f;
+
+    vfloat r = simd::length(px, py);
+    vfloat swirlStrength = 0.8f * (1.0f / (0.5f + r)) * f.warp;
+    vfloat swirlAngle = f.k[7] + 2.0f * sin(f.k[8] + r * 6.0f);
+    vfloat s, c;
+    sincos(swirlAngle * swirlStrength, s, c);
+    vfloat qx = c * px + s * py, qy = c * py - s * px;
+    px = qx; py = qy;
+
+    float rox = cmx * 2.0f, roy = cmy * 2.0f, roz = T * f.speed;
+    float dz = -f.k[2];
+    vfloat len = sqrt(px * px + py * py + dz * dz);
+    vfloat rdx = px / len, rdy = py / len, rdz = vfloat(dz) / len;
+
+    vfloat t = 0.0f, glow = 0.0f;
+    vfloat accumR = 0.0f, accumG = 0.0f, accumB = 0.0f;
+    vfloat active = allLanes;
+    for (int i = 0; i < 140 && any(active); i++) {
+        vfloat posx = rox + rdx * t, posy = roy + rdy * t, posz = roz + rdz * t;
+        vfloat zWrapped = mod(posz + 10.0f * sin(T * 0.15f + posx * 0.07f), vfloat(12.566370f));
+        vfloat d = plasmaTunnelSDF(posx, posy, zWrapped, T, 0.35f, 0.22f, 0.6f);
+        vfloat ad = abs(d);
+        vfloat hit = exp(-24.0f * ad);
+        vfloat n = noise(posx * 1.6f + T * 0.6f, posy * 1.6f - T * 0.4f);
+        vfloat layerBase = 0.5f + 0.5f * sin(10.0f * posz + 4.0f * n + T * 3.0f);
+        vfloat pulse = 0.6f + 0.4f * sin(posz * 3.0f + T * 4.0f + n * 6.0f);
+        vfloat lr = layerBase * (1.0f + 0.2f * sin(T * 2.3f + posz * 2.0f + n * 3.0f));
+        vfloat lg = layerBase * (1.0f + 0.2f * sin(T * 2.7f + posz * 2.2f + n * 2.5f));
+        vfloat lb = layerBase * (1.0f + 0.2f * sin(T * 3.1f + posz * 2.4f + n * 2.0f));
+        vfloat hp = active & (hit * pulse);
+        accumR += hp * lr;
+        accumG += hp * lg;
+        accumB += hp * lb;
+        glow += active & (hit * (1.0f - smoothstep(vfloat(0.0f), vfloat(f.thickness), ad)));
+        t = select(active, t + max(vfloat(0.015f), 0.45f * ad), t);
+        active = active & (t <= 200.0f);
+    }
+
+    vfloat depth = clamp(exp(-0.018f * t), 0.0f, 1.0f);
+    vfloat basePos = fract(f.k[3] + (t * 0.018f));
+    vfloat posR = fract(basePos + accumR * 0.08f + 0.01f);
+    vfloat posG = fract(basePos + accumG * 0.06f + 0.00f);
+    vfloat posB = fract(basePos + accumB * 0.04f - 0.01f);
+
+    vfloat intenR = clamp(accumR * 0.55f + glow * 0.9f, 0.0f, 3.0f);
+    vfloat intenG = clamp(accumG * 0.55f + glow * 0.9f, 0.0f, 3.0f);
+    vfloat intenB = clamp(accumB * 0.55f + glow * 0.9f, 0.0f, 3.0f);
+    vec3 col{ plasmaPalette(posR, f.colorShift).r * intenR,
+              plasmaPalette(posG, f.colorShift).g * intenG,
+              plasmaPalette(posB, f.colorShift).b * intenB };
+    col = col + plasmaPalette(basePos + 0.2f, f.colorShift)
+        * (0.15f * (0.5f + 0.5f * noise(px * 8.0f + T * 0.7f, py * 8.0f + T * 0.7f)));
+
+    vfloat plen = simd::length(px, py);
+    vfloat veins = 0.5f + 0.5f * sin(30.0f * plen - T * 3.2f + noise(px * 12.0f, py * 12.0f));
+    col = col + plasmaPalette(basePos + 0.35f, f.colorShift) * (0.12f * veins);
+
+    vfloat vig = smoothstep(vfloat(1.3f), vfloat(0.18f), plen);
+    col = col * vig;
+    col = mix(vec3{ 0.015f, 0.015f, 0.02f }, col, depth);
+
+    vfloat caNoise = noise(uvx * 10.0f + T * 0.3f, uvy * 10.0f + T * 0.3f);
+    col.r = mix(col.r, plasmaPalette(fract(basePos + caNoise * 0.02f + 0.02f), f.colorShift).r, vfloat(0.12f));
+    col.b = mix(col.b, plasmaPalette(fract(basePos - caNoise * 0.02f - 0.02f), f.colorShift).b, vfloat(0.12f));
+    return col;
+}
+
+// ---- shader3-tunnel.cpp ----
+
+static vec3 tunnelMaterial(const Frame& f, vfloat r, vfloat a, float z) {
+    float ringFreq = f.k[7];
+    vfloat ring = sin(ringFreq * r - 0.6f * z);
+    vfloat stripes = sin(8.0f * a + (1.2f * z + f.colorShift));
+    vfloat mixv = 0.5f + 0.5f * ring * stripes;
+
+    vfloat palettePhase = 0.5f + 0.5f * sin((a + f.colorShift) * 2.0f);
+    vec3 col = mix(vec3{ 0.10f, 0.25f, 0.90f }, vec3{ 0.95f, 0.30f, 0.10f }, palettePhase);
+    col = col * (0.6f + 0.4f * mixv);
+
+    vfloat v = smoothstep(vfloat(f.k[6]), vfloat(0.2f), r);
+    return col * (0.6f + 0.4f * v);
+}
+
+static vec3 shadeTunnel(const Frame& f, vfloat fx, vfloat fy) {
+    vfloat px = (fx * 2.0f - f.resX) / f.resY;
+    vfloat py = (fy * 2.0f - f.resY) / f.resY;
+    float z = f.phase[0];
+
+    float c = f.k[2], s = f.k[3];
+    vfloat dx = px - f.k[0], dy = py - f.k[1];
+    vfloat qx = c * dx + s * dy, qy = c * dy - s * dx;
+
+    vfloat r = simd::length(qx, qy);
+    vfloat a = atan2(qy, qx);
+    a = a + f.k[8] * sin(2.0f * a);
+    vec3 col = tunnelMaterial(f, r, a, z);
+
+    vfloat glow = exp(-f.k[5] * r) * f.k[4];
+    col = col + vec3{ 0.9f, 0.9f, 1.0f } * glow;
+
+    vfloat rings = 0.5f + 0.5f * sin(10.0f * r - 0.6f * z);
+    col = col * (0.8f + 0.2f * rings);
+
+    if (std::fabs(f.colorShift) > hueShiftThreshold) col = mulConsts(f.k, col);
+    return col;
+}
+
+// ---- shader4-flowerpower.cpp ----
+
+static vec3 shadeFlowerPower(const Frame& f, vfloat fx, vfloat fy) {
+    vfloat px = (fx * 2.0f - f.resX) / f.resY;
+    vfloat py = (fy * 2.0f - f.resY) / f.resY;
+    vfloat r = simd::length(px, py);
+    vfloat a = atan2(py, px);
+    float z = f.time * 2.0f;
+    vfloat v = sin(10.0f * r - z) * sin(6.0f * a + z);
+    return vec3{ 0.5f + 0.5f * v, 0.3f + 0.3f * v, 0.8f - 0.5f * v };
+}
+
+// ---- shader5-45single.cpp ----
+
+static vec3 shade45Single(const Frame& f, vfloat fx, vfloat fy) {
+    float resX = f.resX, resY = f.resY;
+    if (resX <= 0.0f || resY <= 0.0f) { resX = 1280.0f; resY = 720.0f; }
+    vfloat px = (fx * 2.0f - resX) / resY;
+    vfloat py = (fy * 2.0f - resY) / resY;
+
+    float z = f.time * std::max(f.speed, 0.001f);
+    vfloat r = simd::length(px, py);
+    vfloat a = atan2(py, px);
+    a += f.warp * 0.25f * sin(2.0f * a + 0.8f * z);
+
+    vfloat rings = smoothstep(vfloat(f.thickness), vfloat(0.0f), abs(sin(10.0f * r - 0.7f * z)));
+    vfloat stripes = 0.5f + 0.5f * sin(6.0f * a + (1.1f * z + f.colorShift));
+    vec3 col = mix(vec3{ 0.12f, 0.25f, 0.90f }, vec3{ 0.95f, 0.30f, 0.10f }, stripes);
+    return col * (0.45f + 0.55f * rings);
+}
+
+// ---- shader6 - ThorTunnel.cpp ----
+
+static vfloat hammerMask(vfloat ux, vfloat uy, const float* k) {
+    float zpos = k[8], scale = k[9];
+
+    vfloat px = ux / scale, py = uy / scale;
+    vfloat handle = smoothstep(vfloat(0.02f), vfloat(0.01f), abs(px))
+        * smoothstep(vfloat(0.6f), vfloat(0.3f), abs(py - (0.3f - 0.8f * zpos)));
+    vfloat hx = px, hy = py - (-0.15f - 0.5f * zpos);
+    vfloat headRect = smoothstep(vfloat(0.35f + 0.02f * scale), vfloat(0.33f + 0.02f * scale), max(abs(hx), abs(hy * 0.4f)));
+    vfloat mask = clamp(headRect + handle * 0.7f, 0.0f, 1.0f);
+    return smoothstep(vfloat(0.15f), vfloat(0.0f), 1.0f - mask);
+}
+
+static vec3 thorPalette(vfloat a, vfloat r, float t, float colorShift) {
+    vfloat wheel = 0.5f + 0.5f * sin(a * 2.0f + (t * 0.8f + colorShift));
+    vec3 col = mix(vec3{ 0.12f, 0.25f, 1.0f }, vec3{ 1.0f, 0.45f, 0.08f }, wheel);
+    return col * (0.5f + 0.5f * smoothstep(vfloat(1.6f), vfloat(0.2f), r));
+}
+
+static vfloat ringsPattern(vfloat r, float z, float thickness, float freq) {
+    vfloat rim = sin(freq * r - 0.9f * z);
+    return smoothstep(vfloat(0.2f), vfloat(0.5f), rim * 0.8f + 0.2f * thickness);
+}
+
+static vec3 shadeThor(const Frame& f, vfloat fx, vfloat fy) {
+    vfloat ux = (fx * 2.0f - f.resX) / f.resY;
+    vfloat uy = (fy * 2.0f - f.resY) / f.resY;
+    float z = f.phase[0];
+
+    float c = f.k[2], s = f.k[3];
+    vfloat ox = ux - f.k[0], oy = uy - f.k[1];
+    vfloat qx = c * ox + s * oy, qy = c * oy - s * ox;
+    vfloat r = simd::length(qx, qy);
+    vfloat a = atan2(qy, qx);
+
+    vfloat rings = ringsPattern(r, z, f.thickness, f.k[10]);
+    vec3 col = thorPalette(a, r, z, f.colorShift) * (0.5f + 0.6f * rings);
+
+    vfloat warpFall = smoothstep(vfloat(0.0f), vfloat(1.6f), r);
+    a += f.k[5] * f.k[4] * warpFall * (0.8f * sin(2.2f * a + 0.6f * z) + 0.6f * sin(5.1f * a + 0.12f * z));
+
+    vfloat streak = smoothstep(vfloat(0.0f), vfloat(0.3f), 1.0f - abs(sin(18.0f * (a + 0.2f * z))));
+    vfloat core = max(vfloat(0.0f), 1.0f - r * 6.0f);
+    col = col + vec3{ 0.9f, 0.95f, 1.0f } * (core * core * core * streak * f.k[6]);
+
+    vfloat hammer = hammerMask(ux, uy * 1.6f, f.k);
+    const float hr = mix(0.15f, 1.0f, 0.9f), hg = mix(0.1f, 0.95f, 0.9f), hb = mix(0.05f, 0.9f, 0.9f);
+    vec3 hammerCol{ hr + 2.2f * hammer, hg + 2.2f * 0.9f * hammer, hb + 2.2f * 0.6f * hammer };
+    col = mix(col, hammerCol, smoothstep(vfloat(0.02f), vfloat(0.6f), hammer));
+
+    vfloat v = smoothstep(vfloat(1.6f), vfloat(0.2f), r) * f.k[7];
+    col = col * v;
+
+    if (std::fabs(f.colorShift) > hueShiftThreshold) col = mulConsts(f.k, col);
+    return col;
+}
+
+// ---- frame ----
+
+typedef vec3 (*Kernel)(const Frame& f, vfloat fx, vfloat fy);
+
+static const struct { const EffectDesc* desc; Kernel kernel; } kernels[] = {
+    { &circlesEffect, shadeCircles },
+    { &twirlEffect, shadeTwirl },
+    { &tunnelEffect, shadeTunnel },
+    { &flowerPowerEffect, shadeFlowerPower },
+    { &singleEffect, shade45Single },
+    { &thorTunnelEffect, shadeThor },
+};
+
+static Kernel findKernel(const EffectDesc& desc) {
+    for (const auto& k : kernels)
+        if (k.desc == &desc) return k.kernel;
+    return nullptr;
+}
+
+bool cpuRendererSupports(const EffectDesc& desc) {
+    return findKernel(desc) != nullptr;
+}
+
+// The tonemap.h resolve, without its dither
+static vfloat shoulder(vfloat c, float knee) {
+    float soft = std::max(1.0f - knee, 1e-5f);
+    vfloat over = max(c - knee, 0.0f);
+    return min(c, knee) + soft * (1.0f - exp(-over / soft));
+}
+
+static vec3 tonemap(vec3 c, const ToneDesc& tone) {
+    c = c * tone.exposure;
+    c = vec3{ shoulder(max(c.r, 0.0f), tone.knee), shoulder(max(c.g, 0.0f), tone.knee), shoulder(max(c.b, 0.0f), tone.knee) };
+    return clamp01(pow(c, tone.gamma));
+}
+
+static void shadeTile(Kernel kernel, const Frame& f, const ToneDesc& tone, int x0, int y0, int x1, int y1, uint8_t* rgba, int w) {
+    float laneOffset[simd::lanes];
+    for (int k = 0; k < simd::lanes; ++k) laneOffset[k] = k + 0.5f; // gl_FragCoord is the pixel centre
+    const vfloat lanesX = vfloat::load(laneOffset);
+    float r[simd::lanes], g[simd::lanes], b[simd::lanes];
+    for (int y = y0; y < y1; ++y) {
+        vfloat fy = y + 0.5f;
+        for (int x = x0; x < x1; x += simd::lanes) {
+            vec3 c = tonemap(kernel(f, lanesX + (float)x, fy), tone) * 255.0f;
+            // unorm conversion, round to nearest
+            (c.r + 0.5f).store(r); (c.g + 0.5f).store(g); (c.b + 0.5f).store(b);
+            int n = std::min(simd::lanes, x1 - x);
+            uint8_t* out = rgba + ((size_t)y * w + x) * 4;
+            for (int k = 0; k < n; ++k, out += 4) {
+                out[0] = (uint8_t)r[k];
+                out[1] = (uint8_t)g[k];
+                out[2] = (uint8_t)b[k];
+                out[3] = 255;
+            }
+        }
+    }
+}
+
+// Same taps as the chromatic-aberration.cpp resolve: red from +shift, blue
+// from -shift pixels, linear filtering along the row, clamped to the edges.
+static void applyChromaticAberration(std::vector<uint8_t>& rgba, int w, int h, float offset) {
+    float shift = offset * 0.5f * h;
+    std::vector<uint8_t> scene = rgba;
+    auto tap = [&](const uint8_t* row, float x, int channel) {
+        x = std::clamp(x, 0.0f, (float)(w - 1));
+        int i0 = (int)x, i1 = std::min(i0 + 1, w - 1);
+        float t = x - i0;
+        float v = mix((float)row[i0 * 4 + channel], (float)row[i1 * 4 + channel], t);
+        return (uint8_t)(v + 0.5f);
+    };
+    parallelFor(h, [&](int y) {
+        const uint8_t* src = scene.data() + (size_t)y * w * 4;
+        uint8_t* dst = rgba.data() + (size_t)y * w * 4;
+        for (int x = 0; x < w; ++x) {
+            dst[x * 4 + 0] = tap(src, x + shift, 0);
+            dst[x * 4 + 2] = tap(src, x - shift, 2);
+        }
+    });
+}
+
+bool renderEffectCpu(const EffectDesc& desc, const EffectParams& params, float time,
+    int w, int h, std::vector<uint8_t>& rgba) {
+    Kernel kernel = findKernel(desc);
+    if (!kernel || w <= 0 || h <= 0) return false;
+    std::call_once(latticeOnce, [] { buildNoiseLattice(lattice); });
+
+    FrameParams block = effectFrameParams(desc, params, time, w, h);
+    Frame f{ time, (float)w, (float)h, params.speed, params.warp, params.thickness, params.colorShift,
+        block.iPhase, block.iConsts };
+    rgba.resize((size_t)w * h * 4);
+    int tilesX = (w + tileW - 1) / tileW, tilesY = (h + tileH - 1) / tileH;
+    parallelFor(tilesX * tilesY, [&](int tile) {
+        int x0 = (tile % tilesX) * tileW, y0 = (tile / tilesX) * tileH;
+        shadeTile(kernel, f, desc.tone, x0, y0, std::min(x0 + tileW, w), std::min(y0 + tileH, h), rgba.data(), w);
+    });
+
+    float aberration = chromaOffset(desc.chroma, params.warp);
+    if (aberration > 0.0f) applyChromaticAberration(rgba, w, h, aberration);
+    return true;
+}
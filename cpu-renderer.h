@@ -0,0 +1,21 @@
+// cpu-renderer.h
+// CPU backend for the built-in effects, for thumbnails without a GPU and for
+// golden reference images. Each effect's fragment shader is ported to the
+// 8-lane types of simd.h, one row batch of 8 pixels per call; the frame is
+// split into tiles spread over the work-stealing pool (thread-pool.h). The
+// noise reads the same hash lattice the GPU samples (noise-texture.h), and the
+// tonemap and chromatic aberration passes are applied the same way, so a
+// frame matches the default GPU build within rounding and the dither.
+#pragma once
+#include <cstdint>
+#include <vector>
+
+#include "effects.h"
+
+// True if desc is one of the built-in effects this backend has a port of
+bool cpuRendererSupports(const EffectDesc& desc);
+
+// Renders one frame into rgba (w * h * 4 bytes, bottom row first like
+// glReadPixels). Uses the pool if it's running; false if desc isn't supported.
+bool renderEffectCpu(const EffectDesc& desc, const EffectParams& params, float time,
+    int w, int h, std::vector<uint8_t>& rgba);
@@ -0,0 +1,143 @@
+// dynamic-res.cpp
+// Dynamic resolution controller and sharpening upscale.
+
+#include "dynamic-res.h"
+#include "profiler.h"
+#include <algorithm>
+#include <cmath>
+
+static const char* upscaleFragmentSrc = R"glsl(
+#version 330 core
+in vec2 uv;
+out vec4 fragColor;
+uniform sampler2D uScene;
+uniform vec2 uUvScale;   // part of the texture the effect rendered into
+uniform vec2 uTexel;     // 1 / texture size
+uniform float uSharpness;
+
+vec3 tap(vec2 st){
+    // stay inside the rendered rectangle so bilinear never pulls in stale texels
+    return texture(uScene, clamp(st, 0.5 * uTexel, uUvScale - 0.5 * uTexel)).rgb;
+}
+
+void main(){
+    vec2 st = uv * uUvScale;
+    vec3 c = tap(st);
+    vec3 n = tap(st + vec2(0.0, uTexel.y));
+    vec3 s = tap(st - vec2(0.0, uTexel.y));
+    vec3 e = tap(st + vec2(uTexel.x, 0.0));
+    vec3 w = tap(st - vec2(uTexel.x, 0.0));
+
+    // contrast-adaptive sharpening: back off where local contrast is already high
+    vec3 mn = min(c, min(min(n, s), min(e, w)));
+    vec3 mx = max(c, max(max(n, s), max(e, w)));
+    vec3 amp = sqrt(clamp(min(mn, 1.0 - mx) / max(mx, vec3(1e-4)), 0.0, 1.0));
+    vec3 wgt = -amp / mix(8.0, 5.0, uSharpness);
+    vec3 col = (c + (n + s + e + w) * wgt) / (1.0 + 4.0 * wgt);
+    fragColor = vec4(mix(c, col, step(0.001, uSharpness)), 1.0);
+}
+)glsl";
+
+static const int historyFrames = 32;
+static const float minScale = 0.35f;
+static const float maxScale = 1.0f;
+
+static struct {
+    bool initialized = false;
+    RenderTarget target;
+    GLuint prog = 0;
+    GLint locScene = -1, locUvScale = -1, locTexel = -1, locSharpness = -1;
+    int w = 0, h = 0;     // window size
+    int rw = 0, rh = 0;   // render size this frame
+    GLint prevFbo = 0;    // where the upscale goes (the window, or an output view)
+    float targetMs = 14.0f;
+    float scale = 1.0f;
+    float costPerPixel = 0.0f; // smoothed GPU ms per rendered pixel
+    uint64_t lastFrameUsed = ~0ull;
+    int pixels[historyFrames] = {};
+} dr;
+
+bool initDynamicRes(int w, int h, float targetMs) {
+    GLuint vs = compileShader(GL_VERTEX_SHADER, vertexShaderSrc);
+    GLuint fs = compileShader(GL_FRAGMENT_SHADER, upscaleFragmentSrc);
+    if (!vs || !fs) return false;
+    dr.prog = linkProgram(vs, fs);
+    glDeleteShader(vs); glDeleteShader(fs);
+    if (!dr.prog) return false;
+    dr.locScene = glGetUniformLocation(dr.prog, "uScene");
+    dr.locUvScale = glGetUniformLocation(dr.prog, "uUvScale");
+    dr.locTexel = glGetUniformLocation(dr.prog, "uTexel");
+    dr.locSharpness = glGetUniformLocation(dr.prog, "uSharpness");
+
+    if (!createRenderTarget(dr.target, w, h)) return false;
+    dr.w = w; dr.h = h;
+    dr.targetMs = targetMs;
+    dr.scale = 1.0f;
+    dr.costPerPixel = 0.0f;
+    dr.initialized = true;
+    return true;
+}
+
+void shutdownDynamicRes() {
+    if (!dr.initialized) return;
+    destroyRenderTarget(dr.target);
+    glDeleteProgram(dr.prog);
+    dr.prog = 0;
+    dr.initialized = false;
+}
+
+void resizeDynamicRes(int w, int h) {
+    if (!dr.initialized) return;
+    dr.w = w; dr.h = h;
+    resizeRenderTarget(dr.target, w, h);
+}
+
+// GPU time is roughly proportional to shaded pixels, so track cost per pixel
+// and size the next frames to fit the budget.
+static void updateScale() {
+    uint64_t frame; float ms;
+    if (!profilerLatestGpu(frame, ms) || frame == dr.lastFrameUsed) return;
+    if (profilerFrameIndex() - frame >= historyFrames) return;
+    dr.lastFrameUsed = frame;
+    int px = dr.pixels[frame % historyFrames];
+    if (px <= 0 || ms <= 0.0f) return;
+
+    float cost = ms / px;
+    dr.costPerPixel = dr.costPerPixel > 0.0f ? dr.costPerPixel * 0.8f + cost * 0.2f : cost;
+    float want = std::sqrt(dr.targetMs / (dr.costPerPixel * (float)dr.w * dr.h));
+    want = std::clamp(want, minScale, maxScale);
+    // move part of the way and ignore jitter, the measurement lags a few frames
+    if (std::fabs(want - dr.scale) > 0.02f) dr.scale += (want - dr.scale) * 0.25f;
+    dr.scale = std::clamp(dr.scale, minScale, maxScale);
+}
+
+void beginDynamicRes(int& rw, int& rh) {
+    updateScale();
+    dr.rw = std::max(1, (int)(dr.w * dr.scale + 0.5f));
+    dr.rh = std::max(1, (int)(dr.h * dr.scale + 0.5f));
+    dr.pixels[profilerFrameIndex() % historyFrames] = dr.rw * dr.rh;
+    rw = dr.rw; rh = dr.rh;
+
+    glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &dr.prevFbo);
+    glBindFramebuffer(GL_FRAMEBUFFER, dr.target.fbo);
+    glViewport(0, 0, dr.rw, dr.rh);
+}
+
+void endDynamicRes(const FullscreenTriangle& tri) {
+    glBindFramebuffer(GL_FRAMEBUFFER, (GLuint)dr.prevFbo);
+    glViewport(0, 0, dr.w, dr.h);
+
+    glUseProgram(dr.prog);
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, dr.target.tex);
+    glUniform1i(dr.locScene, 0);
+    glUniform2f(dr.locUvScale, (float)dr.rw / dr.target.w, (float)dr.rh / dr.target.h);
+    glUniform2f(dr.locTexel, 1.0f / dr.target.w, 1.0f / dr.target.h);
+    // sharpen more the further below native we are
+    glUniform1f(dr.locSharpness, std::clamp((1.0f - dr.scale) * 2.0f, 0.0f, 1.0f));
+    drawFullscreenTriangle(tri);
+}
+
+float dynamicResScale() {
+    return dr.scale;
+}
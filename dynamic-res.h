@@ -0,0 +1,21 @@
+// dynamic-res.h
+// Dynamic resolution: the effect renders into a sub-rectangle of an offscreen
+// target whose size follows measured GPU time toward a frame-time budget, and
+// a contrast-adaptive sharpening pass upscales it to the window.
+#pragma once
+#include "gl-util.h"
+
+bool initDynamicRes(int w, int h, float targetMs);
+void shutdownDynamicRes();
+
+// Window resize: reallocates the render target
+void resizeDynamicRes(int w, int h);
+
+// Picks this frame's scale from the GPU times the profiler has returned and
+// binds the target. rw/rh receive the size the effect must render at.
+void beginDynamicRes(int& rw, int& rh);
+// Upscales into the framebuffer that was bound at beginDynamicRes and
+// restores the full-size viewport
+void endDynamicRes(const FullscreenTriangle& tri);
+
+float dynamicResScale();
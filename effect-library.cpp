@@ -0,0 +1,211 @@
+// effect-library.cpp
+// .effect descriptor parsing into owned EffectDescs.
+
+#include "effect-library.h"
+#include "host-input.h"
+#include <algorithm>
+#include <cstdlib>
+#include <deque>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+static const char* paramNames[effectParamCount] = { "speed", "warp", "thickness", "colorShift" };
+static const struct { const char* name; uint32_t bit; } featureNames[] = {
+    { "hueShift", featureHueShift },
+    { "noiseTex", featureNoiseTex },
+    { "stepCount", featureStepCount },
+    { "quality", featureQuality },
+    { "temporal", featureTemporal },
+    { "compute", featureCompute },
+};
+
+// An EffectDesc with the strings and specs it points to
+struct LibraryEffect {
+    EffectDesc desc = {};
+    std::string name, title, source;
+    ParamSpec specs[effectParamCount];
+};
+
+static struct {
+    std::deque<LibraryEffect> owned;   // stable addresses for the descs
+    std::vector<const EffectDesc*> descs;
+} lib;
+
+static bool readFile(const std::filesystem::path& path, std::string& out) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) return false;
+    std::ostringstream ss;
+    ss << in.rdbuf();
+    out = ss.str();
+    return true;
+}
+
+static int findParam(const std::string& name) {
+    for (int i = 0; i < effectParamCount; ++i)
+        if (name == paramNames[i]) return i;
+    return -1;
+}
+
+// An SDL key name; multi-word names ("Keypad +") are written with '_'
+static SDL_Keycode parseKey(std::string name) {
+    std::replace(name.begin(), name.end(), '_', ' ');
+    return SDL_GetKeyFromName(name.c_str());
+}
+
+// One setting; returns an error message, empty if the line is fine
+static std::string parseLine(const std::string& key, std::istringstream& ss, LibraryEffect& fx, int& phases) {
+    EffectDesc& d = fx.desc;
+    if (key == "name") return (ss >> fx.name) ? "" : "expected name <word>";
+    if (key == "title") {
+        std::getline(ss >> std::ws, fx.title);
+        return fx.title.empty() ? "expected title <text>" : "";
+    }
+    if (key == "source") return (ss >> fx.source) ? "" : "expected source <file.glsl>";
+    if (key == "defaults") {
+        EffectParams& p = d.defaults;
+        return (ss >> p.speed >> p.warp >> p.thickness >> p.colorShift) ? "" : "expected defaults <speed> <warp> <thickness> <colorShift>";
+    }
+    if (key == "param") {
+        std::string name, step, down, up;
+        ParamSpec spec = {};
+        if (!(ss >> name >> spec.min >> spec.max >> step) || findParam(name) < 0 || spec.min > spec.max)
+            return "expected param <speed|warp|thickness|colorShift> <min> <max> <step>[x] [<down key> <up key>]";
+        ParamSpec& target = fx.specs[findParam(name)];
+        spec.scale = step.back() == 'x';
+        if (spec.scale) step.pop_back();
+        spec.step = std::strtof(step.c_str(), nullptr);
+        if (!(spec.step > 0.0f) || (spec.scale && spec.step <= 1.0f)) return "step must be above 0, or above 1 with x";
+        spec.down = target.down;
+        spec.up = target.up;
+        if (ss >> down >> up) {
+            spec.down = parseKey(down);
+            spec.up = parseKey(up);
+            if (spec.down == SDLK_UNKNOWN || spec.up == SDLK_UNKNOWN) return "unknown key name";
+            if (hostReservedKey(spec.down) || hostReservedKey(spec.up)) return "key is taken by the host";
+        }
+        target = spec;
+        return "";
+    }
+    if (key == "chroma") {
+        ChromaDesc& c = d.chroma;
+        return (ss >> c.base >> c.warpGain >> c.warpMax) ? "" : "expected chroma <base> <warp gain> <warp max>";
+    }
+    if (key == "tone") {
+        ToneDesc& t = d.tone;
+        if (!(ss >> t.exposure >> t.gamma)) return "expected tone <exposure> <gamma> [<bloom> <threshold> [<knee>]]";
+        if (ss >> t.bloom && !(ss >> t.bloomThreshold)) return "tone: bloom needs a threshold";
+        if (ss >> t.knee && !(t.knee > 0.0f && t.knee <= 1.0f)) return "tone: knee must be in (0, 1]";
+        return "";
+    }
+    if (key == "phase") {
+        TimePhase ph = {};
+        std::string bySpeed;
+        if (phases == timePhaseCount || !(ss >> ph.rate >> ph.period) || ph.period <= 0.0)
+            return "expected phase <rate> <period> [speed], at most 4";
+        if (ss >> bySpeed) {
+            if (bySpeed != "speed") return "expected phase <rate> <period> [speed]";
+            ph.bySpeed = true;
+        }
+        d.phases[phases++] = ph;
+        return "";
+    }
+    if (key == "features") {
+        std::string name;
+        while (ss >> name) {
+            bool found = false;
+            for (const auto& f : featureNames) {
+                if (name == f.name) {
+                    d.features |= f.bit;
+                    found = true;
+                }
+            }
+            if (!found) return "unknown feature '" + name + "'";
+        }
+        return "";
+    }
+    return "unknown setting '" + key + "'";
+}
+
+static bool loadDescriptor(const std::filesystem::path& path, LibraryEffect& fx) {
+    std::ifstream in(path);
+    if (!in) {
+        std::cerr << "Effects: cannot read " << path.string() << "\n";
+        return false;
+    }
+    fx.desc.defaults = { 6.0f, 1.0f, 0.18f, 0.0f };
+    std::copy(defaultParamSpecs, defaultParamSpecs + effectParamCount, fx.specs);
+    int phases = 0;
+    std::string line;
+    for (int lineNo = 1; std::getline(in, line); ++lineNo) {
+        line = line.substr(0, line.find('#'));
+        std::istringstream ss(line);
+        std::string key;
+        if (!(ss >> key)) continue;
+        std::string error = parseLine(key, ss, fx, phases);
+        if (!error.empty()) {
+            std::cerr << "Effects: " << path.string() << ":" << lineNo << ": " << error << "\n";
+            return false;
+        }
+    }
+    if (fx.name.empty() || fx.source.empty()) {
+        std::cerr << "Effects: " << path.string() << " needs a name and a source\n";
+        return false;
+    }
+    std::filesystem::path sourcePath = path.parent_path() / fx.source;
+    if (!readFile(sourcePath, fx.source) || fx.source.empty()) {
+        std::cerr << "Effects: cannot read " << sourcePath.string() << "\n";
+        return false;
+    }
+    if (fx.title.empty()) fx.title = fx.name;
+    fx.desc.name = fx.name.c_str();
+    fx.desc.title = fx.title.c_str();
+    fx.desc.fragmentSrc = fx.source.c_str();
+    fx.desc.paramSpecs = fx.specs;
+    fx.desc.lazy = true;
+    clampEffectParams(fx.desc, fx.desc.defaults);
+    return true;
+}
+
+static bool nameTaken(const std::string& name) {
+    for (const EffectDesc* d : effectRegistry())
+        if (name == d->name) return true;
+    for (const EffectDesc* d : lib.descs)
+        if (name == d->name) return true;
+    return false;
+}
+
+bool loadEffectLibrary(const char* dir) {
+    std::error_code ec;
+    std::vector<std::filesystem::path> files;
+    for (const auto& entry : std::filesystem::directory_iterator(dir, ec))
+        if (entry.is_regular_file() && entry.path().extension() == ".effect") files.push_back(entry.path());
+    if (ec) {
+        std::cerr << "Effects: cannot list " << dir << ": " << ec.message() << "\n";
+        return false;
+    }
+    std::sort(files.begin(), files.end());
+
+    for (const auto& path : files) {
+        LibraryEffect& fx = lib.owned.emplace_back();
+        bool ok = loadDescriptor(path, fx);
+        if (ok && nameTaken(fx.name)) {
+            std::cerr << "Effects: " << path.string() << ": name '" << fx.name << "' is taken\n";
+            ok = false;
+        }
+        if (!ok) {
+            lib.owned.clear();
+            lib.descs.clear();
+            return false;
+        }
+        lib.descs.push_back(&fx.desc);
+    }
+    std::cout << "Effects: " << lib.descs.size() << " descriptors from " << dir << "\n";
+    return true;
+}
+
+const std::vector<const EffectDesc*>& libraryEffects() {
+    return lib.descs;
+}
@@ -0,0 +1,30 @@
+// effect-library.h
+// Effects as data. Every <name>.effect file in a directory describes one
+// effect: its GLSL file and everything an EffectDesc holds, as one setting
+// per line ('#' starts a comment):
+//   name       kaleido                       short name for --effect, unique
+//   title      Kaleido Tunnel                window title (default: the name)
+//   source     kaleido.glsl                  fragment shader, next to the file
+//   defaults   6.0 1.0 0.18 0.0              speed warp thickness colorShift
+//   param      speed 0.01 50 1.1x Down Up    min max step (x: multiply) [down up keys]
+//   chroma     0.005 0.4 2.0                 aberration base, warp gain, warp max
+//   tone       1.0 0.9 0.2 0.9 0.8           exposure gamma [bloom threshold [knee]]
+//   phase      1.0 62.8318 speed             iPhase rate period [speed], in order
+//   features   hueShift noiseTex stepCount quality temporal compute
+// Keys use SDL's names ("Up", "Z", "Keypad +"); the host's own keys (1..9,
+// TAB, page up/down, the F keys, [ ] and ESC) can't be bound. Loaded effects
+// follow the built-in ones in number-key and TAB order and are lazy (see
+// requestEffect in effects.h): only the descriptors are read at startup, and
+// a shader compiles, or comes out of the binary cache, when it is first
+// shown or next to the one shown.
+#pragma once
+#include <vector>
+
+#include "effects.h"
+
+// Reads every descriptor in dir; false (after printing the file and line)
+// if any is malformed, in which case none are used. Call before
+// registerEffects.
+bool loadEffectLibrary(const char* dir);
+// The loaded effects, sorted by file name
+const std::vector<const EffectDesc*>& libraryEffects();
@@ -0,0 +1,294 @@
+// effects.cpp
+// Effect registry: builds every fragment shader into a resident program.
+
+#include "effects.h"
+#include "effect-library.h"
+#include "noise-texture.h"
+#include "frame-params.h"
+#include "temporal.h"
+#include "compute-march.h"
+#include "audio-input.h"
+#include "telemetry.h"
+#include "timeline.h"
+#include <iostream>
+#include <cstring>
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+const std::vector<const EffectDesc*>& effectRegistry() {
+    static const std::vector<const EffectDesc*> registry = {
+        &circlesEffect,
+        &twirlEffect,
+        &tunnelEffect,
+        &flowerPowerEffect,
+        &singleEffect,
+        &thorTunnelEffect,
+    };
+    return registry;
+}
+
+const ParamSpec defaultParamSpecs[effectParamCount] = {
+    { 0.001f, 1000.0f, 1.1f, true, SDLK_DOWN, SDLK_UP },       // speed
+    { 0.1f, FLT_MAX, 0.1f, false, SDLK_LEFT, SDLK_RIGHT },     // warp
+    { 0.01f, FLT_MAX, 0.01f, false, SDLK_z, SDLK_x },          // thickness
+    { -FLT_MAX, FLT_MAX, 0.05f, false, SDLK_v, SDLK_c },       // colorShift
+};
+
+float& effectParam(EffectParams& p, int i) {
+    float* fields[effectParamCount] = { &p.speed, &p.warp, &p.thickness, &p.colorShift };
+    return *fields[i];
+}
+
+const ParamSpec* effectParamSpecs(const EffectDesc& desc) {
+    return desc.paramSpecs ? desc.paramSpecs : defaultParamSpecs;
+}
+
+void clampEffectParams(const EffectDesc& desc, EffectParams& p) {
+    const ParamSpec* specs = effectParamSpecs(desc);
+    for (int i = 0; i < effectParamCount; ++i)
+        effectParam(p, i) = std::clamp(effectParam(p, i), specs[i].min, specs[i].max);
+}
+
+// The params as drawn this frame: the keys' values plus any audio mapping
+static EffectParams liveParams(const Effect& fx) {
+    EffectParams p = fx.params;
+    p.warp += audioOffset(AudioTarget::Warp);
+    p.thickness = std::max(0.01f, p.thickness + audioOffset(AudioTarget::Thickness));
+    p.colorShift += audioOffset(AudioTarget::ColorShift);
+    return p;
+}
+
+// Variant builds dropped while still compiling; deleted once they finish
+static std::vector<std::shared_ptr<ProgramJob>> retiredJobs;
+
+void registerEffects(std::vector<Effect>& effects) {
+    auto add = [&](const EffectDesc* desc) {
+        Effect fx;
+        fx.desc = desc;
+        fx.source = desc->fragmentSrc;
+        fx.params = desc->defaults;
+        effects.push_back(fx);
+    };
+    for (const EffectDesc* desc : effectRegistry()) add(desc);
+    for (const EffectDesc* desc : libraryEffects()) add(desc);
+}
+
+void requestEffect(Effect& fx) {
+    fx.requested = true;
+}
+
+void reloadEffect(Effect& fx, const std::string& source) {
+    // only one build per effect at a time; the newest source wins
+    if (fx.job) {
+        fx.pendingSource = source;
+        return;
+    }
+    fx.source = source;
+    fx.job = submitProgram(fx.desc->name, vertexShaderSrc, withFrameParams(fx.source));
+}
+
+// Program state, set once: the block binding and the sampler units. The
+// 1x1 draw makes drivers that defer work until first use do it now (compute
+// builds have nothing to draw). Returns whether the program samples the
+// noise texture.
+static bool prepareProgram(GLuint prog, const FullscreenTriangle& tri, bool compute = false) {
+    bindFrameParamsBlock(prog);
+    glUseProgram(prog);
+    GLint locNoise = glGetUniformLocation(prog, "iNoise");
+    if (locNoise >= 0) {
+        glUniform1i(locNoise, noiseTextureUnit);
+        bindNoiseTexture();
+    }
+    GLint locHistory = glGetUniformLocation(prog, "iHistory");
+    if (locHistory >= 0) glUniform1i(locHistory, temporalHistoryUnit);
+    GLint locHistoryDepth = glGetUniformLocation(prog, "iHistoryDepth");
+    if (locHistoryDepth >= 0) glUniform1i(locHistoryDepth, temporalHistoryDepthUnit);
+    if (compute) return locNoise >= 0;
+    GLint vp[4]; glGetIntegerv(GL_VIEWPORT, vp);
+    glViewport(0, 0, 1, 1);
+    drawFullscreenTriangle(tri);
+    glViewport(vp[0], vp[1], vp[2], vp[3]);
+    return locNoise >= 0;
+}
+
+// The source changed; variants of the old one are of no use
+static void dropVariants(Effect& fx) {
+    for (EffectVariant& v : fx.variants) {
+        glDeleteProgram(v.prog);
+        if (v.job) retiredJobs.push_back(v.job);
+    }
+    fx.variants.clear();
+    fx.active = -1;
+}
+
+// Takes a finished variant build; true while it is still compiling
+static bool resolveVariant(const Effect& fx, EffectVariant& v, const FullscreenTriangle& tri) {
+    BuildState state = v.job->state.load(std::memory_order_acquire);
+    if (state == BuildState::Pending) return true;
+    if (state == BuildState::Ready) {
+        v.prog = v.job->prog;
+        v.usesNoise = prepareProgram(v.prog, tri, v.variant.compute == 1);
+        telemetryLog(LogLevel::Info, "Effect '%s' variant %s%s", fx.desc->name,
+            shaderVariantName(v.variant).c_str(), v.job->fromCache ? " (cached)" : "");
+    } else {
+        telemetryLog(LogLevel::Warn, "Variant %s of '%s' failed, drawing the generic build",
+            shaderVariantName(v.variant).c_str(), fx.desc->name);
+        v.failed = true;
+    }
+    v.job.reset();
+    return false;
+}
+
+// Resolves finished variant builds and points fx.active at the one the
+// effect's params need, queueing it if it was never built. Returns the
+// number of variant builds in flight.
+static int updateVariants(Effect& fx, const FullscreenTriangle& tri) {
+    int building = 0;
+    for (EffectVariant& v : fx.variants)
+        if (v.job && resolveVariant(fx, v, tri)) ++building;
+
+    fx.active = -1;
+    ShaderVariant want = selectShaderVariant(fx.desc->features, liveParams(fx).colorShift);
+    if (want.generic() || !fx.prog) return building;
+    int index = -1;
+    for (size_t i = 0; i < fx.variants.size() && index < 0; ++i)
+        if (fx.variants[i].variant == want) index = (int)i;
+    if (index < 0) {
+        EffectVariant v;
+        v.variant = want;
+        std::string label = std::string(fx.desc->name) + " [" + shaderVariantName(want) + "]";
+        if (want.compute == 1)
+            v.job = submitComputeProgram(label.c_str(), withFrameParams(computeShaderSource(fx.source), shaderVariantDefines(want)));
+        else
+            v.job = submitProgram(label.c_str(), vertexShaderSrc, withFrameParams(fx.source, shaderVariantDefines(want)));
+        fx.variants.push_back(v);
+        index = (int)fx.variants.size() - 1;
+        // cache hits are ready at once
+        if (resolveVariant(fx, fx.variants[index], tri)) ++building;
+    }
+    if (fx.variants[index].prog) fx.active = index;
+    return building;
+}
+
+int updateEffects(std::vector<Effect>& effects, const FullscreenTriangle& tri) {
+    pumpShaderCompiler();
+
+    for (size_t i = 0; i < retiredJobs.size();) {
+        BuildState state = retiredJobs[i]->state.load(std::memory_order_acquire);
+        if (state == BuildState::Pending) { ++i; continue; }
+        if (state == BuildState::Ready) glDeleteProgram(retiredJobs[i]->prog);
+        retiredJobs.erase(retiredJobs.begin() + i);
+    }
+
+    int building = 0;
+    for (size_t i = 0; i < effects.size(); ++i) {
+        Effect& fx = effects[i];
+        if (!fx.job && !fx.prog && !fx.failed && (!fx.desc->lazy || fx.requested)) reloadEffect(fx, fx.source);
+        if (!fx.job) continue;
+        BuildState state = fx.job->state.load(std::memory_order_acquire);
+        if (state == BuildState::Pending) { ++building; continue; }
+        if (state == BuildState::Failed) {
+            if (fx.prog) telemetryLog(LogLevel::Warn, "Keeping last good program for '%s'", fx.desc->name);
+            else telemetryLog(LogLevel::Warn, "Skipping effect '%s'", fx.desc->name);
+            fx.failed = !fx.prog;
+            fx.job.reset();
+            if (!fx.pendingSource.empty()) {
+                reloadEffect(fx, fx.pendingSource);
+                fx.pendingSource.clear();
+                ++building;
+            }
+            continue;
+        }
+
+        GLuint prog = fx.job->prog;
+        fx.usesNoise = prepareProgram(prog, tri);
+        telemetryLog(LogLevel::Info, "Effect %d '%s'%s%s", (int)i + 1, fx.desc->name,
+            fx.job->fromCache ? " (cached)" : "", fx.usesNoise ? " noise=texture" : "");
+        glDeleteProgram(fx.prog);
+        fx.prog = prog;
+        fx.failed = false;
+        fx.job.reset();
+        dropVariants(fx);
+        if (!fx.pendingSource.empty()) {
+            reloadEffect(fx, fx.pendingSource);
+            fx.pendingSource.clear();
+            ++building;
+        }
+    }
+    for (Effect& fx : effects) building += updateVariants(fx, tri);
+    return building;
+}
+
+void destroyEffects(std::vector<Effect>& effects) {
+    for (Effect& fx : effects) {
+        dropVariants(fx);
+        glDeleteProgram(fx.prog);
+    }
+    for (const auto& job : retiredJobs)
+        if (job->state.load() == BuildState::Ready) glDeleteProgram(job->prog);
+    retiredJobs.clear();
+    effects.clear();
+}
+
+int findEffect(const std::vector<Effect>& effects, const char* name) {
+    for (size_t i = 0; i < effects.size(); ++i)
+        if (std::strcmp(effects[i].desc->name, name) == 0) return (int)i;
+    return -1;
+}
+
+FrameParams effectFrameParams(const EffectDesc& desc, const EffectParams& live, double time, int w, int h,
+                              float historyDt) {
+    FrameParams params{};
+    params.iResolution[0] = (float)w;
+    params.iResolution[1] = (float)h;
+    params.iTime = (float)time;
+    params.speed = live.speed;
+    params.warp = live.warp;
+    params.thickness = live.thickness;
+    params.colorShift = live.colorShift;
+    params.iTimeHi = (float)time;
+    params.iTimeLo = (float)(time - (double)params.iTimeHi);
+    // a keyed speed is integrated, so a change never jumps the camera
+    double travel = timelineKeysSpeed() ? timelineTravel(time) : time * live.speed;
+    for (int i = 0; i < timePhaseCount; ++i) {
+        const TimePhase& ph = desc.phases[i];
+        if (ph.rate == 0.0 || ph.period <= 0.0) continue;
+        double phase = std::fmod((ph.bySpeed ? travel : time) * ph.rate, ph.period);
+        params.iPhase[i] = (float)(phase < 0.0 ? phase + ph.period : phase);
+    }
+    // frame constants may reproject: they see the history's age
+    params.iHistoryDt = historyDt;
+    if (desc.frameConsts) desc.frameConsts(time, params);
+    return params;
+}
+
+void updateEffectFrame(const Effect& fx, double time, int w, int h, int frame, float historyDt) {
+    FrameParams params = effectFrameParams(*fx.desc, liveParams(fx), time, w, h, historyDt);
+    params.iFrame = frame;
+    std::memcpy(params.iAudio, audioLevels(), sizeof(params.iAudio));
+    updateFrameParams(params);
+}
+
+void useEffect(const Effect& fx) {
+    const EffectVariant* v = fx.active >= 0 ? &fx.variants[fx.active] : nullptr;
+    glUseProgram(v ? v->prog : fx.prog);
+    if (v ? v->usesNoise : fx.usesNoise) bindNoiseTexture();
+}
+
+bool effectTemporal(const Effect& fx) {
+    return fx.active >= 0 && fx.variants[fx.active].variant.temporal == 1;
+}
+
+bool effectCompute(const Effect& fx) {
+    return fx.active >= 0 && fx.variants[fx.active].variant.compute == 1;
+}
+
+float effectAberration(const Effect& fx) {
+    return chromaOffset(fx.desc->chroma, liveParams(fx).warp);
+}
+
+float chromaOffset(const ChromaDesc& c, float warp) {
+    if (c.base <= 0.0f) return 0.0f;
+    return c.base * (1.0f + c.warpGain * std::clamp(warp, 0.0f, c.warpMax));
+}
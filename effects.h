@@ -0,0 +1,179 @@
+// effects.h
+// Effect registry: every fragment shader is compiled once at startup and kept
+// resident, so the host can switch effects within a frame. Effects loaded
+// from descriptor files (effect-library.h) are lazy: they build the first
+// time the host asks for them, and stay resident after that.
+#pragma once
+#include <glad/glad.h>
+#include <SDL2/SDL.h>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "gl-util.h"
+#include "frame-params.h"
+#include "shader-compiler.h"
+#include "shader-variants.h"
+#include "tonemap.h"
+
+// User-tweakable parameters (arrow keys and z/x/c/v)
+struct EffectParams {
+    float speed;
+    float warp;
+    float thickness;
+    float colorShift;
+};
+static const int effectParamCount = 4;
+
+// EffectParams field i, in declaration order
+float& effectParam(EffectParams& p, int i);
+
+// A parameter's range and the keys that step it while the effect is
+// selected. scale steps multiply and divide by step instead of adding it.
+struct ParamSpec {
+    float min;
+    float max;
+    float step;
+    bool scale;
+    SDL_Keycode down;
+    SDL_Keycode up;
+};
+
+// UP/DOWN speed, LEFT/RIGHT warp, z/x thickness, v/c colorShift
+extern const ParamSpec defaultParamSpecs[effectParamCount];
+
+// Chromatic aberration the host applies after the effect (chromatic-aberration.h):
+// base * (1 + warpGain * clamp(warp, 0, warpMax)). A zero base skips the pass.
+struct ChromaDesc {
+    float base;
+    float warpGain;
+    float warpMax;
+};
+
+// A phase the host wraps before it reaches the shader as iPhase[i]:
+// fmod((bySpeed ? travel : time) * rate, period), computed in double each
+// frame, where travel is time * speed, or the integral of the speed track
+// while a timeline keys it (timeline.h). period is one the effect's look
+// repeats at exactly, so the wrap never shows and the shader's sin()/mod()
+// arguments stay small however long the clock has run. rate 0 leaves the
+// phase at 0.
+struct TimePhase {
+    double rate;
+    double period;
+    bool bySpeed;
+};
+static const int timePhaseCount = 4;
+
+// Values an effect's shader would otherwise derive in every pixel from the
+// clock and params alone (path centre, banking, hue matrix...). Called with
+// the rest of the block filled in, phases included; writes iConsts in the
+// layout the effect's GLSL reads. The CPU renderer calls it too.
+typedef void (*FrameConstsFn)(double time, FrameParams& params);
+
+// Static description of an effect, defined next to its fragment shader source
+struct EffectDesc {
+    const char* name;        // short name used with --effect
+    const char* title;       // window title while the effect is active
+    const char* fragmentSrc;
+    EffectParams defaults;
+    ChromaDesc chroma = {};  // none unless given
+    uint32_t features = 0;   // variant switches the source understands (shader-variants.h)
+    TimePhase phases[timePhaseCount] = {};
+    FrameConstsFn frameConsts = nullptr;
+    ToneDesc tone = {};      // exposure 1, no grade, no bloom
+    const ParamSpec* paramSpecs = nullptr; // effectParamCount of them; null for the defaults
+    bool lazy = false;       // built on the first requestEffect instead of at startup
+};
+
+// desc's specs, or defaultParamSpecs
+const ParamSpec* effectParamSpecs(const EffectDesc& desc);
+// Clamps every param into desc's ranges
+void clampEffectParams(const EffectDesc& desc, EffectParams& p);
+
+// A build of an effect's current source specialized by #defines
+struct EffectVariant {
+    ShaderVariant variant;
+    std::shared_ptr<ProgramJob> job; // null once resolved
+    GLuint prog = 0;
+    bool failed = false;             // the generic program draws instead
+    bool usesNoise = false;
+};
+
+// A registered effect: its resident program and current params
+struct Effect {
+    const EffectDesc* desc = nullptr;
+    std::string source;              // fragment source the current build uses
+    std::string pendingSource;       // newer source waiting for the in-flight build
+    std::shared_ptr<ProgramJob> job; // build in flight, null once resolved
+    GLuint prog = 0;                 // last good program, 0 until the first build finishes
+    bool failed = false;
+    EffectParams params{};
+    bool usesNoise = false;          // built with NOISE_TEX 1
+    std::vector<EffectVariant> variants; // built on demand from 'source'
+    int active = -1;                 // variant that draws, -1 for prog
+    bool requested = false;          // a lazy effect the host has asked for
+};
+
+// One description per shaderN-*.cpp
+extern const EffectDesc circlesEffect;
+extern const EffectDesc twirlEffect;
+extern const EffectDesc tunnelEffect;
+extern const EffectDesc flowerPowerEffect;
+extern const EffectDesc singleEffect;
+extern const EffectDesc thorTunnelEffect;
+
+// All built-in effects, in number-key order
+const std::vector<const EffectDesc*>& effectRegistry();
+
+// Creates an entry per built-in effect, then one per loaded descriptor
+// (effect-library.h), using their own sources. The builds are queued by the
+// first updateEffects, so sources can still be replaced (see hot-reload.h)
+// before anything is compiled.
+void registerEffects(std::vector<Effect>& effects);
+
+// Lets a lazy effect's first build start at the next updateEffects; other
+// effects build anyway. Cheap to call every frame.
+void requestEffect(Effect& fx);
+
+// Rebuilds an effect from new fragment source in the background. The current
+// program keeps rendering until the new one links; if it fails to build the
+// last good program stays.
+void reloadEffect(Effect& fx, const std::string& source);
+
+// Picks up finished builds: binds the FrameParams block and draws each new
+// program once into a 1x1 viewport, so drivers that defer work until first
+// use don't hitch on the first switch. Then selects each effect's variant for
+// its current params, queueing the build the first time it is needed; the
+// generic program draws until it is ready. Call once per frame, after
+// params change. Returns the number of builds still in flight.
+int updateEffects(std::vector<Effect>& effects, const FullscreenTriangle& tri);
+void destroyEffects(std::vector<Effect>& effects);
+
+// Index of the effect with the given name, or -1
+int findEffect(const std::vector<Effect>& effects, const char* name);
+
+// Writes this frame's parameter block (frame-params.h) from the effect's
+// params, the audio band levels and any bands mapped onto params
+// (audio-input.h). Once per frame, before the draws that read it. historyDt comes
+// from beginTemporal when the effect draws temporally (temporal.h).
+void updateEffectFrame(const Effect& fx, double time, int w, int h, int frame, float historyDt = 0.0f);
+
+// The part of the block that follows from the effect, its params and the
+// clock: resolution, params, the split time, the phases, historyDt and the
+// frame constants. Shared by updateEffectFrame and the CPU renderer.
+FrameParams effectFrameParams(const EffectDesc& desc, const EffectParams& params, double time, int w, int h,
+                              float historyDt = 0.0f);
+
+// Binds the effect's active program and the noise texture if it samples it
+void useEffect(const Effect& fx);
+
+// True when the active program is a TEMPORAL build, which must draw between
+// beginTemporal and endTemporal
+bool effectTemporal(const Effect& fx);
+// True when the active program is a COMPUTE build, which draws with
+// dispatchComputeMarch instead of the triangle
+bool effectCompute(const Effect& fx);
+
+// Chromatic aberration offset for the effect's current warp, 0 if it has none
+float effectAberration(const Effect& fx);
+float chromaOffset(const ChromaDesc& chroma, float warp);
@@ -0,0 +1,189 @@
+// frame-pacing.cpp
+// Swap interval control, frame start scheduling and display time prediction.
+
+#include "frame-pacing.h"
+#include <glad/glad.h>
+#include <iostream>
+#include <chrono>
+#include <thread>
+#include <cmath>
+#include <algorithm>
+#include <cstring>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#ifndef CREATE_WAITABLE_TIMER_HIGH_RESOLUTION
+#define CREATE_WAITABLE_TIMER_HIGH_RESOLUTION 0x00000002
+#endif
+#endif
+
+typedef std::chrono::steady_clock Clock;
+
+static const char* modeNames[pacingModeCount] = { "vsync", "adaptive", "cap", "low-latency", "off" };
+
+// Safety margin ahead of the vblank in low-latency mode
+static const double wakeMargin = 0.0015;
+// Below this the final stretch of a wait spins instead of sleeping
+static const double spinWindow = 0.001;
+
+static struct {
+    SDL_Window* win = nullptr;
+    PacingMode mode = PacingMode::Vsync;
+    Clock::time_point origin;
+    double capPeriod = 1.0 / 60.0;
+    double period = 1.0 / 60.0; // refresh period, refined from vsynced swaps
+    double lastVblank = 0.0;    // estimated time of the latest flip
+    bool haveVblank = false;
+    double frameStart = 0.0;
+    double work = 0.0;          // smoothed frame start until the frame is submitted
+    double capDeadline = 0.0;
+#ifdef _WIN32
+    HANDLE timer = nullptr;
+#endif
+} fpc;
+
+static double now() {
+    return std::chrono::duration<double>(Clock::now() - fpc.origin).count();
+}
+
+static bool vsynced(PacingMode mode) {
+    return mode == PacingMode::Vsync || mode == PacingMode::Adaptive || mode == PacingMode::LowLatency;
+}
+
+static void sleepUntil(double t) {
+    double remaining = t - now();
+    if (remaining > spinWindow) {
+#ifdef _WIN32
+        if (fpc.timer) {
+            LARGE_INTEGER due;
+            due.QuadPart = -(LONGLONG)((remaining - spinWindow) * 1.0e7); // relative, 100 ns units
+            if (SetWaitableTimerEx(fpc.timer, &due, 0, nullptr, nullptr, nullptr, 0))
+                WaitForSingleObject(fpc.timer, INFINITE);
+        }
+        else
+#endif
+        std::this_thread::sleep_for(std::chrono::duration<double>(remaining - spinWindow));
+    }
+    while (now() < t) std::this_thread::yield();
+}
+
+bool parsePacingMode(const char* name, PacingMode& mode) {
+    for (int i = 0; i < pacingModeCount; ++i) {
+        if (std::strcmp(name, modeNames[i]) == 0) {
+            mode = (PacingMode)i;
+            return true;
+        }
+    }
+    return false;
+}
+
+const char* pacingModeName(PacingMode mode) {
+    return modeNames[(int)mode];
+}
+
+void initFramePacing(SDL_Window* win, PacingMode mode, double capFps) {
+    fpc.win = win;
+    fpc.origin = Clock::now();
+    fpc.capPeriod = 1.0 / (capFps > 0.0 ? capFps : 60.0);
+
+    SDL_DisplayMode dm;
+    if (SDL_GetCurrentDisplayMode(SDL_GetWindowDisplayIndex(win), &dm) == 0 && dm.refresh_rate > 0)
+        fpc.period = 1.0 / dm.refresh_rate;
+
+#ifdef _WIN32
+    fpc.timer = CreateWaitableTimerExW(nullptr, nullptr, CREATE_WAITABLE_TIMER_HIGH_RESOLUTION, TIMER_ALL_ACCESS);
+    if (!fpc.timer) fpc.timer = CreateWaitableTimerExW(nullptr, nullptr, 0, TIMER_ALL_ACCESS); // before Windows 10 1803
+#endif
+    setPacingMode(mode);
+}
+
+void shutdownFramePacing() {
+#ifdef _WIN32
+    if (fpc.timer) CloseHandle(fpc.timer);
+    fpc.timer = nullptr;
+#endif
+    fpc.win = nullptr;
+}
+
+void setPacingMode(PacingMode mode) {
+    int interval = mode == PacingMode::Adaptive ? -1 : vsynced(mode) ? 1 : 0;
+    if (SDL_GL_SetSwapInterval(interval) != 0 && interval == -1) {
+        std::cerr << "Adaptive vsync not supported, using vsync\n";
+        mode = PacingMode::Vsync;
+        SDL_GL_SetSwapInterval(1);
+    }
+    fpc.mode = mode;
+    fpc.haveVblank = false;
+    fpc.capDeadline = now();
+    std::cout << "Frame pacing: " << pacingModeName(mode);
+    if (mode == PacingMode::Cap) std::cout << " " << 1.0 / fpc.capPeriod << " fps";
+    std::cout << "\n";
+}
+
+PacingMode pacingMode() {
+    return fpc.mode;
+}
+
+double pacingOrigin() {
+    return std::chrono::duration<double>(fpc.origin.time_since_epoch()).count();
+}
+
+// First vblank at or after t
+static double vblankAfter(double t) {
+    if (!fpc.haveVblank) return t + fpc.period;
+    double n = std::ceil((t - fpc.lastVblank) / fpc.period);
+    return fpc.lastVblank + std::max(n, 1.0) * fpc.period;
+}
+
+double beginPacedFrame() {
+    double display;
+    if (fpc.mode == PacingMode::Cap) {
+        fpc.capDeadline += fpc.capPeriod;
+        // fell more than a frame behind: start over instead of bursting to catch up
+        if (now() > fpc.capDeadline + fpc.capPeriod) fpc.capDeadline = now();
+        sleepUntil(fpc.capDeadline);
+        fpc.frameStart = now();
+        display = fpc.frameStart + fpc.work;
+    }
+    else if (fpc.mode == PacingMode::LowLatency && fpc.haveVblank) {
+        // wake as late as the recent frames allow and still make the vblank
+        double lead = fpc.work * 1.25 + wakeMargin;
+        display = vblankAfter(now() + lead);
+        sleepUntil(display - lead);
+        fpc.frameStart = now();
+    }
+    else {
+        fpc.frameStart = now();
+        display = vsynced(fpc.mode) ? vblankAfter(fpc.frameStart + fpc.work) : fpc.frameStart + fpc.work;
+    }
+    return display;
+}
+
+void presentPacedFrame() {
+    // low latency needs the whole frame time, GPU included, to schedule the next wake
+    if (fpc.mode == PacingMode::LowLatency) glFinish();
+    double submitted = now();
+    double work = submitted - fpc.frameStart;
+    fpc.work = fpc.work > 0.0 ? fpc.work * 0.9 + work * 0.1 : work;
+
+    SDL_GL_SwapWindow(fpc.win);
+    if (!vsynced(fpc.mode)) return;
+    // without this the swap returns once queued; with it, at the flip
+    if (fpc.mode == PacingMode::LowLatency) glFinish();
+
+    double flip = now();
+    if (fpc.haveVblank) {
+        double d = flip - fpc.lastVblank;
+        double n = std::round(d / fpc.period);
+        if (n >= 1.0 && std::fabs(d - n * fpc.period) < 0.25 * fpc.period)
+            fpc.period = fpc.period * 0.95 + d / n * 0.05;
+    }
+    fpc.lastVblank = flip;
+    fpc.haveVblank = true;
+}
+
+double pacingRefreshHz() {
+    return 1.0 / fpc.period;
+}
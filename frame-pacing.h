@@ -0,0 +1,35 @@
+// frame-pacing.h
+// Frame pacing: picks the swap interval, waits for the right moment to start
+// each frame and predicts when that frame reaches the screen, so effects are
+// animated for the instant they are seen rather than the instant they were
+// recorded.
+#pragma once
+#include <SDL2/SDL.h>
+
+enum class PacingMode {
+    Vsync,      // swap interval 1
+    Adaptive,   // swap interval -1: a late frame tears instead of waiting a whole refresh
+    Cap,        // no vsync; a high-resolution timer holds the rate at --fps
+    LowLatency, // vsync, each frame starts just early enough to make the next vblank
+    Off,        // swap interval 0, no waiting
+};
+static const int pacingModeCount = 5;
+
+bool parsePacingMode(const char* name, PacingMode& mode);
+const char* pacingModeName(PacingMode mode);
+
+void initFramePacing(SDL_Window* win, PacingMode mode, double capFps);
+void shutdownFramePacing();
+void setPacingMode(PacingMode mode);
+PacingMode pacingMode();
+
+// Top of the frame: waits as the mode requires, then returns the predicted
+// display time of this frame in seconds since initFramePacing.
+double beginPacedFrame();
+// Swaps and records the timings the predictions are built from
+void presentPacedFrame();
+// The steady-clock second the times above count from (see clock-sync.h)
+double pacingOrigin();
+
+// Refresh rate as measured from vsynced swaps
+double pacingRefreshHz();
@@ -0,0 +1,135 @@
+// frame-params.cpp
+// Uniform buffer behind the shared FrameParams block.
+
+#include "frame-params.h"
+#include <SDL2/SDL.h>
+#include <iostream>
+#include <cstring>
+
+// Not every glad build carries these (GL 4.4 / ARB_buffer_storage)
+#ifndef GL_MAP_PERSISTENT_BIT
+#define GL_MAP_PERSISTENT_BIT 0x0040
+#endif
+#ifndef GL_MAP_COHERENT_BIT
+#define GL_MAP_COHERENT_BIT 0x0080
+#endif
+
+typedef void (APIENTRY* PFNBUFFERSTORAGE)(GLenum target, GLsizeiptr size, const void* data, GLbitfield flags);
+
+const char* frameParamsGlsl = R"glsl(
+layout(std140) uniform FrameParams {
+    vec2 iResolution;
+    float iTime;
+    float speed;
+    float warp;
+    float thickness;
+    float colorShift;
+    int iFrame;
+    vec4 iAudio[4];
+    float iHistoryDt;
+    float iTimeHi;
+    float iTimeLo;
+    vec4 iPhase;
+    vec4 iConsts[6];
+};
+// level 0..1 of audio band k, low to high frequency
+float audioBand(int k){ return iAudio[k >> 2][k & 3]; }
+)glsl";
+
+// Blocks in flight at once; a slot is rewritten only after its fence passes
+static const int ringSlots = 8;
+
+static struct {
+    GLuint ubo = 0;
+    bool persistent = false;
+    char* mapped = nullptr;
+    GLsizeiptr stride = 0;
+    GLsync fences[ringSlots] = {};
+    int slot = 0;
+} fp;
+
+bool initFrameParams() {
+    GLint align = 256;
+    glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &align);
+    fp.stride = ((GLsizeiptr)sizeof(FrameParams) + align - 1) / align * align;
+
+    glGenBuffers(1, &fp.ubo);
+    glBindBuffer(GL_UNIFORM_BUFFER, fp.ubo);
+
+    PFNBUFFERSTORAGE bufferStorage = nullptr;
+    if (SDL_GL_ExtensionSupported("GL_ARB_buffer_storage"))
+        bufferStorage = (PFNBUFFERSTORAGE)SDL_GL_GetProcAddress("glBufferStorage");
+    if (bufferStorage) {
+        const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+        bufferStorage(GL_UNIFORM_BUFFER, fp.stride * ringSlots, nullptr, flags);
+        fp.mapped = (char*)glMapBufferRange(GL_UNIFORM_BUFFER, 0, fp.stride * ringSlots, flags);
+        fp.persistent = fp.mapped != nullptr;
+        if (!fp.persistent) {
+            // immutable storage can't be respecified; start over with a mutable buffer
+            glDeleteBuffers(1, &fp.ubo);
+            glGenBuffers(1, &fp.ubo);
+            glBindBuffer(GL_UNIFORM_BUFFER, fp.ubo);
+        }
+    }
+    if (!fp.persistent) glBufferData(GL_UNIFORM_BUFFER, sizeof(FrameParams), nullptr, GL_STREAM_DRAW);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+    // programs primed before the first real frame still read a bound block
+    updateFrameParams(FrameParams{});
+    std::cout << "Frame params: " << (fp.persistent ? "persistent mapped ring" : "orphaned buffer") << "\n";
+    return true;
+}
+
+void shutdownFrameParams() {
+    for (GLsync& f : fp.fences) {
+        if (f) glDeleteSync(f);
+        f = nullptr;
+    }
+    if (fp.persistent) {
+        glBindBuffer(GL_UNIFORM_BUFFER, fp.ubo);
+        glUnmapBuffer(GL_UNIFORM_BUFFER);
+        glBindBuffer(GL_UNIFORM_BUFFER, 0);
+    }
+    glDeleteBuffers(1, &fp.ubo);
+    fp = {};
+}
+
+void updateFrameParams(const FrameParams& params) {
+    if (fp.persistent) {
+        // the slot written ringSlots updates ago is normally long retired
+        fp.slot = (fp.slot + 1) % ringSlots;
+        GLsync& fence = fp.fences[fp.slot];
+        if (fence) {
+            glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, GL_TIMEOUT_IGNORED);
+            glDeleteSync(fence);
+            fence = nullptr;
+        }
+        std::memcpy(fp.mapped + fp.slot * fp.stride, &params, sizeof(params));
+        glBindBufferRange(GL_UNIFORM_BUFFER, frameParamsBinding, fp.ubo, fp.slot * fp.stride, sizeof(FrameParams));
+        // covers the draws that read this slot, which are issued after this call
+        fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        return;
+    }
+    glBindBuffer(GL_UNIFORM_BUFFER, fp.ubo);
+    glBufferData(GL_UNIFORM_BUFFER, sizeof(FrameParams), nullptr, GL_STREAM_DRAW);
+    glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(FrameParams), &params);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+    glBindBufferBase(GL_UNIFORM_BUFFER, frameParamsBinding, fp.ubo);
+}
+
+void bindFrameParamsBlock(GLuint prog) {
+    GLuint index = glGetUniformBlockIndex(prog, "FrameParams");
+    if (index != GL_INVALID_INDEX) glUniformBlockBinding(prog, index, frameParamsBinding);
+}
+
+std::string withFrameParams(const std::string& source, const std::string& defines) {
+    size_t pos = 0;
+    size_t version = source.find("#version");
+    if (version != std::string::npos && version == source.find_first_not_of(" \t\r\n")) {
+        pos = source.find('\n', version);
+        pos = pos == std::string::npos ? source.size() : pos + 1;
+    }
+    // #line keeps compile errors pointing at the effect's own line numbers
+    int line = 1;
+    for (size_t i = 0; i < pos; ++i) line += source[i] == '\n';
+    return source.substr(0, pos) + frameParamsGlsl + defines + "#line " + std::to_string(line) + "\n" + source.substr(pos);
+}
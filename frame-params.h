@@ -0,0 +1,48 @@
+// frame-params.h
+// Per-frame parameter block shared by every effect. The GLSL declaration is
+// inserted after each effect's #version line, so all effects see the same
+// std140 layout under the same names, and one buffer write per frame covers
+// whichever program draws.
+#pragma once
+#include <glad/glad.h>
+#include <cstdint>
+#include <string>
+
+static const GLuint frameParamsBinding = 0;
+static const int audioBands = 16;
+static const int frameConstsCount = 24;
+
+// Mirrors the std140 FrameParams block in frameParamsGlsl
+struct FrameParams {
+    float iResolution[2];
+    float iTime;
+    float speed;
+    float warp;
+    float thickness;
+    float colorShift;
+    int32_t iFrame;
+    float iAudio[audioBands]; // vec4[4], band levels 0..1 from audio-input.h, 0 without audio
+    float iHistoryDt;         // seconds since the frame in the temporal history, 0 for none (temporal.h)
+    float iTimeHi, iTimeLo;   // the double clock split in two: iTimeHi + iTimeLo, for differences and own wraps
+    float pad;
+    float iPhase[4];          // the effect's TimePhases (effects.h), wrapped on the CPU in double
+    float iConsts[frameConstsCount]; // vec4[6], the effect's pixel-invariant values (EffectDesc::frameConsts)
+};
+static_assert(sizeof(FrameParams) == 224, "FrameParams must match the std140 block");
+
+extern const char* frameParamsGlsl;
+
+// Uses a persistently mapped ring (GL 4.4 / ARB_buffer_storage) when
+// available, otherwise orphans the buffer on every update.
+bool initFrameParams();
+void shutdownFrameParams();
+
+// Writes the block and binds it to frameParamsBinding
+void updateFrameParams(const FrameParams& params);
+
+// Points the program's FrameParams block at frameParamsBinding
+void bindFrameParamsBlock(GLuint prog);
+
+// Effect source with the block declaration, then any variant #defines
+// (shader-variants.h), inserted after its #version line
+std::string withFrameParams(const std::string& source, const std::string& defines = std::string());
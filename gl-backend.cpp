@@ -0,0 +1,95 @@
+// gl-backend.cpp
+// The GL side of render-backend.h, on the same helpers the full host uses.
+
+#include "render-backend.h"
+#include "gl-util.h"
+#include "shader-compiler.h"
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+static const char* presentNames[] = { "fifo", "mailbox", "immediate" };
+
+bool parsePresentMode(const char* name, PresentMode& mode) {
+    for (int i = 0; i < 3; ++i) {
+        if (std::strcmp(name, presentNames[i]) == 0) {
+            mode = (PresentMode)i;
+            return true;
+        }
+    }
+    return false;
+}
+
+const char* presentModeName(PresentMode mode) {
+    return presentNames[(int)mode];
+}
+
+static struct {
+    SDL_Window* win = nullptr;
+    SDL_GLContext ctx = nullptr;
+    FullscreenTriangle tri;
+    std::vector<GLuint> programs;
+    int w = 0, h = 0;
+} glb;
+
+static SDL_Window* initGl(const char* title, int w, int h, const BackendOptions& opts) {
+    glb.win = createGLWindow(title, w, h, SDL_WINDOW_RESIZABLE, &glb.ctx);
+    if (!glb.win) return nullptr;
+    glb.w = w; glb.h = h;
+    // GL has no mailbox; the closest it offers without tearing is plain vsync
+    int interval = opts.present == PresentMode::Immediate ? 0 : 1;
+    if (opts.present == PresentMode::Mailbox) std::cerr << "GL: no mailbox present mode, using fifo\n";
+    SDL_GL_SetSwapInterval(interval);
+    initShaderCompiler(glb.win, glb.ctx, opts.cacheDir);
+    createFullscreenTriangle(glb.tri);
+    initFrameParams();
+    if (!initTonemap(w, h, false)) std::cerr << "Tonemap pass unavailable, effects draw ungraded\n";
+    return glb.win;
+}
+
+static void shutdownGl() {
+    if (!glb.win) return;
+    for (GLuint prog : glb.programs) glDeleteProgram(prog);
+    glb.programs.clear();
+    shutdownTonemap();
+    shutdownFrameParams();
+    destroyFullscreenTriangle(glb.tri);
+    shutdownShaderCompiler();
+    SDL_GL_DeleteContext(glb.ctx);
+    SDL_DestroyWindow(glb.win);
+    glb.win = nullptr;
+}
+
+static int createGlProgram(const char* label, const std::string& source, const std::string& defines) {
+    std::shared_ptr<ProgramJob> job = submitProgram(label, vertexShaderSrc, withFrameParams(source, defines));
+    finishShaderCompiler();
+    if (job->state.load(std::memory_order_acquire) != BuildState::Ready) return -1;
+    bindFrameParamsBlock(job->prog);
+    glb.programs.push_back(job->prog);
+    return (int)glb.programs.size() - 1;
+}
+
+static bool drawGlFrame(int program, const FrameParams& params, const ToneDesc& tone, int frame) {
+    glViewport(0, 0, glb.w, glb.h);
+    beginTonemap(glb.w, glb.h);
+    glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+    glClear(GL_COLOR_BUFFER_BIT);
+    if (program >= 0) {
+        updateFrameParams(params);
+        glUseProgram(glb.programs[program]);
+        drawFullscreenTriangle(glb.tri);
+    }
+    endTonemap(glb.tri, tone, frame);
+    SDL_GL_SwapWindow(glb.win);
+    return true;
+}
+
+static void resizeGl(int w, int h) {
+    glb.w = w; glb.h = h;
+    resizeTonemap(w, h);
+}
+
+const RenderBackend& glBackend() {
+    static const RenderBackend backend = { "gl", initGl, shutdownGl, createGlProgram, drawGlFrame, resizeGl };
+    return backend;
+}
@@ -0,0 +1,156 @@
+// gl-util.cpp
+// Shared OpenGL helpers used by the timewarp host.
+
+#include "gl-util.h"
+#include <iostream>
+
+// Minimal shader loader for GL3 using shader strings.
+// The source code for the vertex shader stored in a const char array
+const char* vertexShaderSrc = R"glsl(
+#version 330 core
+layout(location = 0) in vec2 inPos;
+out vec2 uv;
+void main(){
+    uv = inPos * 0.5 + 0.5;
+    gl_Position = vec4(inPos, 0.0, 1.0);
+}
+)glsl";
+
+SDL_Window* createGLWindow(const char* title, int w, int h, Uint32 flags, SDL_GLContext* ctx, bool preferCompute) {
+    SDL_GL_SetAttribute(SDL_GL_CONTEXT_MAJOR_VERSION, preferCompute ? 4 : 3);
+    SDL_GL_SetAttribute(SDL_GL_CONTEXT_MINOR_VERSION, 3);
+    SDL_GL_SetAttribute(SDL_GL_CONTEXT_PROFILE_MASK, SDL_GL_CONTEXT_PROFILE_CORE);
+
+    SDL_Window* win = SDL_CreateWindow(title, SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED,
+        w, h, SDL_WINDOW_OPENGL | flags);
+    if (!win) { std::cerr << "CreateWindow failed: " << SDL_GetError() << "\n"; return nullptr; }
+
+    *ctx = SDL_GL_CreateContext(win);
+    if (!*ctx && preferCompute) {
+        // shared contexts made later inherit whichever version worked
+        SDL_GL_SetAttribute(SDL_GL_CONTEXT_MAJOR_VERSION, 3);
+        *ctx = SDL_GL_CreateContext(win);
+    }
+    if (!*ctx) {
+        std::cerr << "CreateContext failed: " << SDL_GetError() << "\n";
+        SDL_DestroyWindow(win);
+        return nullptr;
+    }
+
+    if (!gladLoadGLLoader((GLADloadproc)SDL_GL_GetProcAddress)) {
+        std::cerr << "Failed to initialize GLAD\n";
+        SDL_GL_DeleteContext(*ctx);
+        SDL_DestroyWindow(win);
+        return nullptr;
+    }
+    std::cout << "OpenGL: " << (const char*)glGetString(GL_VERSION) << "\n";
+    return win;
+}
+
+GLuint compileShader(GLenum type, const char* src) {
+    GLuint sh = glCreateShader(type);
+    glShaderSource(sh, 1, &src, nullptr);
+    glCompileShader(sh);
+    GLint ok = 0; glGetShaderiv(sh, GL_COMPILE_STATUS, &ok);
+    if (!ok) {
+        char buf[4096]; glGetShaderInfoLog(sh, sizeof(buf), nullptr, buf);
+        std::cerr << "Shader compile error: " << buf << "\n";
+        glDeleteShader(sh);
+        return 0;
+    }
+    return sh;
+}
+
+GLuint linkProgram(GLuint v, GLuint f) {
+    GLuint p = glCreateProgram();
+    glAttachShader(p, v);
+    glAttachShader(p, f);
+    glBindAttribLocation(p, 0, "inPos");
+    glLinkProgram(p);
+    GLint ok = 0; glGetProgramiv(p, GL_LINK_STATUS, &ok);
+    if (!ok) {
+        char buf[4096]; glGetProgramInfoLog(p, sizeof(buf), nullptr, buf);
+        std::cerr << "Program link error: " << buf << "\n";
+        glDeleteProgram(p);
+        return 0;
+    }
+    // the shaders can be deleted by the caller; the program keeps them alive
+    glDetachShader(p, v);
+    glDetachShader(p, f);
+    return p;
+}
+
+void createFullscreenTriangle(FullscreenTriangle& tri) {
+    float verts[] = { -1.0f, -1.0f, 3.0f, -1.0f, -1.0f, 3.0f }; // odd trick: single triangle covering screen
+    glGenVertexArrays(1, &tri.vao);
+    glBindVertexArray(tri.vao);
+    glGenBuffers(1, &tri.vbo);
+    glBindBuffer(GL_ARRAY_BUFFER, tri.vbo);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(verts), verts, GL_STATIC_DRAW);
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 0, nullptr);
+}
+
+void drawFullscreenTriangle(const FullscreenTriangle& tri) {
+    glBindVertexArray(tri.vao);
+    glDrawArrays(GL_TRIANGLES, 0, 3);
+}
+
+void destroyFullscreenTriangle(FullscreenTriangle& tri) {
+    glDeleteBuffers(1, &tri.vbo);
+    glDeleteVertexArrays(1, &tri.vao);
+    tri.vbo = tri.vao = 0;
+}
+
+static GLenum pixelFormatFor(GLenum internalFormat) {
+    switch (internalFormat) {
+    case GL_R32F: case GL_R16F: case GL_R8: return GL_RED;
+    case GL_RG32F: case GL_RG16F: case GL_RG8: return GL_RG;
+    default: return GL_RGBA;
+    }
+}
+
+static GLenum pixelTypeFor(GLenum internalFormat) {
+    switch (internalFormat) {
+    case GL_RGBA16F: case GL_RGBA32F: case GL_R32F: case GL_R16F:
+    case GL_RG32F: case GL_RG16F: case GL_R11F_G11F_B10F: return GL_FLOAT;
+    default: return GL_UNSIGNED_BYTE;
+    }
+}
+
+bool createRenderTarget(RenderTarget& rt, int w, int h, GLenum internalFormat) {
+    rt.w = w; rt.h = h; rt.format = internalFormat;
+    glGenTextures(1, &rt.tex);
+    glBindTexture(GL_TEXTURE_2D, rt.tex);
+    glTexImage2D(GL_TEXTURE_2D, 0, internalFormat, w, h, 0, pixelFormatFor(internalFormat), pixelTypeFor(internalFormat), nullptr);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+    glGenFramebuffers(1, &rt.fbo);
+    glBindFramebuffer(GL_FRAMEBUFFER, rt.fbo);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, rt.tex, 0);
+    GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    if (status != GL_FRAMEBUFFER_COMPLETE) {
+        std::cerr << "Framebuffer " << w << "x" << h << " incomplete: 0x" << std::hex << status << std::dec << "\n";
+        destroyRenderTarget(rt);
+        return false;
+    }
+    return true;
+}
+
+bool resizeRenderTarget(RenderTarget& rt, int w, int h) {
+    if (rt.w == w && rt.h == h) return false;
+    rt.w = w; rt.h = h;
+    glBindTexture(GL_TEXTURE_2D, rt.tex);
+    glTexImage2D(GL_TEXTURE_2D, 0, rt.format, w, h, 0, pixelFormatFor(rt.format), pixelTypeFor(rt.format), nullptr);
+    return true;
+}
+
+void destroyRenderTarget(RenderTarget& rt) {
+    glDeleteFramebuffers(1, &rt.fbo);
+    glDeleteTextures(1, &rt.tex);
+    rt = RenderTarget{};
+}
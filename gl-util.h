@@ -0,0 +1,42 @@
+// gl-util.h
+// Shared OpenGL helpers used by the timewarp host: window/context creation,
+// shader compile/link, render targets and the fullscreen triangle every
+// effect is drawn with.
+#pragma once
+#include <glad/glad.h>
+#include <SDL2/SDL.h>
+
+// The source code for the vertex shader shared by all effects
+extern const char* vertexShaderSrc;
+
+// Creates a window with a GL 3.3 core context and loads GL through glad.
+// preferCompute asks for 4.3 core first (compute-march.h) and settles for
+// 3.3 when the driver can't. Returns null (after printing why) on failure.
+SDL_Window* createGLWindow(const char* title, int w, int h, Uint32 flags, SDL_GLContext* ctx, bool preferCompute = false);
+
+GLuint compileShader(GLenum type, const char* src);
+GLuint linkProgram(GLuint v, GLuint f);
+
+// Fullscreen triangle VAO/VBO, created once and reused by every effect
+struct FullscreenTriangle {
+    GLuint vao = 0;
+    GLuint vbo = 0;
+};
+
+void createFullscreenTriangle(FullscreenTriangle& tri);
+void drawFullscreenTriangle(const FullscreenTriangle& tri);
+void destroyFullscreenTriangle(FullscreenTriangle& tri);
+
+// Colour texture with its framebuffer, for rendering effects offscreen
+struct RenderTarget {
+    GLuint fbo = 0;
+    GLuint tex = 0;
+    int w = 0;
+    int h = 0;
+    GLenum format = 0;
+};
+
+bool createRenderTarget(RenderTarget& rt, int w, int h, GLenum internalFormat = GL_RGBA8);
+// Reallocates storage if the size changed; returns true if it did
+bool resizeRenderTarget(RenderTarget& rt, int w, int h);
+void destroyRenderTarget(RenderTarget& rt);
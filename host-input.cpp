@@ -0,0 +1,109 @@
+// host-input.cpp
+// Key and window event handling for the interactive host.
+
+#include "host-input.h"
+#include <algorithm>
+#include <atomic>
+#include <memory>
+
+static const double scrubSeconds = 5.0;
+
+static struct {
+    std::unique_ptr<std::atomic<bool>[]> skipped;
+    int count = 0;
+    Uint32 wakeEvent = 0;
+} hi;
+
+void initSkippedEffects(int count) {
+    hi.skipped.reset(new std::atomic<bool>[count]);
+    for (int i = 0; i < count; ++i) hi.skipped[i].store(false);
+    hi.count = count;
+    hi.wakeEvent = SDL_RegisterEvents(1);
+}
+
+void updateSkippedEffects(const std::vector<Effect>& effects) {
+    bool newlySkipped = false;
+    for (int i = 0; i < hi.count && i < (int)effects.size(); ++i) {
+        bool failed = effects[i].failed;
+        if (hi.skipped[i].load(std::memory_order_relaxed) == failed) continue;
+        setEffectSkipped(i, failed);
+        newlySkipped = newlySkipped || failed;
+    }
+    if (newlySkipped && hi.wakeEvent != (Uint32)-1) {
+        // the input thread moves off the effect (or quits if none is left)
+        SDL_Event e = {};
+        e.type = hi.wakeEvent;
+        SDL_PushEvent(&e);
+    }
+}
+
+void setEffectSkipped(int index, bool skipped) {
+    if (index < hi.count) hi.skipped[index].store(skipped, std::memory_order_release);
+}
+
+bool effectSkipped(int index) {
+    return index < hi.count && hi.skipped[index].load(std::memory_order_acquire);
+}
+
+int selectableEffect(int from, int step, int count) {
+    for (int n = 1; n <= count; ++n) {
+        int i = ((from + n * step) % count + count) % count;
+        if (!effectSkipped(i)) return i;
+    }
+    return -1;
+}
+
+bool hostReservedKey(SDL_Keycode key) {
+    static const SDL_Keycode reserved[] = {
+        SDLK_TAB, SDLK_PAGEUP, SDLK_PAGEDOWN, SDLK_ESCAPE, SDLK_LEFTBRACKET, SDLK_RIGHTBRACKET,
+        SDLK_F1, SDLK_F2, SDLK_F3, SDLK_F4, SDLK_F5, SDLK_F6, SDLK_F7,
+    };
+    if (key >= SDLK_1 && key <= SDLK_9) return true;
+    return std::find(std::begin(reserved), std::end(reserved), key) != std::end(reserved);
+}
+
+bool applyInputEvent(const SDL_Event& e, InputSnapshot& s, bool resizable,
+                     const std::vector<const EffectDesc*>& descs) {
+    int count = (int)s.params.size();
+    if (e.type == SDL_QUIT) {
+        s.running = false;
+        return true;
+    }
+    // closing any output window ends the show
+    if (e.type == SDL_WINDOWEVENT && e.window.event == SDL_WINDOWEVENT_CLOSE) {
+        s.running = false;
+        return true;
+    }
+    if (e.type == SDL_WINDOWEVENT && e.window.event == SDL_WINDOWEVENT_SIZE_CHANGED && resizable) {
+        s.w = e.window.data1; s.h = e.window.data2;
+        return true;
+    }
+    if (e.type != SDL_KEYDOWN) return false;
+
+    SDL_Keycode key = e.key.keysym.sym;
+    if (key >= SDLK_1 && key <= SDLK_9 && key - SDLK_1 < count && !effectSkipped(key - SDLK_1)) s.current = key - SDLK_1;
+    int step = key == SDLK_TAB || key == SDLK_PAGEDOWN ? 1 : key == SDLK_PAGEUP ? -1 : 0;
+    if (step != 0) s.current = std::max(0, selectableEffect(s.current, step, count));
+
+    EffectParams& p = s.params[s.current];
+    if (key == SDLK_ESCAPE) s.running = false;
+    if (key == SDLK_F1) s.showProfiler = !s.showProfiler;
+    if (key == SDLK_F2) ++s.csvExports;
+    if (key == SDLK_F3) s.dynamicRes = !s.dynamicRes;
+    if (key == SDLK_F4) ++s.pacingSteps;
+    if (key == SDLK_F5) ++s.qualitySteps;
+    if (key == SDLK_F6) s.temporal = !s.temporal;
+    if (key == SDLK_F7) s.compute = !s.compute;
+    if (key == SDLK_LEFTBRACKET) s.timeOffset -= scrubSeconds;
+    if (key == SDLK_RIGHTBRACKET) s.timeOffset += scrubSeconds;
+    const EffectDesc& desc = *descs[s.current];
+    const ParamSpec* specs = effectParamSpecs(desc);
+    for (int i = 0; i < effectParamCount; ++i) {
+        const ParamSpec& spec = specs[i];
+        float& v = effectParam(p, i);
+        if (key == spec.up) v = spec.scale ? v * spec.step : v + spec.step;
+        if (key == spec.down) v = spec.scale ? v / spec.step : v - spec.step;
+    }
+    clampEffectParams(desc, p);
+    return true;
+}
@@ -0,0 +1,51 @@
+// host-input.h
+// What the input thread hands the render thread: an immutable snapshot of
+// everything the keys and the window control, published through a
+// TripleBuffer (triple-buffer.h). Toggles and values are plain state;
+// one-shot actions are counters, so a press is never lost when the renderer
+// skips a snapshot.
+#pragma once
+#include <SDL2/SDL.h>
+#include <cstdint>
+#include <vector>
+
+#include "effects.h"
+
+struct InputSnapshot {
+    bool running = true;
+    int current = 0;                  // selected effect
+    std::vector<EffectParams> params; // per effect, registry order
+    int w = 0, h = 0;                 // window size
+    bool showProfiler = false;
+    bool dynamicRes = false;
+    bool temporal = false;
+    bool compute = false;             // F7, kept off without GL 4.3
+    uint32_t csvExports = 0;          // F2
+    uint32_t pacingSteps = 0;         // F4
+    uint32_t qualitySteps = 0;        // F5
+    double timeOffset = 0.0;          // [ and ] scrub the clock (and any timeline)
+};
+
+// Applies one SDL event; true if the snapshot changed. resizable is false
+// while the output windows are fixed to their displays (multi-output.h).
+// descs are the effects in registry order; their ParamSpecs map the param
+// keys and ranges of the selected one.
+bool applyInputEvent(const SDL_Event& e, InputSnapshot& s, bool resizable,
+                     const std::vector<const EffectDesc*>& descs);
+
+// Keys the host handles for every effect, which no ParamSpec can take
+bool hostReservedKey(SDL_Keycode key);
+
+// Effects with nothing to draw: their build failed and there is no earlier
+// good program. The render thread marks them (updateSkippedEffects) and the
+// effect keys and OSC step over them. Sized once after SDL_Init, before the
+// render thread starts.
+void initSkippedEffects(int count);
+// Render thread, after updateEffects: mirrors Effect::failed and wakes the
+// input thread when an effect becomes unselectable
+void updateSkippedEffects(const std::vector<Effect>& effects);
+void setEffectSkipped(int index, bool skipped);
+bool effectSkipped(int index);
+// The first effect after from, stepping by step (+1 or -1) and wrapping,
+// that isn't skipped; from itself is tried last. -1 if every effect is.
+int selectableEffect(int from, int step, int count);
@@ -0,0 +1,127 @@
+// hot-reload.cpp
+// Polls effect .glsl files off the render thread and queues changed sources.
+
+#include "hot-reload.h"
+#include "telemetry.h"
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <filesystem>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+
+struct WatchedFile {
+    size_t effect;
+    std::filesystem::path path;
+    std::filesystem::file_time_type lastWrite; // version we last loaded
+    std::filesystem::file_time_type seen;      // newest version seen, loaded once it stops changing
+};
+
+struct ChangedSource {
+    size_t effect;
+    std::string source;
+};
+
+static struct {
+    std::vector<WatchedFile> files;
+    std::thread thread;
+    std::mutex mutex;
+    std::condition_variable cv;
+    bool quit = false;
+    std::vector<ChangedSource> changed; // guarded by mutex
+} hr;
+
+static bool readFile(const std::filesystem::path& path, std::string& out) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) return false;
+    std::ostringstream ss;
+    ss << in.rdbuf();
+    out = ss.str();
+    return true;
+}
+
+static void watchMain() {
+    std::unique_lock<std::mutex> lock(hr.mutex);
+    while (!hr.quit) {
+        hr.cv.wait_for(lock, std::chrono::milliseconds(200));
+        if (hr.quit) break;
+        lock.unlock();
+
+        for (WatchedFile& f : hr.files) {
+            std::error_code ec;
+            auto t = std::filesystem::last_write_time(f.path, ec);
+            if (ec || t == f.lastWrite) continue;
+            // editors often write in several steps; wait for one quiet poll
+            if (t != f.seen) { f.seen = t; continue; }
+            f.lastWrite = t;
+
+            std::string source;
+            if (!readFile(f.path, source) || source.empty()) continue;
+            std::lock_guard<std::mutex> guard(hr.mutex);
+            hr.changed.push_back({ f.effect, std::move(source) });
+        }
+
+        lock.lock();
+    }
+}
+
+bool startShaderWatch(const char* dir, std::vector<Effect>& effects) {
+    std::error_code ec;
+    std::filesystem::create_directories(dir, ec);
+    if (ec) {
+        std::cerr << "Cannot create shader directory " << dir << ": " << ec.message() << "\n";
+        return false;
+    }
+
+    for (size_t i = 0; i < effects.size(); ++i) {
+        Effect& fx = effects[i];
+        std::filesystem::path path = std::filesystem::path(dir) / (std::string(fx.desc->name) + ".glsl");
+        if (!std::filesystem::exists(path)) {
+            std::ofstream out(path, std::ios::binary);
+            out << fx.source;
+            std::cout << "Wrote " << path.string() << "\n";
+        }
+        else if (!readFile(path, fx.source)) {
+            std::cerr << "Cannot read " << path.string() << ", using built-in source\n";
+        }
+
+        WatchedFile f;
+        f.effect = i;
+        f.path = path;
+        f.lastWrite = std::filesystem::last_write_time(path, ec);
+        f.seen = f.lastWrite;
+        hr.files.push_back(f);
+    }
+
+    hr.quit = false;
+    hr.thread = std::thread(watchMain);
+    std::cout << "Watching " << hr.files.size() << " shaders in " << dir << "\n";
+    return true;
+}
+
+void stopShaderWatch() {
+    if (!hr.thread.joinable()) return;
+    {
+        std::lock_guard<std::mutex> lock(hr.mutex);
+        hr.quit = true;
+    }
+    hr.cv.notify_all();
+    hr.thread.join();
+    hr.files.clear();
+    hr.changed.clear();
+}
+
+void pollShaderWatch(std::vector<Effect>& effects) {
+    std::vector<ChangedSource> changed;
+    {
+        std::lock_guard<std::mutex> lock(hr.mutex);
+        if (hr.changed.empty()) return;
+        changed.swap(hr.changed);
+    }
+    for (ChangedSource& c : changed) {
+        telemetryLog(LogLevel::Info, "Reloading '%s'", effects[c.effect].desc->name);
+        reloadEffect(effects[c.effect], c.source);
+    }
+}
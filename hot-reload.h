@@ -0,0 +1,15 @@
+// hot-reload.h
+// Loads effect fragment shaders from <dir>/<effect>.glsl and rebuilds them in
+// the background whenever a file changes. Missing files are written out from
+// the built-in source first, so the directory doubles as an editable copy.
+#pragma once
+#include <vector>
+
+#include "effects.h"
+
+// Call after registerEffects and before the first updateEffects.
+bool startShaderWatch(const char* dir, std::vector<Effect>& effects);
+void stopShaderWatch();
+
+// Hands changed sources to reloadEffect; call once per frame.
+void pollShaderWatch(std::vector<Effect>& effects);
@@ -0,0 +1,186 @@
+// multi-output.cpp
+// Output windows sharing one context, the views they show and the per-frame
+// blit and swap.
+
+#include "multi-output.h"
+#include "gl-util.h"
+#include <iostream>
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+struct OutputWindow {
+    SDL_Window* win = nullptr;
+    int view = 0;
+    SDL_Rect src = {};  // region of the view, GL convention (origin bottom-left)
+    int w = 0, h = 0;
+};
+
+static struct {
+    bool active = false;
+    SDL_GLContext ctx = nullptr;
+    std::vector<OutputWindow> windows;  // [0] is the host's window
+    std::vector<RenderTarget> views;
+    int w = 0, h = 0;
+} mo;
+
+bool parseOutputDisplays(const char* spec, OutputOptions& opts) {
+    opts.displays.clear();
+    if (std::strcmp(spec, "all") == 0) {
+        opts.displays.push_back(-1);  // expanded once SDL is up
+        return true;
+    }
+    const char* p = spec;
+    while (*p) {
+        char* end = nullptr;
+        long d = std::strtol(p, &end, 10);
+        if (end == p || d < 0) return false;
+        opts.displays.push_back((int)d);
+        p = end;
+        if (*p == ',') ++p;
+        else if (*p) return false;
+    }
+    return !opts.displays.empty();
+}
+
+bool initOutputs(SDL_Window* primary, SDL_GLContext ctx, const OutputOptions& opts, int& w, int& h) {
+    int count = SDL_GetNumVideoDisplays();
+    std::vector<int> displays = opts.displays;
+    if (displays.size() == 1 && displays[0] == -1) {
+        displays.clear();
+        for (int d = 0; d < count; ++d) displays.push_back(d);
+    }
+    if (displays.size() < 2) {
+        if (!opts.displays.empty()) std::cout << "Outputs: one display, single window\n";
+        return true;
+    }
+
+    std::vector<SDL_Rect> bounds(displays.size());
+    for (size_t i = 0; i < displays.size(); ++i) {
+        if (displays[i] >= count || SDL_GetDisplayBounds(displays[i], &bounds[i]) != 0) {
+            std::cerr << "Outputs: no display " << displays[i] << " (" << count << " found)\n";
+            return false;
+        }
+    }
+
+    // span: the canvas is the union of the display rectangles
+    int x0 = bounds[0].x, y0 = bounds[0].y, x1 = x0, y1 = y0;
+    int maxW = 0, maxH = 0;
+    for (const SDL_Rect& b : bounds) {
+        x0 = std::min(x0, b.x); y0 = std::min(y0, b.y);
+        x1 = std::max(x1, b.x + b.w); y1 = std::max(y1, b.y + b.h);
+        maxW = std::max(maxW, b.w); maxH = std::max(maxH, b.h);
+    }
+    mo.w = opts.separate ? maxW : x1 - x0;
+    mo.h = opts.separate ? maxH : y1 - y0;
+
+    mo.ctx = ctx;
+    for (size_t i = 0; i < displays.size(); ++i) {
+        const SDL_Rect& b = bounds[i];
+        OutputWindow out;
+        if (i == 0) {
+            out.win = primary;
+            SDL_SetWindowBordered(primary, SDL_FALSE);
+            SDL_SetWindowPosition(primary, b.x, b.y);
+            SDL_SetWindowSize(primary, b.w, b.h);
+        } else {
+            out.win = SDL_CreateWindow(SDL_GetWindowTitle(primary), b.x, b.y, b.w, b.h,
+                SDL_WINDOW_OPENGL | SDL_WINDOW_BORDERLESS);
+            if (!out.win) {
+                std::cerr << "Outputs: CreateWindow on display " << displays[i] << " failed: " << SDL_GetError() << "\n";
+                shutdownOutputs();
+                return false;
+            }
+        }
+        out.w = b.w; out.h = b.h;
+        if (opts.separate) {
+            out.view = (int)i;
+            out.src = { 0, 0, mo.w, mo.h };
+        } else {
+            out.src = { b.x - x0, (y1 - y0) - (b.y - y0) - b.h, b.w, b.h };
+        }
+        mo.windows.push_back(out);
+    }
+    SDL_GL_MakeCurrent(primary, ctx);
+
+    mo.views.resize(opts.separate ? displays.size() : 1);
+    for (RenderTarget& rt : mo.views) {
+        if (!createRenderTarget(rt, mo.w, mo.h)) {
+            std::cerr << "Outputs: cannot create a " << mo.w << "x" << mo.h << " view\n";
+            shutdownOutputs();
+            return false;
+        }
+    }
+
+    mo.active = true;
+    w = mo.w; h = mo.h;
+    std::cout << "Outputs: " << mo.windows.size() << " windows, " << (opts.separate ? "separate" : "span")
+              << " " << mo.w << "x" << mo.h << "\n";
+    for (size_t i = 0; i < mo.windows.size(); ++i) {
+        const OutputWindow& out = mo.windows[i];
+        std::cout << "  display " << displays[i] << ": view " << out.view << " offset "
+                  << out.src.x << "," << out.src.y << " size " << out.w << "x" << out.h << "\n";
+    }
+    return true;
+}
+
+void shutdownOutputs() {
+    releaseOutputViews();
+    closeOutputWindows();
+}
+
+void releaseOutputViews() {
+    if (mo.ctx && !mo.windows.empty()) SDL_GL_MakeCurrent(mo.windows[0].win, mo.ctx);
+    for (RenderTarget& rt : mo.views) destroyRenderTarget(rt);
+    mo.views.clear();
+}
+
+void closeOutputWindows() {
+    // window 0 belongs to the host
+    for (size_t i = 1; i < mo.windows.size(); ++i) SDL_DestroyWindow(mo.windows[i].win);
+    mo.windows.clear();
+    mo.active = false;
+}
+
+bool outputsActive() {
+    return mo.active;
+}
+
+int outputViewCount() {
+    return mo.active ? (int)mo.views.size() : 1;
+}
+
+int outputViewEffect(int view, int current, int effectCount) {
+    return (current + view) % effectCount;
+}
+
+void beginOutputView(int view) {
+    if (!mo.active) return;
+    glBindFramebuffer(GL_FRAMEBUFFER, mo.views[view].fbo);
+    glViewport(0, 0, mo.w, mo.h);
+}
+
+static void blitOutput(const OutputWindow& out) {
+    SDL_GL_MakeCurrent(out.win, mo.ctx);
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, mo.views[out.view].fbo);
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
+    bool scaled = out.src.w != out.w || out.src.h != out.h;
+    glBlitFramebuffer(out.src.x, out.src.y, out.src.x + out.src.w, out.src.y + out.src.h,
+        0, 0, out.w, out.h, GL_COLOR_BUFFER_BIT, scaled ? GL_LINEAR : GL_NEAREST);
+}
+
+void presentOutputs() {
+    if (!mo.active) return;
+    // the pacing mode's interval applies to the first window only; the rest
+    // swap at once so all of them flip on the same refresh
+    int interval = SDL_GL_GetSwapInterval();
+    for (size_t i = 1; i < mo.windows.size(); ++i) {
+        blitOutput(mo.windows[i]);
+        SDL_GL_SetSwapInterval(0);
+        SDL_GL_SwapWindow(mo.windows[i].win);
+    }
+    blitOutput(mo.windows[0]);
+    SDL_GL_SetSwapInterval(interval);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    glViewport(0, 0, mo.windows[0].w, mo.windows[0].h);
+}
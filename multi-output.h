@@ -0,0 +1,49 @@
+// multi-output.h
+// Several windows on several displays driven from the one GL context, so
+// programs, textures and render targets exist once and every output shows
+// the same frame. The host renders into shared views instead of the default
+// framebuffer; each window then blits its region of a view and swaps.
+//
+// Span: one view the size of the union of the chosen displays' desktop
+// bounds; each window shows its own rectangle of it, so iResolution is the
+// whole canvas and a window's offset is where its display sits in it.
+// Separate: one view per output, each drawing its own effect at the size of
+// the largest output (smaller outputs are scaled down).
+#pragma once
+#include <SDL2/SDL.h>
+#include <vector>
+
+struct OutputOptions {
+    std::vector<int> displays;  // display indices; fewer than two leaves the single window as is
+    bool separate = false;
+};
+
+// Parses "0,1,2" or "all" into the display list
+bool parseOutputDisplays(const char* spec, OutputOptions& opts);
+
+// Turns the existing window into output 0 and opens the others. w/h receive
+// the view size the host renders at. Returns false (after printing why) if an
+// output cannot be opened; the single window is left as it was.
+bool initOutputs(SDL_Window* primary, SDL_GLContext ctx, const OutputOptions& opts, int& w, int& h);
+// Both halves below, on a thread that has the context and made the windows
+void shutdownOutputs();
+// Render thread, context current: the views' GL objects
+void releaseOutputViews();
+// The thread that created the windows (SDL wants them destroyed where their
+// events are pumped), after the render thread is done with them
+void closeOutputWindows();
+
+// True once more than one window is being driven
+bool outputsActive();
+// 1 unless outputs are separate
+int outputViewCount();
+// The effect view draws, counting on from the selected one
+int outputViewEffect(int view, int current, int effectCount);
+
+// Binds a view's target and viewport; nothing when outputs are not active
+void beginOutputView(int view);
+
+// Blits and swaps every window but the first, then blits the first and
+// leaves it current so the caller's swap (presentPacedFrame) presents it.
+// Only that swap waits for vblank.
+void presentOutputs();
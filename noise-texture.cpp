@@ -0,0 +1,68 @@
+// noise-texture.cpp
+// Generates the shared noise lattice texture.
+
+#include "noise-texture.h"
+#include <vector>
+#include <cmath>
+#include <cstdint>
+
+static GLuint noiseTex = 0;
+
+static float fract(float x) {
+    return x - std::floor(x);
+}
+
+// Same as hash21 in the effects, so both noise paths agree inside one tile
+static float hash21(float x, float y) {
+    x = fract(x * 123.34f);
+    y = fract(y * 456.21f);
+    float d = x * (x + 45.32f) + y * (y + 45.32f);
+    x += d; y += d;
+    return fract(x * y);
+}
+
+void buildNoiseLattice(uint8_t* texels) {
+    for (int y = 0; y < noiseTextureSize; ++y)
+        for (int x = 0; x < noiseTextureSize; ++x)
+            texels[(size_t)y * noiseTextureSize + x] = (uint8_t)std::lround(hash21((float)x, (float)y) * 255.0f);
+}
+
+float valueNoise(float x, float y) {
+    float ix = std::floor(x), iy = std::floor(y);
+    float fx = x - ix, fy = y - iy;
+    fx = fx * fx * (3.0f - 2.0f * fx);
+    fy = fy * fy * (3.0f - 2.0f * fy);
+    float a = hash21(ix, iy), b = hash21(ix + 1.0f, iy);
+    float c = hash21(ix, iy + 1.0f), d = hash21(ix + 1.0f, iy + 1.0f);
+    float ab = a + (b - a) * fx, cd = c + (d - c) * fx;
+    return ab + (cd - ab) * fy;
+}
+
+bool initNoiseTexture() {
+    std::vector<uint8_t> texels((size_t)noiseTextureSize * noiseTextureSize);
+    buildNoiseLattice(texels.data());
+
+    glGenTextures(1, &noiseTex);
+    glBindTexture(GL_TEXTURE_2D, noiseTex);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_R8, noiseTextureSize, noiseTextureSize, 0, GL_RED, GL_UNSIGNED_BYTE, texels.data());
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    // the effects interpolate through the bilinear filter; no mips, the lattice must stay exact
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    return true;
+}
+
+void shutdownNoiseTexture() {
+    glDeleteTextures(1, &noiseTex);
+    noiseTex = 0;
+}
+
+void bindNoiseTexture() {
+    glActiveTexture(GL_TEXTURE0 + noiseTextureUnit);
+    glBindTexture(GL_TEXTURE_2D, noiseTex);
+    glActiveTexture(GL_TEXTURE0);
+}
@@ -0,0 +1,25 @@
+// noise-texture.h
+// Shared noise lattice for the effects. Texel (x, y) of a tileable 256x256
+// R8 texture holds hash21(vec2(x, y)) rounded to 8 bits, so an effect built with NOISE_TEX 1
+// replaces the four hashes and the mix of its value noise with one filtered
+// fetch. With NOISE_TEX 0 it keeps the ALU version; both exist so the
+// trade-off can be measured per GPU (see --benchmark).
+#pragma once
+#include <glad/glad.h>
+#include <cstdint>
+
+static const int noiseTextureSize = 256;
+static const int noiseTextureUnit = 1; // unit 0 is left to the post passes
+
+// Fills noiseTextureSize^2 texels, row y = lattice y; shared with the CPU renderer
+void buildNoiseLattice(uint8_t* texels);
+
+// The NOISE_TEX 0 value noise at (x, y), for per-frame values worked out on
+// the CPU (EffectDesc::frameConsts)
+float valueNoise(float x, float y);
+
+bool initNoiseTexture();
+void shutdownNoiseTexture();
+
+// Binds the texture to noiseTextureUnit; the active unit is left at 0
+void bindNoiseTexture();
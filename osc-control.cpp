@@ -0,0 +1,357 @@
+// osc-control.cpp
+// UDP receive thread, the in-place OSC parser and the telemetry replies.
+
+#ifdef _WIN32
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#pragma comment(lib, "ws2_32.lib")
+typedef SOCKET socket_t;
+typedef int socklen_t;
+static const socket_t noSocket = INVALID_SOCKET;
+static void closeSocket(socket_t s) { closesocket(s); }
+#else
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+typedef int socket_t;
+static const socket_t noSocket = -1;
+static void closeSocket(socket_t s) { close(s); }
+#endif
+
+#include "osc-control.h"
+#include "telemetry.h"
+#include "triple-buffer.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <thread>
+
+static const size_t packetBytes = 1536;   // one Ethernet frame's worth
+static const size_t replyBytes = 256;
+static const int receiveTimeoutMs = 20;   // bounds the reply jitter and the stop delay
+static const int maxBundleDepth = 4;
+
+static const char* paramNames[4] = { "speed", "warp", "thickness", "colorShift" };
+static const char* addressPrefix = "/timewarp/";
+
+struct OscPeer {
+    sockaddr_in addr = {};
+    std::chrono::steady_clock::time_point lastHeard;
+    bool live = false;
+};
+
+static struct {
+    std::atomic<bool> running{false};
+    std::thread thread;
+    socket_t sock = noSocket;
+    OscOptions opts;
+    const std::vector<std::string>* names = nullptr;
+    Uint32 wakeEvent = (Uint32)-1;
+    // receive thread only
+    RemoteControl state;
+    bool dirty = false;
+    bool heard = false;  // the packet held a /timewarp/ message we understood
+    OscPeer peers[oscMaxPeers];
+    char packet[packetBytes];
+    char reply[replyBytes];
+    int fpsCounter = -1, frameMsCounter = -1, gpuMsCounter = -1, effectCounter = -1;
+    // written by the receive thread, read by the input thread
+    TripleBuffer<RemoteControl> published{ RemoteControl{} };
+    // input thread only: the serials it has applied
+    RemoteControl applied;
+} osc;
+
+// ---- reading, in place and bounds-checked; OSC is big-endian, 4-byte aligned ----
+
+struct OscReader {
+    const char* p;
+    const char* end;
+};
+
+static bool readString(OscReader& r, const char*& s) {
+    const char* nul = (const char*)std::memchr(r.p, 0, (size_t)(r.end - r.p));
+    if (!nul) return false;
+    size_t padded = ((size_t)(nul - r.p) / 4 + 1) * 4;
+    if (padded > (size_t)(r.end - r.p)) return false;
+    s = r.p;
+    r.p += padded;
+    return true;
+}
+
+static bool readWord(OscReader& r, uint32_t& v) {
+    if (r.end - r.p < 4) return false;
+    const unsigned char* b = (const unsigned char*)r.p;
+    v = (uint32_t)b[0] << 24 | (uint32_t)b[1] << 16 | (uint32_t)b[2] << 8 | b[3];
+    r.p += 4;
+    return true;
+}
+
+static int findEffectName(const char* name) {
+    for (size_t i = 0; i < osc.names->size(); ++i)
+        if ((*osc.names)[i] == name) return (int)i;
+    return -1;
+}
+
+static void handleMessage(const char* data, size_t size) {
+    OscReader r{ data, data + size };
+    const char* address;
+    const char* tags = ",";
+    if (!readString(r, address)) return;
+    // messages without a type tag string carry no arguments we can read
+    if (r.p < r.end && *r.p == ',' && !readString(r, tags)) return;
+    size_t prefix = std::strlen(addressPrefix);
+    if (std::strncmp(address, addressPrefix, prefix) != 0) return;
+    const char* name = address + prefix;
+
+    bool hasNumber = false;
+    float number = 0.0f;
+    const char* text = nullptr;
+    uint32_t word;
+    if (tags[1] == 'f' && readWord(r, word)) {
+        std::memcpy(&number, &word, sizeof(number));
+        hasNumber = std::isfinite(number);
+    } else if (tags[1] == 'i' && readWord(r, word)) {
+        number = (float)(int32_t)word;
+        hasNumber = true;
+    } else if (tags[1] == 's' && !readString(r, text)) {
+        text = nullptr;
+    }
+
+    RemoteControl& s = osc.state;
+    for (int i = 0; i < 4; ++i) {
+        if (hasNumber && std::strcmp(name, paramNames[i]) == 0) {
+            s.params[i] = number;
+            ++s.paramSerial[i];
+            osc.dirty = osc.heard = true;
+        }
+    }
+    if (std::strcmp(name, "effect") == 0) {
+        // range-checked as a float: converting one outside int's range is undefined
+        int count = (int)osc.names->size();
+        int index = -1;
+        if (hasNumber && number >= 1.0f && number < (float)count + 1.0f) index = (int)number - 1;
+        else if (!hasNumber && text) index = findEffectName(text);
+        if (index >= 0 && index < count) {
+            s.effect = index;
+            ++s.effectSerial;
+            osc.dirty = osc.heard = true;
+        }
+    }
+    if (std::strcmp(name, "next") == 0) { ++s.nextSteps; osc.dirty = osc.heard = true; }
+    if (std::strcmp(name, "prev") == 0) { ++s.prevSteps; osc.dirty = osc.heard = true; }
+}
+
+// A bundle's time tag is ignored: everything applies on arrival
+static void handlePacket(const char* data, size_t size, int depth) {
+    if (size >= 16 && std::memcmp(data, "#bundle", 8) == 0) {
+        if (depth >= maxBundleDepth) return;
+        OscReader r{ data + 16, data + size };
+        uint32_t elementSize;
+        while (readWord(r, elementSize)) {
+            if (elementSize == 0 || elementSize % 4 != 0 || elementSize > (size_t)(r.end - r.p)) return;
+            handlePacket(r.p, elementSize, depth + 1);
+            r.p += elementSize;
+        }
+        return;
+    }
+    handleMessage(data, size);
+}
+
+// ---- writing the replies into the static buffer ----
+
+struct OscWriter {
+    char* p;
+    char* end;
+    bool ok;
+};
+
+static void writeWord(OscWriter& w, uint32_t v) {
+    if (w.end - w.p < 4) { w.ok = false; return; }
+    unsigned char* b = (unsigned char*)w.p;
+    b[0] = (unsigned char)(v >> 24); b[1] = (unsigned char)(v >> 16); b[2] = (unsigned char)(v >> 8); b[3] = (unsigned char)v;
+    w.p += 4;
+}
+
+static void writeString(OscWriter& w, const char* s) {
+    size_t n = std::strlen(s), padded = (n / 4 + 1) * 4;
+    if ((size_t)(w.end - w.p) < padded) { w.ok = false; return; }
+    std::memcpy(w.p, s, n);
+    std::memset(w.p + n, 0, padded - n);
+    w.p += padded;
+}
+
+// One bundle element: size, address, ",f" or ",i", the argument
+static void writeElement(OscWriter& w, const char* name, char tag, uint32_t bits) {
+    char* sizeAt = w.p;
+    writeWord(w, 0);
+    char* start = w.p;
+    char address[32];
+    std::snprintf(address, sizeof(address), "%s%s", addressPrefix, name);
+    writeString(w, address);
+    const char tags[3] = { ',', tag, 0 };
+    writeString(w, tags);
+    writeWord(w, bits);
+    if (!w.ok) return;
+    OscWriter size{ sizeAt, start, true };
+    writeWord(size, (uint32_t)(w.p - start));
+}
+
+static void writeFloat(OscWriter& w, const char* name, double value) {
+    float f = (float)value;
+    uint32_t bits;
+    std::memcpy(&bits, &f, sizeof(bits));
+    writeElement(w, name, 'f', bits);
+}
+
+static void sendReplies() {
+    using clock = std::chrono::steady_clock;
+    auto now = clock::now();
+    OscWriter w{ osc.reply, osc.reply + replyBytes, true };
+    writeString(w, "#bundle");
+    writeWord(w, 0); writeWord(w, 1);  // time tag: immediately
+    writeFloat(w, "fps", telemetryCounterValue(osc.fpsCounter));
+    writeFloat(w, "frame_ms", telemetryCounterValue(osc.frameMsCounter));
+    writeFloat(w, "gpu_ms", telemetryCounterValue(osc.gpuMsCounter));
+    writeElement(w, "effect", 'i', (uint32_t)((int32_t)telemetryCounterValue(osc.effectCounter) + 1));
+    if (!w.ok) return;
+    for (OscPeer& peer : osc.peers) {
+        if (!peer.live) continue;
+        if (std::chrono::duration<double>(now - peer.lastHeard).count() > oscPeerTimeoutSeconds) {
+            peer.live = false;
+            continue;
+        }
+        sendto(osc.sock, osc.reply, (int)(w.p - osc.reply), 0, (const sockaddr*)&peer.addr, sizeof(peer.addr));
+    }
+}
+
+static void notePeer(const sockaddr_in& from) {
+    auto now = std::chrono::steady_clock::now();
+    OscPeer* slot = nullptr;
+    for (OscPeer& peer : osc.peers) {
+        if (peer.live && peer.addr.sin_addr.s_addr == from.sin_addr.s_addr && peer.addr.sin_port == from.sin_port) {
+            slot = &peer;
+            break;
+        }
+        // a free slot, else the one heard from longest ago
+        if (!slot || (slot->live && (!peer.live || peer.lastHeard < slot->lastHeard))) slot = &peer;
+    }
+    if (!slot->live) telemetryLog(LogLevel::Info, "OSC: peer %s:%d", inet_ntoa(from.sin_addr), ntohs(from.sin_port));
+    slot->addr = from;
+    slot->lastHeard = now;
+    slot->live = true;
+}
+
+static void oscThread() {
+    using clock = std::chrono::steady_clock;
+    auto period = std::chrono::duration_cast<clock::duration>(
+        std::chrono::duration<double>(osc.opts.replyHz > 0.0 ? 1.0 / osc.opts.replyHz : 1.0));
+    auto nextReply = clock::now() + period;
+    while (osc.running.load(std::memory_order_acquire)) {
+        sockaddr_in from = {};
+        socklen_t fromLen = sizeof(from);
+        int n = (int)recvfrom(osc.sock, osc.packet, (int)packetBytes, 0, (sockaddr*)&from, &fromLen);
+        if (n > 0) {
+            osc.dirty = osc.heard = false;
+            handlePacket(osc.packet, (size_t)n, 0);
+            // only a sender of valid control messages gets telemetry back, so
+            // stray or spoofed datagrams can't aim the replies anywhere
+            if (osc.heard) notePeer(from);
+            if (osc.dirty) {
+                osc.published.back() = osc.state;
+                osc.published.publish();
+                // the input thread sleeps in SDL_WaitEventTimeout until this
+                SDL_Event e = {};
+                e.type = osc.wakeEvent;
+                SDL_PushEvent(&e);
+            }
+        }
+        auto now = clock::now();
+        if (osc.opts.replyHz > 0.0 && now >= nextReply) {
+            nextReply += period;
+            if (nextReply < now) nextReply = now + period;
+            sendReplies();
+        }
+    }
+}
+
+bool startOscControl(const OscOptions& opts, const std::vector<std::string>& effectNames) {
+    if (opts.port <= 0) return false;
+#ifdef _WIN32
+    WSADATA wsa;
+    if (WSAStartup(MAKEWORD(2, 2), &wsa) != 0) return false;
+#endif
+    osc.sock = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    sockaddr_in addr = {};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons((unsigned short)opts.port);
+    addr.sin_addr.s_addr = htonl(INADDR_ANY);  // the control surface is usually another machine
+    if (osc.sock == noSocket || bind(osc.sock, (const sockaddr*)&addr, sizeof(addr)) != 0) {
+        std::cerr << "OSC: cannot listen on UDP port " << opts.port << "\n";
+        if (osc.sock != noSocket) closeSocket(osc.sock);
+        osc.sock = noSocket;
+#ifdef _WIN32
+        WSACleanup();
+#endif
+        return false;
+    }
+#ifdef _WIN32
+    DWORD timeout = receiveTimeoutMs;
+#else
+    timeval timeout = { 0, receiveTimeoutMs * 1000 };
+#endif
+    setsockopt(osc.sock, SOL_SOCKET, SO_RCVTIMEO, (const char*)&timeout, sizeof(timeout));
+
+    osc.opts = opts;
+    osc.names = &effectNames;
+    osc.wakeEvent = SDL_RegisterEvents(1);
+    osc.fpsCounter = telemetryCounter("fps");
+    osc.frameMsCounter = telemetryCounter("frame_ms");
+    osc.gpuMsCounter = telemetryCounter("gpu_ms");
+    osc.effectCounter = telemetryCounter("effect");
+    osc.running.store(true, std::memory_order_release);
+    osc.thread = std::thread(oscThread);
+    std::cout << "OSC: listening on UDP port " << opts.port << "\n";
+    return true;
+}
+
+void stopOscControl() {
+    if (!osc.running.load()) return;
+    osc.running.store(false, std::memory_order_release);
+    osc.thread.join();
+    closeSocket(osc.sock);
+    osc.sock = noSocket;
+#ifdef _WIN32
+    WSACleanup();
+#endif
+}
+
+bool applyOscControl(InputSnapshot& s, const std::vector<const EffectDesc*>& descs) {
+    if (!osc.running.load(std::memory_order_relaxed) || !osc.published.update()) return false;
+    const RemoteControl& rc = osc.published.front();
+    int count = (int)s.params.size();
+    bool changed = false;
+    if (rc.effectSerial != osc.applied.effectSerial && rc.effect < count && !effectSkipped(rc.effect)) {
+        s.current = rc.effect;
+        changed = true;
+    }
+    for (uint32_t n = osc.applied.nextSteps; n != rc.nextSteps; ++n, changed = true) s.current = std::max(0, selectableEffect(s.current, 1, count));
+    for (uint32_t n = osc.applied.prevSteps; n != rc.prevSteps; ++n, changed = true) s.current = std::max(0, selectableEffect(s.current, -1, count));
+
+    EffectParams& p = s.params[s.current];
+    float* fields[4] = { &p.speed, &p.warp, &p.thickness, &p.colorShift };
+    for (int i = 0; i < 4; ++i) {
+        if (rc.paramSerial[i] == osc.applied.paramSerial[i]) continue;
+        *fields[i] = rc.params[i];
+        changed = true;
+    }
+    // the same ranges as the keys
+    clampEffectParams(*descs[s.current], p);
+    osc.applied = rc;
+    return changed;
+}
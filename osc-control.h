@@ -0,0 +1,52 @@
+// osc-control.h
+// Remote control over OSC (Open Sound Control) on UDP, for when the machine
+// is out of reach of its keyboard. A thread of its own receives into one
+// static buffer and parses each packet in place, bundles included, without
+// allocating. What a message sets accumulates in a RemoteControl state that
+// the thread publishes through a TripleBuffer and then wakes the input
+// thread with an SDL user event. The input thread folds it into the next
+// InputSnapshot (see applyOscControl), so the render loop sees remote
+// changes exactly like key presses and never waits on the network.
+//
+// Addresses (numbers as float or int32 arguments):
+//   /timewarp/speed f   /timewarp/warp f   /timewarp/thickness f
+//   /timewarp/colorShift f                    set on the selected effect
+//   /timewarp/effect i|s                      select by number (1..) or name
+//   /timewarp/next   /timewarp/prev
+// Every peer that sent a valid one of these in the last
+// oscPeerTimeoutSeconds gets a bundle of /timewarp/fps, /timewarp/frame_ms,
+// /timewarp/gpu_ms (f) and /timewarp/effect (i) back at replyHz, read from
+// the telemetry counters (telemetry.h).
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "host-input.h"
+
+static const int oscMaxPeers = 4;
+static const double oscPeerTimeoutSeconds = 10.0;
+
+struct OscOptions {
+    int port = 0;          // 0: off
+    double replyHz = 10.0; // telemetry back to the peers; 0: none
+};
+
+// Everything received so far; a serial per field tells a new value from one
+// already applied, so a snapshot the input thread skips loses nothing
+struct RemoteControl {
+    float params[4] = {};           // speed, warp, thickness, colorShift
+    uint32_t paramSerial[4] = {};
+    int effect = 0;
+    uint32_t effectSerial = 0;
+    uint32_t nextSteps = 0, prevSteps = 0;
+};
+
+// After SDL_Init; names are the effects in registry order and must outlive
+// the thread
+bool startOscControl(const OscOptions& opts, const std::vector<std::string>& effectNames);
+void stopOscControl();
+
+// Input thread: applies what arrived since the last call, clamped to the
+// ranges of descs[s.current] (registry order); true if s changed
+bool applyOscControl(InputSnapshot& s, const std::vector<const EffectDesc*>& descs);
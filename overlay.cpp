@@ -0,0 +1,115 @@
+// overlay.cpp
+// Immediate-mode 2D overlay used by the profiler and other debug views.
+
+#include "overlay.h"
+#include "gl-util.h"
+#include <vector>
+#include <cctype>
+
+static const char* overlayVertexSrc = R"glsl(
+#version 330 core
+layout(location = 0) in vec2 inPos;
+layout(location = 1) in vec4 inColor;
+uniform vec2 uScreen;
+out vec4 color;
+void main(){
+    color = inColor;
+    vec2 ndc = inPos / uScreen * 2.0 - 1.0;
+    gl_Position = vec4(ndc.x, -ndc.y, 0.0, 1.0);
+}
+)glsl";
+
+static const char* overlayFragmentSrc = R"glsl(
+#version 330 core
+in vec4 color;
+out vec4 fragColor;
+void main(){
+    fragColor = color;
+}
+)glsl";
+
+// 3x5 glyphs for ASCII 32..95, row-major from the top-left, bit 14 first
+static const uint16_t font3x5[64] = {
+    0x0000, 0x2482, 0x0000, 0x0000, 0x0000, 0x52a5, 0x0000, 0x2400,  //  !"#$%&'
+    0x2922, 0x224a, 0x0aa8, 0x05d0, 0x0014, 0x01c0, 0x0002, 0x12a4,  // ()*+,-./
+    0x7b6f, 0x2c97, 0x73e7, 0x73cf, 0x5bc9, 0x79cf, 0x79ef, 0x7249,  // 01234567
+    0x7bef, 0x7bcf, 0x0410, 0x0000, 0x1511, 0x0e38, 0x4454, 0x6282,  // 89:;<=>?
+    0x0000, 0x2bed, 0x6bae, 0x3923, 0x6b6e, 0x79a7, 0x79a4, 0x396b,  // @ABCDEFG
+    0x5bed, 0x7497, 0x126a, 0x5bad, 0x4927, 0x5fed, 0x6b6d, 0x2b6a,  // HIJKLMNO
+    0x6ba4, 0x2b73, 0x6bad, 0x388e, 0x7492, 0x5b6f, 0x5b6a, 0x5bfd,  // PQRSTUVW
+    0x5aad, 0x5a92, 0x72a7, 0x0000, 0x0000, 0x0000, 0x0000, 0x0007,  // XYZ[\]^_
+};
+
+static struct {
+    GLuint prog = 0;
+    GLint locScreen = -1;
+    GLuint vao = 0;
+    GLuint vbo = 0;
+    std::vector<float> verts; // x, y, r, g, b, a
+} ov;
+
+bool initOverlay() {
+    GLuint vs = compileShader(GL_VERTEX_SHADER, overlayVertexSrc);
+    GLuint fs = compileShader(GL_FRAGMENT_SHADER, overlayFragmentSrc);
+    if (!vs || !fs) return false;
+    ov.prog = linkProgram(vs, fs);
+    glDeleteShader(vs); glDeleteShader(fs);
+    if (!ov.prog) return false;
+    ov.locScreen = glGetUniformLocation(ov.prog, "uScreen");
+
+    glGenVertexArrays(1, &ov.vao);
+    glBindVertexArray(ov.vao);
+    glGenBuffers(1, &ov.vbo);
+    glBindBuffer(GL_ARRAY_BUFFER, ov.vbo);
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 6 * sizeof(float), nullptr);
+    glEnableVertexAttribArray(1);
+    glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void*)(2 * sizeof(float)));
+    return true;
+}
+
+void shutdownOverlay() {
+    glDeleteBuffers(1, &ov.vbo);
+    glDeleteVertexArrays(1, &ov.vao);
+    glDeleteProgram(ov.prog);
+    ov.vbo = ov.vao = ov.prog = 0;
+}
+
+void overlayRect(float x, float y, float w, float h, uint32_t rgba) {
+    float r = ((rgba >> 24) & 0xff) / 255.0f;
+    float g = ((rgba >> 16) & 0xff) / 255.0f;
+    float b = ((rgba >> 8) & 0xff) / 255.0f;
+    float a = (rgba & 0xff) / 255.0f;
+    const float corners[6][2] = { {x, y}, {x + w, y}, {x + w, y + h}, {x, y}, {x + w, y + h}, {x, y + h} };
+    for (const auto& c : corners) {
+        ov.verts.insert(ov.verts.end(), { c[0], c[1], r, g, b, a });
+    }
+}
+
+float overlayText(float x, float y, float scale, uint32_t rgba, const char* text) {
+    for (const char* s = text; *s; ++s) {
+        int c = std::toupper((unsigned char)*s);
+        uint16_t bits = (c >= 32 && c < 96) ? font3x5[c - 32] : 0;
+        for (int i = 0; i < 15; ++i) {
+            if (bits & (1 << (14 - i)))
+                overlayRect(x + (i % 3) * scale, y + (i / 3) * scale, scale, scale, rgba);
+        }
+        x += 4 * scale;
+    }
+    return x;
+}
+
+void drawOverlay(int w, int h) {
+    if (ov.verts.empty() || !ov.prog) return;
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    glUseProgram(ov.prog);
+    glUniform2f(ov.locScreen, (float)w, (float)h);
+    glBindVertexArray(ov.vao);
+    glBindBuffer(GL_ARRAY_BUFFER, ov.vbo);
+    // orphan and refill; the overlay is small and rebuilt every frame
+    glBufferData(GL_ARRAY_BUFFER, ov.verts.size() * sizeof(float), ov.verts.data(), GL_STREAM_DRAW);
+    glDrawArrays(GL_TRIANGLES, 0, (GLsizei)(ov.verts.size() / 6));
+    glDisable(GL_BLEND);
+    ov.verts.clear();
+}
@@ -0,0 +1,17 @@
+// overlay.h
+// Immediate-mode 2D overlay: coloured rectangles and a built-in 3x5 pixel font,
+// batched into a single draw. Coordinates are window pixels, origin top-left,
+// colours are 0xRRGGBBAA.
+#pragma once
+#include <cstdint>
+
+bool initOverlay();
+void shutdownOverlay();
+
+void overlayRect(float x, float y, float w, float h, uint32_t rgba);
+// Draws upper-case text; each font pixel is scale x scale window pixels.
+// Returns the x coordinate after the last glyph.
+float overlayText(float x, float y, float scale, uint32_t rgba, const char* text);
+
+// Draws everything queued since the last call, alpha blended over the frame.
+void drawOverlay(int w, int h);
@@ -0,0 +1,86 @@
+// png-writer.cpp
+// PNG encoder using stored (uncompressed) deflate blocks: fast to write,
+// lossless, and needs no zlib.
+
+#include "png-writer.h"
+#include <vector>
+#include <algorithm>
+#include <cstdio>
+
+static uint32_t crc32(uint32_t crc, const uint8_t* p, size_t n) {
+    static const struct CrcTable {
+        uint32_t t[256];
+        CrcTable() {
+            for (uint32_t i = 0; i < 256; ++i) {
+                uint32_t c = i;
+                for (int k = 0; k < 8; ++k) c = c & 1 ? 0xedb88320u ^ (c >> 1) : c >> 1;
+                t[i] = c;
+            }
+        }
+    } table;
+    crc = ~crc;
+    for (size_t i = 0; i < n; ++i) crc = table.t[(crc ^ p[i]) & 0xff] ^ (crc >> 8);
+    return ~crc;
+}
+
+static void putBE32(std::vector<uint8_t>& out, uint32_t v) {
+    out.push_back((uint8_t)(v >> 24)); out.push_back((uint8_t)(v >> 16));
+    out.push_back((uint8_t)(v >> 8)); out.push_back((uint8_t)v);
+}
+
+static void putChunk(std::vector<uint8_t>& out, const char* type, const uint8_t* data, size_t n) {
+    putBE32(out, (uint32_t)n);
+    size_t start = out.size();
+    out.insert(out.end(), type, type + 4);
+    out.insert(out.end(), data, data + n);
+    putBE32(out, crc32(0, out.data() + start, n + 4));
+}
+
+bool writePng(const char* path, const uint8_t* rgbaBottomUp, int w, int h) {
+    // filter byte plus RGB per row, top row first
+    size_t rowBytes = 1 + 3 * (size_t)w;
+    std::vector<uint8_t> raw((size_t)h * rowBytes);
+    for (int y = 0; y < h; ++y) {
+        uint8_t* dst = raw.data() + (size_t)y * rowBytes;
+        const uint8_t* src = rgbaBottomUp + (size_t)(h - 1 - y) * w * 4;
+        *dst++ = 0;
+        for (int x = 0; x < w; ++x, src += 4, dst += 3) { dst[0] = src[0]; dst[1] = src[1]; dst[2] = src[2]; }
+    }
+
+    // zlib stream of stored blocks, Adler-32 reduced every 5552 bytes as zlib does
+    std::vector<uint8_t> z = { 0x78, 0x01 };
+    z.reserve(raw.size() + raw.size() / 65535 * 5 + 16);
+    uint32_t a = 1, b = 0;
+    for (size_t pos = 0; pos < raw.size(); ) {
+        size_t n = std::min<size_t>(5552, raw.size() - pos);
+        for (size_t i = 0; i < n; ++i) { a += raw[pos + i]; b += a; }
+        a %= 65521; b %= 65521;
+        pos += n;
+    }
+    size_t pos = 0;
+    for (;;) {
+        size_t n = std::min<size_t>(65535, raw.size() - pos);
+        bool last = pos + n == raw.size();
+        z.push_back(last ? 1 : 0);
+        z.push_back((uint8_t)n); z.push_back((uint8_t)(n >> 8));
+        z.push_back((uint8_t)~n); z.push_back((uint8_t)(~n >> 8));
+        z.insert(z.end(), raw.begin() + pos, raw.begin() + pos + n);
+        pos += n;
+        if (last) break;
+    }
+    putBE32(z, (b << 16) | a);
+
+    std::vector<uint8_t> png = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n' };
+    uint8_t ihdr[13] = {};
+    for (int i = 0; i < 4; ++i) { ihdr[i] = (uint8_t)(w >> (24 - 8 * i)); ihdr[4 + i] = (uint8_t)(h >> (24 - 8 * i)); }
+    ihdr[8] = 8; // bit depth
+    ihdr[9] = 2; // truecolour
+    putChunk(png, "IHDR", ihdr, sizeof(ihdr));
+    putChunk(png, "IDAT", z.data(), z.size());
+    putChunk(png, "IEND", nullptr, 0);
+
+    FILE* f = fopen(path, "wb");
+    if (!f) return false;
+    bool ok = fwrite(png.data(), 1, png.size(), f) == png.size();
+    return fclose(f) == 0 && ok;
+}
@@ -0,0 +1,8 @@
+// png-writer.h
+// Minimal PNG writer for frame exports and reference images.
+#pragma once
+#include <cstdint>
+
+// Writes an 8-bit RGB PNG from RGBA pixels stored bottom row first, the
+// order glReadPixels returns. Alpha is dropped.
+bool writePng(const char* path, const uint8_t* rgbaBottomUp, int w, int h);
@@ -0,0 +1,288 @@
+// profiler.cpp
+// Frame profiler with non-blocking GPU timer queries.
+
+#include "profiler.h"
+#include "overlay.h"
+#include "telemetry.h"
+#include <glad/glad.h>
+#include <fstream>
+#include <chrono>
+#include <algorithm>
+#include <cstdio>
+#include <cstdint>
+
+static const int querySlots = 8;     // frames the GPU may lag behind before we drop a timing
+static const int sampleCount = 8192; // retained for CSV export
+static const int statWindow = 512;   // samples per effect behind the percentiles
+static const int graphFrames = 240;
+static const int histBins = 48;      // 0.5 ms each, the last bin collects everything slower
+static const float histBinMs = 0.5f;
+static const float budgetMs = 1000.0f / 60.0f;
+
+typedef std::chrono::high_resolution_clock Clock;
+
+struct Sample {
+    uint64_t frame;
+    int effect;
+    float frameMs; // interval to the next frame
+    float cpuMs;   // frame start until swap
+    float swapMs;
+    float gpuMs;   // effect draw; negative if no timing was taken
+};
+
+struct QuerySlot {
+    GLuint query = 0;
+    bool open = false;      // sample not yet pushed
+    bool timed = false;     // a query was issued for it
+    bool frameDone = false; // frameMs is known
+    Clock::time_point start;
+    Sample sample{};
+};
+
+struct Stats {
+    float p50, p95, p99;
+};
+
+static struct {
+    bool initialized = false;
+    std::vector<std::string> names;
+    QuerySlot slots[querySlots];
+    uint64_t frame = 0;
+    Clock::time_point swapStart;
+
+    std::vector<Sample> samples; // ring of sampleCount
+    uint64_t pushed = 0;
+    bool haveGpu = false;
+    uint64_t latestGpuFrame = 0;
+    float latestGpuMs = 0.0f;
+
+    // cached overlay statistics
+    Clock::time_point statsTime;
+    int statsEffect = -1;
+    Stats gpu{}, cpu{}, swap{}, interval{};
+    int hist[histBins] = {};
+    int statsSamples = 0;
+} prof;
+
+static float msSince(Clock::time_point t, Clock::time_point now) {
+    return std::chrono::duration<float, std::milli>(now - t).count();
+}
+
+static void pushSample(const Sample& s) {
+    prof.samples[prof.pushed % sampleCount] = s;
+    ++prof.pushed;
+}
+
+bool initProfiler(const std::vector<std::string>& effectNames) {
+    prof.names = effectNames;
+    for (QuerySlot& slot : prof.slots) glGenQueries(1, &slot.query);
+    prof.samples.assign(sampleCount, Sample{});
+    prof.initialized = true;
+    return true;
+}
+
+void shutdownProfiler() {
+    if (!prof.initialized) return;
+    for (QuerySlot& slot : prof.slots) {
+        glDeleteQueries(1, &slot.query);
+        slot = QuerySlot{};
+    }
+    prof.initialized = false;
+}
+
+// Pushes finished frames oldest first; stops at the first GPU result not yet available.
+static void resolveSlots() {
+    for (int i = querySlots - 1; i >= 1; --i) {
+        if (prof.frame < (uint64_t)i) continue;
+        QuerySlot& slot = prof.slots[(prof.frame - i) % querySlots];
+        if (!slot.open || !slot.frameDone) continue;
+        if (slot.timed) {
+            GLint available = 0;
+            glGetQueryObjectiv(slot.query, GL_QUERY_RESULT_AVAILABLE, &available);
+            if (!available) break;
+            GLuint64 ns = 0;
+            glGetQueryObjectui64v(slot.query, GL_QUERY_RESULT, &ns);
+            slot.sample.gpuMs = (float)(ns / 1.0e6);
+            prof.haveGpu = true;
+            prof.latestGpuFrame = slot.sample.frame;
+            prof.latestGpuMs = slot.sample.gpuMs;
+        }
+        pushSample(slot.sample);
+        slot.open = false;
+    }
+}
+
+void profilerBeginFrame(int effect) {
+    if (!prof.initialized) return;
+    Clock::time_point now = Clock::now();
+    if (prof.frame > 0) {
+        QuerySlot& prev = prof.slots[(prof.frame - 1) % querySlots];
+        prev.sample.frameMs = msSince(prev.start, now);
+        prev.frameDone = true;
+    }
+    resolveSlots();
+
+    QuerySlot& slot = prof.slots[prof.frame % querySlots];
+    if (slot.open) {
+        // the GPU is more than querySlots frames behind; keep the CPU side, drop its GPU time
+        slot.sample.gpuMs = -1.0f;
+        pushSample(slot.sample);
+    }
+    slot.open = true;
+    slot.timed = false;
+    slot.frameDone = false;
+    slot.start = now;
+    slot.sample = Sample{ prof.frame, effect, 0.0f, 0.0f, 0.0f, -1.0f };
+}
+
+void profilerBeginGpu() {
+    if (!prof.initialized) return;
+    QuerySlot& slot = prof.slots[prof.frame % querySlots];
+    glBeginQuery(GL_TIME_ELAPSED, slot.query);
+    slot.timed = true;
+}
+
+void profilerEndGpu() {
+    if (!prof.initialized) return;
+    glEndQuery(GL_TIME_ELAPSED);
+}
+
+void profilerBeginSwap() {
+    if (!prof.initialized) return;
+    prof.swapStart = Clock::now();
+    QuerySlot& slot = prof.slots[prof.frame % querySlots];
+    slot.sample.cpuMs = msSince(slot.start, prof.swapStart);
+}
+
+void profilerEndSwap() {
+    if (!prof.initialized) return;
+    QuerySlot& slot = prof.slots[prof.frame % querySlots];
+    slot.sample.swapMs = msSince(prof.swapStart, Clock::now());
+    ++prof.frame;
+}
+
+uint64_t profilerFrameIndex() {
+    return prof.frame;
+}
+
+bool profilerLatestGpu(uint64_t& frame, float& ms) {
+    if (!prof.haveGpu) return false;
+    frame = prof.latestGpuFrame;
+    ms = prof.latestGpuMs;
+    return true;
+}
+
+static Stats percentiles(std::vector<float>& v) {
+    if (v.empty()) return Stats{ 0.0f, 0.0f, 0.0f };
+    std::sort(v.begin(), v.end());
+    auto at = [&](float q) { return v[std::min(v.size() - 1, (size_t)(q * (v.size() - 1) + 0.5f))]; };
+    return Stats{ at(0.50f), at(0.95f), at(0.99f) };
+}
+
+static void updateStats(int effect) {
+    std::vector<float> gpu, cpu, swap, interval;
+    std::fill(prof.hist, prof.hist + histBins, 0);
+    uint64_t available = std::min<uint64_t>(prof.pushed, sampleCount);
+    for (uint64_t i = 0; i < available && (int)cpu.size() < statWindow; ++i) {
+        const Sample& s = prof.samples[(prof.pushed - 1 - i) % sampleCount];
+        if (s.effect != effect) continue;
+        cpu.push_back(s.cpuMs);
+        swap.push_back(s.swapMs);
+        interval.push_back(s.frameMs);
+        if (s.gpuMs >= 0.0f) {
+            gpu.push_back(s.gpuMs);
+            prof.hist[std::min(histBins - 1, (int)(s.gpuMs / histBinMs))]++;
+        }
+    }
+    prof.statsSamples = (int)cpu.size();
+    prof.gpu = percentiles(gpu);
+    prof.cpu = percentiles(cpu);
+    prof.swap = percentiles(swap);
+    prof.interval = percentiles(interval);
+}
+
+void drawProfilerOverlay(int effect, int w, int h) {
+    if (!prof.initialized) return;
+    Clock::time_point now = Clock::now();
+    if (effect != prof.statsEffect || msSince(prof.statsTime, now) > 250.0f) {
+        updateStats(effect);
+        prof.statsEffect = effect;
+        prof.statsTime = now;
+    }
+
+    const float scale = 2.0f, line = 14.0f;
+    const float x0 = 10.0f, y0 = 10.0f, width = 380.0f;
+    const float graphH = 80.0f, histH = 60.0f;
+    const float panelH = 6 * line + graphH + histH + 3 * line;
+    overlayRect(x0 - 6, y0 - 6, width + 12, panelH + 12, 0x000000b0);
+
+    char buf[128];
+    float y = y0;
+    const char* name = effect >= 0 && effect < (int)prof.names.size() ? prof.names[effect].c_str() : "?";
+    snprintf(buf, sizeof(buf), "%s  %dX%d  %d SAMPLES", name, w, h, prof.statsSamples);
+    overlayText(x0, y, scale, 0xffffffff, buf); y += line * 1.5f;
+    const struct { const char* label; const Stats& s; uint32_t color; } rows[] = {
+        { "GPU", prof.gpu, 0xffa040ff },
+        { "CPU", prof.cpu, 0x60c0ffff },
+        { "SWAP", prof.swap, 0xc0c0c0ff },
+        { "FRAME", prof.interval, 0x80ff80ff },
+    };
+    for (const auto& r : rows) {
+        snprintf(buf, sizeof(buf), "%-5s P50 %6.2f P95 %6.2f P99 %6.2f MS", r.label, r.s.p50, r.s.p95, r.s.p99);
+        overlayText(x0, y, scale, r.color, buf);
+        y += line;
+    }
+    y += line * 0.5f;
+
+    // rolling graph of recent frames: frame interval behind, GPU time in front
+    const float maxMs = 2.0f * budgetMs;
+    overlayText(x0, y, scale, 0xffffffff, "LAST 240 FRAMES 0-33 MS"); y += line;
+    float barW = width / graphFrames;
+    uint64_t shown = std::min<uint64_t>(prof.pushed, graphFrames);
+    for (uint64_t i = 0; i < shown; ++i) {
+        const Sample& s = prof.samples[(prof.pushed - shown + i) % sampleCount];
+        float bx = x0 + i * barW;
+        float fh = std::min(s.frameMs / maxMs, 1.0f) * graphH;
+        overlayRect(bx, y + graphH - fh, barW, fh, 0x3060a0c0);
+        if (s.gpuMs >= 0.0f) {
+            float gh = std::min(s.gpuMs / maxMs, 1.0f) * graphH;
+            overlayRect(bx, y + graphH - gh, barW, gh, s.effect == effect ? 0xffa040ff : 0x806020ff);
+        }
+    }
+    overlayRect(x0, y + graphH - budgetMs / maxMs * graphH, width, 1.0f, 0xff3030ff);
+    y += graphH + line * 0.5f;
+
+    // distribution of GPU time for this effect
+    snprintf(buf, sizeof(buf), "GPU HISTOGRAM 0-%d MS", (int)(histBins * histBinMs));
+    overlayText(x0, y, scale, 0xffffffff, buf); y += line;
+    int peak = 1;
+    for (int c : prof.hist) peak = std::max(peak, c);
+    float binW = width / histBins;
+    for (int i = 0; i < histBins; ++i) {
+        float bh = (float)prof.hist[i] / peak * histH;
+        overlayRect(x0 + i * binW, y + histH - bh, binW - 1.0f, bh, 0x60e060ff);
+    }
+    overlayRect(x0 + budgetMs / histBinMs * binW, y, 1.0f, histH, 0xff3030ff);
+
+    drawOverlay(w, h);
+}
+
+bool exportProfilerCsv(const char* path) {
+    std::ofstream out(path);
+    if (!out) {
+        telemetryLog(LogLevel::Error, "Cannot write %s", path);
+        return false;
+    }
+    out << "frame,effect,frame_ms,cpu_ms,swap_ms,gpu_ms\n";
+    uint64_t available = std::min<uint64_t>(prof.pushed, sampleCount);
+    for (uint64_t i = prof.pushed - available; i < prof.pushed; ++i) {
+        const Sample& s = prof.samples[i % sampleCount];
+        out << s.frame << ","
+            << (s.effect >= 0 && s.effect < (int)prof.names.size() ? prof.names[s.effect] : "?") << ","
+            << s.frameMs << "," << s.cpuMs << "," << s.swapMs << ",";
+        if (s.gpuMs >= 0.0f) out << s.gpuMs;
+        out << "\n";
+    }
+    telemetryLog(LogLevel::Info, "Wrote %llu samples to %s", (unsigned long long)available, path);
+    return true;
+}
@@ -0,0 +1,31 @@
+// profiler.h
+// Frame profiler. GPU time of each effect draw comes from GL_TIME_ELAPSED
+// queries kept in a ring and read back only once available, so profiling
+// never stalls the pipeline. Frame interval, CPU work and swap time are taken
+// at the same points of every frame and joined with the GPU time of that
+// frame. Results are shown as an overlay and can be exported to CSV.
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+
+bool initProfiler(const std::vector<std::string>& effectNames);
+void shutdownProfiler();
+
+void profilerBeginFrame(int effect); // top of the frame, before any GL work
+void profilerBeginGpu();             // bracket the effect draw through its tonemap and bloom
+void profilerEndGpu();
+void profilerBeginSwap();            // bracket SDL_GL_SwapWindow
+void profilerEndSwap();
+
+// Index of the frame currently being recorded
+uint64_t profilerFrameIndex();
+// Most recent GPU time that has come back, and the frame it belongs to
+bool profilerLatestGpu(uint64_t& frame, float& ms);
+
+// Percentiles and histograms for the given effect, drawn through overlay.h
+void drawProfilerOverlay(int effect, int w, int h);
+
+// Writes every retained sample as frame,effect,frame_ms,cpu_ms,swap_ms,gpu_ms;
+// reports through telemetryLog, since the render loop calls it
+bool exportProfilerCsv(const char* path);
@@ -0,0 +1,106 @@
+// quality.cpp
+// Quality tier selection and the auto tier controller.
+
+#include "quality.h"
+#include "shader-variants.h"
+#include "profiler.h"
+#include "telemetry.h"
+#include <iostream>
+#include <cstring>
+#include <cstdint>
+
+static const char* tierNames[qualityTierCount] = { "low", "medium", "high", "ultra" };
+
+static const int historyFrames = 32;
+// GPU samples of a new tier before it is judged (variants may still be building)
+static const int settleSamples = 30;
+// A tier is raised only after this many samples under upHeadroom * budget;
+// returning to a tier that just ran over budget takes longer
+static const int upSamples = 120;
+static const int upSamplesAfterDrop = 600;
+static const float upHeadroom = 0.55f;
+
+static struct {
+    QualityTier tier = QualityTier::High;
+    bool automatic = false;
+    float targetMs = 14.0f;
+    float avgMs = 0.0f;      // smoothed GPU time at the current tier
+    int samples = 0;         // GPU samples taken at the current tier
+    int headroom = 0;        // consecutive samples with room for the next tier
+    bool dropped = false;    // the current tier was reached by stepping down
+    uint64_t lastFrameUsed = ~0ull;
+    QualityTier tiers[historyFrames] = {};
+} q;
+
+bool parseQualityTier(const char* name, QualityTier& tier) {
+    for (int i = 0; i < qualityTierCount; ++i) {
+        if (std::strcmp(name, tierNames[i]) == 0) {
+            tier = (QualityTier)i;
+            return true;
+        }
+    }
+    return false;
+}
+
+const char* qualityTierName(QualityTier tier) {
+    return tierNames[(int)tier];
+}
+
+static void applyTier(QualityTier tier, bool dropped) {
+    q.tier = tier;
+    q.avgMs = 0.0f;
+    q.samples = 0;
+    q.headroom = 0;
+    q.dropped = dropped;
+    setShaderVariantQuality((int)tier);
+}
+
+void initQuality(QualityTier tier, bool automatic, float targetMs) {
+    q.targetMs = targetMs;
+    q.automatic = automatic;
+    applyTier(tier, false);
+}
+
+void setQualityTier(QualityTier tier) {
+    q.automatic = false;
+    applyTier(tier, false);
+}
+
+void setQualityAuto(bool automatic) {
+    q.automatic = automatic;
+    applyTier(q.tier, false);
+}
+
+QualityTier qualityTier() {
+    return q.tier;
+}
+
+bool qualityAuto() {
+    return q.automatic;
+}
+
+void updateQuality() {
+    q.tiers[profilerFrameIndex() % historyFrames] = q.tier;
+    if (!q.automatic) return;
+
+    uint64_t frame; float ms;
+    if (!profilerLatestGpu(frame, ms) || frame == q.lastFrameUsed) return;
+    q.lastFrameUsed = frame;
+    // only frames drawn at the current tier say anything about it
+    if (profilerFrameIndex() - frame >= historyFrames || q.tiers[frame % historyFrames] != q.tier) return;
+
+    q.avgMs = q.samples > 0 ? q.avgMs * 0.9f + ms * 0.1f : ms;
+    if (++q.samples < settleSamples) return;
+
+    int tier = (int)q.tier;
+    if (q.avgMs > q.targetMs && tier > 0) {
+        applyTier((QualityTier)(tier - 1), true);
+        telemetryLog(LogLevel::Info, "Quality: %s (GPU over %g ms)", qualityTierName(q.tier), q.targetMs);
+        return;
+    }
+    q.headroom = q.avgMs < q.targetMs * upHeadroom ? q.headroom + 1 : 0;
+    if (q.headroom >= (q.dropped ? upSamplesAfterDrop : upSamples) && tier < qualityTierCount - 1) {
+        applyTier((QualityTier)(tier + 1), false);
+        telemetryLog(LogLevel::Info, "Quality: %s (GPU headroom)", qualityTierName(q.tier));
+    }
+}
@@ -0,0 +1,32 @@
+// quality.h
+// Named quality tiers for the raymarched effects. A tier is a compile-time
+// switch (QUALITY, see shader-variants.h) that sets the iteration count, the
+// smallest step, the far distance and an early-out once a pixel's
+// accumulated intensity saturates. In auto mode the tier follows measured GPU
+// time: one down as soon as frames run over budget, one up after a long run
+// of headroom.
+#pragma once
+
+enum class QualityTier {
+    Low,    // integrated GPUs: fewer, longer steps, nearer far plane, early-out
+    Medium,
+    High,   // as the effects were authored
+    Ultra,  // more and finer steps, farther
+};
+static const int qualityTierCount = 4;
+
+bool parseQualityTier(const char* name, QualityTier& tier);
+const char* qualityTierName(QualityTier tier);
+
+// targetMs is the GPU budget auto mode holds frames under
+void initQuality(QualityTier tier, bool automatic, float targetMs);
+
+// Picks a fixed tier and leaves auto mode
+void setQualityTier(QualityTier tier);
+void setQualityAuto(bool automatic);
+QualityTier qualityTier();
+bool qualityAuto();
+
+// Auto mode: reads the GPU times the profiler has returned and changes tier
+// when needed. Once per frame, before updateEffects.
+void updateQuality();
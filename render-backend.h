@@ -0,0 +1,51 @@
+// render-backend.h
+// The part of drawing an effect that differs between graphics APIs: the
+// window, building a program from an effect's GLSL, one frame of effect
+// pass plus tonemap, and present. The full host (timewarp.cpp) stays on GL
+// directly, since every post pass is written against it; the bare host
+// (bare-host.h) draws through this table, so the same effects can run on GL
+// or on Vulkan and the two can be compared frame for frame.
+#pragma once
+#include <SDL2/SDL.h>
+#include <string>
+
+#include "frame-params.h"
+#include "tonemap.h"
+
+enum class PresentMode {
+    Fifo,       // vsync, every frame shown
+    Mailbox,    // vsync without blocking: the newest frame replaces a queued one
+    Immediate,  // no vsync, may tear
+};
+
+bool parsePresentMode(const char* name, PresentMode& mode);
+const char* presentModeName(PresentMode mode);
+
+struct BackendOptions {
+    const char* cacheDir = nullptr; // compiled programs (SPIR-V, pipeline cache); null for none
+    PresentMode present = PresentMode::Fifo;
+    int framesInFlight = 2;         // frames recorded ahead of the GPU, where the API lets us choose
+};
+
+struct RenderBackend {
+    const char* name;
+    // Creates the window and everything the frames need; null (after
+    // printing why) on failure
+    SDL_Window* (*init)(const char* title, int w, int h, const BackendOptions& opts);
+    void (*shutdown)();
+    // Builds an effect's fragment source, with the variant #defines
+    // (shader-variants.h) inserted after its #version line; the backend adds
+    // the FrameParams block. Returns a program handle, or -1 if it fails.
+    int (*createProgram)(const char* label, const std::string& source, const std::string& defines);
+    // Draws program at the window size with params (iResolution included)
+    // into the HDR target, tonemaps into the window and presents. False once
+    // the window can't be drawn any more.
+    bool (*drawFrame)(int program, const FrameParams& params, const ToneDesc& tone, int frame);
+    // Window size changed
+    void (*resize)(int w, int h);
+};
+
+const RenderBackend& glBackend();
+// Null unless built with TIMEWARP_VULKAN (Vulkan SDK headers, vulkan-1 and
+// shaderc_combined): the Vulkan|x64 configuration of timewarp.vcxproj
+const RenderBackend* vulkanBackend();
@@ -0,0 +1,59 @@
+// render-pool.cpp
+// Slots of the render-target pool and their reuse order.
+
+#include "render-pool.h"
+#include "telemetry.h"
+#include <cstdint>
+
+struct PoolSlot {
+    RenderTarget rt;
+    bool inUse = false;
+    uint64_t lastUse = 0;  // acquire count at the last hand-out; lowest goes first
+};
+
+static struct {
+    PoolSlot slots[renderPoolSlots];
+    uint64_t acquires = 0;
+} pool;
+
+static bool matches(const RenderTarget& rt, int w, int h, GLenum format) {
+    return rt.fbo && rt.w == w && rt.h == h && rt.format == format;
+}
+
+RenderTarget* acquireRenderTarget(int w, int h, GLenum format) {
+    PoolSlot* pick = nullptr;
+    for (PoolSlot& s : pool.slots) {
+        if (s.inUse) continue;
+        if (matches(s.rt, w, h, format)) { pick = &s; break; }
+        // an empty slot before any live one, then the least recently used
+        if (!pick || (pick->rt.fbo && (!s.rt.fbo || s.lastUse < pick->lastUse))) pick = &s;
+    }
+    if (!pick) {
+        telemetryLog(LogLevel::Warn, "Render pool: all %d targets in use", renderPoolSlots);
+        return nullptr;
+    }
+    if (!matches(pick->rt, w, h, format)) {
+        if (pick->rt.fbo && pick->rt.format == format) {
+            resizeRenderTarget(pick->rt, w, h);
+        } else {
+            if (pick->rt.fbo) destroyRenderTarget(pick->rt);
+            if (!createRenderTarget(pick->rt, w, h, format)) return nullptr;
+        }
+        telemetryLog(LogLevel::Debug, "Render pool: slot %d now %dx%d", (int)(pick - pool.slots), w, h);
+    }
+    pick->inUse = true;
+    pick->lastUse = ++pool.acquires;
+    return &pick->rt;
+}
+
+void releaseRenderTarget(RenderTarget* rt) {
+    for (PoolSlot& s : pool.slots)
+        if (&s.rt == rt) s.inUse = false;
+}
+
+void shutdownRenderPool() {
+    for (PoolSlot& s : pool.slots) {
+        if (s.rt.fbo) destroyRenderTarget(s.rt);
+        s.inUse = false;
+    }
+}
@@ -0,0 +1,17 @@
+// render-pool.h
+// Fixed set of offscreen targets for passes that need them only some of the
+// time (effect transitions, compositor.h). Targets are keyed by size and
+// format: a released one goes out again for the same key with its storage
+// untouched, and only a request for a key no free slot has reallocates the
+// least recently used free slot. The pool never grows past renderPoolSlots.
+#pragma once
+#include "gl-util.h"
+
+static const int renderPoolSlots = 4;
+
+// A target of exactly w x h and format; null when every slot is taken
+RenderTarget* acquireRenderTarget(int w, int h, GLenum format = GL_RGBA8);
+void releaseRenderTarget(RenderTarget* rt);
+
+// Frees every slot; nothing may be acquired at this point
+void shutdownRenderPool();
@@ -0,0 +1,354 @@
+// shader-compiler.cpp
+// Asynchronous program builds with an on-disk program binary cache.
+
+#include "shader-compiler.h"
+#include "gl-util.h"
+#include <iostream>
+#include <fstream>
+#include <filesystem>
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <algorithm>
+#include <cstdio>
+
+// Not every glad build carries these (GL 4.1 / KHR_parallel_shader_compile)
+#ifndef GL_PROGRAM_BINARY_RETRIEVABLE_HINT
+#define GL_PROGRAM_BINARY_RETRIEVABLE_HINT 0x8257
+#endif
+#ifndef GL_PROGRAM_BINARY_LENGTH
+#define GL_PROGRAM_BINARY_LENGTH 0x8741
+#endif
+#ifndef GL_NUM_PROGRAM_BINARY_FORMATS
+#define GL_NUM_PROGRAM_BINARY_FORMATS 0x87FE
+#endif
+#ifndef GL_COMPLETION_STATUS_KHR
+#define GL_COMPLETION_STATUS_KHR 0x91B1
+#endif
+#ifndef GL_COMPUTE_SHADER
+#define GL_COMPUTE_SHADER 0x91B9
+#endif
+
+typedef void (APIENTRY* PFNMAXSHADERCOMPILERTHREADS)(GLuint count);
+
+static const uint32_t cacheMagic = 0x42505754; // "TWPB"
+static const uint32_t cacheVersion = 1;
+
+struct CacheHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t format;
+    uint32_t length;
+};
+
+static struct {
+    std::string driver;
+    std::filesystem::path cacheDir;
+    bool useCache = false;
+    bool parallel = false;
+
+    // parallel_shader_compile path
+    std::vector<std::shared_ptr<ProgramJob>> inFlight;
+
+    // shared-context worker path
+    SDL_Window* workerWin = nullptr;
+    SDL_GLContext workerCtx = nullptr;
+    std::thread worker;
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::deque<std::shared_ptr<ProgramJob>> queue;
+    bool quit = false;
+
+    std::atomic<int> pending{ 0 };
+} sc;
+
+// FNV-1a, good enough to tell shader revisions apart
+static uint64_t hashBytes(uint64_t h, const char* data, size_t n) {
+    for (size_t i = 0; i < n; ++i) {
+        h ^= (uint8_t)data[i];
+        h *= 1099511628211ull;
+    }
+    return h;
+}
+
+static uint64_t programKey(const std::string& vs, const std::string& fs) {
+    uint64_t h = 14695981039346656037ull;
+    h = hashBytes(h, sc.driver.c_str(), sc.driver.size() + 1);
+    h = hashBytes(h, vs.c_str(), vs.size() + 1);
+    h = hashBytes(h, fs.c_str(), fs.size() + 1);
+    return h;
+}
+
+static std::filesystem::path cachePath(uint64_t key) {
+    char name[32];
+    snprintf(name, sizeof(name), "%016llx.bin", (unsigned long long)key);
+    return sc.cacheDir / name;
+}
+
+static GLuint loadProgramBinary(uint64_t key) {
+    std::filesystem::path path = cachePath(key);
+    std::ifstream in(path, std::ios::binary);
+    if (!in) return 0;
+
+    CacheHeader hdr{};
+    in.read((char*)&hdr, sizeof(hdr));
+    if (!in || hdr.magic != cacheMagic || hdr.version != cacheVersion || hdr.length == 0) return 0;
+    std::vector<char> data(hdr.length);
+    in.read(data.data(), hdr.length);
+    if (!in) return 0;
+
+    GLuint prog = glCreateProgram();
+    glProgramBinary(prog, hdr.format, data.data(), (GLsizei)hdr.length);
+    GLint ok = 0; glGetProgramiv(prog, GL_LINK_STATUS, &ok);
+    if (!ok) {
+        // driver update or corrupt file; rebuild from source
+        glDeleteProgram(prog);
+        in.close();
+        std::error_code ec;
+        std::filesystem::remove(path, ec);
+        return 0;
+    }
+    return prog;
+}
+
+static void storeProgramBinary(GLuint prog, uint64_t key) {
+    GLint length = 0; glGetProgramiv(prog, GL_PROGRAM_BINARY_LENGTH, &length);
+    if (length <= 0) return;
+    std::vector<char> data(length);
+    GLenum format = 0;
+    glGetProgramBinary(prog, length, nullptr, &format, data.data());
+
+    // write to a temp file and rename so a concurrent launch never reads half a binary
+    std::filesystem::path path = cachePath(key);
+    std::filesystem::path tmp = path;
+    tmp += ".tmp";
+    {
+        std::ofstream out(tmp, std::ios::binary | std::ios::trunc);
+        if (!out) return;
+        CacheHeader hdr{ cacheMagic, cacheVersion, format, (uint32_t)length };
+        out.write((const char*)&hdr, sizeof(hdr));
+        out.write(data.data(), length);
+        if (!out) return;
+    }
+    std::error_code ec;
+    std::filesystem::rename(tmp, path, ec);
+}
+
+static void printShaderLog(GLuint sh, const char* label) {
+    if (!sh) return;
+    GLint ok = 0; glGetShaderiv(sh, GL_COMPILE_STATUS, &ok);
+    if (ok) return;
+    char buf[4096]; glGetShaderInfoLog(sh, sizeof(buf), nullptr, buf);
+    std::cerr << "Shader compile error (" << label << "): " << buf << "\n";
+}
+
+static GLuint createLinkedProgram(GLuint vs, GLuint fs) {
+    GLuint p = glCreateProgram();
+    if (vs) glAttachShader(p, vs);
+    glAttachShader(p, fs);
+    glBindAttribLocation(p, 0, "inPos");
+    if (sc.useCache) glProgramParameteri(p, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+    glLinkProgram(p);
+    return p;
+}
+
+// Finishes a program after its link completed; returns false on failure.
+static bool finishProgram(ProgramJob& job, GLuint prog) {
+    GLint ok = 0; glGetProgramiv(prog, GL_LINK_STATUS, &ok);
+    if (!ok) {
+        printShaderLog(job.vs, job.label.c_str());
+        printShaderLog(job.fs, job.label.c_str());
+        char buf[4096]; glGetProgramInfoLog(prog, sizeof(buf), nullptr, buf);
+        std::cerr << "Program link error (" << job.label << "): " << buf << "\n";
+        glDeleteProgram(prog);
+    }
+    else {
+        if (job.vs) glDetachShader(prog, job.vs);
+        glDetachShader(prog, job.fs);
+        if (sc.useCache) storeProgramBinary(prog, job.key);
+    }
+    glDeleteShader(job.vs);
+    glDeleteShader(job.fs);
+    job.vs = job.fs = 0;
+    job.prog = ok ? prog : 0;
+    return ok != 0;
+}
+
+// Issues the compiles and the link; drivers with parallel compile return at once
+static GLuint compileJob(ProgramJob& job) {
+    const char* fsSrc = job.fragmentSrc.c_str();
+    if (!job.vertexSrc.empty()) {
+        const char* vsSrc = job.vertexSrc.c_str();
+        job.vs = glCreateShader(GL_VERTEX_SHADER);
+        glShaderSource(job.vs, 1, &vsSrc, nullptr);
+        glCompileShader(job.vs);
+    }
+    job.fs = glCreateShader(job.vertexSrc.empty() ? GL_COMPUTE_SHADER : GL_FRAGMENT_SHADER);
+    glShaderSource(job.fs, 1, &fsSrc, nullptr);
+    glCompileShader(job.fs);
+    return createLinkedProgram(job.vs, job.fs);
+}
+
+static void completeJob(ProgramJob& job, bool ok) {
+    job.state.store(ok ? BuildState::Ready : BuildState::Failed, std::memory_order_release);
+    sc.pending.fetch_sub(1);
+}
+
+static void workerMain() {
+    SDL_GL_MakeCurrent(sc.workerWin, sc.workerCtx);
+    for (;;) {
+        std::shared_ptr<ProgramJob> job;
+        {
+            std::unique_lock<std::mutex> lock(sc.mutex);
+            sc.cv.wait(lock, [] { return sc.quit || !sc.queue.empty(); });
+            if (sc.quit) break;
+            job = sc.queue.front();
+            sc.queue.pop_front();
+        }
+        GLuint prog = compileJob(*job);
+        bool ok = finishProgram(*job, prog);
+        // the program object is shared, but its contents are only guaranteed
+        // visible to the render context once this context has finished
+        glFinish();
+        completeJob(*job, ok);
+    }
+    SDL_GL_MakeCurrent(sc.workerWin, nullptr);
+}
+
+bool initShaderCompiler(SDL_Window* win, SDL_GLContext ctx, const char* cacheDir) {
+    sc.driver = std::string((const char*)glGetString(GL_VENDOR)) + "|" +
+        (const char*)glGetString(GL_RENDERER) + "|" + (const char*)glGetString(GL_VERSION);
+
+    GLint numFormats = 0;
+    if (SDL_GL_ExtensionSupported("GL_ARB_get_program_binary"))
+        glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &numFormats);
+    if (cacheDir && numFormats > 0) {
+        std::error_code ec;
+        sc.cacheDir = cacheDir;
+        std::filesystem::create_directories(sc.cacheDir, ec);
+        sc.useCache = !ec;
+        if (ec) std::cerr << "Shader cache disabled, cannot create " << cacheDir << ": " << ec.message() << "\n";
+    }
+
+    PFNMAXSHADERCOMPILERTHREADS maxThreads = nullptr;
+    if (SDL_GL_ExtensionSupported("GL_KHR_parallel_shader_compile"))
+        maxThreads = (PFNMAXSHADERCOMPILERTHREADS)SDL_GL_GetProcAddress("glMaxShaderCompilerThreadsKHR");
+    else if (SDL_GL_ExtensionSupported("GL_ARB_parallel_shader_compile"))
+        maxThreads = (PFNMAXSHADERCOMPILERTHREADS)SDL_GL_GetProcAddress("glMaxShaderCompilerThreadsARB");
+    if (maxThreads) {
+        maxThreads(0xFFFFFFFFu); // let the driver pick
+        sc.parallel = true;
+        std::cout << "Shader compiler: parallel_shader_compile, cache " << (sc.useCache ? "on" : "off") << "\n";
+        return true;
+    }
+
+    // Fall back to a worker with its own context sharing objects with ours
+    sc.workerWin = SDL_CreateWindow("timewarp shader compiler", 0, 0, 1, 1, SDL_WINDOW_OPENGL | SDL_WINDOW_HIDDEN);
+    if (sc.workerWin) {
+        SDL_GL_SetAttribute(SDL_GL_SHARE_WITH_CURRENT_CONTEXT, 1);
+        sc.workerCtx = SDL_GL_CreateContext(sc.workerWin);
+        SDL_GL_SetAttribute(SDL_GL_SHARE_WITH_CURRENT_CONTEXT, 0);
+        SDL_GL_MakeCurrent(win, ctx);
+    }
+    if (!sc.workerCtx) {
+        std::cerr << "Shader compiler: no shared context (" << SDL_GetError() << "), compiling synchronously\n";
+        if (sc.workerWin) SDL_DestroyWindow(sc.workerWin);
+        sc.workerWin = nullptr;
+        return true;
+    }
+    sc.worker = std::thread(workerMain);
+    std::cout << "Shader compiler: shared-context worker, cache " << (sc.useCache ? "on" : "off") << "\n";
+    return true;
+}
+
+void shutdownShaderCompiler() {
+    stopShaderCompiler();
+    closeShaderCompilerWindow();
+}
+
+void stopShaderCompiler() {
+    if (sc.worker.joinable()) {
+        {
+            std::lock_guard<std::mutex> lock(sc.mutex);
+            sc.quit = true;
+        }
+        sc.cv.notify_all();
+        sc.worker.join();
+    }
+
+    for (auto& job : sc.inFlight) {
+        glDeleteProgram(job->prog);
+        glDeleteShader(job->vs);
+        glDeleteShader(job->fs);
+        job->prog = job->vs = job->fs = 0;
+        job->state.store(BuildState::Failed);
+    }
+    sc.inFlight.clear();
+    for (auto& job : sc.queue) job->state.store(BuildState::Failed);
+    sc.queue.clear();
+    sc.pending = 0;
+}
+
+void closeShaderCompilerWindow() {
+    if (sc.workerCtx) SDL_GL_DeleteContext(sc.workerCtx);
+    if (sc.workerWin) SDL_DestroyWindow(sc.workerWin);
+    sc.workerCtx = nullptr;
+    sc.workerWin = nullptr;
+}
+
+std::shared_ptr<ProgramJob> submitProgram(const char* label, const std::string& vertexSrc, const std::string& fragmentSrc) {
+    auto job = std::make_shared<ProgramJob>();
+    job->label = label;
+    job->vertexSrc = vertexSrc;
+    job->fragmentSrc = fragmentSrc;
+    job->key = programKey(vertexSrc, fragmentSrc);
+    sc.pending.fetch_add(1);
+
+    if (sc.useCache) {
+        if (GLuint prog = loadProgramBinary(job->key)) {
+            job->prog = prog;
+            job->fromCache = true;
+            completeJob(*job, true);
+            return job;
+        }
+    }
+
+    if (sc.worker.joinable()) {
+        {
+            std::lock_guard<std::mutex> lock(sc.mutex);
+            sc.queue.push_back(job);
+        }
+        sc.cv.notify_one();
+        return job;
+    }
+
+    // Parallel path: issue everything, query nothing until the driver says it's done.
+    // Without either mechanism this is the same code, it just blocks in the first query.
+    job->prog = compileJob(*job);
+    sc.inFlight.push_back(job);
+    return job;
+}
+
+std::shared_ptr<ProgramJob> submitComputeProgram(const char* label, const std::string& computeSrc) {
+    return submitProgram(label, std::string(), computeSrc);
+}
+
+void pumpShaderCompiler() {
+    for (size_t i = 0; i < sc.inFlight.size();) {
+        ProgramJob& job = *sc.inFlight[i];
+        GLint done = GL_TRUE;
+        if (sc.parallel) glGetProgramiv(job.prog, GL_COMPLETION_STATUS_KHR, &done);
+        if (!done) { ++i; continue; }
+        completeJob(job, finishProgram(job, job.prog));
+        sc.inFlight.erase(sc.inFlight.begin() + i);
+    }
+}
+
+void finishShaderCompiler() {
+    while (sc.pending.load() > 0) {
+        pumpShaderCompiler();
+        SDL_Delay(1);
+    }
+}
@@ -0,0 +1,56 @@
+// shader-compiler.h
+// Asynchronous program builds with an on-disk program binary cache.
+//
+// Programs are built off the render path in one of two ways:
+// - GL_KHR/ARB_parallel_shader_compile: compile and link are issued on the
+//   render context and polled with GL_COMPLETION_STATUS_KHR, never blocking.
+// - otherwise a worker thread with its own shared GL context does the
+//   compile/link and hands back the finished program name.
+// Linked programs are stored with glGetProgramBinary, keyed by a hash of the
+// sources and the driver string, and reloaded with glProgramBinary next launch.
+#pragma once
+#include <glad/glad.h>
+#include <SDL2/SDL.h>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+enum class BuildState { Pending, Ready, Failed };
+
+// One program build; the host keeps the shared_ptr and polls state
+struct ProgramJob {
+    std::string label;
+    std::string vertexSrc;   // empty for a compute program
+    std::string fragmentSrc; // or the compute shader
+    uint64_t key = 0;
+    bool fromCache = false;
+    std::atomic<BuildState> state{ BuildState::Pending };
+    GLuint prog = 0;    // valid once state is Ready
+    // shader objects of an in-flight parallel compile
+    GLuint vs = 0;
+    GLuint fs = 0;      // the compute shader of a compute build
+};
+
+// Must be called with the render context current. cacheDir may be null to
+// disable the binary cache.
+bool initShaderCompiler(SDL_Window* win, SDL_GLContext ctx, const char* cacheDir);
+// Both halves below, on a thread that has the render context and made the
+// worker window
+void shutdownShaderCompiler();
+// Render thread, context current: joins the worker and drops unfinished builds
+void stopShaderCompiler();
+// The thread that called initShaderCompiler, once the render thread is done:
+// the worker's window and shared context
+void closeShaderCompilerWindow();
+
+// Queues a build. Cache hits complete immediately.
+std::shared_ptr<ProgramJob> submitProgram(const char* label, const std::string& vertexSrc, const std::string& fragmentSrc);
+// Same for a program with a single compute shader (GL 4.3)
+std::shared_ptr<ProgramJob> submitComputeProgram(const char* label, const std::string& computeSrc);
+
+// Advances parallel compiles; call once per frame on the render thread.
+void pumpShaderCompiler();
+
+// Blocks until every submitted build has finished.
+void finishShaderCompiler();
@@ -0,0 +1,69 @@
+// shader-variants.cpp
+// Variant selection and the #define prelude for each permutation.
+
+#include "shader-variants.h"
+#include <cmath>
+
+static struct {
+    int noiseTex = -1;
+    int stepCount = 0;
+    int quality = defaultQualityTier;
+    bool temporal = false;
+    bool compute = false;
+} overrides;
+
+void setShaderVariantOverrides(int noiseTex, int stepCount) {
+    overrides.noiseTex = noiseTex;
+    overrides.stepCount = stepCount;
+}
+
+void setShaderVariantQuality(int tier) {
+    overrides.quality = tier;
+}
+
+void setShaderVariantTemporal(bool on) {
+    overrides.temporal = on;
+}
+
+void setShaderVariantCompute(bool on) {
+    overrides.compute = on;
+}
+
+ShaderVariant selectShaderVariant(uint32_t features, float colorShift) {
+    ShaderVariant v;
+    if (features & featureHueShift) v.hueShift = std::fabs(colorShift) > hueShiftThreshold ? 1 : 0;
+    if (features & featureNoiseTex) v.noiseTex = overrides.noiseTex;
+    if (features & featureStepCount) v.stepCount = overrides.stepCount;
+    // the default tier is what the source builds anyway
+    if ((features & featureQuality) && overrides.quality != defaultQualityTier) v.quality = overrides.quality;
+    if ((features & featureTemporal) && overrides.temporal) v.temporal = 1;
+    else if ((features & featureCompute) && overrides.compute) v.compute = 1;
+    return v;
+}
+
+std::string shaderVariantDefines(const ShaderVariant& v) {
+    std::string s;
+    if (v.hueShift >= 0) s += "#define HUE_SHIFT " + std::to_string(v.hueShift) + "\n";
+    if (v.noiseTex >= 0) s += "#define NOISE_TEX " + std::to_string(v.noiseTex) + "\n";
+    if (v.stepCount > 0) s += "#define STEP_COUNT " + std::to_string(v.stepCount) + "\n";
+    if (v.quality >= 0) s += "#define QUALITY " + std::to_string(v.quality) + "\n";
+    if (v.temporal >= 0) s += "#define TEMPORAL " + std::to_string(v.temporal) + "\n";
+    if (v.compute >= 0) s += "#define COMPUTE " + std::to_string(v.compute) + "\n";
+    return s;
+}
+
+std::string shaderVariantName(const ShaderVariant& v) {
+    std::string s;
+    auto add = [&](const char* name, int value) {
+        if (!s.empty()) s += " ";
+        s += name;
+        s += "=" + std::to_string(value);
+    };
+    if (v.hueShift >= 0) add("HUE_SHIFT", v.hueShift);
+    if (v.noiseTex >= 0) add("NOISE_TEX", v.noiseTex);
+    if (v.stepCount > 0) add("STEP_COUNT", v.stepCount);
+    if (v.quality >= 0) add("QUALITY", v.quality);
+    if (v.temporal >= 0) add("TEMPORAL", v.temporal);
+    if (v.compute >= 0) add("COMPUTE", v.compute);
+    return s.empty() ? "generic" : s;
+}
@@ -0,0 +1,60 @@
+// shader-variants.h
+// Compile-time specializations of the effect shaders. An effect lists the
+// switches its source understands (EffectDesc::features); for each frame the
+// host picks the variant its current parameters need and builds it on first
+// use with the matching #defines, so the common case runs without the uniform
+// test and with constants the compiler can fold. The generic build (nothing
+// defined, every decision taken at run time) draws until a variant is ready
+// and whenever one fails. Built variants stay resident per effect and, like
+// every program, land in the binary cache (shader-compiler.h).
+#pragma once
+#include <cstdint>
+#include <string>
+
+// Switches an effect's fragment source responds to
+enum : uint32_t {
+    featureHueShift = 1u << 0,  // HUE_SHIFT 0/1 replaces the colorShift test around the hue matrix
+    featureNoiseTex = 1u << 1,  // NOISE_TEX 0/1 picks ALU or texture value noise
+    featureStepCount = 1u << 2, // STEP_COUNT sets the raymarch iterations
+    featureQuality = 1u << 3,   // QUALITY 0..3 picks the raymarch tier (quality.h)
+    featureTemporal = 1u << 4,  // TEMPORAL 1 marches half the tiles and reprojects the rest (temporal.h)
+    featureCompute = 1u << 5,   // COMPUTE 1 builds the source as the tiled compute march (compute-march.h)
+};
+
+// The tier the shaders build when QUALITY is not defined (High)
+static const int defaultQualityTier = 2;
+
+// One permutation; -1 / 0 leaves a switch to the source, the generic build has none set
+struct ShaderVariant {
+    int hueShift = -1;
+    int noiseTex = -1;
+    int stepCount = 0;
+    int quality = -1;
+    int temporal = -1;
+    int compute = -1;
+    bool operator==(const ShaderVariant&) const = default;
+    bool generic() const { return *this == ShaderVariant{}; }
+};
+
+// Below this |colorShift| the specialized builds leave the hue matrix out;
+// the effects' run-time HUE_SHIFT_ON tests and the CPU renderer use it too
+static const float hueShiftThreshold = 0.0001f;
+
+// Host-wide choices that don't come from effect parameters (--noise, --steps);
+// -1 / 0 leave them to each shader
+void setShaderVariantOverrides(int noiseTex, int stepCount);
+// Current quality tier, 0..3; set through quality.h
+void setShaderVariantQuality(int tier);
+// Temporal accumulation on or off (--temporal, F6)
+void setShaderVariantTemporal(bool on);
+// Compute backend on or off (--compute, F7); temporal draws stay on the fragment path
+void setShaderVariantCompute(bool on);
+
+// The variant for an effect with these features at this colorShift
+ShaderVariant selectShaderVariant(uint32_t features, float colorShift);
+
+// #define lines for the switches the variant sets, one per line
+std::string shaderVariantDefines(const ShaderVariant& v);
+
+// Short form for logs, e.g. "HUE_SHIFT=0 QUALITY=1"; "generic" if none
+std::string shaderVariantName(const ShaderVariant& v);
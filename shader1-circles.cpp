@@ -1,41 +1,51 @@
-// main.cpp
-// Build: see instructions below
+// shader1-circles.cpp
+// Effect: Circles. Registered with the timewarp host (see effects.cpp).
 
-#define SDL_MAIN_HANDLED
-#pragma comment(linker, "/SUBSYSTEM:CONSOLE")
-#include <glad/glad.h>
-#include <SDL2/SDL.h>
-#include <iostream>
-#include <string>
-#include <chrono>
-#include <algorithm> // for std::max
-
-#pragma comment(lib, "opengl32.lib")
-
-// Minimal shader loader for GL2/GL3 compatibility using shader strings.
-// The source code for the vertex shader stored in a const char array
-static const char* vertexShaderSrc = R"glsl(
-#version 330 core
-layout(location = 0) in vec2 inPos;
-out vec2 uv;
-void main(){
-    uv = inPos * 0.5 + 0.5;
-    gl_Position = vec4(inPos, 0.0, 1.0);
-}
-)glsl";
+#include "effects.h"
 
 static const char* fragmentShaderSrc = R"glsl(
 #version 330 core
+#if COMPUTE
+// Compute backend (compute-march.h), built as #version 430: pass 0 runs one
+// thread per 8x8 tile, pass 1 one work group per tile
+layout(local_size_x = 8, local_size_y = 8) in;
+layout(location = 0) uniform int iComputePass;
+layout(binding = 0, rgba16f) writeonly uniform image2D iOutput;
+layout(binding = 1, rg32f) uniform image2D iTileStart;  // t, steps
+#else
 in vec2 uv;
+#if TEMPORAL
+layout(location = 0) out vec4 fragColor;
+layout(location = 1) out vec4 historyOut;     // accum, glow
+layout(location = 2) out float historyDepth;  // t
+uniform sampler2D iHistory;
+uniform sampler2D iHistoryDepth;
+#else
 out vec4 fragColor;
-uniform float iTime;
-uniform vec2 iResolution;
-uniform float speed;
-uniform float warp;
-uniform float thickness;
-uniform float colorShift;
+#endif
+#endif
+// iTime, iResolution, speed, warp, thickness and colorShift come from the
+// host's FrameParams block, inserted after #version (frame-params.h)
+// iPhase.x is the travel iTime * speed, wrapped at 2pi: every z term of the
+// tunnel is a whole multiple of it (phases in circlesEffect below)
 
 // 2D hash / noise
+// NOISE_TEX 1: one filtered fetch from the host's hash lattice (noise-texture.h);
+// NOISE_TEX 0: four hashes per call. Inside a 256-cell tile the two agree to
+// within the texture's 8-bit rounding (1/510) and the filter's weight precision.
+#ifndef NOISE_TEX
+#define NOISE_TEX 1
+#endif
+#if NOISE_TEX
+uniform sampler2D iNoise;
+float noise(vec2 p){
+    vec2 i = floor(p);
+    vec2 f = fract(p);
+    f = f*f*(3.0-2.0*f);
+    // moving the sample point by the smoothed fraction lets the bilinear filter do both mixes
+    return textureLod(iNoise, (i + f + 0.5) / 256.0, 0.0).r;
+}
+#else
 float hash21(vec2 p){
     p = fract(p * vec2(123.34, 456.21));
     p += dot(p, p + 45.32);
@@ -51,6 +61,45 @@ float noise(vec2 p){
     float d = hash21(i + vec2(1.0,1.0));
     return mix(mix(a,b,f.x), mix(c,d,f.x), f.y);
 }
+#endif
+
+// Quality tier from the host (quality.h): 0 low, 1 medium, 2 high (as
+// authored), 3 ultra. It sets the iterations, the smallest step, the far
+// distance and, on the lower tiers, the accumulated intensity at which the
+// march stops early (past saturation more steps only move the hue a little).
+#ifndef QUALITY
+#define QUALITY 2
+#endif
+#if QUALITY == 0
+#define TIER_STEPS 48
+#define MIN_STEP 0.05
+#define FAR_DIST 60.0
+#define EARLY_OUT 2.5
+#elif QUALITY == 1
+#define TIER_STEPS 80
+#define MIN_STEP 0.03
+#define FAR_DIST 80.0
+#define EARLY_OUT 4.0
+#elif QUALITY == 2
+#define TIER_STEPS 120
+#define MIN_STEP 0.02
+#define FAR_DIST 100.0
+#else
+#define TIER_STEPS 200
+#define MIN_STEP 0.012
+#define FAR_DIST 120.0
+#endif
+// --steps overrides the tier's iterations (shader-variants.h)
+#ifndef STEP_COUNT
+#define STEP_COUNT TIER_STEPS
+#endif
+
+// TEMPORAL 1: every other 8x8 tile marches, the rest reuse last frame (temporal.h)
+#ifndef TEMPORAL
+#define TEMPORAL 0
+#endif
+// weight of this frame's march where the history is usable
+#define TEMPORAL_BLEND 0.5
 
 // palette
 vec3 palette(float t){
@@ -72,20 +121,35 @@ float tunnelSDF(vec3 p){
     return r - radius;
 }
 
-void main(){
-    vec2 p = (uv * 2.0 - 1.0);
-    p.x *= iResolution.x / iResolution.y;
+float focal(float time){
+    return 1.5 - 0.3 * sin(time*0.2); // slight pitch oscillation
+}
 
-    // camera ray
-    vec3 ro = vec3(0.0, 0.0, iTime * speed);
-    vec3 rd = normalize(vec3(p.xy, -1.5 + 0.3 * sin(iTime*0.2))); // slight pitch oscillation
+// Per-frame values every pixel shares; the compute path works them out once
+// per work group
+struct FrameConsts {
+    float focalLen;
+    float paletteBase;
+};
 
-    // march along ray; sample tunnel SDF (signed distance)
-    float t = 0.0;
-    float glow = 0.0;
-    float accum = 0.0;
+FrameConsts frameConsts(){
+    return FrameConsts(focal(iTime), fract(iTime * 0.1 * warp));
+}
+
+// camera ray through st (0..1 across the view); p is its screen position
+vec3 cameraRay(vec2 st, float focalLen, out vec2 p){
+    p = st * 2.0 - 1.0;
+    p.x *= iResolution.x / iResolution.y;
+    return normalize(vec3(p.xy, -focalLen));
+}
+
+// march along ray from t0 with i0 of the iterations already spent; sample tunnel SDF (signed distance)
+void march(vec3 ro, vec3 rd, float t0, int i0, out float t, out float accum, out float glow){
+    t = t0;
+    glow = 0.0;
+    accum = 0.0;
     float thicknessLocal = thickness;
-    for(int i=0;i<120;i++){
+    for(int i=i0;i<STEP_COUNT;i++){
         vec3 pos = ro + rd * t;
         // make tunnel repeat in z so it looks infinite
         float zWrapped = mod(pos.z, 12.566370); // 2*pi*2 approximated
@@ -101,16 +165,38 @@ void main(){
         glow += hit * (1.0 - smoothstep(0.0, thicknessLocal, abs(d)));
 
         // adaptive step: small near surface, larger in emptier space
-        t += max(0.02, 0.5 * abs(d));
-        if(t > 100.0) break;
+        t += max(MIN_STEP, 0.5 * abs(d));
+        if(t > FAR_DIST) break;
+#ifdef EARLY_OUT
+        if(accum * 0.6 + glow * 0.8 > EARLY_OUT) break;
+#endif
     }
+}
+
+#if TEMPORAL
+// Last frame's march state for this ray: the point at the depth stored for
+// this pixel, as seen from where the camera was iHistoryDt ago
+bool reproject(vec3 rd, out vec4 past, out float pastT){
+    float d = texelFetch(iHistoryDepth, ivec2(gl_FragCoord.xy), 0).r;
+    vec3 q = rd * d + vec3(0.0, 0.0, iHistoryDt * speed);
+    if(q.z > -1e-3) return false;
+    vec2 pp = q.xy * (focal(iTime - iHistoryDt) / -q.z);
+    vec2 st = vec2(pp.x * iResolution.y / iResolution.x, pp.y) * 0.5 + 0.5;
+    if(any(lessThan(st, vec2(0.0))) || any(greaterThan(st, vec2(1.0)))) return false;
+    vec2 coord = st * iResolution / vec2(textureSize(iHistory, 0));
+    past = texture(iHistory, coord);
+    pastT = texture(iHistoryDepth, coord).r;
+    return true;
+}
+#endif
 
-    // color by accum and depth
+// color by accum and depth
+vec3 shade(vec2 p, float t, float accum, float glow, FrameConsts k){
     float depth = clamp(exp(-0.02 * t), 0.0, 1.0);
     float intensity = clamp(accum * 0.6 + glow * 0.8, 0.0, 2.5);
 
     // multicolored palette using depth and longitudinal harmonics
-    float palettePos = fract((iTime * 0.1 * warp) + (t * 0.02) + accum*0.1);
+    float palettePos = fract(k.paletteBase + (t * 0.02) + accum*0.1);
     vec3 col = palette(palettePos) * intensity;
 
     // add radial streaks / plasma veins
@@ -122,149 +208,108 @@ void main(){
     col *= vig;
     col = mix(vec3(0.02,0.02,0.03), col, depth);
 
-    // gamma
-    col = pow(clamp(col, 0.0, 1.0), vec3(0.8));
-    fragColor = vec4(col, 1.0);
+    // linear and unclamped; the host's tonemap pass grades it (tone below)
+    return col;
 }
-)glsl";
 
-static GLuint compileShader(GLenum type, const char* src) {
-    GLuint sh = glCreateShader(type);
-    glShaderSource(sh, 1, &src, nullptr);
-    glCompileShader(sh);
-    GLint ok = 0; glGetShaderiv(sh, GL_COMPILE_STATUS, &ok);
-    if (!ok) {
-        char buf[4096]; glGetShaderInfoLog(sh, sizeof(buf), nullptr, buf);
-        std::cerr << "Shader compile error: " << buf << "\n";
-        return 0;
+#if COMPUTE
+// Far from the surface a step adds under exp(-20 * SKIP_BAND) and no glow
+#define SKIP_BAND 0.5
+// bound on how fast the SDF changes across rays (the 40x rings dominate); it
+// widens the band by how far the tile's other rays are from the centre one
+#define SKIP_LIPSCHITZ 10.0
+
+// Steps the tile's centre ray for as long as every ray of the tile stays
+// clear of the surface. spread is the largest distance per unit t from the
+// centre ray to a corner ray.
+void skipEmpty(vec3 ro, vec3 rd, float spread, out float t, out int steps){
+    t = 0.0;
+    for(steps = 0; steps < STEP_COUNT; steps++){
+        vec3 pos = ro + rd * t;
+        float d = tunnelSDF(vec3(pos.xy, mod(pos.z, 12.566370)));
+        if(abs(d) < SKIP_BAND + SKIP_LIPSCHITZ * spread * t) break;
+        t += max(MIN_STEP, 0.5 * abs(d));
+        if(t > FAR_DIST) break;
     }
-    return sh;
 }
 
-static GLuint linkProgram(GLuint v, GLuint f) {
-    GLuint p = glCreateProgram();
-    glAttachShader(p, v);
-    glAttachShader(p, f);
-    glBindAttribLocation(p, 0, "inPos");
-    glLinkProgram(p);
-    GLint ok = 0; glGetProgramiv(p, GL_LINK_STATUS, &ok);
-    if (!ok) {
-        char buf[4096]; glGetProgramInfoLog(p, sizeof(buf), nullptr, buf);
-        std::cerr << "Program link error: " << buf << "\n";
-        return 0;
-    }
-    return p;
-}
+shared FrameConsts sConsts;
+shared vec2 sTileStart;
 
-int main(int argc, char** argv) {
-    if (SDL_Init(SDL_INIT_VIDEO) != 0) {
-        std::cerr << "SDL_Init failed: " << SDL_GetError() << "\n";
-        return 1;
+void main(){
+    vec3 ro = vec3(0.0, 0.0, iPhase.x);
+    vec2 p;
+    if(iComputePass == 0){
+        ivec2 tile = ivec2(gl_GlobalInvocationID.xy);
+        if(any(greaterThanEqual(tile * 8, ivec2(iResolution)))) return;
+        FrameConsts k = frameConsts();
+        vec2 base = vec2(tile * 8);
+        vec3 rd = cameraRay((base + 4.0) / iResolution, k.focalLen, p);
+        float spread = 0.0;
+        for(int c = 0; c < 4; c++)
+            spread = max(spread, length(cameraRay((base + 8.0 * vec2(c & 1, c >> 1)) / iResolution, k.focalLen, p) - rd));
+        float t;
+        int steps;
+        skipEmpty(ro, rd, spread, t, steps);
+        imageStore(iTileStart, tile, vec4(t, float(steps), 0.0, 0.0));
+        return;
     }
-    //SDL_Init(SDL_INIT_VIDEO);
-
-    SDL_GL_SetAttribute(SDL_GL_CONTEXT_MAJOR_VERSION, 3);
-    SDL_GL_SetAttribute(SDL_GL_CONTEXT_MINOR_VERSION, 3);
-    SDL_GL_SetAttribute(SDL_GL_CONTEXT_PROFILE_MASK, SDL_GL_CONTEXT_PROFILE_CORE);
 
-    int w = 1280, h = 720;
-    SDL_Window* win = SDL_CreateWindow("Plasma Time Warp Tunnel", SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED,
-        w, h, SDL_WINDOW_OPENGL | SDL_WINDOW_RESIZABLE);
-    if (!win) { std::cerr << "CreateWindow failed\n"; return 1; }
-
-    SDL_GLContext ctx = SDL_GL_CreateContext(win);
-    if (!ctx) { std::cerr << "CreateContext failed\n"; return 1; }
-
-    if (!gladLoadGLLoader((GLADloadproc)SDL_GL_GetProcAddress)) {
-        std::cerr << "Failed to initialize GLAD\n";
-        return 1;
+    if(gl_LocalInvocationIndex == 0u){
+        sConsts = frameConsts();
+        sTileStart = imageLoad(iTileStart, ivec2(gl_WorkGroupID.xy)).xy;
     }
-    std::cout << "OpenGL: " << (const char*)glGetString(GL_VERSION) << "\n";
-
-    // Load OpenGL functions if needed; on many setups gl* from <GL/gl.h> is enough.
-    // Create shaders
-    GLuint vs = compileShader(GL_VERTEX_SHADER, vertexShaderSrc);
-    GLuint fs = compileShader(GL_FRAGMENT_SHADER, fragmentShaderSrc);
-    if (!vs || !fs) return 1;
-    GLuint prog = linkProgram(vs, fs);
-    glDeleteShader(vs); glDeleteShader(fs);
-    if (!prog) return 1;
-
-    // Fullscreen triangle VAO/VBO
-    GLuint vao, vbo;
-    float verts[] = { -1.0f, -1.0f, 3.0f, -1.0f, -1.0f, 3.0f }; // odd trick: single triangle covering screen
-    glGenVertexArrays(1, &vao);
-    glBindVertexArray(vao);
-    glGenBuffers(1, &vbo);
-    glBindBuffer(GL_ARRAY_BUFFER, vbo);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(verts), verts, GL_STATIC_DRAW);
-    glEnableVertexAttribArray(0);
-    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 0, nullptr);
-
-    // Uniform locations
-    GLint locTime = glGetUniformLocation(prog, "iTime");
-    GLint locRes = glGetUniformLocation(prog, "iResolution");
-    GLint locSpeed = glGetUniformLocation(prog, "speed");
-    GLint locWarp = glGetUniformLocation(prog, "warp");
-    GLint locThickness = glGetUniformLocation(prog, "thickness");
-    GLint locColorShift = glGetUniformLocation(prog, "colorShift");
-
-    auto start = std::chrono::high_resolution_clock::now();
-    bool running = true;
-    SDL_Event e;
-    // default params
-    float speed = 6.0f;
-    float warp = 1.0f;
-    float thickness = 0.18f;
-    float colorShift = 0.0f;
-
-    while (running) {
-        while (SDL_PollEvent(&e)) {
-            if (e.type == SDL_QUIT) running = false;
-            if (e.type == SDL_KEYDOWN) {
-                if (e.key.keysym.sym == SDLK_ESCAPE) running = false;
-                if (e.key.keysym.sym == SDLK_UP) speed *= 1.1f;
-                if (e.key.keysym.sym == SDLK_DOWN) speed /= 1.1f;
-                if (e.key.keysym.sym == SDLK_LEFT) warp = std::max(0.1f, warp - 0.1f);
-                if (e.key.keysym.sym == SDLK_RIGHT) warp += 0.1f;
-                if (e.key.keysym.sym == SDLK_z) thickness = std::max(0.01f, thickness - 0.01f);
-                if (e.key.keysym.sym == SDLK_x) thickness += 0.01f;
-                if (e.key.keysym.sym == SDLK_c) colorShift += 0.05f;
-                if (e.key.keysym.sym == SDLK_v) colorShift -= 0.05f;
-            }
-            if (e.type == SDL_WINDOWEVENT && e.window.event == SDL_WINDOWEVENT_SIZE_CHANGED) {
-                w = e.window.data1; h = e.window.data2;
-                glViewport(0, 0, w, h);
-            }
+    barrier();
+    ivec2 pixel = ivec2(gl_GlobalInvocationID.xy);
+    if(any(greaterThanEqual(pixel, ivec2(iResolution)))) return;
+    FrameConsts k = sConsts;
+    vec3 rd = cameraRay((vec2(pixel) + 0.5) / iResolution, k.focalLen, p);
+    float t, accum, glow;
+    march(ro, rd, sTileStart.x, int(sTileStart.y), t, accum, glow);
+    imageStore(iOutput, pixel, vec4(shade(p, t, accum, glow, k), 1.0));
+}
+#else
+void main(){
+    FrameConsts k = frameConsts();
+    vec2 p;
+    vec3 ro = vec3(0.0, 0.0, iPhase.x);
+    vec3 rd = cameraRay(uv, k.focalLen, p);
+
+    float t, accum, glow;
+#if TEMPORAL
+    vec4 past = vec4(0.0);
+    float pastT = 0.0;
+    bool reused = iHistoryDt > 0.0 && reproject(rd, past, pastT);
+    ivec2 tile = ivec2(gl_FragCoord.xy) >> 3;
+    if(!reused || ((tile.x + tile.y + iFrame) & 1) == 0){
+        march(ro, rd, 0.0, 0, t, accum, glow);
+        if(reused){
+            accum = mix(past.x, accum, TEMPORAL_BLEND);
+            glow = mix(past.y, glow, TEMPORAL_BLEND);
         }
-
-        auto now = std::chrono::high_resolution_clock::now();
-        std::chrono::duration<float> diff = now - start;
-        float t = diff.count();
-
-        glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
-        glClear(GL_COLOR_BUFFER_BIT);
-
-        glUseProgram(prog);
-        glUniform1f(locTime, t);
-        glUniform2f(locRes, (float)w, (float)h);
-        glUniform1f(locSpeed, speed);
-        glUniform1f(locWarp, warp);
-        glUniform1f(locThickness, thickness);
-        glUniform1f(locColorShift, colorShift);
-
-        glBindVertexArray(vao);
-        glDrawArrays(GL_TRIANGLES, 0, 3);
-
-        SDL_GL_SwapWindow(win);
-        SDL_Delay(1);
+    } else {
+        accum = past.x;
+        glow = past.y;
+        t = pastT;
     }
+    historyOut = vec4(accum, glow, 0.0, 0.0);
+    historyDepth = t;
+#else
+    march(ro, rd, 0.0, 0, t, accum, glow);
+#endif
+    fragColor = vec4(shade(p, t, accum, glow, k), 1.0);
+}
+#endif
+)glsl";
 
-    glDeleteBuffers(1, &vbo);
-    glDeleteVertexArrays(1, &vao);
-    glDeleteProgram(prog);
-    SDL_GL_DeleteContext(ctx);
-    SDL_DestroyWindow(win);
-    SDL_Quit();
-    return 0;
-}
\ No newline at end of file
+const EffectDesc circlesEffect = {
+    "circles",
+    "Plasma Time Warp Tunnel - Circles",
+    fragmentShaderSrc,
+    { 6.0f, 1.0f, 0.18f, 0.0f }, // speed, warp, thickness, colorShift
+    {},                          // no chromatic aberration
+    featureNoiseTex | featureStepCount | featureQuality | featureTemporal | featureCompute,
+    { { 1.0, 6.283185307179586, true } }, // iPhase.x: travel
+    nullptr,
+    { 1.0f, 0.8f, 0.15f, 1.0f }, // tone: exposure, gamma, bloom, bloom threshold
+};
@@ -1,41 +1,59 @@
-// main.cpp
-// Build: see instructions below
-
-#define SDL_MAIN_HANDLED
-#pragma comment(linker, "/SUBSYSTEM:CONSOLE")
-#include <glad/glad.h>
-#include <SDL2/SDL.h>
-#include <iostream>
-#include <string>
-#include <chrono>
-#include <algorithm> // for std::max
-
-#pragma comment(lib, "opengl32.lib")
-
-// Minimal shader loader for GL2/GL3 compatibility using shader strings.
-// The source code for the vertex shader stored in a const char array
-static const char* vertexShaderSrc = R"glsl(
-#version 330 core
-layout(location = 0) in vec2 inPos;
-out vec2 uv;
-void main(){
-    uv = inPos * 0.5 + 0.5;
-    gl_Position = vec4(inPos, 0.0, 1.0);
-}
-)glsl";
+// shader2-twirl.cpp
+// Effect: Twirl. Registered with the timewarp host (see effects.cpp).
+
+#include "effects.h"
+#include "noise-texture.h"
+#include <cmath>
 
 static const char* fragmentShaderSrc = R"glsl(
 #version 330 core
+#if COMPUTE
+// Compute backend (compute-march.h), built as #version 430: pass 0 runs one
+// thread per 8x8 tile, pass 1 one work group per tile
+layout(local_size_x = 8, local_size_y = 8) in;
+layout(location = 0) uniform int iComputePass;
+layout(binding = 0, rgba16f) writeonly uniform image2D iOutput;
+layout(binding = 1, rg32f) uniform image2D iTileStart;  // t, steps
+#else
 in vec2 uv;
+#if TEMPORAL
+layout(location = 0) out vec4 fragColor;
+layout(location = 1) out vec4 historyOut;     // accumR, accumG, accumB, glow
+layout(location = 2) out float historyDepth;  // t
+uniform sampler2D iHistory;
+uniform sampler2D iHistoryDepth;
+#else
 out vec4 fragColor;
-uniform float iTime;
-uniform vec2 iResolution;
-uniform float speed;
-uniform float warp;
-uniform float thickness;
-uniform float colorShift;
+#endif
+#endif
+// iTime, iResolution, speed, warp, thickness and colorShift come from the
+// host's FrameParams block, inserted after #version (frame-params.h)
+// iPhase.x is the travel iTime * speed, wrapped at 20pi: the z frequencies
+// (multiples of 0.2) and the 4pi z-wrap all repeat there (twirlEffect below).
+// The FrameConsts come in iConsts, worked out once by the host
+// (twirlFrameConsts below):
+//   iConsts[0]      centre move xy, focal length, palette base
+//   iConsts[1]      chroma base xy, unused, swirl angle base
+//   iConsts[2].x    swirl phase, wrapped at 2pi
+//   iConsts[2].yzw  last frame's centre move xy and focal length (TEMPORAL)
 
 // 2D hash / noise
+// NOISE_TEX 1: one filtered fetch from the host's hash lattice (noise-texture.h);
+// NOISE_TEX 0: four hashes per call. Inside a 256-cell tile the two agree to
+// within the texture's 8-bit rounding (1/510) and the filter's weight precision.
+#ifndef NOISE_TEX
+#define NOISE_TEX 1
+#endif
+#if NOISE_TEX
+uniform sampler2D iNoise;
+float noise(vec2 p){
+    vec2 i = floor(p);
+    vec2 f = fract(p);
+    f = f*f*(3.0-2.0*f);
+    // moving the sample point by the smoothed fraction lets the bilinear filter do both mixes
+    return textureLod(iNoise, (i + f + 0.5) / 256.0, 0.0).r;
+}
+#else
 float hash21(vec2 p){
     p = fract(p * vec2(123.34, 456.21));
     p += dot(p, p + 45.32);
@@ -51,6 +69,45 @@ float noise(vec2 p){
     float d = hash21(i + vec2(1.0,1.0));
     return mix(mix(a,b,f.x), mix(c,d,f.x), f.y);
 }
+#endif
+
+// Quality tier from the host (quality.h): 0 low, 1 medium, 2 high (as
+// authored), 3 ultra. It sets the iterations, the smallest step, the far
+// distance and, on the lower tiers, the accumulated intensity at which the
+// march stops early (past saturation more steps only move the hue a little).
+#ifndef QUALITY
+#define QUALITY 2
+#endif
+#if QUALITY == 0
+#define TIER_STEPS 56
+#define MIN_STEP 0.04
+#define FAR_DIST 100.0
+#define EARLY_OUT 3.0
+#elif QUALITY == 1
+#define TIER_STEPS 96
+#define MIN_STEP 0.025
+#define FAR_DIST 150.0
+#define EARLY_OUT 4.5
+#elif QUALITY == 2
+#define TIER_STEPS 140
+#define MIN_STEP 0.015
+#define FAR_DIST 200.0
+#else
+#define TIER_STEPS 220
+#define MIN_STEP 0.01
+#define FAR_DIST 240.0
+#endif
+// --steps overrides the tier's iterations (shader-variants.h)
+#ifndef STEP_COUNT
+#define STEP_COUNT TIER_STEPS
+#endif
+
+// TEMPORAL 1: every other 8x8 tile marches, the rest reuse last frame (temporal.h)
+#ifndef TEMPORAL
+#define TEMPORAL 0
+#endif
+// weight of this frame's march where the history is usable
+#define TEMPORAL_BLEND 0.5
 
 // palette
 vec3 palette(float t){
@@ -75,40 +132,50 @@ mat2 rot(float a){
     return mat2(c, -s, s, c);
 }
 
-void main(){
-    vec2 p = (uv * 2.0 - 1.0);
-    p.x *= iResolution.x / iResolution.y;
-
-    // moving/oscillating tunnel center (gives drifting "center" to fly through)
-    vec2 centerMove = vec2(sin(iTime * 0.6) * 0.35, cos(iTime * 0.4) * 0.25) * (0.5 + 0.5*warp);
-    // organic jitter/noise on center
-    centerMove += 0.08 * vec2(noise(vec2(iTime*0.7, 0.0)), noise(vec2(0.0, iTime*0.9)));
-
-    // apply center offset to screen coords
-    p -= centerMove * 0.6;
-
-    // radial swirl that grows towards center
-    float r = length(p);
+// radial swirl that grows towards center; a rotation, so it keeps r.
+// base and phase are the time terms, time * 0.8 and time * 0.4
+float swirlAt(float r, float base, float phase){
     float swirlStrength = 0.8 * (1.0 / (0.5 + r)) * warp;
-    float swirlAngle = iTime * 0.8 + 2.0 * sin(iTime * 0.4 + r * 6.0);
-    p = rot(swirlAngle * swirlStrength) * p;
+    float swirlAngle = base + 2.0 * sin(phase + r * 6.0);
+    return swirlAngle * swirlStrength;
+}
+
+// Per-frame values every pixel shares: the drifting centre, the focal length
+// and the rest, from the host; the compute path keeps them in shared memory
+struct FrameConsts {
+    vec2 centerMove;
+    float focalLen;
+    float paletteBase;
+    vec2 chromaBase;   // small chromatic offset base (palette lookup shifts per channel)
+    float swirlBase;
+    float swirlPhase;
+};
+
+FrameConsts frameConsts(){
+    return FrameConsts(iConsts[0].xy, iConsts[0].z, iConsts[0].w,
+        iConsts[1].xy, iConsts[1].w, iConsts[2].x);
+}
 
-    // small chromatic offset base (we will shift palette lookup later per channel)
-    vec2 chromaBase = 0.003 * vec2(sin(iTime*1.7), cos(iTime*1.3)) * (1.0 + warp);
+// camera ray through st (0..1 across the view); p is its swirled screen position
+vec3 cameraRay(vec2 st, FrameConsts k, out vec2 p){
+    p = st * 2.0 - 1.0;
+    p.x *= iResolution.x / iResolution.y;
 
-    // camera ray
-    vec3 ro = vec3(centerMove.xy * 2.0, iTime * speed);
-    vec3 rd = normalize(vec3(p.xy, -1.6 + 0.5 * sin(iTime*0.2)));
+    // apply center offset to screen coords
+    p -= k.centerMove * 0.6;
+    p = rot(swirlAt(length(p), k.swirlBase, k.swirlPhase)) * p;
+    return normalize(vec3(p.xy, -k.focalLen));
+}
 
-    // raymarch along tunnel; accumulate per-channel contributions
-    float t = 0.0;
-    float accum = 0.0;
-    float glow = 0.0;
+// raymarch along tunnel from t0 with i0 of the iterations already spent; accumulate per-channel contributions
+void march(vec3 ro, vec3 rd, float t0, int i0, out float t, out vec3 accumRGB, out float glow){
+    t = t0;
+    glow = 0.0;
     float thicknessLocal = thickness;
     // separate accumulators for chromatic feel
     float accumR = 0.0, accumG = 0.0, accumB = 0.0;
 
-    for(int i=0;i<140;i++){
+    for(int i=i0;i<STEP_COUNT;i++){
         vec3 pos = ro + rd * t;
         float zWrapped = mod(pos.z + 10.0 * sin(iTime*0.15 + pos.x*0.07), 12.566370); // moving z wrap with small x-dependent offset
         vec3 rp = vec3(pos.xy, zWrapped);
@@ -132,15 +199,45 @@ void main(){
 
         glow += hit * (1.0 - smoothstep(0.0, thicknessLocal, abs(d)));
 
-        t += max(0.015, 0.45 * abs(d));
-        if(t > 200.0) break;
+        t += max(MIN_STEP, 0.45 * abs(d));
+        if(t > FAR_DIST) break;
+#ifdef EARLY_OUT
+        if(min(accumR, min(accumG, accumB)) * 0.55 + glow * 0.9 > EARLY_OUT) break;
+#endif
     }
+    accumRGB = vec3(accumR, accumG, accumB);
+}
+
+#if TEMPORAL
+// Last frame's march state for this ray: the point at the depth stored for
+// this pixel, projected through last frame's camera and unswirled with last
+// frame's swirl back to a pixel
+bool reproject(vec3 rd, vec2 c, out vec4 past, out float pastT){
+    float d = texelFetch(iHistoryDepth, ivec2(gl_FragCoord.xy), 0).r;
+    vec2 prevC = iConsts[2].yz;
+    vec3 q = rd * d + vec3((c - prevC) * 2.0, iHistoryDt * speed);
+    if(q.z > -1e-3) return false;
+    vec2 pp = q.xy * (iConsts[2].w / -q.z);
+    // the swirl's time terms, iHistoryDt earlier
+    pp = rot(-swirlAt(length(pp), iConsts[1].w - 0.8 * iHistoryDt, iConsts[2].x - 0.4 * iHistoryDt)) * pp + prevC * 0.6;
+    vec2 st = vec2(pp.x * iResolution.y / iResolution.x, pp.y) * 0.5 + 0.5;
+    if(any(lessThan(st, vec2(0.0))) || any(greaterThan(st, vec2(1.0)))) return false;
+    vec2 coord = st * iResolution / vec2(textureSize(iHistory, 0));
+    past = texture(iHistory, coord);
+    pastT = texture(iHistoryDepth, coord).r;
+    return true;
+}
+#endif
+
+// final colour from the march result; st as for cameraRay
+vec3 shade(vec2 p, vec2 st, float t, vec3 accumRGB, float glow, FrameConsts k){
+    float accumR = accumRGB.r, accumG = accumRGB.g, accumB = accumRGB.b;
 
     // depth/fog
     float depth = clamp(exp(-0.018 * t), 0.0, 1.0);
 
     // palette positions per-channel to enhance separation
-    float basePos = fract((iTime * 0.12 * warp) + (t * 0.018));
+    float basePos = fract(k.paletteBase + (t * 0.018));
     float posR = fract(basePos + accumR * 0.08 + 0.01);
     float posG = fract(basePos + accumG * 0.06 + 0.00);
     float posB = fract(basePos + accumB * 0.04 - 0.01);
@@ -162,166 +259,156 @@ void main(){
     float veins = 0.5 + 0.5 * sin(30.0 * length(p) - iTime * 3.2 + noise(p*12.0));
     col += 0.12 * palette(basePos + 0.35) * veins;
 
-    // subtle bloom by raising near-center intensity
-    float centerBoost = smoothstep(0.7, 0.0, length(p)) * (1.0 + 0.8 * sin(iTime*1.5));
-    col += 0.25 * centerBoost * palette(basePos + 0.5);
-
     // vignette and fog tint
     float vig = smoothstep(1.3, 0.18, length(p));
     col *= vig;
     col = mix(vec3(0.015,0.015,0.02), col, depth);
 
     // chromatic aberration smear: sample palette edges with tiny uv offsets
-    vec2 caShiftR = chromaBase * 1.5;
-    vec2 caShiftB = -chromaBase * 1.5;
-    float caNoise = noise(uv * 10.0 + iTime*0.3);
+    vec2 caShiftR = k.chromaBase * 1.5;
+    vec2 caShiftB = -k.chromaBase * 1.5;
+    float caNoise = noise(st * 10.0 + iTime*0.3);
     col.r = mix(col.r, palette(fract(basePos + caNoise*0.02 + 0.02)).r, 0.12);
     col.b = mix(col.b, palette(fract(basePos - caNoise*0.02 - 0.02)).b, 0.12);
 
-    // final color grading and gamma
-    col = pow(clamp(col, 0.0, 1.0), vec3(0.85));
-    fragColor = vec4(col, 1.0);
+    // linear and unclamped; the host's tonemap pass grades it (tone below)
+    return col;
 }
-)glsl";
-
 
-static GLuint compileShader(GLenum type, const char* src) {
-    GLuint sh = glCreateShader(type);
-    glShaderSource(sh, 1, &src, nullptr);
-    glCompileShader(sh);
-    GLint ok = 0; glGetShaderiv(sh, GL_COMPILE_STATUS, &ok);
-    if (!ok) {
-        char buf[4096]; glGetShaderInfoLog(sh, sizeof(buf), nullptr, buf);
-        std::cerr << "Shader compile error: " << buf << "\n";
-        return 0;
+#if COMPUTE
+// Far from the surface a step adds under exp(-24 * SKIP_BAND) and no glow
+#define SKIP_BAND 0.5
+// bound on how fast the SDF changes across rays (the 40x rings dominate); it
+// widens the band by how far the tile's other rays are from the centre one
+#define SKIP_LIPSCHITZ 10.0
+// the swirl bends a tile's rays; its interior may reach a little past the corners
+#define SKIP_SWIRL_SLACK 1.25
+
+// Steps the tile's centre ray for as long as every ray of the tile stays
+// clear of the surface. spread is the largest distance per unit t from the
+// centre ray to a corner ray.
+void skipEmpty(vec3 ro, vec3 rd, float spread, out float t, out int steps){
+    t = 0.0;
+    for(steps = 0; steps < STEP_COUNT; steps++){
+        vec3 pos = ro + rd * t;
+        float d = tunnelSDF(vec3(pos.xy, mod(pos.z + 10.0 * sin(iTime*0.15 + pos.x*0.07), 12.566370)));
+        if(abs(d) < SKIP_BAND + SKIP_LIPSCHITZ * spread * t) break;
+        t += max(MIN_STEP, 0.45 * abs(d));
+        if(t > FAR_DIST) break;
     }
-    return sh;
 }
 
-static GLuint linkProgram(GLuint v, GLuint f) {
-    GLuint p = glCreateProgram();
-    glAttachShader(p, v);
-    glAttachShader(p, f);
-    glBindAttribLocation(p, 0, "inPos");
-    glLinkProgram(p);
-    GLint ok = 0; glGetProgramiv(p, GL_LINK_STATUS, &ok);
-    if (!ok) {
-        char buf[4096]; glGetProgramInfoLog(p, sizeof(buf), nullptr, buf);
-        std::cerr << "Program link error: " << buf << "\n";
-        return 0;
-    }
-    return p;
-}
+shared FrameConsts sConsts;
+shared vec2 sTileStart;
 
-int main(int argc, char** argv) {
-    if (SDL_Init(SDL_INIT_VIDEO) != 0) {
-        std::cerr << "SDL_Init failed: " << SDL_GetError() << "\n";
-        return 1;
+void main(){
+    vec2 p;
+    if(iComputePass == 0){
+        ivec2 tile = ivec2(gl_GlobalInvocationID.xy);
+        if(any(greaterThanEqual(tile * 8, ivec2(iResolution)))) return;
+        FrameConsts k = frameConsts();
+        vec3 ro = vec3(k.centerMove.xy * 2.0, iPhase.x);
+        vec2 base = vec2(tile * 8);
+        vec3 rd = cameraRay((base + 4.0) / iResolution, k, p);
+        float spread = 0.0;
+        for(int c = 0; c < 4; c++)
+            spread = max(spread, length(cameraRay((base + 8.0 * vec2(c & 1, c >> 1)) / iResolution, k, p) - rd));
+        float t;
+        int steps;
+        skipEmpty(ro, rd, spread * SKIP_SWIRL_SLACK, t, steps);
+        imageStore(iTileStart, tile, vec4(t, float(steps), 0.0, 0.0));
+        return;
     }
-    //SDL_Init(SDL_INIT_VIDEO);
-
-    SDL_GL_SetAttribute(SDL_GL_CONTEXT_MAJOR_VERSION, 3);
-    SDL_GL_SetAttribute(SDL_GL_CONTEXT_MINOR_VERSION, 3);
-    SDL_GL_SetAttribute(SDL_GL_CONTEXT_PROFILE_MASK, SDL_GL_CONTEXT_PROFILE_CORE);
-
-    int w = 1280, h = 720;
-    SDL_Window* win = SDL_CreateWindow("Plasma Time Warp Tunnel", SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED,
-        w, h, SDL_WINDOW_OPENGL | SDL_WINDOW_RESIZABLE);
-    if (!win) { std::cerr << "CreateWindow failed\n"; return 1; }
-
-    SDL_GLContext ctx = SDL_GL_CreateContext(win);
-    if (!ctx) { std::cerr << "CreateContext failed\n"; return 1; }
 
-    if (!gladLoadGLLoader((GLADloadproc)SDL_GL_GetProcAddress)) {
-        std::cerr << "Failed to initialize GLAD\n";
-        return 1;
+    if(gl_LocalInvocationIndex == 0u){
+        sConsts = frameConsts();
+        sTileStart = imageLoad(iTileStart, ivec2(gl_WorkGroupID.xy)).xy;
     }
-    std::cout << "OpenGL: " << (const char*)glGetString(GL_VERSION) << "\n";
-
-    // Load OpenGL functions if needed; on many setups gl* from <GL/gl.h> is enough.
-    // Create shaders
-    GLuint vs = compileShader(GL_VERTEX_SHADER, vertexShaderSrc);
-    GLuint fs = compileShader(GL_FRAGMENT_SHADER, fragmentShaderSrc);
-    if (!vs || !fs) return 1;
-    GLuint prog = linkProgram(vs, fs);
-    glDeleteShader(vs); glDeleteShader(fs);
-    if (!prog) return 1;
-
-    // Fullscreen triangle VAO/VBO
-    GLuint vao, vbo;
-    float verts[] = { -1.0f, -1.0f, 3.0f, -1.0f, -1.0f, 3.0f }; // odd trick: single triangle covering screen
-    glGenVertexArrays(1, &vao);
-    glBindVertexArray(vao);
-    glGenBuffers(1, &vbo);
-    glBindBuffer(GL_ARRAY_BUFFER, vbo);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(verts), verts, GL_STATIC_DRAW);
-    glEnableVertexAttribArray(0);
-    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 0, nullptr);
-
-    // Uniform locations
-    GLint locTime = glGetUniformLocation(prog, "iTime");
-    GLint locRes = glGetUniformLocation(prog, "iResolution");
-    GLint locSpeed = glGetUniformLocation(prog, "speed");
-    GLint locWarp = glGetUniformLocation(prog, "warp");
-    GLint locThickness = glGetUniformLocation(prog, "thickness");
-    GLint locColorShift = glGetUniformLocation(prog, "colorShift");
-
-    auto start = std::chrono::high_resolution_clock::now();
-    bool running = true;
-    SDL_Event e;
-    // default params
-    float speed = 6.0f;
-    float warp = 1.0f;
-    float thickness = 0.18f;
-    float colorShift = 0.0f;
-
-    while (running) {
-        while (SDL_PollEvent(&e)) {
-            if (e.type == SDL_QUIT) running = false;
-            if (e.type == SDL_KEYDOWN) {
-                if (e.key.keysym.sym == SDLK_ESCAPE) running = false;
-                if (e.key.keysym.sym == SDLK_UP) speed *= 1.1f;
-                if (e.key.keysym.sym == SDLK_DOWN) speed /= 1.1f;
-                if (e.key.keysym.sym == SDLK_LEFT) warp = std::max(0.1f, warp - 0.1f);
-                if (e.key.keysym.sym == SDLK_RIGHT) warp += 0.1f;
-                if (e.key.keysym.sym == SDLK_z) thickness = std::max(0.01f, thickness - 0.01f);
-                if (e.key.keysym.sym == SDLK_x) thickness += 0.01f;
-                if (e.key.keysym.sym == SDLK_c) colorShift += 0.05f;
-                if (e.key.keysym.sym == SDLK_v) colorShift -= 0.05f;
-            }
-            if (e.type == SDL_WINDOWEVENT && e.window.event == SDL_WINDOWEVENT_SIZE_CHANGED) {
-                w = e.window.data1; h = e.window.data2;
-                glViewport(0, 0, w, h);
-            }
+    barrier();
+    ivec2 pixel = ivec2(gl_GlobalInvocationID.xy);
+    if(any(greaterThanEqual(pixel, ivec2(iResolution)))) return;
+    FrameConsts k = sConsts;
+    vec2 st = (vec2(pixel) + 0.5) / iResolution;
+    vec3 ro = vec3(k.centerMove.xy * 2.0, iPhase.x);
+    vec3 rd = cameraRay(st, k, p);
+    float t, glow;
+    vec3 accumRGB;
+    march(ro, rd, sTileStart.x, int(sTileStart.y), t, accumRGB, glow);
+    imageStore(iOutput, pixel, vec4(shade(p, st, t, accumRGB, glow, k), 1.0));
+}
+#else
+void main(){
+    FrameConsts k = frameConsts();
+    vec2 p;
+    vec3 ro = vec3(k.centerMove.xy * 2.0, iPhase.x);
+    vec3 rd = cameraRay(uv, k, p);
+    vec2 centerMove = k.centerMove;
+
+    float t, glow;
+    vec3 accumRGB;
+#if TEMPORAL
+    vec4 past = vec4(0.0);
+    float pastT = 0.0;
+    bool reused = iHistoryDt > 0.0 && reproject(rd, centerMove, past, pastT);
+    ivec2 tile = ivec2(gl_FragCoord.xy) >> 3;
+    if(!reused || ((tile.x + tile.y + iFrame) & 1) == 0){
+        march(ro, rd, 0.0, 0, t, accumRGB, glow);
+        if(reused){
+            accumRGB = mix(past.rgb, accumRGB, TEMPORAL_BLEND);
+            glow = mix(past.a, glow, TEMPORAL_BLEND);
         }
+    } else {
+        accumRGB = past.rgb;
+        glow = past.a;
+        t = pastT;
+    }
+    historyOut = vec4(accumRGB, glow);
+    historyDepth = t;
+#else
+    march(ro, rd, 0.0, 0, t, accumRGB, glow);
+#endif
+    fragColor = vec4(shade(p, uv, t, accumRGB, glow, k), 1.0);
+}
+#endif
+)glsl";
 
-        auto now = std::chrono::high_resolution_clock::now();
-        std::chrono::duration<float> diff = now - start;
-        float t = diff.count();
-
-        glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
-        glClear(GL_COLOR_BUFFER_BIT);
-
-        glUseProgram(prog);
-        glUniform1f(locTime, t);
-        glUniform2f(locRes, (float)w, (float)h);
-        glUniform1f(locSpeed, speed);
-        glUniform1f(locWarp, warp);
-        glUniform1f(locThickness, thickness);
-        glUniform1f(locColorShift, colorShift);
+// Moving/oscillating tunnel center (gives drifting "center" to fly through),
+// with organic jitter/noise
+static void twirlCenter(double time, float warp, float* c) {
+    float moveScale = 0.5f + 0.5f * warp;
+    c[0] = (float)std::sin(time * 0.6) * 0.35f * moveScale + 0.08f * valueNoise((float)(time * 0.7), 0.0f);
+    c[1] = (float)std::cos(time * 0.4) * 0.25f * moveScale + 0.08f * valueNoise(0.0f, (float)(time * 0.9));
+}
 
-        glBindVertexArray(vao);
-        glDrawArrays(GL_TRIANGLES, 0, 3);
+static float twirlFocal(double time) {
+    return 1.6f - 0.5f * (float)std::sin(time * 0.2);
+}
 
-        SDL_GL_SwapWindow(win);
-        SDL_Delay(1);
-    }
+// The FrameConsts of the shader above; the time terms are taken in double
+static void twirlFrameConsts(double time, FrameParams& fp) {
+    float* k = fp.iConsts;
+    twirlCenter(time, fp.warp, &k[0]);
+    k[2] = twirlFocal(time);
+    double base = time * 0.12 * fp.warp;
+    k[3] = (float)(base - std::floor(base));
+    k[4] = 0.003f * (float)std::sin(time * 1.7) * (1.0f + fp.warp);
+    k[5] = 0.003f * (float)std::cos(time * 1.3) * (1.0f + fp.warp);
+    k[7] = (float)(time * 0.8);
+    k[8] = (float)std::fmod(time * 0.4, 6.283185307179586); // only inside sin()
+    // last frame's camera, for reprojecting the temporal history
+    double prev = time - fp.iHistoryDt;
+    twirlCenter(prev, fp.warp, &k[9]);
+    k[11] = twirlFocal(prev);
+}
 
-    glDeleteBuffers(1, &vbo);
-    glDeleteVertexArrays(1, &vao);
-    glDeleteProgram(prog);
-    SDL_GL_DeleteContext(ctx);
-    SDL_DestroyWindow(win);
-    SDL_Quit();
-    return 0;
-}
\ No newline at end of file
+const EffectDesc twirlEffect = {
+    "twirl",
+    "Plasma Time Warp Tunnel - Twirl",
+    fragmentShaderSrc,
+    { 6.0f, 1.0f, 0.18f, 0.0f }, // speed, warp, thickness, colorShift
+    {},                          // no chromatic aberration
+    featureNoiseTex | featureStepCount | featureQuality | featureTemporal | featureCompute,
+    { { 1.0, 62.83185307179586, true } }, // iPhase.x: travel
+    twirlFrameConsts,
+    { 1.0f, 0.85f, 0.15f, 1.0f }, // tone: exposure, gamma, bloom, bloom threshold
+};
@@ -1,38 +1,25 @@
-// main.cpp
-// Build: see instructions below
+// shader3-tunnel.cpp
+// Effect: Corner Tunnel. Registered with the timewarp host (see effects.cpp).
 // In development!! see todo
-#define SDL_MAIN_HANDLED
-#pragma comment(linker, "/SUBSYSTEM:CONSOLE")
-#include <glad/glad.h>
-#include <SDL2/SDL.h>
-#include <iostream>
-#include <string>
-#include <chrono>
-#include <algorithm> // for std::max
-
-#pragma comment(lib, "opengl32.lib")
-
-// Minimal shader loader for GL2/GL3 compatibility using shader strings.
-// The source code for the vertex shader stored in a const char array
-static const char* vertexShaderSrc = R"glsl(
-#version 330 core
-layout(location = 0) in vec2 inPos;
-out vec2 uv;
-void main(){
-    uv = inPos * 0.5 + 0.5;
-    gl_Position = vec4(inPos, 0.0, 1.0);
-}
-)glsl";
+
+#include "effects.h"
+#include <algorithm>
+#include <cmath>
 
 static const char* fragmentShaderSrc = R"glsl(
 #version 330 core
 out vec4 FragColor;
-uniform vec2 uResolution;
-uniform float uTime;
-uniform float uSpeed;
-uniform float warp;
-uniform float thickness;
-uniform float colorShift;
+// iTime, iResolution, speed, warp, thickness and colorShift come from the
+// host's FrameParams block, inserted after #version (frame-params.h)
+// The travel iTime * speed arrives wrapped twice (tunnelEffect below):
+// iPhase.x at 20pi for the waves (all multiples of 0.1 in z), iPhase.y at
+// 24 for the path (four 6-long cardinal segments)
+// What doesn't change across the frame comes in iConsts, worked out once by
+// the host (tunnelFrameConsts below):
+//   iConsts[0]      path centre xy (damped), bank cos, bank sin
+//   iConsts[1]      glow pulse, glow spread, inner falloff, ring frequency
+//   iConsts[2].x    angular bow, eased along each path segment
+//   iConsts[3..5]   hue matrix columns in xyz
 
 /*
     Corner-bending tunnel
@@ -42,87 +29,20 @@ uniform float colorShift;
     - Screen-space tunnel mapping for performance: no raymarch, just polar distortion.
 
     Controls:
-    - uTime: travel speed and turn cadence.
-    - uResolution: viewport size.
+    - iTime: travel speed and turn cadence.
+    - iResolution: viewport size.
     - warp: multiplies angular warp effect around corners
     - thickness: controls wall thickness / ring sharpness (0.1..2.0 typical)
     - colorShift: shifts palette angle (radians)
 */
 
-float smoothstep01(float x) {
-    return smoothstep(0.0, 1.0, clamp(x, 0.0, 1.0));
-}
-
-// Cubic ease in/out (s-curve) for pleasant corner bows
-float easeInOut(float t) {
-    t = clamp(t, 0.0, 1.0);
-    return t*t*(3.0 - 2.0*t);
-}
-
-// Rotate 2D vector by angle
-mat2 rot(float a) {
-    float s = sin(a), c = cos(a);
-    return mat2(c, -s, s, c);
-}
-
-// Piecewise cardinal directions with smoothed 90 turns.
-// Each segment lasts segLen in "z travel"; we blend directions across a blend window.
-vec2 pathDirection(float z) {
-    float segLen = 6.0;
-    float blendLen = 2.2;
-    float t = z / segLen;
-    float i = floor(t);
-    float f = fract(t);
-
-    // Determine base direction (cardinals cycle: +X, +Y, -X, -Y)
-    int idx = int(mod(i, 4.0));
-    vec2 dir;
-    if (idx == 0) dir = vec2(1.0, 0.0);
-    else if (idx == 1) dir = vec2(0.0, 1.0);
-    else if (idx == 2) dir = vec2(-1.0, 0.0);
-    else              dir = vec2(0.0, -1.0);
-
-    // Next direction for blending during corner
-    int idxNext = int(mod(i + 1.0, 4.0));
-    vec2 dirNext;
-    if (idxNext == 0) dirNext = vec2(1.0, 0.0);
-    else if (idxNext == 1) dirNext = vec2(0.0, 1.0);
-    else if (idxNext == 2) dirNext = vec2(-1.0, 0.0);
-    else                   dirNext = vec2(0.0, -1.0);
-
-    // Determine ease factor: only active near the end of the segment
-    float cornerStart = 1.0 - (blendLen / segLen);
-    float w = easeInOut((f - cornerStart) / (1.0 - cornerStart));
-
-    // Blend directions to create a smooth "bow" around the corner
-    vec2 blended = normalize(mix(dir, dirNext, w));
-    return blended;
-}
-
-// Compute the center offset of the tunnel along the path
-vec2 pathCenter(float z) {
-    float segLen = 6.0;
-    float i = floor(z / segLen);
-    float f = fract(z / segLen);
-
-    // Accumulate position across segments
-    // For each full segment, move in its cardinal direction by segLen*(1 - blendFrac)
-    // Then add the current segments eased displacement.
-    // For a simple and stable result, we integrate locally with direction and a mild lateral bow.
-    vec2 dir = pathDirection(z);
-    // Per-corner bow amplitude (lateral offset that creates a rounded feel)
-    float bowAmp = 1.6;
-    float turnPhase = easeInOut(f); // 0..1 across the segment
-    // Lateral bow perpendicular to current direction
-    vec2 perp = vec2(-dir.y, dir.x);
-    float bow = bowAmp * sin(3.14159 * turnPhase) * smoothstep01(turnPhase);
-
-    // Forward accumulation approximation: move along dir scaled by local progress
-    // This keeps the center advancing steadily; we dont need exact global integration for the effect.
-    vec2 forward = dir * (f * segLen);
-
-    return forward + perp * bow;
-}
+// HUE_SHIFT 0/1 is set by the host's variant selection (shader-variants.h);
+// left undefined, the hue matrix is decided from colorShift at run time
+#ifdef HUE_SHIFT
+#define HUE_SHIFT_ON (HUE_SHIFT != 0)
+#else
+#define HUE_SHIFT_ON (abs(colorShift) > 0.0001)
+#endif
 
 // Hue rotate helper
 vec3 hueRotate(vec3 c, float angle) {
@@ -147,7 +67,7 @@ vec3 hueRotate(vec3 c, float angle) {
 // Procedural texture for the tunnel walls
 vec3 tunnelMaterial(vec2 uv, float r, float a, float z) {
     // Apply thickness to ring frequency and radial falloff
-    float ringFreq = 10.0 * max(0.25, thickness); // thicker -> fewer tighter rings
+    float ringFreq = iConsts[1].w; // thicker -> fewer tighter rings
 
     float ring = sin(ringFreq * r - 0.6 * z);
 
@@ -166,7 +86,7 @@ vec3 tunnelMaterial(vec2 uv, float r, float a, float z) {
     col *= 0.6 + 0.4 * mixv;
 
     // Radial falloff tuned by thickness: larger thickness => softer inside falloff
-    float innerSoft = mix(1.4, 0.6, smoothstep(0.2, 2.0, thickness));
+    float innerSoft = iConsts[1].z;
     float v = smoothstep(innerSoft, 0.2, r);
     col *= 0.6 + 0.4 * v;
 
@@ -175,24 +95,16 @@ vec3 tunnelMaterial(vec2 uv, float r, float a, float z) {
 
 void main() {
     // Normalize coordinates
-    vec2 p = (gl_FragCoord.xy * 2.0 - uResolution.xy) / uResolution.y;
-
-    float time = uTime;
+    vec2 p = (gl_FragCoord.xy * 2.0 - iResolution.xy) / iResolution.y;
 
     // Travel speed and depth
-    float speed = uSpeed;
-    float z = time * speed;
+    float z = iPhase.x;
+    float zPath = iPhase.y;
 
-    // Path orientation and banking (roll around the tunnel axis)
-    vec2 dir = pathDirection(z);
-    float bank = 0.6 * sin(0.7 * z); // gentle banking that responds to turns
-    mat2 bankRot = rot(bank);
-
-    // Offset the center based on path (bows around corners)
-    vec2 center = pathCenter(z);
-    // Smooth global offset accumulation to avoid drift explosion:
-    // Keep center moderately bounded by damping.
-    center *= 0.15;
+    // Banking (roll around the tunnel axis) and the centre offset along the
+    // path (bows around corners), the same for every pixel
+    mat2 bankRot = mat2(iConsts[0].z, -iConsts[0].w, iConsts[0].w, iConsts[0].z);
+    vec2 center = iConsts[0].xy;
 
     // Transform screen space by banking and center offset
     vec2 q = bankRot * (p - center);
@@ -203,38 +115,20 @@ void main() {
 
     // Axial repetition to give the sense of forward motion
     float repeat = 6.0;
-    float axial = (z + 1.5 * r);
+    float axial = (zPath + 1.5 * r);
     float stripePhase = mod(axial, repeat) / repeat;
 
     // Slight angular warp tied to corner easing for "bow" feel inside the tube
-    float turnEase = easeInOut(fract((z / 6.0)));
-    a += 0.35 * turnEase * sin(2.0 * a);
-    //a += 0.15 * turnEase * sin(2.0 * a) * (1.0 + clamp(warp, 0.0, 1.0));
-    // Base color
-    vec3 base = tunnelMaterial(q, r, a, z);
-
-    // Chromatic separation (subtle)
-    float ca = (0.004 + 0.002 * turnEase) * (1.0 + 0.4 * clamp(warp, 0.0, 2.0));
-    vec2 qR = bankRot * (p - center) + vec2(ca, 0.0);
-    vec2 qG = bankRot * (p - center);
-    vec2 qB = bankRot * (p - center) - vec2(ca, 0.0);
-
-    float rR = length(qR);
-    float rG = length(qG);
-    float rB = length(qB);
-    float aR = atan(qR.y, qR.x);
-    float aG = atan(qG.y, qG.x);
-    float aB = atan(qB.y, qB.x);
-
-    vec3 col;
-    col.r = tunnelMaterial(qR, rR, aR, z).r;
-    col.g = tunnelMaterial(qG, rG, aG, z).g;
-    col.b = tunnelMaterial(qB, rB, aB, z).b;
+    a += iConsts[2].x * sin(2.0 * a);
+
+    // Wall colour, evaluated once; the host's chromatic aberration pass
+    // splits the channels afterwards (chroma in tunnelEffect below)
+    vec3 col = tunnelMaterial(q, r, a, z);
 
     // Inner glow near the axis for speed lines; thickness affects spread of glow
-    float glowSpread = mix(10.0, 3.0, smoothstep(0.0, 2.0, thickness));
+    float glowSpread = iConsts[1].y;
     float glow = exp(-glowSpread * r);
-    col += vec3(0.9, 0.9, 1.0) * glow * (0.5 + 0.5 * sin(1.5 * z));
+    col += vec3(0.9, 0.9, 1.0) * glow * iConsts[1].x;
 
     // Segment markers for depth cues
     float rings = 0.5 + 0.5 * sin(10.0 * r - 0.6 * z);
@@ -242,173 +136,102 @@ void main() {
     
 // Apply an overall palette hue shift using colorShift (user-level)
     // small rotate by colorShift radians for subtle tuning
-    if (abs(colorShift) > 0.0001) {
+    if (HUE_SHIFT_ON) {
         // simple approximate hue rotation by remapping via sin/cos on channels
-        float cs = cos(colorShift);
-        float ss = sin(colorShift);
-        mat3 hueMat = mat3(
-            vec3(0.213 + cs*0.787 - ss*0.213, 0.213 - cs*0.213 + ss*0.143, 0.213 - cs*0.213 - ss*0.787),
-            vec3(0.715 - cs*0.715 - ss*0.715, 0.715 + cs*0.285 + ss*0.140, 0.715 - cs*0.715 + ss*0.283),
-            vec3(0.072 - cs*0.072 + ss*0.928, 0.072 - cs*0.072 - ss*0.283, 0.072 + cs*0.928 + ss*0.0)
-        );
-        col = clamp(hueMat * col, 0.0, 1.0);
+        mat3 hueMat = mat3(iConsts[3].xyz, iConsts[4].xyz, iConsts[5].xyz);
+        col = hueMat * col;
     }
 
-    // Final tone mapping
-    col = pow(col, vec3(0.9)); // mild gamma tweak
-
+    // linear and unclamped; the host's tonemap pass grades it (tone below)
     FragColor = vec4(col, 1.0);
 }
 )glsl";
 
+// ---- per-frame constants, the scalar part of the shader above ----
 
-
-static GLuint compileShader(GLenum type, const char* src) {
-    GLuint sh = glCreateShader(type);
-    glShaderSource(sh, 1, &src, nullptr);
-    glCompileShader(sh);
-    GLint ok = 0; glGetShaderiv(sh, GL_COMPILE_STATUS, &ok);
-    if (!ok) {
-        char buf[4096]; glGetShaderInfoLog(sh, sizeof(buf), nullptr, buf);
-        std::cerr << "Shader compile error: " << buf << "\n";
-        return 0;
-    }
-    return sh;
+static float mix(float a, float b, float t) { return a + (b - a) * t; }
+static float smoothstep(float e0, float e1, float x) {
+    float t = std::clamp((x - e0) / (e1 - e0), 0.0f, 1.0f);
+    return t * t * (3.0f - 2.0f * t);
 }
 
-static GLuint linkProgram(GLuint v, GLuint f) {
-    GLuint p = glCreateProgram();
-    glAttachShader(p, v);
-    glAttachShader(p, f);
-    glBindAttribLocation(p, 0, "inPos");
-    glLinkProgram(p);
-    GLint ok = 0; glGetProgramiv(p, GL_LINK_STATUS, &ok);
-    if (!ok) {
-        char buf[4096]; glGetProgramInfoLog(p, sizeof(buf), nullptr, buf);
-        std::cerr << "Program link error: " << buf << "\n";
-        return 0;
-    }
-    return p;
+// Cubic ease in/out (s-curve) for pleasant corner bows
+static float easeInOut(float t) {
+    t = std::clamp(t, 0.0f, 1.0f);
+    return t * t * (3.0f - 2.0f * t);
 }
 
-int main(int argc, char** argv) {
-    if (SDL_Init(SDL_INIT_VIDEO) != 0) {
-        std::cerr << "SDL_Init failed: " << SDL_GetError() << "\n";
-        return 1;
-    }
-    SDL_Init(SDL_INIT_VIDEO);
-
-    SDL_GL_SetAttribute(SDL_GL_CONTEXT_MAJOR_VERSION, 3);
-    SDL_GL_SetAttribute(SDL_GL_CONTEXT_MINOR_VERSION, 3);
-    SDL_GL_SetAttribute(SDL_GL_CONTEXT_PROFILE_MASK, SDL_GL_CONTEXT_PROFILE_CORE);
-
-    int w = 1280, h = 720;
-    SDL_Window* win = SDL_CreateWindow("Plasma Time Warp Tunnel", SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED,
-        w, h, SDL_WINDOW_OPENGL | SDL_WINDOW_RESIZABLE);
-    if (!win) { std::cerr << "CreateWindow failed\n"; return 1; }
+// Piecewise cardinal directions (+X, +Y, -X, -Y) with smoothed 90 turns.
+// Each segment lasts segLen in "z travel"; we blend directions across a blend window.
+static void pathDirection(float z, float& x, float& y) {
+    static const float cardinals[4][2] = { { 1.0f, 0.0f }, { 0.0f, 1.0f }, { -1.0f, 0.0f }, { 0.0f, -1.0f } };
+    const float segLen = 6.0f, blendLen = 2.2f;
+    float t = z / segLen;
+    float i = std::floor(t);
+    float f = t - i;
+    int idx = (int)(i - 4.0f * std::floor(i / 4.0f));
+    const float* dir = cardinals[idx & 3];
+    const float* dirNext = cardinals[(idx + 1) & 3];
+    // ease factor, only active near the end of the segment
+    float cornerStart = 1.0f - (blendLen / segLen);
+    float w = easeInOut((f - cornerStart) / (1.0f - cornerStart));
+    x = mix(dir[0], dirNext[0], w);
+    y = mix(dir[1], dirNext[1], w);
+    float len = std::sqrt(x * x + y * y);
+    x /= len; y /= len;
+}
 
-    SDL_GLContext ctx = SDL_GL_CreateContext(win);
-    if (!ctx) { std::cerr << "CreateContext failed\n"; return 1; }
+// Centre offset of the tunnel along the path: local progress along the
+// current direction plus a lateral bow perpendicular to it. We don't need
+// exact global integration for the effect.
+static void pathCenter(float z, float& x, float& y) {
+    const float segLen = 6.0f, bowAmp = 1.6f;
+    float f = z / segLen - std::floor(z / segLen);
+    float dx, dy;
+    pathDirection(z, dx, dy);
+    float turnPhase = easeInOut(f);
+    float bow = bowAmp * std::sin(3.14159f * turnPhase) * smoothstep(0.0f, 1.0f, turnPhase);
+    x = dx * (f * segLen) - dy * bow;
+    y = dy * (f * segLen) + dx * bow;
+}
 
-    if (!gladLoadGLLoader((GLADloadproc)SDL_GL_GetProcAddress)) {
-        std::cerr << "Failed to initialize GLAD\n";
-        return 1;
-    }
-    std::cout << "OpenGL: " << (const char*)glGetString(GL_VERSION) << "\n";
-
-    // Load OpenGL functions if needed; on many setups gl* from <GL/gl.h> is enough.
-    // Create shaders
-    GLuint vs = compileShader(GL_VERTEX_SHADER, vertexShaderSrc);
-    GLuint fs = compileShader(GL_FRAGMENT_SHADER, fragmentShaderSrc);
-    if (!vs || !fs) return 1;
-    GLuint prog = linkProgram(vs, fs);
-    glDeleteShader(vs); glDeleteShader(fs);
-    if (!prog) return 1;
-
-    // Fullscreen triangle VAO/VBO
-    GLuint vao, vbo;
-    float verts[] = { -1.0f, -1.0f, 3.0f, -1.0f, -1.0f, 3.0f }; // odd trick: single triangle covering screen
-    glGenVertexArrays(1, &vao);
-    glBindVertexArray(vao);
-    glGenBuffers(1, &vbo);
-    glBindBuffer(GL_ARRAY_BUFFER, vbo);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(verts), verts, GL_STATIC_DRAW);
-    glEnableVertexAttribArray(0);
-    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 0, nullptr);
-
-    // TODO: Uniform locations
-    // Now query the uniform location
-    GLint locRes = glGetUniformLocation(prog, "uResolution");
-    GLint locTime = glGetUniformLocation(prog, "uTime");
-    GLint locSpeed = glGetUniformLocation(prog, "uSpeed");
-    GLint locWarp = glGetUniformLocation(prog, "warp");
-    GLint locThickness = glGetUniformLocation(prog, "thickness");
-    GLint locColorShift = glGetUniformLocation(prog, "colorShift");
-
-    auto start = std::chrono::high_resolution_clock::now();
-    bool running = true;
-    SDL_Event e;
-    // default params
-    float speed = 2.0f;
-    float warp = 1.0f;
-    float thickness = 0.18f;
-    float colorShift = 0.0f;
-    glViewport(0, 0, w, h);
-
-    while (running) {
-        while (SDL_PollEvent(&e)) {
-            if (e.type == SDL_QUIT) running = false;
-            if (e.type == SDL_KEYDOWN) {
-                if (e.key.keysym.sym == SDLK_ESCAPE) running = false;
-                if (e.key.keysym.sym == SDLK_UP) speed *= 1.1f;
-                if (e.key.keysym.sym == SDLK_DOWN) speed /= 1.1f;
-                if (e.key.keysym.sym == SDLK_LEFT) warp = std::max(0.1f, warp - 0.1f);
-                if (e.key.keysym.sym == SDLK_RIGHT) warp += 0.1f;
-                if (e.key.keysym.sym == SDLK_z) thickness = std::max(0.01f, thickness - 0.01f);
-                if (e.key.keysym.sym == SDLK_x) thickness += 0.01f;
-                if (e.key.keysym.sym == SDLK_c) colorShift += 0.05f;
-                if (e.key.keysym.sym == SDLK_v) colorShift -= 0.05f;
-            }
-            if (e.type == SDL_WINDOWEVENT && e.window.event == SDL_WINDOWEVENT_SIZE_CHANGED) {
-                w = e.window.data1; h = e.window.data2;
-                glViewport(0, 0, w, h);
-            }
-        }
-
-        auto now = std::chrono::high_resolution_clock::now();
-        std::chrono::duration<float> diff = now - start;
-        float t = diff.count();
-
-        glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
-        glClear(GL_COLOR_BUFFER_BIT);
-
-        glUseProgram(prog);
-        glUniform1f(locTime, t);
-        glUniform2f(locRes, (float)w, (float)h);
-        glUniform1f(locSpeed, speed);
-        glUniform1f(locWarp, warp);
-        glUniform1f(locThickness, thickness);
-        glUniform1f(locColorShift, colorShift);
-
-        std::cout << "Loc iTime=" << locTime
-            << " uResolution=" << locRes
-            << " speed=" << locSpeed
-            << " warp=" << locWarp
-            << " thickness=" << locThickness
-            << " colorShift=" << locColorShift
-            << "\n";
-        glBindVertexArray(vao);
-        glDrawArrays(GL_TRIANGLES, 0, 3);
-
-        SDL_GL_SwapWindow(win);
-        SDL_Delay(1);
-    }
+static void tunnelFrameConsts(double, FrameParams& fp) {
+    float z = fp.iPhase[0], zPath = fp.iPhase[1];
+    float* k = fp.iConsts;
+    // keep the centre moderately bounded by damping
+    pathCenter(zPath, k[0], k[1]);
+    k[0] *= 0.15f; k[1] *= 0.15f;
+    float bank = 0.6f * std::sin(0.7f * z); // gentle banking that responds to turns
+    k[2] = std::cos(bank);
+    k[3] = std::sin(bank);
+
+    k[4] = 0.5f + 0.5f * std::sin(1.5f * z);
+    k[5] = mix(10.0f, 3.0f, smoothstep(0.0f, 2.0f, fp.thickness));
+    k[6] = mix(1.4f, 0.6f, smoothstep(0.2f, 2.0f, fp.thickness));
+    k[7] = 10.0f * std::max(0.25f, fp.thickness);
+    // from zPath like pathCenter: its period is 4 segments, iPhase.x's isn't
+    float turnEase = easeInOut(zPath / 6.0f - std::floor(zPath / 6.0f));
+    k[8] = 0.35f * turnEase;
+
+    float cs = std::cos(fp.colorShift), ss = std::sin(fp.colorShift);
+    const float hueMat[9] = {
+        0.213f + cs * 0.787f - ss * 0.213f, 0.213f - cs * 0.213f + ss * 0.143f, 0.213f - cs * 0.213f - ss * 0.787f,
+        0.715f - cs * 0.715f - ss * 0.715f, 0.715f + cs * 0.285f + ss * 0.140f, 0.715f - cs * 0.715f + ss * 0.283f,
+        0.072f - cs * 0.072f + ss * 0.928f, 0.072f - cs * 0.072f - ss * 0.283f, 0.072f + cs * 0.928f + ss * 0.0f,
+    };
+    for (int c = 0; c < 3; ++c)
+        for (int r = 0; r < 3; ++r) k[12 + c * 4 + r] = hueMat[c * 3 + r];
+}
 
-    glDeleteBuffers(1, &vbo);
-    glDeleteVertexArrays(1, &vao);
-    glDeleteProgram(prog);
-    SDL_GL_DeleteContext(ctx);
-    SDL_DestroyWindow(win);
-    SDL_Quit();
-    return 0;
-}
\ No newline at end of file
+const EffectDesc tunnelEffect = {
+    "tunnel",
+    "Plasma Time Warp Tunnel - Corner Tunnel",
+    fragmentShaderSrc,
+    { 2.0f, 1.0f, 0.18f, 0.0f }, // speed, warp, thickness, colorShift
+    { 0.005f, 0.4f, 2.0f },      // chromatic aberration: base, warp gain, warp max
+    featureHueShift,
+    { { 1.0, 62.83185307179586, true },  // iPhase.x: travel, waves
+      { 1.0, 24.0, true } },             // iPhase.y: travel, path
+    tunnelFrameConsts,
+    { 1.0f, 0.9f, 0.2f, 0.9f },  // tone: exposure, gamma, bloom, bloom threshold
+};
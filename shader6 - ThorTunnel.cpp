@@ -1,39 +1,24 @@
-// main.cpp
-// Build: see instructions below
+// shader6 - ThorTunnel.cpp
+// Effect: Thor Tunnel. Registered with the timewarp host (see effects.cpp).
 
-#define SDL_MAIN_HANDLED
-#pragma comment(linker, "/SUBSYSTEM:CONSOLE")
-#include <glad/glad.h>
-#include <SDL2/SDL.h>
-#include <iostream>
-#include <string>
-#include <chrono>
-#include <algorithm> // for std::max
-
-#pragma comment(lib, "opengl32.lib")
-
-// Minimal shader loader for GL2/GL3 compatibility using shader strings.
-// The source code for the vertex shader stored in a const char array
-static const char* vertexShaderSrc = R"glsl(
-#version 330 core
-layout(location = 0) in vec2 inPos;
-out vec2 uv;
-void main(){
-    uv = inPos * 0.5 + 0.5;
-    gl_Position = vec4(inPos, 0.0, 1.0);
-}
-)glsl";
+#include "effects.h"
+#include <algorithm>
+#include <cmath>
 
 static const char* fragmentShaderSrc = R"glsl(
 #version 330 core
 out vec4 FragColor;
-
-uniform vec2 uResolution;
-uniform float uTime;
-uniform float uSpeed;
-uniform float warp;
-uniform float thickness;
-uniform float colorShift;
+// iTime, iResolution, speed, warp, thickness and colorShift come from the
+// host's FrameParams block, inserted after #version (frame-params.h)
+// The travel iTime * speed arrives wrapped twice (thorTunnelEffect below):
+// iPhase.x at 100pi for the waves (all multiples of 0.02 in z), iPhase.y at
+// 120 for the 24-long cardinal path and the hammer's 0.625 loop
+// What doesn't change across the frame comes in iConsts, worked out once by
+// the host (thorFrameConsts below):
+//   iConsts[0]      path centre xy (damped), bank cos, bank sin
+//   iConsts[1]      turn ease, vortex warp, streak gain, vignette gain
+//   iConsts[2]      hammer depth, hammer scale, ring frequency
+//   iConsts[3..5]   hue matrix columns in xyz
 
 /*
  Dramatic "Thor hammer" travel through bending warp tunnels.
@@ -45,44 +30,20 @@ uniform float colorShift;
    * colorShift: hue rotation in radians
 */
 
-float PI = 3.14159265358979323846;
-
-mat2 rot(float a) {
-    float s = sin(a), c = cos(a);
-    return mat2(c, -s, s, c);
-}
-
-float easeInOut(float t) {
-    t = clamp(t, 0.0, 1.0);
-    return t * t * (3.0 - 2.0 * t);
-}
-
-// simple pseudo-hue rotate (approx)
-vec3 hueShift(vec3 c, float angle) {
-    float ca = cos(angle), sa = sin(angle);
-    mat3 m = mat3(
-        vec3(0.299, 0.587, 0.114),
-        vec3(0.299, 0.587, 0.114),
-        vec3(0.299, 0.587, 0.114)
-    );
-    mat3 p = mat3(
-        vec3(0.701, -0.587, -0.114),
-        vec3(-0.299, 0.413, -0.114),
-        vec3(-0.3, -0.588, 0.886)
-    );
-    return clamp((m + ca * p + sa * (p * mat3(
-        vec3(0.0), vec3(0.0), vec3(0.0)
-    ))) * c, 0.0, 1.0);
-}
+// HUE_SHIFT 0/1 is set by the host's variant selection (shader-variants.h);
+// left undefined, the hue matrix is decided from colorShift at run time
+#ifdef HUE_SHIFT
+#define HUE_SHIFT_ON (HUE_SHIFT != 0)
+#else
+#define HUE_SHIFT_ON (abs(colorShift) > 0.0001)
+#endif
 
 // stylized hammer silhouette at axis: long handle + rectangular head
-float hammerMask(vec2 uv, float t) {
+float hammerMask(vec2 uv) {
     // uv in tunnel local coordinates: y along handle, x radial
-    // scale and bob the hammer along t (axial travel)
-    float travel = mod(t * 1.6, 8.0); // loop travel speed for effect
-    float zpos = -fract(travel) * 2.0 + 0.4; // moves toward camera
-    // simulated depth scale
-    float scale = mix(0.9, 0.25, clamp((zpos + 1.0), 0.0, 1.0));
+    // the hammer bobs toward the camera along the path, scaled by depth
+    float zpos = iConsts[2].x;
+    float scale = iConsts[2].y;
 
     vec2 p = uv / scale;
     // handle: narrow rectangle along y
@@ -109,7 +70,7 @@ vec3 palette(float a, float r, float t) {
 
 float ringsPattern(float r, float z, float thickness) {
     // thicker -> softer rings; thinner -> tight crisp rings
-    float freq = mix(18.0, 6.0, smoothstep(0.2, 2.0, thickness));
+    float freq = iConsts[2].z;
     float rim = sin(freq * r - 0.9 * z);
     // sharpen by thickness
     float sharp = smoothstep(0.2, 0.5, rim * 0.8 + 0.2 * thickness);
@@ -118,31 +79,15 @@ float ringsPattern(float r, float z, float thickness) {
 
 void main() {
     // normalized pixel coords
-    vec2 uv = (gl_FragCoord.xy * 2.0 - uResolution.xy) / uResolution.y;
+    vec2 uv = (gl_FragCoord.xy * 2.0 - iResolution.xy) / iResolution.y;
 
     // travel depth
-    float z = uTime * uSpeed;
+    float z = iPhase.x;
+    float zPath = iPhase.y;
 
-    // banking: amplify for violent swing
-    float bank = 0.9 * sin(0.9 * z);
-    mat2 bankRot = rot(bank);
-
-    // path center: stronger lateral bows for exaggerated corners
-    float segLen = 6.0;
-    float segIdx = floor(z / segLen);
-    float segFrac = fract(z / segLen);
-    // choose cardinal directions
-    int idx = int(mod(segIdx, 4.0));
-    vec2 dir;
-    if (idx == 0) dir = vec2(1.0, 0.0);
-    else if (idx == 1) dir = vec2(0.0, 1.0);
-    else if (idx == 2) dir = vec2(-1.0, 0.0);
-    else dir = vec2(0.0, -1.0);
-    float bowAmp = 2.4; // stronger bow for dramatic bending
-    float bowPhase = easeInOut(segFrac);
-    vec2 perp = vec2(-dir.y, dir.x);
-    vec2 center = dir * (segFrac * segLen * 0.75) + perp * bowAmp * sin(PI * bowPhase) * smoothstep(0.0, 1.0, bowPhase);
-    center *= 0.12; // mild damping
+    // banking and the path center are the same for every pixel
+    mat2 bankRot = mat2(iConsts[0].z, -iConsts[0].w, iConsts[0].w, iConsts[0].z);
+    vec2 center = iConsts[0].xy;
 
     // apply banking and center to uv
     vec2 q = bankRot * (uv - center);
@@ -151,210 +96,111 @@ void main() {
     float r = length(q);
     float a = atan(q.y, q.x);
 
+    // strong rings and streaks - thickness controls softness. Evaluated once on
+    // the unwarped angle; the host's chromatic aberration pass splits the
+    // channels afterwards (chroma in thorTunnelEffect below)
+    float rings = ringsPattern(r, z, thickness);
+    vec3 col = palette(a, r, z) * (0.5 + 0.6 * rings);
+
     // deep vortex warp: combine radial-dependent and angle-dependent warp
-    float turnEase = easeInOut(fract(z / segLen));
-    float baseWarp = 0.6 + 1.6 * clamp(warp, 0.0, 3.0); // user-controlled magnitude
+    float turnEase = iConsts[1].x;
+    float baseWarp = iConsts[1].y; // user-controlled magnitude
     // radial falloff so center is more stable and outer walls twist strongly
     float warpFall = smoothstep(0.0, 1.6, r);
     // angular displacement: multi-frequency to create hammer-smear streaks
     a += baseWarp * turnEase * warpFall * (0.8 * sin(2.2 * a + 0.6*z) + 0.6 * sin(5.1 * a + 0.12*z));
 
-    // Chromatic offset increases with warp to emphasize streaks
-    float ca = (0.006 + 0.006 * turnEase) * (1.0 + 0.9 * clamp(warp, 0.0, 3.0));
-    vec2 qR = bankRot * (uv - center) + vec2(ca, 0.0);
-    vec2 qG = bankRot * (uv - center);
-    vec2 qB = bankRot * (uv - center) - vec2(ca, 0.0);
-
-    float rR = length(qR);
-    float rG = length(qG);
-    float rB = length(qB);
-    float aR = atan(qR.y, qR.x);
-    float aG = atan(qG.y, qG.x);
-    float aB = atan(qB.y, qB.x);
-
-    // strong rings and streaks - thickness controls softness
-    float ringsR = ringsPattern(rR, z, thickness);
-    float ringsG = ringsPattern(rG, z, thickness);
-    float ringsB = ringsPattern(rB, z, thickness);
-
-    vec3 colR = palette(aR, rR, z) * (0.5 + 0.6 * ringsR);
-    vec3 colG = palette(aG, rG, z) * (0.5 + 0.6 * ringsG);
-    vec3 colB = palette(aB, rB, z) * (0.5 + 0.6 * ringsB);
-
-    vec3 col = vec3(colR.r, colG.g, colB.b);
-
     // intense inner streaks / motion lines: high frequency angular modulation
     float streak = smoothstep(0.0, 0.3, 1.0 - abs(sin(18.0 * (a + 0.2*z)) ) );
-    col += 1.2 * vec3(0.9, 0.95, 1.0) * pow(max(0.0, 1.0 - r*6.0), 3.0) * streak * (0.5 + 0.8 * clamp(warp, 0.0, 3.0));
+    col += vec3(0.9, 0.95, 1.0) * pow(max(0.0, 1.0 - r*6.0), 3.0) * streak * iConsts[1].z;
 
     // procedural hammer mask at axis (use unwarped local uv so hammer looks like object passing through)
-    float hammer = hammerMask(uv * vec2(1.0, 1.6), z);
+    float hammer = hammerMask(uv * vec2(1.0, 1.6));
     // hammer glint and color (bright metal)
     vec3 hammerCol = mix(vec3(0.15,0.1,0.05), vec3(1.0,0.95,0.9), 0.9);
     // composite hammer onto col with additive glow to sell impact
     col = mix(col, hammerCol + 2.2 * vec3(1.0,0.9,0.6) * hammer, smoothstep(0.02, 0.6, hammer));
 
     // vignette and radial tone controlled by thickness
-    float v = smoothstep(1.6, 0.2, r) * (0.6 + 0.4 * (1.5 - clamp(thickness, 0.2, 2.0)));
+    float v = smoothstep(1.6, 0.2, r) * iConsts[1].w;
     col *= v;
 
     // final color shift (hue)
-    if (abs(colorShift) > 1e-5) {
-        col = hueShift(col, colorShift);
+    if (HUE_SHIFT_ON) {
+        col = mat3(iConsts[3].xyz, iConsts[4].xyz, iConsts[5].xyz) * col;
     }
 
-    // clamp and gamma
-    col = pow(clamp(col, 0.0, 1.0), vec3(0.9));
-
+    // linear and unclamped; the host's tonemap pass grades it (tone below)
     FragColor = vec4(col, 1.0);
 }
 )glsl";
 
+// ---- per-frame constants, the scalar part of the shader above ----
 
+static const float PI = 3.14159265358979323846f;
 
-static GLuint compileShader(GLenum type, const char* src) {
-    GLuint sh = glCreateShader(type);
-    glShaderSource(sh, 1, &src, nullptr);
-    glCompileShader(sh);
-    GLint ok = 0; glGetShaderiv(sh, GL_COMPILE_STATUS, &ok);
-    if (!ok) {
-        char buf[4096]; glGetShaderInfoLog(sh, sizeof(buf), nullptr, buf);
-        std::cerr << "Shader compile error: " << buf << "\n";
-        return 0;
-    }
-    return sh;
+static float mix(float a, float b, float t) { return a + (b - a) * t; }
+static float smoothstep(float e0, float e1, float x) {
+    float t = std::clamp((x - e0) / (e1 - e0), 0.0f, 1.0f);
+    return t * t * (3.0f - 2.0f * t);
 }
-
-static GLuint linkProgram(GLuint v, GLuint f) {
-    GLuint p = glCreateProgram();
-    glAttachShader(p, v);
-    glAttachShader(p, f);
-    glBindAttribLocation(p, 0, "inPos");
-    glLinkProgram(p);
-    GLint ok = 0; glGetProgramiv(p, GL_LINK_STATUS, &ok);
-    if (!ok) {
-        char buf[4096]; glGetProgramInfoLog(p, sizeof(buf), nullptr, buf);
-        std::cerr << "Program link error: " << buf << "\n";
-        return 0;
-    }
-    return p;
+static float easeInOut(float t) {
+    t = std::clamp(t, 0.0f, 1.0f);
+    return t * t * (3.0f - 2.0f * t);
 }
 
-int main(int argc, char** argv) {
-    if (SDL_Init(SDL_INIT_VIDEO) != 0) {
-        std::cerr << "SDL_Init failed: " << SDL_GetError() << "\n";
-        return 1;
-    }
-    //SDL_Init(SDL_INIT_VIDEO);
-
-    SDL_GL_SetAttribute(SDL_GL_CONTEXT_MAJOR_VERSION, 3);
-    SDL_GL_SetAttribute(SDL_GL_CONTEXT_MINOR_VERSION, 3);
-    SDL_GL_SetAttribute(SDL_GL_CONTEXT_PROFILE_MASK, SDL_GL_CONTEXT_PROFILE_CORE);
-
-    int w = 1280, h = 720;
-    SDL_Window* win = SDL_CreateWindow("Plasma Time Warp Tunnel", SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED,
-        w, h, SDL_WINDOW_OPENGL | SDL_WINDOW_RESIZABLE);
-    if (!win) { std::cerr << "CreateWindow failed\n"; return 1; }
-
-    SDL_GLContext ctx = SDL_GL_CreateContext(win);
-    if (!ctx) { std::cerr << "CreateContext failed\n"; return 1; }
-
-    if (!gladLoadGLLoader((GLADloadproc)SDL_GL_GetProcAddress)) {
-        std::cerr << "Failed to initialize GLAD\n";
-        return 1;
-    }
-    std::cout << "OpenGL: " << (const char*)glGetString(GL_VERSION) << "\n";
-
-    // Load OpenGL functions if needed; on many setups gl* from <GL/gl.h> is enough.
-    // Create shaders
-    GLuint vs = compileShader(GL_VERTEX_SHADER, vertexShaderSrc);
-    GLuint fs = compileShader(GL_FRAGMENT_SHADER, fragmentShaderSrc);
-    if (!vs || !fs) return 1;
-    GLuint prog = linkProgram(vs, fs);
-    glDeleteShader(vs); glDeleteShader(fs);
-    if (!prog) return 1;
-
-    // Fullscreen triangle VAO/VBO
-    GLuint vao, vbo;
-    float verts[] = { -1.0f, -1.0f, 3.0f, -1.0f, -1.0f, 3.0f }; // odd trick: single triangle covering screen
-    glGenVertexArrays(1, &vao);
-    glBindVertexArray(vao);
-    glGenBuffers(1, &vbo);
-    glBindBuffer(GL_ARRAY_BUFFER, vbo);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(verts), verts, GL_STATIC_DRAW);
-    glEnableVertexAttribArray(0);
-    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 0, nullptr);
+static void thorFrameConsts(double, FrameParams& fp) {
+    // cardinal directions in path order: +X, +Y, -X, -Y
+    static const float cardinals[4][2] = { { 1.0f, 0.0f }, { 0.0f, 1.0f }, { -1.0f, 0.0f }, { 0.0f, -1.0f } };
+    float z = fp.iPhase[0], zPath = fp.iPhase[1];
+    float warp = std::clamp(fp.warp, 0.0f, 3.0f);
+    float* k = fp.iConsts;
 
-    // Uniform locations
-    GLint locTime = glGetUniformLocation(prog, "uTime");
-    GLint locRes = glGetUniformLocation(prog, "uResolution");
-    GLint locSpeed = glGetUniformLocation(prog, "uSpeed");
-    GLint locWarp = glGetUniformLocation(prog, "warp");
-    GLint locThickness = glGetUniformLocation(prog, "thickness");
-    GLint locColorShift = glGetUniformLocation(prog, "colorShift");
-
-    auto start = std::chrono::high_resolution_clock::now();
-    bool running = true;
-    SDL_Event e;
-    // default params
-    float speed = 6.0f;
-    float warp = 1.0f;
-    float thickness = 0.18f;
-    float colorShift = 0.0f;
-    glViewport(0, 0, w, h);
-    while (running) {
-        while (SDL_PollEvent(&e)) {
-            if (e.type == SDL_QUIT) running = false;
-            if (e.type == SDL_KEYDOWN) {
-                if (e.key.keysym.sym == SDLK_ESCAPE) running = false;
-                if (e.key.keysym.sym == SDLK_UP) speed *= 1.1f;
-                if (e.key.keysym.sym == SDLK_DOWN) speed /= 1.1f;
-                if (e.key.keysym.sym == SDLK_LEFT) warp = std::max(0.1f, warp - 0.1f);
-                if (e.key.keysym.sym == SDLK_RIGHT) warp += 0.1f;
-                if (e.key.keysym.sym == SDLK_z) thickness = std::max(0.01f, thickness - 0.01f);
-                if (e.key.keysym.sym == SDLK_x) thickness += 0.01f;
-                if (e.key.keysym.sym == SDLK_c) colorShift += 0.05f;
-                if (e.key.keysym.sym == SDLK_v) colorShift -= 0.05f;
-            }
-            if (e.type == SDL_WINDOWEVENT && e.window.event == SDL_WINDOWEVENT_SIZE_CHANGED) {
-                w = e.window.data1; h = e.window.data2;
-                glViewport(0, 0, w, h);
-            }
-        }
-
-        auto now = std::chrono::high_resolution_clock::now();
-        std::chrono::duration<float> diff = now - start;
-        float t = diff.count();
-
-        glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
-        glClear(GL_COLOR_BUFFER_BIT);
-
-        glUseProgram(prog);
-        glUniform1f(locTime, t);
-        glUniform2f(locRes, (float)w, (float)h);
-        glUniform1f(locSpeed, speed);
-        glUniform1f(locWarp, warp);
-        glUniform1f(locThickness, thickness);
-        glUniform1f(locColorShift, colorShift);
-        std::cout << "Loc iTime=" << locTime
-            << " uResolution=" << locRes
-            << " speed=" << locSpeed
-            << " warp=" << locWarp
-            << " thickness=" << locThickness
-            << " colorShift=" << locColorShift
-            << "\n";
-        glBindVertexArray(vao);
-        glDrawArrays(GL_TRIANGLES, 0, 3);
-
-        SDL_GL_SwapWindow(win);
-        SDL_Delay(1);
-    }
+    // path center: stronger lateral bows for exaggerated corners
+    const float segLen = 6.0f, bowAmp = 2.4f;
+    float segIdx = std::floor(zPath / segLen);
+    float segFrac = zPath / segLen - segIdx;
+    const float* dir = cardinals[(int)(segIdx - 4.0f * std::floor(segIdx / 4.0f)) & 3];
+    float bowPhase = easeInOut(segFrac);
+    float bow = bowAmp * std::sin(PI * bowPhase) * smoothstep(0.0f, 1.0f, bowPhase);
+    k[0] = (dir[0] * (segFrac * segLen * 0.75f) - dir[1] * bow) * 0.12f; // mild damping
+    k[1] = (dir[1] * (segFrac * segLen * 0.75f) + dir[0] * bow) * 0.12f;
+    // banking: amplify for violent swing
+    float bank = 0.9f * std::sin(0.9f * z);
+    k[2] = std::cos(bank);
+    k[3] = std::sin(bank);
+
+    k[4] = bowPhase;  // the turn ease, easeInOut of the same segment fraction
+    k[5] = 0.6f + 1.6f * warp;
+    k[6] = 1.2f * (0.5f + 0.8f * warp);
+    k[7] = 0.6f + 0.4f * (1.5f - std::clamp(fp.thickness, 0.2f, 2.0f));
+
+    // hammer: loops along the path toward the camera, smaller as it nears
+    float travel = zPath * 1.6f;
+    travel -= 8.0f * std::floor(travel / 8.0f);
+    float zpos = -(travel - std::floor(travel)) * 2.0f + 0.4f;
+    k[8] = zpos;
+    k[9] = mix(0.9f, 0.25f, std::clamp(zpos + 1.0f, 0.0f, 1.0f));
+    // thicker -> softer rings; thinner -> tight crisp rings
+    k[10] = mix(18.0f, 6.0f, smoothstep(0.2f, 2.0f, fp.thickness));
+
+    // simple pseudo-hue rotate: (m + cos * p), the sin term multiplies a zero matrix
+    const float m[3] = { 0.299f, 0.587f, 0.114f };
+    const float p[9] = { 0.701f, -0.587f, -0.114f, -0.299f, 0.413f, -0.114f, -0.3f, -0.588f, 0.886f };
+    float ca = std::cos(fp.colorShift);
+    for (int c = 0; c < 3; ++c)
+        for (int r = 0; r < 3; ++r) k[12 + c * 4 + r] = m[r] + ca * p[c * 3 + r];
+}
 
-    glDeleteBuffers(1, &vbo);
-    glDeleteVertexArrays(1, &vao);
-    glDeleteProgram(prog);
-    SDL_GL_DeleteContext(ctx);
-    SDL_DestroyWindow(win);
-    SDL_Quit();
-    return 0;
-}
\ No newline at end of file
+const EffectDesc thorTunnelEffect = {
+    "thor",
+    "Plasma Time Warp Tunnel - Thor Tunnel",
+    fragmentShaderSrc,
+    { 6.0f, 1.0f, 0.18f, 0.0f }, // speed, warp, thickness, colorShift
+    { 0.009f, 0.9f, 3.0f },      // chromatic aberration: base, warp gain, warp max
+    featureHueShift,
+    { { 1.0, 314.1592653589793, true },  // iPhase.x: travel, waves
+      { 1.0, 120.0, true } },            // iPhase.y: travel, path
+    thorFrameConsts,
+    { 1.0f, 0.9f, 0.3f, 0.9f },  // tone: exposure, gamma, bloom, bloom threshold (the hammer flash)
+};
@@ -0,0 +1,316 @@
+// simd.h
+// 8-wide float type for the CPU renderer, plus the GLSL built-ins the effects
+// use (sin, exp, pow, atan, smoothstep...). Lanes map to AVX2, two SSE2 or
+// two NEON registers, or plain floats, picked at compile time; the math is
+// written once on top of a handful of per-ISA primitives.
+#pragma once
+#include <cstdint>
+#include <cstring>
+#include <cmath>
+
+#if defined(__AVX2__)
+#define TW_SIMD_AVX2 1
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define TW_SIMD_SSE2 1
+#include <emmintrin.h>
+#if defined(__SSE4_1__)
+#include <smmintrin.h>
+#endif
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#define TW_SIMD_NEON 1
+#include <arm_neon.h>
+#endif
+
+namespace simd {
+
+static const int lanes = 8;
+
+namespace detail {
+
+#if TW_SIMD_AVX2
+typedef __m256 N;
+typedef __m256i NI;
+static const int perNative = 8;
+inline N set1(float x) { return _mm256_set1_ps(x); }
+inline N load(const float* p) { return _mm256_loadu_ps(p); }
+inline void store(float* p, N a) { _mm256_storeu_ps(p, a); }
+inline N add(N a, N b) { return _mm256_add_ps(a, b); }
+inline N sub(N a, N b) { return _mm256_sub_ps(a, b); }
+inline N mul(N a, N b) { return _mm256_mul_ps(a, b); }
+inline N div(N a, N b) { return _mm256_div_ps(a, b); }
+inline N min(N a, N b) { return _mm256_min_ps(a, b); }
+inline N max(N a, N b) { return _mm256_max_ps(a, b); }
+inline N sqrt(N a) { return _mm256_sqrt_ps(a); }
+inline N floor(N a) { return _mm256_floor_ps(a); }
+inline N band(N a, N b) { return _mm256_and_ps(a, b); }
+inline N bor(N a, N b) { return _mm256_or_ps(a, b); }
+inline N bxor(N a, N b) { return _mm256_xor_ps(a, b); }
+inline N bandnot(N a, N b) { return _mm256_andnot_ps(a, b); } // ~a & b
+inline N lt(N a, N b) { return _mm256_cmp_ps(a, b, _CMP_LT_OQ); }
+inline N le(N a, N b) { return _mm256_cmp_ps(a, b, _CMP_LE_OQ); }
+inline N eq(N a, N b) { return _mm256_cmp_ps(a, b, _CMP_EQ_OQ); }
+inline bool any(N a) { return _mm256_movemask_ps(a) != 0; }
+inline NI toInt(N a) { return _mm256_cvttps_epi32(a); }
+inline N toFloat(NI a) { return _mm256_cvtepi32_ps(a); }
+inline NI iadd(NI a, NI b) { return _mm256_add_epi32(a, b); }
+inline NI iset1(int x) { return _mm256_set1_epi32(x); }
+inline NI iand(NI a, NI b) { return _mm256_and_si256(a, b); }
+inline NI ior(NI a, NI b) { return _mm256_or_si256(a, b); }
+inline NI shl23(NI a) { return _mm256_slli_epi32(a, 23); }
+inline NI shr23(NI a) { return _mm256_srli_epi32(a, 23); }
+inline N asFloat(NI a) { return _mm256_castsi256_ps(a); }
+inline NI asInt(N a) { return _mm256_castps_si256(a); }
+
+#elif TW_SIMD_SSE2
+typedef __m128 N;
+typedef __m128i NI;
+static const int perNative = 4;
+inline N set1(float x) { return _mm_set1_ps(x); }
+inline N load(const float* p) { return _mm_loadu_ps(p); }
+inline void store(float* p, N a) { _mm_storeu_ps(p, a); }
+inline N add(N a, N b) { return _mm_add_ps(a, b); }
+inline N sub(N a, N b) { return _mm_sub_ps(a, b); }
+inline N mul(N a, N b) { return _mm_mul_ps(a, b); }
+inline N div(N a, N b) { return _mm_div_ps(a, b); }
+inline N min(N a, N b) { return _mm_min_ps(a, b); }
+inline N max(N a, N b) { return _mm_max_ps(a, b); }
+inline N sqrt(N a) { return _mm_sqrt_ps(a); }
+inline N band(N a, N b) { return _mm_and_ps(a, b); }
+inline N bor(N a, N b) { return _mm_or_ps(a, b); }
+inline N bxor(N a, N b) { return _mm_xor_ps(a, b); }
+inline N bandnot(N a, N b) { return _mm_andnot_ps(a, b); }
+inline N lt(N a, N b) { return _mm_cmplt_ps(a, b); }
+inline N le(N a, N b) { return _mm_cmple_ps(a, b); }
+inline N eq(N a, N b) { return _mm_cmpeq_ps(a, b); }
+inline bool any(N a) { return _mm_movemask_ps(a) != 0; }
+inline NI toInt(N a) { return _mm_cvttps_epi32(a); }
+inline N toFloat(NI a) { return _mm_cvtepi32_ps(a); }
+inline NI iadd(NI a, NI b) { return _mm_add_epi32(a, b); }
+inline NI iset1(int x) { return _mm_set1_epi32(x); }
+inline NI iand(NI a, NI b) { return _mm_and_si128(a, b); }
+inline NI ior(NI a, NI b) { return _mm_or_si128(a, b); }
+inline NI shl23(NI a) { return _mm_slli_epi32(a, 23); }
+inline NI shr23(NI a) { return _mm_srli_epi32(a, 23); }
+inline N asFloat(NI a) { return _mm_castsi128_ps(a); }
+inline NI asInt(N a) { return _mm_castps_si128(a); }
+#if defined(__SSE4_1__)
+inline N floor(N a) { return _mm_floor_ps(a); }
+#else
+inline N floor(N a) {
+    // truncate, then step down where that rounded up (negative inputs)
+    N t = toFloat(toInt(a));
+    return sub(t, band(lt(a, t), set1(1.0f)));
+}
+#endif
+
+#elif TW_SIMD_NEON
+typedef float32x4_t N;
+typedef int32x4_t NI;
+static const int perNative = 4;
+inline N set1(float x) { return vdupq_n_f32(x); }
+inline N load(const float* p) { return vld1q_f32(p); }
+inline void store(float* p, N a) { vst1q_f32(p, a); }
+inline N add(N a, N b) { return vaddq_f32(a, b); }
+inline N sub(N a, N b) { return vsubq_f32(a, b); }
+inline N mul(N a, N b) { return vmulq_f32(a, b); }
+inline N div(N a, N b) { return vdivq_f32(a, b); }
+inline N min(N a, N b) { return vminnmq_f32(a, b); }
+inline N max(N a, N b) { return vmaxnmq_f32(a, b); }
+inline N sqrt(N a) { return vsqrtq_f32(a); }
+inline N floor(N a) { return vrndmq_f32(a); }
+inline N band(N a, N b) { return vreinterpretq_f32_u32(vandq_u32(vreinterpretq_u32_f32(a), vreinterpretq_u32_f32(b))); }
+inline N bor(N a, N b) { return vreinterpretq_f32_u32(vorrq_u32(vreinterpretq_u32_f32(a), vreinterpretq_u32_f32(b))); }
+inline N bxor(N a, N b) { return vreinterpretq_f32_u32(veorq_u32(vreinterpretq_u32_f32(a), vreinterpretq_u32_f32(b))); }
+inline N bandnot(N a, N b) { return vreinterpretq_f32_u32(vbicq_u32(vreinterpretq_u32_f32(b), vreinterpretq_u32_f32(a))); }
+inline N lt(N a, N b) { return vreinterpretq_f32_u32(vcltq_f32(a, b)); }
+inline N le(N a, N b) { return vreinterpretq_f32_u32(vcleq_f32(a, b)); }
+inline N eq(N a, N b) { return vreinterpretq_f32_u32(vceqq_f32(a, b)); }
+inline bool any(N a) { return vmaxvq_u32(vreinterpretq_u32_f32(a)) != 0; }
+inline NI toInt(N a) { return vcvtq_s32_f32(a); }
+inline N toFloat(NI a) { return vcvtq_f32_s32(a); }
+inline NI iadd(NI a, NI b) { return vaddq_s32(a, b); }
+inline NI iset1(int x) { return vdupq_n_s32(x); }
+inline NI iand(NI a, NI b) { return vandq_s32(a, b); }
+inline NI ior(NI a, NI b) { return vorrq_s32(a, b); }
+inline NI shl23(NI a) { return vshlq_n_s32(a, 23); }
+inline NI shr23(NI a) { return vreinterpretq_s32_u32(vshrq_n_u32(vreinterpretq_u32_s32(a), 23)); }
+inline N asFloat(NI a) { return vreinterpretq_f32_s32(a); }
+inline NI asInt(N a) { return vreinterpretq_s32_f32(a); }
+
+#else
+// Portable fallback; masks are all-ones bit patterns as on the SIMD paths
+typedef float N;
+typedef int32_t NI;
+static const int perNative = 1;
+inline uint32_t bits(float x) { uint32_t u; std::memcpy(&u, &x, 4); return u; }
+inline float fromBits(uint32_t u) { float x; std::memcpy(&x, &u, 4); return x; }
+inline N set1(float x) { return x; }
+inline N load(const float* p) { return *p; }
+inline void store(float* p, N a) { *p = a; }
+inline N add(N a, N b) { return a + b; }
+inline N sub(N a, N b) { return a - b; }
+inline N mul(N a, N b) { return a * b; }
+inline N div(N a, N b) { return a / b; }
+inline N min(N a, N b) { return a < b ? a : b; } // NaN in a gives b, as minps does
+inline N max(N a, N b) { return a > b ? a : b; }
+inline N sqrt(N a) { return std::sqrt(a); }
+inline N floor(N a) { return std::floor(a); }
+inline N band(N a, N b) { return fromBits(bits(a) & bits(b)); }
+inline N bor(N a, N b) { return fromBits(bits(a) | bits(b)); }
+inline N bxor(N a, N b) { return fromBits(bits(a) ^ bits(b)); }
+inline N bandnot(N a, N b) { return fromBits(~bits(a) & bits(b)); }
+inline N lt(N a, N b) { return fromBits(a < b ? ~0u : 0u); }
+inline N le(N a, N b) { return fromBits(a <= b ? ~0u : 0u); }
+inline N eq(N a, N b) { return fromBits(a == b ? ~0u : 0u); }
+inline bool any(N a) { return bits(a) != 0; }
+inline NI toInt(N a) { return (NI)a; }
+inline N toFloat(NI a) { return (float)a; }
+inline NI iadd(NI a, NI b) { return (NI)((uint32_t)a + (uint32_t)b); }
+inline NI iset1(int x) { return x; }
+inline NI iand(NI a, NI b) { return a & b; }
+inline NI ior(NI a, NI b) { return a | b; }
+inline NI shl23(NI a) { return (NI)((uint32_t)a << 23); }
+inline NI shr23(NI a) { return (NI)((uint32_t)a >> 23); }
+inline N asFloat(NI a) { return fromBits((uint32_t)a); }
+inline NI asInt(N a) { return (NI)bits(a); }
+#endif
+
+static const int natives = lanes / perNative;
+
+} // namespace detail
+
+#define TW_SIMD_EACH(expr) for (int k = 0; k < detail::natives; ++k) r.v[k] = (expr)
+
+// Eight floats; comparisons return masks of the same type (all bits set per true lane)
+struct vfloat {
+    detail::N v[detail::natives];
+    vfloat() = default;
+    vfloat(float x) { for (int k = 0; k < detail::natives; ++k) v[k] = detail::set1(x); }
+    static vfloat load(const float* p) {
+        vfloat r;
+        TW_SIMD_EACH(detail::load(p + k * detail::perNative));
+        return r;
+    }
+    void store(float* p) const {
+        for (int k = 0; k < detail::natives; ++k) detail::store(p + k * detail::perNative, v[k]);
+    }
+};
+
+struct vint {
+    detail::NI v[detail::natives];
+};
+
+inline vfloat operator+(vfloat a, vfloat b) { vfloat r; TW_SIMD_EACH(detail::add(a.v[k], b.v[k])); return r; }
+inline vfloat operator-(vfloat a, vfloat b) { vfloat r; TW_SIMD_EACH(detail::sub(a.v[k], b.v[k])); return r; }
+inline vfloat operator*(vfloat a, vfloat b) { vfloat r; TW_SIMD_EACH(detail::mul(a.v[k], b.v[k])); return r; }
+inline vfloat operator/(vfloat a, vfloat b) { vfloat r; TW_SIMD_EACH(detail::div(a.v[k], b.v[k])); return r; }
+inline vfloat operator-(vfloat a) { return vfloat(0.0f) - a; }
+inline vfloat& operator+=(vfloat& a, vfloat b) { return a = a + b; }
+inline vfloat& operator-=(vfloat& a, vfloat b) { return a = a - b; }
+inline vfloat& operator*=(vfloat& a, vfloat b) { return a = a * b; }
+inline vfloat operator<(vfloat a, vfloat b) { vfloat r; TW_SIMD_EACH(detail::lt(a.v[k], b.v[k])); return r; }
+inline vfloat operator<=(vfloat a, vfloat b) { vfloat r; TW_SIMD_EACH(detail::le(a.v[k], b.v[k])); return r; }
+inline vfloat operator>(vfloat a, vfloat b) { return b < a; }
+inline vfloat operator>=(vfloat a, vfloat b) { return b <= a; }
+inline vfloat operator==(vfloat a, vfloat b) { vfloat r; TW_SIMD_EACH(detail::eq(a.v[k], b.v[k])); return r; }
+inline vfloat operator&(vfloat a, vfloat b) { vfloat r; TW_SIMD_EACH(detail::band(a.v[k], b.v[k])); return r; }
+inline vfloat operator|(vfloat a, vfloat b) { vfloat r; TW_SIMD_EACH(detail::bor(a.v[k], b.v[k])); return r; }
+inline vfloat andNot(vfloat a, vfloat b) { vfloat r; TW_SIMD_EACH(detail::bandnot(a.v[k], b.v[k])); return r; } // ~a & b
+
+inline bool any(vfloat m) {
+    for (int k = 0; k < detail::natives; ++k) if (detail::any(m.v[k])) return true;
+    return false;
+}
+
+// m ? a : b per lane
+inline vfloat select(vfloat m, vfloat a, vfloat b) { return (m & a) | andNot(m, b); }
+
+inline vfloat min(vfloat a, vfloat b) { vfloat r; TW_SIMD_EACH(detail::min(a.v[k], b.v[k])); return r; }
+inline vfloat max(vfloat a, vfloat b) { vfloat r; TW_SIMD_EACH(detail::max(a.v[k], b.v[k])); return r; }
+inline vfloat sqrt(vfloat a) { vfloat r; TW_SIMD_EACH(detail::sqrt(a.v[k])); return r; }
+inline vfloat floor(vfloat a) { vfloat r; TW_SIMD_EACH(detail::floor(a.v[k])); return r; }
+inline vfloat abs(vfloat a) { return andNot(vfloat(-0.0f), a); }
+inline vfloat fract(vfloat a) { return a - floor(a); }
+inline vfloat mod(vfloat a, vfloat b) { return a - b * floor(a / b); }
+inline vfloat clamp(vfloat x, vfloat lo, vfloat hi) { return min(max(x, lo), hi); }
+inline vfloat mix(vfloat a, vfloat b, vfloat t) { return a + (b - a) * t; }
+inline vfloat smoothstep(vfloat e0, vfloat e1, vfloat x) {
+    vfloat t = clamp((x - e0) / (e1 - e0), 0.0f, 1.0f);
+    return t * t * (3.0f - 2.0f * t);
+}
+inline vfloat length(vfloat x, vfloat y) { return sqrt(x * x + y * y); }
+
+// 2^n for integral n in [-126, 127]
+inline vfloat exp2i(vfloat n) {
+    vfloat r;
+    TW_SIMD_EACH(detail::asFloat(detail::shl23(detail::iadd(detail::toInt(n.v[k]), detail::iset1(127)))));
+    return r;
+}
+
+inline vfloat exp2(vfloat x) {
+    x = clamp(x, -126.0f, 126.0f);
+    vfloat n = floor(x + 0.5f);
+    vfloat f = (x - n) * 0.69314718f; // |f| <= ln2 / 2
+    vfloat p = 1.0f + f * (1.0f + f * (0.5f + f * (1.6666667e-1f + f * (4.1666668e-2f + f * (8.3333338e-3f + f * 1.3888889e-3f)))));
+    return p * exp2i(n);
+}
+
+inline vfloat exp(vfloat x) { return exp2(x * 1.44269504f); }
+
+// log2 for x > 0
+inline vfloat log2(vfloat x) {
+    vfloat e, m;
+    for (int k = 0; k < detail::natives; ++k) {
+        detail::NI b = detail::asInt(x.v[k]);
+        e.v[k] = detail::toFloat(detail::iadd(detail::shr23(detail::iand(b, detail::iset1(0x7f800000))), detail::iset1(-127)));
+        m.v[k] = detail::asFloat(detail::ior(detail::iand(b, detail::iset1(0x007fffff)), detail::iset1(0x3f800000)));
+    }
+    // mantissa into [sqrt(1/2), sqrt(2)) so the series converges quickly
+    vfloat big = m > 1.41421356f;
+    m = select(big, m * 0.5f, m);
+    e = e + (big & vfloat(1.0f));
+    vfloat u = (m - 1.0f) / (m + 1.0f), u2 = u * u;
+    vfloat ln = 2.0f * u * (1.0f + u2 * (0.33333333f + u2 * (0.2f + u2 * (0.14285715f + u2 * 0.11111111f))));
+    return e + ln * 1.44269504f;
+}
+
+// GLSL pow: x <= 0 gives 0 here (undefined in GLSL, 0 on the GPUs we target for y > 0)
+inline vfloat pow(vfloat x, vfloat y) {
+    vfloat r = exp2(y * log2(max(x, 1e-30f)));
+    return select(x > 0.0f, r, 0.0f);
+}
+
+inline void sincos(vfloat x, vfloat& s, vfloat& c) {
+    // quadrant, then Cody-Waite reduction by pi/2 in three parts
+    vfloat j = floor(x * 0.63661977f + 0.5f);
+    vfloat r = ((x - j * 1.5703125f) - j * 4.837512969970703125e-4f) - j * 7.54978995489188216e-8f;
+    vfloat r2 = r * r;
+    vfloat sp = r + r * r2 * (-1.6666654611e-1f + r2 * (8.3321608736e-3f + r2 * -1.9515295891e-4f));
+    vfloat cp = 1.0f - 0.5f * r2 + r2 * r2 * (4.166664568298827e-2f + r2 * (-1.388731625493765e-3f + r2 * 2.443315711809948e-5f));
+    vfloat q = j - 4.0f * floor(j * 0.25f); // 0..3
+    vfloat swap = (q == 1.0f) | (q == 3.0f);
+    vfloat sinNeg = q >= 2.0f;
+    vfloat cosNeg = (q == 1.0f) | (q == 2.0f);
+    vfloat ss = select(swap, cp, sp), cc = select(swap, sp, cp);
+    s = select(sinNeg, -ss, ss);
+    c = select(cosNeg, -cc, cc);
+}
+
+inline vfloat sin(vfloat x) { vfloat s, c; sincos(x, s, c); return s; }
+inline vfloat cos(vfloat x) { vfloat s, c; sincos(x, s, c); return c; }
+
+// GLSL atan(y, x); 0 where both are 0
+inline vfloat atan2(vfloat y, vfloat x) {
+    vfloat ax = abs(x), ay = abs(y);
+    vfloat a = min(ax, ay) / max(max(ax, ay), 1e-30f);
+    vfloat s = a * a;
+    vfloat r = a * (0.99997726f + s * (-0.33262347f + s * (0.19354346f + s * (-0.11643287f + s * (0.05265332f + s * -0.01172120f)))));
+    r = select(ay > ax, 1.57079633f - r, r);
+    r = select(x < 0.0f, 3.14159265f - r, r);
+    return select(y < 0.0f, -r, r);
+}
+
+#undef TW_SIMD_EACH
+
+} // namespace simd
@@ -0,0 +1,276 @@
+// telemetry.cpp
+// Log ring, counter table, the drain/sample thread and the local socket.
+
+#ifdef _WIN32
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#pragma comment(lib, "ws2_32.lib")
+typedef SOCKET socket_t;
+static const socket_t noSocket = INVALID_SOCKET;
+static void closeSocket(socket_t s) { closesocket(s); }
+static void setNonBlocking(socket_t s) { u_long on = 1; ioctlsocket(s, FIONBIO, &on); }
+static const int sendFlags = 0;
+#else
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <unistd.h>
+typedef int socket_t;
+static const socket_t noSocket = -1;
+static void closeSocket(socket_t s) { close(s); }
+static void setNonBlocking(socket_t s) { fcntl(s, F_SETFL, fcntl(s, F_GETFL, 0) | O_NONBLOCK); }
+static const int sendFlags = MSG_NOSIGNAL;
+#endif
+
+#include "telemetry.h"
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstdarg>
+#include <cstdlib>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+static const size_t ringSlots = 512;      // power of two
+static const size_t messageBytes = 240;
+static const int maxCounters = 64;
+static const int drainIntervalMs = 10;
+
+static const char* levelNames[] = { "error", "warn", "info", "debug" };
+
+// Bounded multi-producer queue (per-slot sequence numbers); one consumer
+struct LogSlot {
+    std::atomic<size_t> seq{0};
+    LogLevel level = LogLevel::Info;
+    char text[messageBytes];
+};
+
+static struct {
+    LogSlot slots[ringSlots];
+    std::atomic<size_t> enqueuePos{0};
+    size_t dequeuePos = 0;             // drain thread only
+    std::atomic<uint32_t> dropped{0};
+} ring;
+
+static struct {
+    std::mutex registerLock;           // registration only, never on the sampling path
+    const char* names[maxCounters] = {};
+    std::atomic<double> values[maxCounters];
+    std::atomic<int> count{0};
+} counters;
+
+static struct {
+    std::atomic<int> level{(int)LogLevel::Info};
+    std::atomic<bool> running{false};
+    TelemetryOptions opts;
+    std::thread thread;
+    socket_t listener = noSocket;
+    std::vector<socket_t> clients;
+    std::chrono::steady_clock::time_point start;
+    uint32_t reportedDrops = 0;
+} tel;
+
+static struct RingInit {
+    RingInit() { for (size_t i = 0; i < ringSlots; ++i) ring.slots[i].seq.store(i, std::memory_order_relaxed); }
+} ringInit;
+
+bool parseLogLevel(const char* name, LogLevel& level) {
+    for (int i = 0; i < 4; ++i) {
+        if (std::strcmp(name, levelNames[i]) == 0) {
+            level = (LogLevel)i;
+            return true;
+        }
+    }
+    return false;
+}
+
+static void writeMessage(LogLevel level, const char* text) {
+    std::ostream& out = level <= LogLevel::Warn ? std::cerr : std::cout;
+    out << text << '\n';
+}
+
+void telemetryLog(LogLevel level, const char* fmt, ...) {
+    if ((int)level > tel.level.load(std::memory_order_relaxed)) return;
+    va_list args;
+    va_start(args, fmt);
+    if (!tel.running.load(std::memory_order_acquire)) {
+        char text[messageBytes];
+        std::vsnprintf(text, sizeof(text), fmt, args);
+        va_end(args);
+        writeMessage(level, text);
+        return;
+    }
+    size_t pos = ring.enqueuePos.load(std::memory_order_relaxed);
+    LogSlot* slot;
+    for (;;) {
+        slot = &ring.slots[pos & (ringSlots - 1)];
+        size_t seq = slot->seq.load(std::memory_order_acquire);
+        if (seq == pos) {
+            if (ring.enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+        } else if (seq < pos) {
+            // full: the drain thread is that far behind
+            ring.dropped.fetch_add(1, std::memory_order_relaxed);
+            va_end(args);
+            return;
+        } else {
+            pos = ring.enqueuePos.load(std::memory_order_relaxed);
+        }
+    }
+    slot->level = level;
+    std::vsnprintf(slot->text, messageBytes, fmt, args);
+    va_end(args);
+    slot->seq.store(pos + 1, std::memory_order_release);
+}
+
+int telemetryCounter(const char* name) {
+    std::lock_guard<std::mutex> lock(counters.registerLock);
+    int n = counters.count.load(std::memory_order_relaxed);
+    for (int i = 0; i < n; ++i)
+        if (std::strcmp(counters.names[i], name) == 0) return i;
+    if (n == maxCounters) return -1;
+    counters.names[n] = name;
+    counters.values[n].store(0.0, std::memory_order_relaxed);
+    counters.count.store(n + 1, std::memory_order_release);
+    return n;
+}
+
+void setTelemetryCounter(int id, double value) {
+    if (id >= 0) counters.values[id].store(value, std::memory_order_relaxed);
+}
+
+double telemetryCounterValue(int id) {
+    if (id < 0 || id >= counters.count.load(std::memory_order_acquire)) return 0.0;
+    return counters.values[id].load(std::memory_order_relaxed);
+}
+
+static void drainLog() {
+    for (;;) {
+        LogSlot& slot = ring.slots[ring.dequeuePos & (ringSlots - 1)];
+        if (slot.seq.load(std::memory_order_acquire) != ring.dequeuePos + 1) break;
+        writeMessage(slot.level, slot.text);
+        slot.seq.store(ring.dequeuePos + ringSlots, std::memory_order_release);
+        ++ring.dequeuePos;
+    }
+    uint32_t dropped = ring.dropped.load(std::memory_order_relaxed);
+    if (dropped != tel.reportedDrops) {
+        tel.reportedDrops = dropped;
+        std::cerr << "Telemetry: log ring full, " << dropped << " messages dropped so far\n";
+    }
+}
+
+static std::string sampleJson(double seconds) {
+    char buf[64];
+    std::snprintf(buf, sizeof(buf), "{\"t\":%.3f", seconds);
+    std::string line = buf;
+    int n = counters.count.load(std::memory_order_acquire);
+    for (int i = 0; i < n; ++i) {
+        std::snprintf(buf, sizeof(buf), ",\"%s\":%.6g", counters.names[i], counters.values[i].load(std::memory_order_relaxed));
+        line += buf;
+    }
+    line += "}\n";
+    return line;
+}
+
+static bool openListener(int port) {
+#ifdef _WIN32
+    WSADATA wsa;
+    if (WSAStartup(MAKEWORD(2, 2), &wsa) != 0) return false;
+#endif
+    tel.listener = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+    if (tel.listener == noSocket) return false;
+    int reuse = 1;
+    setsockopt(tel.listener, SOL_SOCKET, SO_REUSEADDR, (const char*)&reuse, sizeof(reuse));
+    sockaddr_in addr = {};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons((unsigned short)port);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);  // local tools only
+    if (bind(tel.listener, (const sockaddr*)&addr, sizeof(addr)) != 0 || listen(tel.listener, 4) != 0) {
+        closeSocket(tel.listener);
+        tel.listener = noSocket;
+        return false;
+    }
+    setNonBlocking(tel.listener);
+    return true;
+}
+
+static void serveSample(const std::string& line) {
+    for (;;) {
+        socket_t c = accept(tel.listener, nullptr, nullptr);
+        if (c == noSocket) break;
+        setNonBlocking(c);
+        tel.clients.push_back(c);
+    }
+    for (size_t i = 0; i < tel.clients.size();) {
+        // a client that can't keep up loses the line rather than holding the thread
+        int sent = (int)send(tel.clients[i], line.data(), (int)line.size(), sendFlags);
+        bool wouldBlock = false;
+#ifdef _WIN32
+        wouldBlock = sent < 0 && WSAGetLastError() == WSAEWOULDBLOCK;
+#else
+        wouldBlock = sent < 0 && (errno == EAGAIN || errno == EWOULDBLOCK);
+#endif
+        if (sent < 0 && !wouldBlock) {
+            closeSocket(tel.clients[i]);
+            tel.clients.erase(tel.clients.begin() + i);
+        } else {
+            ++i;
+        }
+    }
+}
+
+static void telemetryThread() {
+    using clock = std::chrono::steady_clock;
+    double hz = tel.opts.sampleHz > 0.0 ? tel.opts.sampleHz : 10.0;
+    auto period = std::chrono::duration_cast<clock::duration>(std::chrono::duration<double>(1.0 / hz));
+    auto nextSample = clock::now() + period;
+    while (tel.running.load(std::memory_order_acquire)) {
+        drainLog();
+        auto now = clock::now();
+        if (now >= nextSample && (tel.opts.sampleHz > 0.0 || tel.listener != noSocket)) {
+            nextSample += period;
+            if (nextSample < now) nextSample = now + period;  // after a stall, don't burst
+            std::string line = sampleJson(std::chrono::duration<double>(now - tel.start).count());
+            if (tel.opts.sampleHz > 0.0) std::cout << line;
+            if (tel.listener != noSocket) serveSample(line);
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(drainIntervalMs));
+    }
+    drainLog();
+}
+
+bool startTelemetry(const TelemetryOptions& opts) {
+    tel.opts = opts;
+    tel.level.store((int)opts.level, std::memory_order_relaxed);
+    tel.start = std::chrono::steady_clock::now();
+    if (opts.port > 0) {
+        if (openListener(opts.port)) std::cout << "Telemetry: counters on 127.0.0.1:" << opts.port << "\n";
+        else std::cerr << "Telemetry: cannot listen on port " << opts.port << "\n";
+    }
+    tel.running.store(true, std::memory_order_release);
+    tel.thread = std::thread(telemetryThread);
+    // early error returns from main still flush and join
+    static bool registered = false;
+    if (!registered) registered = std::atexit(stopTelemetry) == 0;
+    return true;
+}
+
+void stopTelemetry() {
+    if (!tel.running.load()) return;
+    tel.running.store(false, std::memory_order_release);
+    tel.thread.join();
+    for (socket_t c : tel.clients) closeSocket(c);
+    tel.clients.clear();
+    if (tel.listener != noSocket) {
+        closeSocket(tel.listener);
+        tel.listener = noSocket;
+#ifdef _WIN32
+        WSACleanup();
+#endif
+    }
+}
@@ -0,0 +1,36 @@
+// telemetry.h
+// Logging and live counters that stay off the frame. telemetryLog formats
+// into a slot of a preallocated lock-free ring and returns; a background
+// thread writes the messages out, so a slow console never stalls a frame.
+// Messages below the level are dropped before they are formatted. Counters
+// (fps, GPU ms, params...) are plain atomics the frame stores into; the same
+// thread samples them at a fixed rate to the console and/or to local TCP
+// clients as one JSON object per line.
+#pragma once
+
+enum class LogLevel { Error, Warn, Info, Debug };
+
+bool parseLogLevel(const char* name, LogLevel& level);
+
+struct TelemetryOptions {
+    LogLevel level = LogLevel::Info;
+    double sampleHz = 0.0;  // counters to the console at this rate; 0 = off
+    int port = 0;           // serve counters on 127.0.0.1:port; 0 = off
+};
+
+// Until this runs, and after stopTelemetry, telemetryLog writes directly
+bool startTelemetry(const TelemetryOptions& opts);
+// Writes whatever is still queued and closes the socket
+void stopTelemetry();
+
+// printf-style, from any thread; never blocks or allocates. A full ring
+// drops the message and counts it.
+void telemetryLog(LogLevel level, const char* fmt, ...);
+
+// Registers a counter and returns its id; name must stay valid (a literal).
+// Registering the same name again returns the same id.
+int telemetryCounter(const char* name);
+// Any thread, one relaxed store
+void setTelemetryCounter(int id, double value);
+// The last value stored, 0 for an unknown id; any thread
+double telemetryCounterValue(int id);
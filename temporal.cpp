@@ -0,0 +1,142 @@
+// temporal.cpp
+// Per-view targets and march-state history for temporal accumulation.
+
+#include "temporal.h"
+#include <iostream>
+#include <vector>
+
+// Past this gap (a stall, a seek, a paused export) the history is too far off
+static const float maxHistoryDt = 0.25f;
+
+struct TemporalSlot {
+    GLuint color = 0;        // RGBA16F like the scene, copied out at endTemporal
+    GLuint state[2] = {};    // RGBA16F march integrals, ping-pong
+    GLuint depth[2] = {};    // R16F march depth, ping-pong
+    GLuint fbo[2] = {};      // colour, state[i], depth[i]
+    int w = 0, h = 0;
+    int current = 0;         // pair written this frame
+    const void* effect = nullptr;
+    double time = 0.0;
+    int rw = 0, rh = 0;
+    bool valid = false;      // the other pair holds a usable frame
+};
+
+static struct {
+    bool initialized = false;
+    std::vector<TemporalSlot> slots;
+    int w = 0, h = 0;
+    int active = -1;
+    GLint prevFbo = 0;
+    GLint prevViewport[4] = {};
+} tp;
+
+static void allocTexture(GLuint tex, GLenum internalFormat, GLenum format, GLenum type, int w, int h) {
+    glBindTexture(GL_TEXTURE_2D, tex);
+    glTexImage2D(GL_TEXTURE_2D, 0, internalFormat, w, h, 0, format, type, nullptr);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+}
+
+static void allocSlot(TemporalSlot& s, int w, int h) {
+    s.w = w; s.h = h;
+    s.valid = false;
+    allocTexture(s.color, GL_RGBA16F, GL_RGBA, GL_FLOAT, w, h);
+    for (int i = 0; i < 2; ++i) {
+        allocTexture(s.state[i], GL_RGBA16F, GL_RGBA, GL_FLOAT, w, h);
+        allocTexture(s.depth[i], GL_R16F, GL_RED, GL_FLOAT, w, h);
+    }
+}
+
+static bool createSlot(TemporalSlot& s, int w, int h) {
+    glGenTextures(1, &s.color);
+    glGenTextures(2, s.state);
+    glGenTextures(2, s.depth);
+    allocSlot(s, w, h);
+
+    static const GLenum drawBuffers[] = { GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1, GL_COLOR_ATTACHMENT2 };
+    glGenFramebuffers(2, s.fbo);
+    bool complete = true;
+    for (int i = 0; i < 2; ++i) {
+        glBindFramebuffer(GL_FRAMEBUFFER, s.fbo[i]);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, s.color, 0);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT1, GL_TEXTURE_2D, s.state[i], 0);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT2, GL_TEXTURE_2D, s.depth[i], 0);
+        glDrawBuffers(3, drawBuffers);
+        complete = complete && glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE;
+    }
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    return complete;
+}
+
+static void destroySlot(TemporalSlot& s) {
+    glDeleteFramebuffers(2, s.fbo);
+    glDeleteTextures(1, &s.color);
+    glDeleteTextures(2, s.state);
+    glDeleteTextures(2, s.depth);
+    s = TemporalSlot{};
+}
+
+bool initTemporal(int w, int h) {
+    tp.w = w; tp.h = h;
+    tp.initialized = true;
+    return true;
+}
+
+void shutdownTemporal() {
+    for (TemporalSlot& s : tp.slots) destroySlot(s);
+    tp.slots.clear();
+    tp.initialized = false;
+}
+
+void resizeTemporal(int w, int h) {
+    tp.w = w; tp.h = h;
+    for (TemporalSlot& s : tp.slots) allocSlot(s, w, h);
+}
+
+float beginTemporal(int slot, const void* effect, double time, int rw, int rh) {
+    if (!tp.initialized) return 0.0f;
+    // slots are created the first time a view draws temporally
+    while ((int)tp.slots.size() <= slot) {
+        tp.slots.emplace_back();
+        if (!createSlot(tp.slots.back(), tp.w, tp.h)) {
+            std::cerr << "Temporal target " << tp.w << "x" << tp.h << " incomplete, temporal accumulation off\n";
+            shutdownTemporal();
+            return 0.0f;
+        }
+    }
+    TemporalSlot& s = tp.slots[slot];
+    float dt = (float)(time - s.time);
+    bool usable = s.valid && s.effect == effect && s.rw == rw && s.rh == rh && dt > 0.0f && dt < maxHistoryDt;
+    s.current ^= 1;
+    s.effect = effect;
+    s.time = time;
+    s.rw = rw; s.rh = rh;
+    tp.active = slot;
+
+    glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &tp.prevFbo);
+    glGetIntegerv(GL_VIEWPORT, tp.prevViewport);
+    glBindFramebuffer(GL_FRAMEBUFFER, s.fbo[s.current]);
+    glViewport(0, 0, rw, rh);
+    glActiveTexture(GL_TEXTURE0 + temporalHistoryUnit);
+    glBindTexture(GL_TEXTURE_2D, s.state[s.current ^ 1]);
+    glActiveTexture(GL_TEXTURE0 + temporalHistoryDepthUnit);
+    glBindTexture(GL_TEXTURE_2D, s.depth[s.current ^ 1]);
+    glActiveTexture(GL_TEXTURE0);
+    return usable ? dt : 0.0f;
+}
+
+void endTemporal() {
+    if (tp.active < 0) return;
+    TemporalSlot& s = tp.slots[tp.active];
+    tp.active = -1;
+    s.valid = true;
+
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, s.fbo[s.current]);
+    glReadBuffer(GL_COLOR_ATTACHMENT0);
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, (GLuint)tp.prevFbo);
+    glBlitFramebuffer(0, 0, s.rw, s.rh, 0, 0, s.rw, s.rh, GL_COLOR_BUFFER_BIT, GL_NEAREST);
+    glBindFramebuffer(GL_FRAMEBUFFER, (GLuint)tp.prevFbo);
+    glViewport(tp.prevViewport[0], tp.prevViewport[1], tp.prevViewport[2], tp.prevViewport[3]);
+}
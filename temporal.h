@@ -0,0 +1,34 @@
+// temporal.h
+// Temporal accumulation for the raymarched glow of circles and twirl. Built
+// with TEMPORAL 1 (shader-variants.h), an effect marches only every other
+// 8x8 tile each frame, in a checkerboard that flips per frame. The other
+// tiles take last frame's march result (accum, glow and depth) reprojected
+// through the known camera motion, and marched tiles blend with it. Whole
+// tiles rather than single pixels take one path, so a SIMD group never
+// splits and the skipped half of the march is really saved.
+//
+// The effect writes its colour and the march state to two attachments of a
+// target owned here; endTemporal copies the colour to whatever framebuffer
+// was bound at begin, so it nests inside dynamic resolution and the
+// aberration pass. The march state ping-pongs between frames.
+#pragma once
+#include "gl-util.h"
+
+// Units the previous frame's march state is bound to (noise uses 1)
+static const int temporalHistoryUnit = 2;      // iHistory: RGBA16F integrals
+static const int temporalHistoryDepthUnit = 3; // iHistoryDepth: R16F march depth
+
+bool initTemporal(int w, int h);
+void shutdownTemporal();
+
+// Window resize: reallocates every slot and drops their history
+void resizeTemporal(int w, int h);
+
+// Redirects the draw into slot's target (one slot per output view) and binds
+// the history. Returns the seconds since the frame the history holds, or 0
+// when it can't be used (first frame, a different effect, a new render size
+// or a time jump); pass it to updateEffectFrame.
+float beginTemporal(int slot, const void* effect, double time, int rw, int rh);
+// Copies the colour into the framebuffer bound at begin and keeps the march
+// state for the next frame
+void endTemporal();
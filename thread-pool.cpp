@@ -0,0 +1,151 @@
+// thread-pool.cpp
+// Per-worker deques with stealing, one sleep condition for idle workers.
+
+#include "thread-pool.h"
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <deque>
+#include <vector>
+#include <memory>
+#include <algorithm>
+
+struct Batch {
+    const std::function<void(int)>* fn = nullptr;
+    std::atomic<int> remaining{ 0 };
+    std::mutex mutex;
+    std::condition_variable done;
+    bool finished = false;
+};
+
+struct Task {
+    Batch* batch;
+    int index;
+};
+
+struct WorkQueue {
+    std::mutex mutex;
+    std::deque<Task> tasks;
+};
+
+static struct {
+    bool initialized = false;
+    std::vector<std::unique_ptr<WorkQueue>> queues; // one per worker thread
+    std::vector<std::thread> threads;
+    std::mutex sleepMutex;
+    std::condition_variable wake;
+    std::atomic<int> queued{ 0 };
+    bool quit = false;
+} pool;
+
+static bool popOwn(int self, Task& task) {
+    WorkQueue& q = *pool.queues[self];
+    std::lock_guard<std::mutex> lock(q.mutex);
+    if (q.tasks.empty()) return false;
+    task = q.tasks.back();
+    q.tasks.pop_back();
+    return true;
+}
+
+// Takes the oldest task of any queue, starting after 'self' (-1 for the caller)
+static bool steal(int self, Task& task) {
+    int n = (int)pool.queues.size();
+    for (int k = 1; k <= n; ++k) {
+        int victim = (self + k + n) % n;
+        if (victim == self) continue;
+        WorkQueue& q = *pool.queues[victim];
+        std::lock_guard<std::mutex> lock(q.mutex);
+        if (q.tasks.empty()) continue;
+        task = q.tasks.front();
+        q.tasks.pop_front();
+        return true;
+    }
+    return false;
+}
+
+static void runTask(const Task& task) {
+    pool.queued.fetch_sub(1);
+    Batch& b = *task.batch;
+    (*b.fn)(task.index);
+    if (b.remaining.fetch_sub(1) == 1) {
+        // notify under the lock: the owner may return as soon as it can take it
+        std::lock_guard<std::mutex> lock(b.mutex);
+        b.finished = true;
+        b.done.notify_all();
+    }
+}
+
+static void workerMain(int self) {
+    for (;;) {
+        Task task;
+        if (popOwn(self, task) || steal(self, task)) {
+            runTask(task);
+            continue;
+        }
+        std::unique_lock<std::mutex> lock(pool.sleepMutex);
+        pool.wake.wait(lock, [] { return pool.quit || pool.queued.load() > 0; });
+        if (pool.quit) break;
+    }
+}
+
+void initThreadPool(int threads) {
+    if (pool.initialized) return;
+    if (threads <= 0) threads = (int)std::max(1u, std::thread::hardware_concurrency());
+    int workers = threads - 1; // the caller is the last one
+    pool.quit = false;
+    for (int i = 0; i < workers; ++i) pool.queues.push_back(std::make_unique<WorkQueue>());
+    for (int i = 0; i < workers; ++i) pool.threads.emplace_back(workerMain, i);
+    pool.initialized = true;
+}
+
+void shutdownThreadPool() {
+    if (!pool.initialized) return;
+    {
+        std::lock_guard<std::mutex> lock(pool.sleepMutex);
+        pool.quit = true;
+    }
+    pool.wake.notify_all();
+    for (std::thread& t : pool.threads) t.join();
+    pool.threads.clear();
+    pool.queues.clear();
+    pool.initialized = false;
+}
+
+int threadPoolSize() {
+    return pool.initialized ? (int)pool.threads.size() + 1 : 1;
+}
+
+void parallelFor(int count, const std::function<void(int)>& fn) {
+    if (count <= 0) return;
+    if (!pool.initialized || pool.queues.empty() || count == 1) {
+        for (int i = 0; i < count; ++i) fn(i);
+        return;
+    }
+
+    Batch batch;
+    batch.fn = &fn;
+    batch.remaining = count;
+    // contiguous runs per worker keep neighbouring tiles together until stolen
+    int n = (int)pool.queues.size();
+    pool.queued.fetch_add(count);
+    for (int w = 0; w < n; ++w) {
+        int begin = (int)((long long)count * w / n), end = (int)((long long)count * (w + 1) / n);
+        if (begin == end) continue;
+        WorkQueue& q = *pool.queues[w];
+        std::lock_guard<std::mutex> lock(q.mutex);
+        // pushed in reverse so the owner's back-pops walk its run forwards
+        for (int i = end - 1; i >= begin; --i) q.tasks.push_back(Task{ &batch, i });
+    }
+    {
+        // a worker between its check of 'queued' and its wait holds this; the notify can't slip past it
+        std::lock_guard<std::mutex> lock(pool.sleepMutex);
+    }
+    pool.wake.notify_all();
+
+    Task task;
+    while (batch.remaining.load() > 0 && steal(-1, task)) runTask(task);
+
+    std::unique_lock<std::mutex> lock(batch.mutex);
+    batch.done.wait(lock, [&] { return batch.finished; });
+}
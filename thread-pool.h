@@ -0,0 +1,18 @@
+// thread-pool.h
+// Work-stealing thread pool for the CPU renderer. Each worker owns a deque:
+// it pops its own tasks from the back and, once empty, steals from the front
+// of the others, so uneven tiles (a raymarch that ends early next to one that
+// runs all its steps) still keep every core busy. The calling thread helps
+// until its batch is done.
+#pragma once
+#include <functional>
+
+// threads <= 0 uses one per hardware thread, the caller included
+void initThreadPool(int threads = 0);
+void shutdownThreadPool();
+// Threads that run tasks, counting the caller; 1 if the pool isn't started
+int threadPoolSize();
+
+// Runs fn(0) .. fn(count - 1) across the pool and returns when all are done.
+// Runs inline if the pool isn't started.
+void parallelFor(int count, const std::function<void(int)>& fn);
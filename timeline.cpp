@@ -0,0 +1,262 @@
+// timeline.cpp
+// Memory-mapped keyframe tracks and their per-frame evaluation.
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#include "timeline.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+static const char* paramNames[] = { "speed", "warp", "thickness", "colorShift" };
+static const char* curveNames[] = { "step", "linear", "ease", "cubic" };
+
+static struct {
+    const uint8_t* data = nullptr;
+    size_t size = 0;
+#ifdef _WIN32
+    HANDLE file = INVALID_HANDLE_VALUE;
+    HANDLE mapping = nullptr;
+#endif
+    // points into the mapping; null where a parameter has no track
+    const TimelineKey* keys[timelineParamCount] = {};
+    uint32_t keyCount[timelineParamCount] = {};
+    double length = 0.0;
+    std::vector<double> travel; // integral of the speed track up to each of its keys
+} tl;
+
+static int findName(const char* const* names, int count, const std::string& name) {
+    for (int i = 0; i < count; ++i)
+        if (name == names[i]) return i;
+    return -1;
+}
+
+bool buildTimeline(const char* textPath, const char* binaryPath) {
+    std::ifstream in(textPath);
+    if (!in) {
+        std::cerr << "Timeline: cannot read " << textPath << "\n";
+        return false;
+    }
+    std::vector<TimelineKey> tracks[timelineParamCount];
+    std::string line;
+    for (int lineNo = 1; std::getline(in, line); ++lineNo) {
+        line = line.substr(0, line.find('#'));
+        std::istringstream ss(line);
+        std::string param, curve = "linear";
+        TimelineKey key = {};
+        if (!(ss >> param)) continue;
+        int p = findName(paramNames, timelineParamCount, param);
+        if (!(ss >> key.time >> key.value) || p < 0 || ((ss >> curve) && findName(curveNames, 4, curve) < 0)) {
+            std::cerr << "Timeline: " << textPath << ":" << lineNo << ": expected <param> <seconds> <value> [curve]\n";
+            return false;
+        }
+        key.curve = (uint32_t)findName(curveNames, 4, curve);
+        tracks[p].push_back(key);
+    }
+
+    TimelineHeader header = { { 'T', 'W', 'T', 'L' }, 1, 0, 0 };
+    for (const auto& keys : tracks) header.trackCount += keys.empty() ? 0 : 1;
+    std::vector<TimelineTrack> table;
+    uint32_t offset = (uint32_t)(sizeof(TimelineHeader) + header.trackCount * sizeof(TimelineTrack));
+    for (int p = 0; p < timelineParamCount; ++p) {
+        if (tracks[p].empty()) continue;
+        std::stable_sort(tracks[p].begin(), tracks[p].end(),
+            [](const TimelineKey& a, const TimelineKey& b) { return a.time < b.time; });
+        table.push_back({ (uint32_t)p, (uint32_t)tracks[p].size(), offset, 0 });
+        offset += (uint32_t)(tracks[p].size() * sizeof(TimelineKey));
+    }
+
+    std::ofstream out(binaryPath, std::ios::binary);
+    out.write((const char*)&header, sizeof(header));
+    out.write((const char*)table.data(), table.size() * sizeof(TimelineTrack));
+    for (const auto& keys : tracks) out.write((const char*)keys.data(), keys.size() * sizeof(TimelineKey));
+    if (!out) {
+        std::cerr << "Timeline: cannot write " << binaryPath << "\n";
+        return false;
+    }
+    std::cout << "Timeline: " << binaryPath << ", " << header.trackCount << " tracks\n";
+    return true;
+}
+
+static bool mapFile(const char* path) {
+#ifdef _WIN32
+    tl.file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (tl.file == INVALID_HANDLE_VALUE) return false;
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(tl.file, &size) || size.QuadPart == 0) return false;
+    tl.mapping = CreateFileMappingA(tl.file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (!tl.mapping) return false;
+    tl.data = (const uint8_t*)MapViewOfFile(tl.mapping, FILE_MAP_READ, 0, 0, 0);
+    tl.size = (size_t)size.QuadPart;
+#else
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return false;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size == 0) { close(fd); return false; }
+    void* p = mmap(nullptr, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (p == MAP_FAILED) return false;
+    tl.data = (const uint8_t*)p;
+    tl.size = (size_t)st.st_size;
+#endif
+    return tl.data != nullptr;
+}
+
+// Every offset in range, every track sorted; the file is trusted after this
+static bool validate() {
+    if (tl.size < sizeof(TimelineHeader)) return false;
+    const TimelineHeader& header = *(const TimelineHeader*)tl.data;
+    if (std::memcmp(header.magic, "TWTL", 4) != 0 || header.version != 1) return false;
+    if (header.trackCount > (tl.size - sizeof(TimelineHeader)) / sizeof(TimelineTrack)) return false;
+    const TimelineTrack* table = (const TimelineTrack*)(tl.data + sizeof(TimelineHeader));
+    for (uint32_t i = 0; i < header.trackCount; ++i) {
+        const TimelineTrack& t = table[i];
+        if (t.param >= (uint32_t)timelineParamCount || t.keyCount == 0 || tl.keys[t.param]) return false;
+        if (t.keyOffset % alignof(TimelineKey) != 0 || t.keyOffset > tl.size ||
+            t.keyCount > (tl.size - t.keyOffset) / sizeof(TimelineKey)) return false;
+        const TimelineKey* keys = (const TimelineKey*)(tl.data + t.keyOffset);
+        for (uint32_t k = 0; k < t.keyCount; ++k) {
+            if (keys[k].curve > (uint32_t)TimelineCurve::Cubic) return false;
+            if (k > 0 && !(keys[k].time >= keys[k - 1].time)) return false;
+        }
+        tl.keys[t.param] = keys;
+        tl.keyCount[t.param] = t.keyCount;
+        tl.length = std::max(tl.length, (double)keys[t.keyCount - 1].time);
+    }
+    return true;
+}
+
+static double segmentIntegral(const TimelineKey* keys, uint32_t count, uint32_t i, double s);
+
+bool loadTimeline(const char* path) {
+    closeTimeline();
+    if (!mapFile(path) || !validate()) {
+        std::cerr << "Timeline: " << path << " is missing or not a timeline (see --timeline-build)\n";
+        closeTimeline();
+        return false;
+    }
+    if (const TimelineKey* keys = tl.keys[(int)TimelineParam::Speed]) {
+        uint32_t count = tl.keyCount[(int)TimelineParam::Speed];
+        tl.travel.resize(count);
+        tl.travel[0] = (double)keys[0].value * keys[0].time;
+        for (uint32_t i = 1; i < count; ++i) tl.travel[i] = tl.travel[i - 1] + segmentIntegral(keys, count, i - 1, 1.0);
+    }
+    int tracks = 0;
+    for (int p = 0; p < timelineParamCount; ++p) tracks += tl.keys[p] ? 1 : 0;
+    std::cout << "Timeline: " << path << ", " << tracks << " tracks, " << tl.length << " s\n";
+    return true;
+}
+
+void closeTimeline() {
+#ifdef _WIN32
+    if (tl.data) UnmapViewOfFile(tl.data);
+    if (tl.mapping) CloseHandle(tl.mapping);
+    if (tl.file != INVALID_HANDLE_VALUE) CloseHandle(tl.file);
+    tl.mapping = nullptr;
+    tl.file = INVALID_HANDLE_VALUE;
+#else
+    if (tl.data) munmap((void*)tl.data, tl.size);
+#endif
+    tl.data = nullptr;
+    tl.size = 0;
+    for (int p = 0; p < timelineParamCount; ++p) {
+        tl.keys[p] = nullptr;
+        tl.keyCount[p] = 0;
+    }
+    tl.length = 0.0;
+    tl.travel.clear();
+}
+
+bool timelineLoaded() { return tl.data != nullptr; }
+double timelineLength() { return tl.length; }
+
+// Slope at key i from its neighbours, in value per second
+static float tangent(const TimelineKey* keys, uint32_t count, uint32_t i) {
+    uint32_t a = i > 0 ? i - 1 : i, b = i + 1 < count ? i + 1 : i;
+    float dt = keys[b].time - keys[a].time;
+    return dt > 0.0f ? (keys[b].value - keys[a].value) / dt : 0.0f;
+}
+
+static float evaluate(const TimelineKey* keys, uint32_t count, float time) {
+    // first key after time; the segment starts one before it
+    const TimelineKey* next = std::upper_bound(keys, keys + count, time,
+        [](float t, const TimelineKey& k) { return t < k.time; });
+    if (next == keys) return keys[0].value;
+    if (next == keys + count) return keys[count - 1].value;
+    uint32_t i = (uint32_t)(next - keys) - 1;
+    const TimelineKey& k0 = keys[i];
+    const TimelineKey& k1 = *next;
+    float span = k1.time - k0.time;
+    float s = span > 0.0f ? (time - k0.time) / span : 1.0f;
+    switch ((TimelineCurve)k0.curve) {
+    case TimelineCurve::Step: return k0.value;
+    case TimelineCurve::Linear: return k0.value + (k1.value - k0.value) * s;
+    case TimelineCurve::Ease: return k0.value + (k1.value - k0.value) * s * s * (3.0f - 2.0f * s);
+    case TimelineCurve::Cubic: {
+        float m0 = tangent(keys, count, i) * span, m1 = tangent(keys, count, i + 1) * span;
+        float s2 = s * s, s3 = s2 * s;
+        return (2.0f * s3 - 3.0f * s2 + 1.0f) * k0.value + (s3 - 2.0f * s2 + s) * m0
+            + (-2.0f * s3 + 3.0f * s2) * k1.value + (s3 - s2) * m1;
+    }
+    }
+    return k0.value;
+}
+
+// Integral of segment i (key i to key i + 1) from its start to fraction s,
+// in value * seconds: the antiderivatives of the curves evaluate() draws
+static double segmentIntegral(const TimelineKey* keys, uint32_t count, uint32_t i, double s) {
+    const TimelineKey& k0 = keys[i];
+    const TimelineKey& k1 = keys[i + 1];
+    double span = (double)k1.time - k0.time;
+    double v0 = k0.value, dv = (double)k1.value - k0.value;
+    double s2 = s * s, s3 = s2 * s, s4 = s3 * s;
+    switch ((TimelineCurve)k0.curve) {
+    case TimelineCurve::Step: return span * v0 * s;
+    case TimelineCurve::Linear: return span * (v0 * s + dv * s2 * 0.5);
+    case TimelineCurve::Ease: return span * (v0 * s + dv * (s3 - 0.5 * s4));
+    case TimelineCurve::Cubic: {
+        double m0 = (double)tangent(keys, count, i) * span, m1 = (double)tangent(keys, count, i + 1) * span;
+        return span * ((0.5 * s4 - s3 + s) * v0 + (0.25 * s4 - s3 / 1.5 + 0.5 * s2) * m0
+            + (s3 - 0.5 * s4) * k1.value + (0.25 * s4 - s3 / 3.0) * m1);
+    }
+    }
+    return span * v0 * s;
+}
+
+void applyTimeline(double time, EffectParams& params) {
+    float* fields[timelineParamCount] = { &params.speed, &params.warp, &params.thickness, &params.colorShift };
+    for (int p = 0; p < timelineParamCount; ++p)
+        if (tl.keys[p]) *fields[p] = evaluate(tl.keys[p], tl.keyCount[p], (float)time);
+    if (tl.keys[(int)TimelineParam::Thickness]) params.thickness = std::max(0.01f, params.thickness);
+}
+
+bool timelineKeysSpeed() { return !tl.travel.empty(); }
+
+double timelineTravel(double time) {
+    const TimelineKey* keys = tl.keys[(int)TimelineParam::Speed];
+    uint32_t count = tl.keyCount[(int)TimelineParam::Speed];
+    if (!keys) return 0.0;
+    const TimelineKey* next = std::upper_bound(keys, keys + count, (float)time,
+        [](float t, const TimelineKey& k) { return t < k.time; });
+    if (next == keys) return (double)keys[0].value * time;
+    uint32_t i = (uint32_t)(next - keys) - 1;
+    double since = time - keys[i].time;
+    if (next == keys + count) return tl.travel[i] + (double)keys[i].value * since;
+    double span = (double)next->time - keys[i].time;
+    if (span <= 0.0) return tl.travel[i];
+    return tl.travel[i] + segmentIntegral(keys, count, i, std::clamp(since / span, 0.0, 1.0));
+}
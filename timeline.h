@@ -0,0 +1,69 @@
+// timeline.h
+// Keyframed parameter curves for choreographed shows. A timeline is a
+// binary file that is memory-mapped and used in place: one sorted key array
+// per parameter, each key naming the curve to the next one. Evaluating at
+// any time is a binary search per track, so scrubbing costs the same as
+// playing. Tracks override the matching EffectParams; parameters without a
+// track keep following the keys.
+//
+// Binary layout (little-endian), all offsets from the start of the file:
+//   TimelineHeader, trackCount x TimelineTrack, then the TimelineKey arrays.
+// buildTimeline writes it from a text file with one key per line:
+//   <speed|warp|thickness|colorShift> <seconds> <value> [step|linear|ease|cubic]
+// '#' starts a comment; keys of a parameter may come in any order.
+#pragma once
+#include <cstdint>
+
+#include "effects.h"
+
+enum class TimelineCurve : uint32_t {
+    Step,    // hold until the next key
+    Linear,
+    Ease,    // smoothstep, like easeInOut() in the tunnel shaders
+    Cubic,   // Hermite through the neighbouring keys (Catmull-Rom tangents)
+};
+
+enum class TimelineParam : uint32_t { Speed, Warp, Thickness, ColorShift };
+static const int timelineParamCount = 4;
+
+struct TimelineHeader {
+    char magic[4];         // "TWTL"
+    uint32_t version;      // 1
+    uint32_t trackCount;
+    uint32_t reserved;
+};
+
+struct TimelineTrack {
+    uint32_t param;        // TimelineParam
+    uint32_t keyCount;
+    uint32_t keyOffset;    // byte offset of the first TimelineKey
+    uint32_t reserved;
+};
+
+struct TimelineKey {
+    float time;            // seconds, increasing within a track
+    float value;
+    uint32_t curve;        // TimelineCurve of the segment to the next key
+};
+
+// Text to binary; returns false with a message on the first bad line
+bool buildTimeline(const char* textPath, const char* binaryPath);
+
+// Maps and validates a binary timeline; replaces any loaded one
+bool loadTimeline(const char* path);
+void closeTimeline();
+bool timelineLoaded();
+// Time of the last key of any track
+double timelineLength();
+
+// Overrides the params that have a track with their value at time
+void applyTimeline(double time, EffectParams& params);
+
+// True while a loaded timeline keys speed
+bool timelineKeysSpeed();
+// The travel (iTime * speed in the shaders) at time under the speed track:
+// its integral from 0, so changing speed changes how fast the bySpeed phases
+// advance instead of rescaling all the time already elapsed. Before the
+// first key and after the last the speed holds. A binary search, like the
+// curves, over running totals kept per key.
+double timelineTravel(double time);
@@ -0,0 +1,641 @@
+// timewarp.cpp
+// Multi-effect host: one SDL window and GL context, every effect compiled once
+// at startup and kept resident so switching is instant. Events stay on the
+// main thread, GL and the clock run on a render thread (see main).
+//
+// Usage: see usageText below.
+// Keys: 1..9 select effect, TAB / PAGEDOWN next, PAGEUP previous,
+//       UP/DOWN speed, LEFT/RIGHT warp, z/x thickness, c/v colorShift (unless a
+//       loaded effect binds its own), ESC quit,
+//       F1 profiler overlay, F2 export profile CSV, F3 dynamic resolution,
+//       F4 next frame pacing mode, F5 next quality tier (then auto),
+//       F6 temporal accumulation, F7 compute march,
+//       [ / ] scrub 5 s back / forward.
+// With --outputs the keys act on whichever output window has focus.
+
+#define SDL_MAIN_HANDLED
+#pragma comment(linker, "/SUBSYSTEM:CONSOLE")
+#include <glad/glad.h>
+#include <SDL2/SDL.h>
+#include <iostream>
+#include <string>
+#include <chrono>
+#include <vector>
+#include <algorithm> // for std::max
+#include <cstdlib>
+#include <cstdio>
+#include <cstring>
+#include <cctype>
+#include <thread>
+
+#include "gl-util.h"
+#include "effects.h"
+#include "hot-reload.h"
+#include "overlay.h"
+#include "profiler.h"
+#include "benchmark.h"
+#include "bare-host.h"
+#include "video-export.h"
+#include "noise-texture.h"
+#include "dynamic-res.h"
+#include "chromatic-aberration.h"
+#include "frame-params.h"
+#include "frame-pacing.h"
+#include "cpu-reference.h"
+#include "quality.h"
+#include "multi-output.h"
+#include "temporal.h"
+#include "compute-march.h"
+#include "compositor.h"
+#include "tonemap.h"
+#include "bloom.h"
+#include "render-pool.h"
+#include "audio-input.h"
+#include "host-input.h"
+#include "triple-buffer.h"
+#include "telemetry.h"
+#include "timeline.h"
+#include "effect-library.h"
+#include "osc-control.h"
+#include "clock-sync.h"
+
+#pragma comment(lib, "opengl32.lib")
+
+static const char* usageText =
+    "Usage: timewarp [options]\n"
+    "  --effect <name>          start on this effect\n"
+    "  --shader-cache <dir>     program binary cache (default ./shadercache)\n"
+    "  --no-shader-cache\n"
+    "  --shader-dir <dir>       load <dir>/<effect>.glsl and hot-reload on change\n"
+    "  --effects-dir <dir>      add the effects described by <dir>/*.effect, built when first shown\n"
+    "  --profile                show the profiler overlay\n"
+    "  --profile-csv <file>     F2 export path (default timewarp-profile.csv)\n"
+    "  --dynamic-res            scale render resolution to the GPU budget\n"
+    "  --target-ms <ms>         GPU budget per frame for --dynamic-res and --quality auto (default 14)\n"
+    "  --pacing <mode>          vsync (default), adaptive, cap, low-latency or off\n"
+    "  --fps <n>                frame rate for --pacing cap (default 60)\n"
+    "  --noise <texture|alu>    value noise path built into circles and twirl\n"
+    "  --steps <n>              raymarch iterations for circles and twirl\n"
+    "  --quality <tier>         low, medium, high (default), ultra or auto\n"
+    "  --temporal               circles and twirl march half their tiles, reproject the rest\n"
+    "  --transition <mode>      effect switches: crossfade (default), wipe or cut\n"
+    "  --transition-seconds <s> length of a transition (default 0.8)\n"
+    "  --compute                circles and twirl march as GL 4.3 compute, skipping empty space per tile\n"
+    "  --srgb                   sRGB window framebuffer; the tonemap pass writes linear colour\n"
+    "  --no-bloom               skip the bloom pass\n"
+    "  --audio                  analyse the default capture device into iAudio\n"
+    "  --audio-device <name>    analyse this capture device\n"
+    "  --audio-map <p:band:g>   add g * band level (0..15) to warp, thickness or colorShift\n"
+    "  --outputs <0,1,.. | all> one borderless window per display, spanning one canvas\n"
+    "  --separate-outputs       with --outputs: each display shows the next effect\n"
+    "  --timeline <file>        drive params from a keyframe timeline ([ and ] scrub)\n"
+    "  --log-level <level>      error, warn, info (default) or debug\n"
+    "  --telemetry <hz>         print fps, GPU ms and params as JSON lines at this rate\n"
+    "  --telemetry-port <port>  serve the same lines on 127.0.0.1:<port>\n"
+    "  --osc <port>             take OSC control messages on this UDP port\n"
+    "  --osc-reply-hz <hz>      fps and GPU ms back to OSC senders (default 10, 0 = off)\n"
+    "  --sync-lead <port>       serve the show clock to followers on this UDP port\n"
+    "  --sync-follow <host[:port]> run on the leader's show clock (default port 7010)\n"
+    "  --sync-fps <hz>          frame grid of the leader's clock (default 60)\n"
+    "  --swap-group <n>         join NV swap group n and barrier 1, for genlocked walls\n"
+    "       timewarp --timeline-build <keys.txt> <file>\n"
+    "       timewarp --backend vulkan | --bare [--present fifo|mailbox|immediate] [--frames-in-flight <n>]\n"
+    "                [--bare-seconds <s>] [--effect <name>]  effects and tonemap only, on Vulkan or GL\n"
+    "       timewarp --benchmark [--bench-frames <n>] [--bench-out <file>] [--effect <name>]\n"
+    "       timewarp --export <file.y4m | frames/%05d.png | file.mp4> [--effect <name>]\n"
+    "                [--export-size <w>x<h>] [--export-fps <n>] [--export-seconds <s>]\n"
+    "                [--export-start <s>] [--ffmpeg-args \"<args>\"]  other extensions pipe into ffmpeg\n"
+    "       timewarp --cpu-render <file.png | thumbs/%s.png> [--effect <name>] [--cpu-size <w>x<h>]\n"
+    "                [--cpu-time <s>] [--threads <n>] [--cpu-compare [--cpu-tolerance <n>]]\n";
+
+int main(int argc, char** argv) {
+    auto launch = std::chrono::high_resolution_clock::now();
+    const char* startEffect = nullptr;
+    const char* shaderCache = "shadercache";
+    const char* shaderDir = nullptr;
+    const char* effectsDir = nullptr;
+    const char* profileCsv = "timewarp-profile.csv";
+    bool showProfiler = false;
+    bool benchmark = false;
+    BenchmarkOptions bench;
+    BareHostOptions bare;
+    bool vulkan = false, bareHost = false;
+    ExportOptions exportOpts;
+    CpuRenderOptions cpuOpts;
+    bool dynamicRes = false;
+    float targetMs = 14.0f;
+    PacingMode pacing = PacingMode::Vsync;
+    double capFps = 60.0;
+    int noiseTex = -1, stepCount = 0; // left to each shader
+    QualityTier quality = QualityTier::High;
+    bool qualityAutomatic = false;
+    OutputOptions outputs;
+    bool temporal = false;
+    bool compute = false;
+    bool srgb = false;
+    bool bloom = true;
+    TransitionMode transition = TransitionMode::Crossfade;
+    double transitionSeconds = 0.8;
+    bool audio = false;
+    const char* audioDevice = nullptr;
+    std::vector<AudioMapping> audioMappings;
+    TelemetryOptions telemetry;
+    OscOptions osc;
+    ClockSyncOptions clockSync;
+    unsigned swapGroup = 0;
+    const char* timelinePath = nullptr;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--effect" && i + 1 < argc) startEffect = argv[++i];
+        else if (arg == "--shader-cache" && i + 1 < argc) shaderCache = argv[++i];
+        else if (arg == "--no-shader-cache") shaderCache = nullptr;
+        else if (arg == "--shader-dir" && i + 1 < argc) shaderDir = argv[++i];
+        else if (arg == "--effects-dir" && i + 1 < argc) effectsDir = argv[++i];
+        else if (arg == "--profile") showProfiler = true;
+        else if (arg == "--profile-csv" && i + 1 < argc) profileCsv = argv[++i];
+        else if (arg == "--benchmark") benchmark = true;
+        else if (arg == "--backend" && i + 1 < argc && (std::strcmp(argv[i + 1], "gl") == 0 || std::strcmp(argv[i + 1], "vulkan") == 0))
+            vulkan = std::strcmp(argv[++i], "vulkan") == 0;
+        else if (arg == "--bare") bareHost = true;
+        else if (arg == "--present" && i + 1 < argc && parsePresentMode(argv[i + 1], bare.backendOpts.present)) ++i;
+        else if (arg == "--frames-in-flight" && i + 1 < argc) bare.backendOpts.framesInFlight = std::max(1, std::atoi(argv[++i]));
+        else if (arg == "--bare-seconds" && i + 1 < argc) bare.seconds = std::max(0.0, std::atof(argv[++i]));
+        else if (arg == "--bench-frames" && i + 1 < argc) bench.frames = std::max(1, std::atoi(argv[++i]));
+        else if (arg == "--bench-out" && i + 1 < argc) bench.output = argv[++i];
+        else if (arg == "--export" && i + 1 < argc) exportOpts.output = argv[++i];
+        else if (arg == "--export-size" && i + 1 < argc && std::sscanf(argv[i + 1], "%dx%d", &exportOpts.width, &exportOpts.height) == 2) ++i;
+        else if (arg == "--export-fps" && i + 1 < argc) exportOpts.fps = std::max(1.0, std::atof(argv[++i]));
+        else if (arg == "--export-seconds" && i + 1 < argc) exportOpts.seconds = std::max(0.0, std::atof(argv[++i]));
+        else if (arg == "--export-start" && i + 1 < argc) exportOpts.start = std::atof(argv[++i]);
+        else if (arg == "--ffmpeg-args" && i + 1 < argc) exportOpts.ffmpegArgs = argv[++i];
+        else if (arg == "--cpu-render" && i + 1 < argc) cpuOpts.output = argv[++i];
+        else if (arg == "--cpu-size" && i + 1 < argc && std::sscanf(argv[i + 1], "%dx%d", &cpuOpts.width, &cpuOpts.height) == 2) ++i;
+        else if (arg == "--cpu-time" && i + 1 < argc) cpuOpts.time = (float)std::atof(argv[++i]);
+        else if (arg == "--cpu-compare") cpuOpts.compare = true;
+        else if (arg == "--cpu-tolerance" && i + 1 < argc) cpuOpts.tolerance = std::max(0, std::atoi(argv[++i]));
+        else if (arg == "--threads" && i + 1 < argc) cpuOpts.threads = std::max(0, std::atoi(argv[++i]));
+        else if (arg == "--dynamic-res") dynamicRes = true;
+        else if (arg == "--target-ms" && i + 1 < argc) targetMs = std::max(1.0f, (float)std::atof(argv[++i]));
+        else if (arg == "--pacing" && i + 1 < argc && parsePacingMode(argv[i + 1], pacing)) ++i;
+        else if (arg == "--fps" && i + 1 < argc) capFps = std::max(1.0, std::atof(argv[++i]));
+        else if (arg == "--noise" && i + 1 < argc && (std::string(argv[i + 1]) == "texture" || std::string(argv[i + 1]) == "alu"))
+            noiseTex = std::string(argv[++i]) == "texture" ? 1 : 0;
+        else if (arg == "--steps" && i + 1 < argc) stepCount = std::max(1, std::atoi(argv[++i]));
+        else if (arg == "--quality" && i + 1 < argc && std::string(argv[i + 1]) == "auto") { qualityAutomatic = true; ++i; }
+        else if (arg == "--quality" && i + 1 < argc && parseQualityTier(argv[i + 1], quality)) ++i;
+        else if (arg == "--outputs" && i + 1 < argc && parseOutputDisplays(argv[i + 1], outputs)) ++i;
+        else if (arg == "--separate-outputs") outputs.separate = true;
+        else if (arg == "--temporal") temporal = true;
+        else if (arg == "--compute") compute = true;
+        else if (arg == "--srgb") srgb = true;
+        else if (arg == "--no-bloom") bloom = false;
+        else if (arg == "--transition" && i + 1 < argc && parseTransitionMode(argv[i + 1], transition)) ++i;
+        else if (arg == "--transition-seconds" && i + 1 < argc) transitionSeconds = std::atof(argv[++i]);
+        else if (arg == "--audio") audio = true;
+        else if (arg == "--audio-device" && i + 1 < argc) { audio = true; audioDevice = argv[++i]; }
+        else if (arg == "--audio-map" && i + 1 < argc) {
+            AudioMapping mapping;
+            if (!parseAudioMapping(argv[++i], mapping)) {
+                std::cerr << "Bad --audio-map '" << argv[i] << "', expected warp|thickness|colorShift:<band>:<gain>\n";
+                return 1;
+            }
+            audioMappings.push_back(mapping);
+            audio = true;
+        }
+        else if (arg == "--timeline" && i + 1 < argc) timelinePath = argv[++i];
+        else if (arg == "--timeline-build" && i + 2 < argc) return buildTimeline(argv[i + 1], argv[i + 2]) ? 0 : 1;
+        else if (arg == "--log-level" && i + 1 < argc && parseLogLevel(argv[i + 1], telemetry.level)) ++i;
+        else if (arg == "--telemetry" && i + 1 < argc) telemetry.sampleHz = std::max(0.0, std::atof(argv[++i]));
+        else if (arg == "--telemetry-port" && i + 1 < argc) telemetry.port = std::max(0, std::atoi(argv[++i]));
+        else if (arg == "--osc" && i + 1 < argc) osc.port = std::max(0, std::atoi(argv[++i]));
+        else if (arg == "--osc-reply-hz" && i + 1 < argc) osc.replyHz = std::max(0.0, std::atof(argv[++i]));
+        else if (arg == "--sync-lead" && i + 1 < argc) {
+            clockSync.role = SyncRole::Leader;
+            clockSync.port = std::max(1, std::atoi(argv[++i]));
+        }
+        else if (arg == "--sync-follow" && i + 1 < argc) {
+            clockSync.role = SyncRole::Follower;
+            if (!parseSyncLeader(argv[++i], clockSync)) {
+                std::cerr << "Bad --sync-follow '" << argv[i] << "', expected <host>[:<port>]\n";
+                return 1;
+            }
+        }
+        else if (arg == "--sync-fps" && i + 1 < argc) clockSync.fps = std::max(1.0, std::atof(argv[++i]));
+        else if (arg == "--swap-group" && i + 1 < argc) swapGroup = (unsigned)std::max(0, std::atoi(argv[++i]));
+        else {
+            std::cerr << "Unknown argument: " << arg << "\n" << usageText;
+            return 1;
+        }
+    }
+
+    // specialized builds are picked per frame from these and the effect params
+    setShaderVariantOverrides(noiseTex, stepCount);
+    initQuality(quality, qualityAutomatic, targetMs);
+    setShaderVariantTemporal(temporal);
+    if (timelinePath && !loadTimeline(timelinePath)) return 1;
+    // only the descriptors; each shader builds when its effect is first wanted
+    if (effectsDir && !loadEffectLibrary(effectsDir)) return 1;
+
+    // the effects alone through a RenderBackend; the full host below is GL only
+    if (vulkan || bareHost) {
+        bare.backend = vulkan ? vulkanBackend() : &glBackend();
+        if (!bare.backend) {
+            std::cerr << "Built without the Vulkan backend (define TIMEWARP_VULKAN, link vulkan-1 and shaderc_combined)\n";
+            return 1;
+        }
+        bare.backendOpts.cacheDir = shaderCache;
+        bare.effect = startEffect;
+        return runBareHost(bare);
+    }
+    if (benchmark) {
+        bench.shaderCache = shaderCache;
+        bench.effect = startEffect;
+        return runBenchmark(bench);
+    }
+    if (exportOpts.output) {
+        exportOpts.shaderCache = shaderCache;
+        exportOpts.effect = startEffect;
+        return runExport(exportOpts);
+    }
+    if (cpuOpts.output) {
+        cpuOpts.shaderCache = shaderCache;
+        cpuOpts.effect = startEffect;
+        return runCpuRender(cpuOpts);
+    }
+
+    // from here on render-thread messages are queued and written off the frame
+    startTelemetry(telemetry);
+    if (SDL_Init(SDL_INIT_VIDEO) != 0) {
+        std::cerr << "SDL_Init failed: " << SDL_GetError() << "\n";
+        return 1;
+    }
+
+    int w = 1280, h = 720;
+    SDL_GLContext ctx = nullptr;
+    if (srgb) SDL_GL_SetAttribute(SDL_GL_FRAMEBUFFER_SRGB_CAPABLE, 1);
+    SDL_Window* win = createGLWindow("Plasma Time Warp Tunnel", w, h, SDL_WINDOW_RESIZABLE, &ctx, compute);
+    if (!win) return 1;
+    // extra displays share this context; w/h become the size of the shared view
+    if (!initOutputs(win, ctx, outputs, w, h)) return 1;
+    glViewport(0, 0, w, h);
+
+    // Build every effect once in the background; programs stay resident until exit
+    initShaderCompiler(win, ctx, shaderCache);
+    std::vector<Effect> effects;
+    registerEffects(effects);
+    bool watching = shaderDir && startShaderWatch(shaderDir, effects);
+
+    // Fullscreen triangle VAO/VBO shared by all effects
+    FullscreenTriangle tri;
+    createFullscreenTriangle(tri);
+    initNoiseTexture();
+    initFrameParams();
+
+    std::vector<std::string> effectNames;
+    for (const Effect& fx : effects) effectNames.push_back(fx.desc->name);
+    initOverlay();
+    initProfiler(effectNames);
+    if (!initDynamicRes(w, h, targetMs)) dynamicRes = false;
+    initChromaticAberration(w, h);
+    if (!initTonemap(w, h, srgb)) std::cerr << "Tonemap pass unavailable, effects draw ungraded\n";
+    if (bloom && !initBloom(w, h)) std::cerr << "Bloom unavailable\n";
+    initTemporal(w, h);
+    if (compute && !initComputeMarch(w, h)) compute = false;
+    setShaderVariantCompute(compute);
+    if (!initCompositor(transition, transitionSeconds, w, h)) initCompositor(TransitionMode::Cut, 0.0, w, h);
+    // without a device the bands stay at 0 and the mappings add nothing
+    if (audio) initAudio(audioDevice, audioMappings);
+
+    int current = 0;
+    if (startEffect) {
+        current = findEffect(effects, startEffect);
+        if (current < 0) {
+            std::cerr << "Unknown effect '" << startEffect << "', available:";
+            for (const Effect& fx : effects) std::cerr << " " << fx.desc->name;
+            std::cerr << "\n";
+            return 1;
+        }
+    }
+    SDL_SetWindowTitle(win, effects[current].desc->title);
+
+    // This thread keeps the window and its events (SDL wants them where the
+    // window was made) and publishes what the keys set; the render thread
+    // owns GL, the effects and the clock, and takes the newest snapshot at
+    // the top of each frame. A blocking swap never holds up input.
+    InputSnapshot input;
+    input.current = current;
+    for (const Effect& fx : effects) input.params.push_back(fx.params);
+    input.w = w; input.h = h;
+    input.showProfiler = showProfiler;
+    input.dynamicRes = dynamicRes;
+    input.temporal = temporal;
+    input.compute = compute;
+    TripleBuffer<InputSnapshot> snapshots(input);
+    initSkippedEffects((int)effects.size());
+    std::vector<const char*> titles;
+    std::vector<const EffectDesc*> descs;
+    for (const Effect& fx : effects) {
+        titles.push_back(fx.desc->title);
+        descs.push_back(fx.desc);
+    }
+
+    auto renderLoop = [&]() {
+        SDL_GL_MakeCurrent(win, ctx);
+        initFramePacing(win, pacing, capFps);
+        if (swapGroup > 0 && !joinSwapGroup(swapGroup))
+            telemetryLog(LogLevel::Warn, "Swap group %u unavailable, swaps stay unsynchronized", swapGroup);
+        InputSnapshot applied = snapshots.front();
+        bool firstFrame = true;
+        bool allBuilt = false;
+        int frame = 0;
+        const int fpsCounter = telemetryCounter("fps");
+        const int frameMsCounter = telemetryCounter("frame_ms");
+        const int gpuMsCounter = telemetryCounter("gpu_ms");
+        const int effectCounter = telemetryCounter("effect");
+        const int speedCounter = telemetryCounter("speed");
+        const int warpCounter = telemetryCounter("warp");
+        const int thicknessCounter = telemetryCounter("thickness");
+        const int colorShiftCounter = telemetryCounter("color_shift");
+        const int scaleCounter = telemetryCounter("dynres_scale");
+        const int qualityCounter = telemetryCounter("quality");
+        double lastT = 0.0;
+        float frameMs = 0.0f;
+
+        // one effect at rw x rh into the bound framebuffer; the outgoing side
+        // of a transition draws without temporal reuse (its iHistoryDt stays 0)
+        auto drawEffect = [&](Effect& fx, int view, double t, int rw, int rh, bool temporalReuse) {
+            float aberration = effectAberration(fx);
+            bool reproject = temporalReuse && effectTemporal(fx);
+            if (aberration > 0.0f) beginChromaticAberration(rw, rh);
+            float historyDt = reproject ? beginTemporal(view, &fx, t, rw, rh) : 0.0f;
+            updateEffectFrame(fx, t, rw, rh, frame, historyDt);
+            useEffect(fx);
+            if (effectCompute(fx)) dispatchComputeMarch(rw, rh);
+            else drawFullscreenTriangle(tri);
+            if (reproject) endTemporal();
+            if (aberration > 0.0f) endChromaticAberration(tri, aberration);
+        };
+        double timeOffset = 0.0;
+
+        while (true) {
+            if (snapshots.update()) {
+                const InputSnapshot& s = snapshots.front();
+                if (!s.running) break;
+                for (size_t i = 0; i < effects.size(); ++i) effects[i].params = s.params[i];
+                // the switch itself stays instant; the compositor blends into it
+                if (s.current != current) startTransition(current);
+                current = s.current;
+                showProfiler = s.showProfiler;
+                dynamicRes = s.dynamicRes;
+                timeOffset = s.timeOffset;
+                if (s.temporal != temporal) {
+                    temporal = s.temporal;
+                    setShaderVariantTemporal(temporal);
+                }
+                if (s.compute != compute && computeMarchAvailable()) {
+                    compute = s.compute;
+                    setShaderVariantCompute(compute);
+                }
+                if (s.w != w || s.h != h) {
+                    w = s.w; h = s.h;
+                    glViewport(0, 0, w, h);
+                    resizeDynamicRes(w, h);
+                    resizeChromaticAberration(w, h);
+                    resizeTonemap(w, h);
+                    resizeBloom(w, h);
+                    resizeTemporal(w, h);
+                    resizeComputeMarch(w, h);
+                    resizeCompositor(w, h);
+                }
+                for (uint32_t n = applied.csvExports; n != s.csvExports; ++n) exportProfilerCsv(profileCsv);
+                for (uint32_t n = applied.pacingSteps; n != s.pacingSteps; ++n)
+                    setPacingMode((PacingMode)(((int)pacingMode() + 1) % pacingModeCount));
+                for (uint32_t n = applied.qualitySteps; n != s.qualitySteps; ++n) {
+                    // low -> medium -> high -> ultra -> auto -> low
+                    if (qualityAuto()) setQualityTier(QualityTier::Low);
+                    else if ((int)qualityTier() + 1 < qualityTierCount) setQualityTier((QualityTier)((int)qualityTier() + 1));
+                    else setQualityAuto(true);
+                }
+                applied.csvExports = s.csvExports;
+                applied.pacingSteps = s.pacingSteps;
+                applied.qualitySteps = s.qualitySteps;
+            }
+
+            // waits per the pacing mode; effects are animated for when this frame is shown
+            // kept in double; effects get it wrapped per their TimePhases (effects.h)
+            double t = beginPacedFrame();
+            // with --sync-* the leader's clock on its frame grid, scrubbed by the leader
+            t = clockSyncActive() ? syncShowTime(pacingOrigin() + t, timeOffset) : t + timeOffset;
+            profilerBeginFrame(current);
+            if (frame > 0) {
+                float dtMs = (float)((t - lastT) * 1000.0);
+                frameMs = frameMs > 0.0f ? frameMs * 0.9f + dtMs * 0.1f : dtMs;
+            }
+            lastT = t;
+
+            // keyed params follow the clock; the rest keep what the keys set
+            if (timelineLoaded())
+                for (Effect& fx : effects) applyTimeline(t, fx.params);
+            // edited shaders rebuild in the background; the old program draws meanwhile
+            if (watching) pollShaderWatch(effects);
+            // band levels and mapped params feed variant selection and the frame block
+            updateAudio();
+            updateQuality();
+            // lazy effects build once shown, or once a key press away from it
+            int count = (int)effects.size();
+            requestEffect(effects[current]);
+            requestEffect(effects[(current + 1) % count]);
+            requestEffect(effects[(current + count - 1) % count]);
+            if (transitionFrom() >= 0) requestEffect(effects[transitionFrom()]);
+            for (int view = 0; view < outputViewCount(); ++view) requestEffect(effects[outputViewEffect(view, current, count)]);
+            int building = updateEffects(effects, tri);
+            updateSkippedEffects(effects);
+            if (building == 0 && !allBuilt) {
+                std::chrono::duration<float, std::milli> ms = std::chrono::high_resolution_clock::now() - launch;
+                telemetryLog(LogLevel::Info, "All effects built after %g ms", ms.count());
+                allBuilt = true;
+            }
+
+            // one view per frame, or one per output with --separate-outputs; a
+            // single GPU sample spans every view's effect pass
+            int views = outputViewCount();
+            int rw = w, rh = h;
+            bool timing = false;
+            bool fading = transitionActive(t);
+            for (int view = 0; view < views; ++view) {
+                Effect& fx = effects[outputViewEffect(view, current, (int)effects.size())];
+                Effect& outgoing = effects[outputViewEffect(view, fading ? transitionFrom() : current, (int)effects.size())];
+                beginOutputView(view);
+
+                // render size differs from the window while dynamic resolution is on
+                rw = w; rh = h;
+                if (dynamicRes) beginDynamicRes(rw, rh);
+                // everything up to the tonemap draws linear HDR
+                beginTonemap(rw, rh);
+
+                glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+                glClear(GL_COLOR_BUFFER_BIT);
+
+                // an effect shows black until its program is ready
+                bool blend = fading && &outgoing != &fx;
+                ToneDesc tone = blend ? mixTone(outgoing.desc->tone, fx.desc->tone, transitionProgress()) : fx.desc->tone;
+                if (fx.prog || (blend && outgoing.prog)) {
+                    if (!timing) profilerBeginGpu();
+                    timing = true;
+                    if (blend) {
+                        int lw, lh;
+                        beginTransitionLayer(TransitionLayer::Outgoing, rw, rh, lw, lh);
+                        if (outgoing.prog) drawEffect(outgoing, view, t, lw, lh, false);
+                        endTransitionLayer();
+                        beginTransitionLayer(TransitionLayer::Incoming, rw, rh, lw, lh);
+                        if (fx.prog) drawEffect(fx, view, t, lw, lh, true);
+                        endTransitionLayer();
+                        compositeTransition(tri);
+                    } else {
+                        drawEffect(fx, view, t, rw, rh, true);
+                    }
+                }
+                endTonemap(tri, tone, frame);
+                // the sample covers the bloom and the resolve too, which grow with rw x rh
+                if (timing && view + 1 == views) {
+                    profilerEndGpu();
+                    timing = false;
+                }
+                if (dynamicRes) endDynamicRes(tri);
+            }
+            if (timing) profilerEndGpu();
+
+            uint64_t gpuFrame = 0;
+            float gpuMs = 0.0f;
+            if (profilerLatestGpu(gpuFrame, gpuMs)) setTelemetryCounter(gpuMsCounter, gpuMs);
+            const EffectParams& live = effects[current].params;
+            setTelemetryCounter(fpsCounter, frameMs > 0.0f ? 1000.0f / frameMs : 0.0f);
+            setTelemetryCounter(frameMsCounter, frameMs);
+            setTelemetryCounter(effectCounter, current);
+            setTelemetryCounter(speedCounter, live.speed);
+            setTelemetryCounter(warpCounter, live.warp);
+            setTelemetryCounter(thicknessCounter, live.thickness);
+            setTelemetryCounter(colorShiftCounter, live.colorShift);
+            setTelemetryCounter(scaleCounter, dynamicRes ? dynamicResScale() : 1.0f);
+            setTelemetryCounter(qualityCounter, (int)qualityTier());
+            // the overlay goes on the first view
+            if (views > 1) beginOutputView(0);
+
+            if (showProfiler) {
+                char buf[64];
+                snprintf(buf, sizeof(buf), "PACING %s %.1f HZ", pacingModeName(pacingMode()), pacingRefreshHz());
+                for (char* c = buf; *c; ++c) *c = (char)toupper((unsigned char)*c);
+                overlayText(10.0f, h - 20.0f, 2.0f, 0xffffffff, buf);
+                if (dynamicRes) {
+                    snprintf(buf, sizeof(buf), "DYNAMIC RES %d%% %dX%d", (int)(dynamicResScale() * 100.0f + 0.5f), rw, rh);
+                    overlayText(10.0f, h - 34.0f, 2.0f, 0xffffffff, buf);
+                }
+                snprintf(buf, sizeof(buf), "QUALITY %s%s", qualityTierName(qualityTier()), qualityAuto() ? " AUTO" : "");
+                for (char* c = buf; *c; ++c) *c = (char)toupper((unsigned char)*c);
+                overlayText(10.0f, h - 48.0f, 2.0f, 0xffffffff, buf);
+                if (temporal) overlayText(10.0f, h - 62.0f, 2.0f, 0xffffffff, "TEMPORAL");
+                if (timelineLoaded()) {
+                    snprintf(buf, sizeof(buf), "TIMELINE %.1f / %.1f S", t, timelineLength());
+                    overlayText(10.0f, h - 76.0f, 2.0f, 0xffffffff, buf);
+                }
+                if (compute) overlayText(10.0f, h - 90.0f, 2.0f, 0xffffffff, "COMPUTE");
+                if (audio) {
+                    const float* levels = audioLevels();
+                    for (int b = 0; b < audioBands; ++b)
+                        overlayRect(w - 10.0f - (audioBands - b) * 8.0f, h - 10.0f - 40.0f * levels[b], 6.0f, 40.0f * levels[b], 0x40c0ffc0);
+                }
+                drawProfilerOverlay(current, w, h);
+            }
+
+            profilerBeginSwap();
+            presentOutputs();
+            presentPacedFrame();
+            profilerEndSwap();
+            if (firstFrame && effects[current].prog) {
+                std::chrono::duration<float, std::milli> ms = std::chrono::high_resolution_clock::now() - launch;
+                telemetryLog(LogLevel::Info, "First frame after %g ms", ms.count());
+                firstFrame = false;
+            }
+            ++frame;
+        }
+
+        stopShaderWatch();
+        releaseOutputViews();
+        shutdownFramePacing();
+        shutdownTemporal();
+        shutdownComputeMarch();
+        shutdownCompositor();
+        shutdownRenderPool();
+        shutdownChromaticAberration();
+        shutdownBloom();
+        shutdownTonemap();
+        shutdownDynamicRes();
+        shutdownFrameParams();
+        shutdownNoiseTexture();
+        shutdownProfiler();
+        shutdownOverlay();
+        stopShaderCompiler();
+        destroyFullscreenTriangle(tri);
+        destroyEffects(effects);
+        SDL_GL_MakeCurrent(win, nullptr);
+    };
+
+    int status = 0;
+    // running before the first frame, so a follower never starts on its own clock for long
+    if (clockSync.role != SyncRole::Off && !startClockSync(clockSync)) {
+        // the renderer starts only to shut down, so everything is released as on quit
+        input.running = false;
+        snapshots.back() = input;
+        snapshots.publish();
+        status = 1;
+    }
+    SDL_GL_MakeCurrent(win, nullptr);
+    std::thread renderer(renderLoop);
+    // remote changes arrive as wakeups of the loop below
+    if (osc.port > 0 && input.running) startOscControl(osc, effectNames);
+
+    int shownEffect = current;
+    while (input.running) {
+        SDL_Event e;
+        // sleeps until there is input; the timeout only bounds how long a
+        // lost wakeup could delay quitting
+        if (!SDL_WaitEventTimeout(&e, 100)) continue;
+        bool changed = false;
+        do changed = applyInputEvent(e, input, !outputsActive(), descs) || changed;
+        while (SDL_PollEvent(&e));
+        changed = applyOscControl(input, descs) || changed;
+        // the render thread found nothing to draw for the selected effect
+        if (effectSkipped(input.current)) {
+            int next = selectableEffect(input.current, 1, (int)effects.size());
+            if (next < 0) {
+                std::cerr << "No effect could be built\n";
+                input.running = false;
+                status = 1;
+            } else {
+                input.current = next;
+            }
+            changed = true;
+        }
+        if (input.current != shownEffect) {
+            shownEffect = input.current;
+            SDL_SetWindowTitle(win, titles[shownEffect]);
+        }
+        if (changed) {
+            snapshots.back() = input;
+            snapshots.publish();
+        }
+    }
+    renderer.join();
+    closeOutputWindows();
+    closeShaderCompilerWindow();
+    stopOscControl();
+    stopClockSync();
+
+    shutdownAudio();
+    closeTimeline();
+    SDL_GL_DeleteContext(ctx);
+    SDL_DestroyWindow(win);
+    SDL_Quit();
+    stopTelemetry();
+    return status;
+}
@@ -0,0 +1,177 @@
+// tonemap.cpp
+// RGBA16F scene target and the tonemap, grade and dither resolve.
+
+#include "tonemap.h"
+#include "bloom.h"
+#include <algorithm>
+#include <iostream>
+
+static const char* resolveFragmentSrc = R"glsl(
+#version 330 core
+out vec4 fragColor;
+uniform sampler2D uScene;
+uniform sampler2D uBloom;
+uniform vec2 uBloomScale;  // part of uBloom this frame covers
+uniform vec2 uBloomTexel;
+uniform vec2 uSceneSize;
+uniform float uBloomGain;  // 0 without bloom
+uniform float uExposure;
+uniform float uGamma;    // the effect's grading exponent
+uniform float uKnee;
+uniform float uDither;   // one output step
+uniform int uFrame;
+uniform bool uLinearOut; // an sRGB framebuffer encodes after us
+
+// identity up to the knee; a knee of 1 leaves a hard clamp (the soft part shrinks to nothing)
+vec3 shoulder(vec3 c){
+    float soft = max(1.0 - uKnee, 1e-5);
+    vec3 over = max(c - uKnee, 0.0);
+    return min(c, uKnee) + soft * (1.0 - exp(-over / soft));
+}
+
+float hash(vec2 p){
+    vec3 q = fract(vec3(p.xyx) * 0.1031);
+    q += dot(q, q.yzx + 33.33);
+    return fract((q.x + q.y) * q.z);
+}
+
+vec3 srgbToLinear(vec3 c){
+    return mix(c / 12.92, pow((c + 0.055) / 1.055, vec3(2.4)), step(0.04045, c));
+}
+
+void main(){
+    // the scene is drawn at the size of the viewport this pass covers
+    vec3 c = texelFetch(uScene, ivec2(gl_FragCoord.xy), 0).rgb;
+    if (uBloomGain > 0.0) {
+        vec2 st = gl_FragCoord.xy / uSceneSize * uBloomScale;
+        c += uBloomGain * texture(uBloom, clamp(st, 0.5 * uBloomTexel, uBloomScale - 0.5 * uBloomTexel)).rgb;
+    }
+    c = shoulder(max(c * uExposure, 0.0));
+    c = pow(c, vec3(uGamma));
+    // triangular noise in [-1, 1) steps, shifted every frame
+    vec2 p = gl_FragCoord.xy + float(uFrame & 63) * vec2(47.0, 17.0);
+    c += (hash(p) + hash(p + 0.5) - 1.0) * uDither;
+    c = clamp(c, 0.0, 1.0);
+    fragColor = vec4(uLinearOut ? srgbToLinear(c) : c, 1.0);
+}
+)glsl";
+
+static struct {
+    bool initialized = false;
+    bool srgb = false;
+    RenderTarget target;
+    GLuint prog = 0;
+    GLint locScene = -1, locBloom = -1, locBloomScale = -1, locBloomTexel = -1, locSceneSize = -1, locBloomGain = -1;
+    GLint locExposure = -1, locGamma = -1, locKnee = -1, locDither = -1, locFrame = -1, locLinearOut = -1;
+    GLint prevFbo = 0;
+    GLint prevViewport[4] = {};
+    int rw = 0, rh = 0;
+} tm;
+
+ToneDesc mixTone(const ToneDesc& a, const ToneDesc& b, float k) {
+    ToneDesc t;
+    t.exposure = a.exposure + (b.exposure - a.exposure) * k;
+    t.gamma = a.gamma + (b.gamma - a.gamma) * k;
+    t.bloom = a.bloom + (b.bloom - a.bloom) * k;
+    t.bloomThreshold = a.bloomThreshold + (b.bloomThreshold - a.bloomThreshold) * k;
+    t.knee = a.knee + (b.knee - a.knee) * k;
+    return t;
+}
+
+// Whether the window's back buffer really got an sRGB format
+static bool defaultFramebufferSrgb() {
+    GLint prev = 0;
+    glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &prev);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    GLint encoding = GL_LINEAR;
+    glGetFramebufferAttachmentParameteriv(GL_FRAMEBUFFER, GL_BACK_LEFT, GL_FRAMEBUFFER_ATTACHMENT_COLOR_ENCODING, &encoding);
+    glBindFramebuffer(GL_FRAMEBUFFER, (GLuint)prev);
+    return encoding == GL_SRGB;
+}
+
+bool initTonemap(int w, int h, bool srgbOutput) {
+    GLuint vs = compileShader(GL_VERTEX_SHADER, vertexShaderSrc);
+    GLuint fs = compileShader(GL_FRAGMENT_SHADER, resolveFragmentSrc);
+    if (!vs || !fs) return false;
+    tm.prog = linkProgram(vs, fs);
+    glDeleteShader(vs); glDeleteShader(fs);
+    if (!tm.prog) return false;
+    tm.locScene = glGetUniformLocation(tm.prog, "uScene");
+    tm.locBloom = glGetUniformLocation(tm.prog, "uBloom");
+    tm.locBloomScale = glGetUniformLocation(tm.prog, "uBloomScale");
+    tm.locBloomTexel = glGetUniformLocation(tm.prog, "uBloomTexel");
+    tm.locSceneSize = glGetUniformLocation(tm.prog, "uSceneSize");
+    tm.locBloomGain = glGetUniformLocation(tm.prog, "uBloomGain");
+    tm.locExposure = glGetUniformLocation(tm.prog, "uExposure");
+    tm.locGamma = glGetUniformLocation(tm.prog, "uGamma");
+    tm.locKnee = glGetUniformLocation(tm.prog, "uKnee");
+    tm.locDither = glGetUniformLocation(tm.prog, "uDither");
+    tm.locFrame = glGetUniformLocation(tm.prog, "uFrame");
+    tm.locLinearOut = glGetUniformLocation(tm.prog, "uLinearOut");
+
+    if (!createRenderTarget(tm.target, w, h, GL_RGBA16F)) {
+        glDeleteProgram(tm.prog);
+        tm.prog = 0;
+        return false;
+    }
+    tm.srgb = srgbOutput && defaultFramebufferSrgb();
+    if (srgbOutput && !tm.srgb) std::cerr << "Tonemap: no sRGB framebuffer, encoding in the shader\n";
+    tm.initialized = true;
+    return true;
+}
+
+void shutdownTonemap() {
+    if (!tm.initialized) return;
+    destroyRenderTarget(tm.target);
+    glDeleteProgram(tm.prog);
+    tm.prog = 0;
+    tm.initialized = false;
+}
+
+void resizeTonemap(int w, int h) {
+    if (!tm.initialized) return;
+    resizeRenderTarget(tm.target, w, h);
+}
+
+void beginTonemap(int rw, int rh) {
+    if (!tm.initialized) return;
+    glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &tm.prevFbo);
+    glGetIntegerv(GL_VIEWPORT, tm.prevViewport);
+    tm.rw = std::min(rw, tm.target.w);
+    tm.rh = std::min(rh, tm.target.h);
+    glBindFramebuffer(GL_FRAMEBUFFER, tm.target.fbo);
+    glViewport(0, 0, tm.rw, tm.rh);
+}
+
+void endTonemap(const FullscreenTriangle& tri, const ToneDesc& tone, int frame) {
+    if (!tm.initialized) return;
+    BloomImage bloom;
+    if (tone.bloom > 0.0f) bloom = buildBloom(tri, tm.target, tm.rw, tm.rh, tone.bloomThreshold);
+    glBindFramebuffer(GL_FRAMEBUFFER, (GLuint)tm.prevFbo);
+    glViewport(tm.prevViewport[0], tm.prevViewport[1], tm.prevViewport[2], tm.prevViewport[3]);
+
+    // offscreen targets (dynamic resolution, output views, readbacks) are
+    // plain RGBA8 and get encoded values
+    bool hardwareEncode = tm.srgb && tm.prevFbo == 0;
+    glUseProgram(tm.prog);
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, tm.target.tex);
+    glUniform1i(tm.locScene, 0);
+    glActiveTexture(GL_TEXTURE0 + tonemapBloomUnit);
+    glBindTexture(GL_TEXTURE_2D, bloom.tex);
+    glUniform1i(tm.locBloom, tonemapBloomUnit);
+    glUniform2f(tm.locBloomScale, bloom.uvScale[0], bloom.uvScale[1]);
+    glUniform2f(tm.locBloomTexel, bloom.texel[0], bloom.texel[1]);
+    glUniform2f(tm.locSceneSize, (float)tm.rw, (float)tm.rh);
+    glUniform1f(tm.locBloomGain, bloom.tex ? tone.bloom * bloom.gain : 0.0f);
+    glActiveTexture(GL_TEXTURE0);
+    glUniform1f(tm.locExposure, tone.exposure);
+    glUniform1f(tm.locGamma, tone.gamma);
+    glUniform1f(tm.locKnee, tone.knee);
+    glUniform1f(tm.locDither, 1.0f / 255.0f);
+    glUniform1i(tm.locFrame, frame);
+    glUniform1i(tm.locLinearOut, hardwareEncode ? 1 : 0);
+    if (hardwareEncode) glEnable(GL_FRAMEBUFFER_SRGB);
+    drawFullscreenTriangle(tri);
+    if (hardwareEncode) glDisable(GL_FRAMEBUFFER_SRGB);
+}
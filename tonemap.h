@@ -0,0 +1,49 @@
+// tonemap.h
+// HDR scene target and the one pass that turns it into display values.
+// Effects write unclamped linear colour into an RGBA16F target (and so do
+// the passes nested inside it: aberration, temporal, transitions); a single
+// resolve then applies the effect's exposure, its highlight shoulder (a
+// hard clamp unless it asks for one), its grading exponent (its ToneDesc)
+// and a triangular dither of one output step, which hides the banding the
+// 8-bit outputs would show in the glow falloffs. Bloom (bloom.h) is built
+// from the scene target and added before the exposure. With an sRGB-capable
+// window the pass writes linear values and the hardware encodes them.
+#pragma once
+#include "gl-util.h"
+
+// How the pass turns an effect's linear HDR colour into display values: add
+// bloom * the blurred parts above bloomThreshold, multiply by exposure, roll
+// off the highlights above knee, then pow(c, gamma), the grade its shader
+// used to end with. A zero bloom skips building it.
+//
+// Below the knee the shoulder passes values through unchanged; above it they
+// roll off toward 1 instead of clipping, which also compresses (knee, 1]. At
+// the default knee of 1 it is the clamp the shaders used to end with, so an
+// effect looks exactly as it did until it opts into a softer shoulder.
+struct ToneDesc {
+    float exposure = 1.0f;
+    float gamma = 1.0f;
+    float bloom = 0.0f;
+    float bloomThreshold = 1.0f;
+    float knee = 1.0f;
+};
+
+// Tone for a frame that is k of the way from tone a to tone b
+ToneDesc mixTone(const ToneDesc& a, const ToneDesc& b, float k);
+
+// The bloom result is sampled here; the scene itself on unit 0
+static const int tonemapBloomUnit = 5;
+
+// srgbOutput: the window was created with SDL_GL_FRAMEBUFFER_SRGB_CAPABLE;
+// if the default framebuffer turns out not to be sRGB the pass encodes itself
+bool initTonemap(int w, int h, bool srgbOutput);
+void shutdownTonemap();
+
+// Window resize: reallocates the scene target
+void resizeTonemap(int w, int h);
+
+// Redirects drawing into the scene target at rw x rh; the host clears it
+void beginTonemap(int rw, int rh);
+// Resolves into the framebuffer and viewport bound at begin. frame varies
+// the dither pattern.
+void endTonemap(const FullscreenTriangle& tri, const ToneDesc& tone, int frame);
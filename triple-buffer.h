@@ -0,0 +1,34 @@
+// triple-buffer.h
+// Lock-free single-writer/single-reader triple buffer. The writer fills
+// back() and publishes it; the reader picks up the newest published value
+// with update() and reads front() until the next one. Neither side ever
+// waits: intermediate values the reader didn't get to are simply replaced.
+#pragma once
+#include <atomic>
+
+template <typename T>
+class TripleBuffer {
+public:
+    explicit TripleBuffer(const T& initial) : slots{ initial, initial, initial } {}
+
+    // Writer side
+    T& back() { return slots[backIndex]; }
+    void publish() {
+        backIndex = middle.exchange(backIndex | freshBit, std::memory_order_acq_rel) & indexMask;
+    }
+
+    // Reader side: true if front() changed
+    bool update() {
+        if (!(middle.load(std::memory_order_relaxed) & freshBit)) return false;
+        frontIndex = middle.exchange(frontIndex, std::memory_order_acq_rel) & indexMask;
+        return true;
+    }
+    const T& front() const { return slots[frontIndex]; }
+
+private:
+    static constexpr int freshBit = 4, indexMask = 3;
+    T slots[3];
+    int backIndex = 0;   // writer only
+    int frontIndex = 1;  // reader only
+    alignas(64) std::atomic<int> middle{ 2 };
+};
@@ -0,0 +1,389 @@
+// video-export.cpp
+// Deterministic offscreen rendering with asynchronous readback and streaming writers.
+
+#include "video-export.h"
+#include "effects.h"
+#include "gl-util.h"
+#include "shader-compiler.h"
+#include "noise-texture.h"
+#include "chromatic-aberration.h"
+#include "tonemap.h"
+#include "bloom.h"
+#include "frame-params.h"
+#include "timeline.h"
+#include "png-writer.h"
+#include <iostream>
+#include <string>
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <algorithm>
+#include <numeric>
+#include <cstdio>
+#include <cstring>
+#include <cstdint>
+#include <cmath>
+#include <atomic>
+
+#ifdef _WIN32
+#define popen _popen
+#define pclose _pclose
+static const char* pipeMode = "wb";
+#else
+static const char* pipeMode = "w";
+#endif
+
+// Not every glad build carries these (GL 4.4 / ARB_buffer_storage)
+#ifndef GL_MAP_PERSISTENT_BIT
+#define GL_MAP_PERSISTENT_BIT 0x0040
+#endif
+#ifndef GL_MAP_COHERENT_BIT
+#define GL_MAP_COHERENT_BIT 0x0080
+#endif
+
+typedef void (APIENTRY* PFNBUFFERSTORAGE)(GLenum target, GLsizeiptr size, const void* data, GLbitfield flags);
+
+// Readbacks in flight. A frame is handed to the writer readbackLag frames
+// after it is issued, when its fence has normally passed, and its buffer is
+// reused readbackSlots frames after, giving the writer the difference.
+static const int readbackSlots = 4;
+static const int readbackLag = 2;
+
+enum class ExportFormat { Y4M, PNG, FFmpeg };
+
+struct ReadbackSlot {
+    GLuint pbo = 0;
+    GLsync fence = nullptr;
+    const uint8_t* mapped = nullptr; // persistent mapping, if available
+    std::vector<uint8_t> staging;    // copy of the frame otherwise
+    int frame = -1;
+    bool busy = false;               // owned by the writer thread
+};
+
+static struct {
+    ExportFormat format = ExportFormat::Y4M;
+    std::string output;
+    int w = 0, h = 0;
+    FILE* file = nullptr;            // Y4M file or ffmpeg pipe
+    std::vector<uint8_t> scratch;    // writer-side conversion buffer
+    std::atomic<bool> failed{ false };
+
+    ReadbackSlot slots[readbackSlots];
+    std::thread writer;
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::deque<int> queue;           // slots ready to write, in frame order
+    bool quit = false;
+} ex;
+
+// ---- Y4M: planar 4:4:4, BT.709 limited range ----
+
+static bool writeY4mFrame(const uint8_t* rgbaBottomUp, int w, int h) {
+    size_t plane = (size_t)w * h;
+    ex.scratch.resize(plane * 3);
+    uint8_t* Y = ex.scratch.data();
+    uint8_t* U = Y + plane;
+    uint8_t* V = U + plane;
+    for (int y = 0; y < h; ++y) {
+        const uint8_t* row = rgbaBottomUp + (size_t)(h - 1 - y) * w * 4;
+        size_t o = (size_t)y * w;
+        for (int x = 0; x < w; ++x, ++o) {
+            int r = row[x * 4], g = row[x * 4 + 1], b = row[x * 4 + 2];
+            // coefficients scaled by 256
+            Y[o] = (uint8_t)((47 * r + 157 * g + 16 * b + 128) / 256 + 16);
+            U[o] = (uint8_t)((-26 * r - 87 * g + 112 * b + 128 * 256 + 128) / 256);
+            V[o] = (uint8_t)((112 * r - 102 * g - 10 * b + 128 * 256 + 128) / 256);
+        }
+    }
+    return fputs("FRAME\n", ex.file) >= 0 && fwrite(ex.scratch.data(), 1, ex.scratch.size(), ex.file) == ex.scratch.size();
+}
+
+static bool writeRawFrame(const uint8_t* rgbaBottomUp, int w, int h) {
+    size_t stride = (size_t)w * 4;
+    for (int y = h - 1; y >= 0; --y)
+        if (fwrite(rgbaBottomUp + y * stride, 1, stride, ex.file) != stride) return false;
+    return true;
+}
+
+static bool writeFrame(int frame, const uint8_t* rgba) {
+    switch (ex.format) {
+    case ExportFormat::Y4M: return writeY4mFrame(rgba, ex.w, ex.h);
+    case ExportFormat::FFmpeg: return writeRawFrame(rgba, ex.w, ex.h);
+    case ExportFormat::PNG: {
+        char path[1024];
+        snprintf(path, sizeof(path), ex.output.c_str(), frame);
+        return writePng(path, rgba, ex.w, ex.h);
+    }
+    }
+    return false;
+}
+
+static void writerMain() {
+    std::unique_lock<std::mutex> lock(ex.mutex);
+    for (;;) {
+        ex.cv.wait(lock, [] { return ex.quit || !ex.queue.empty(); });
+        if (ex.queue.empty()) break;
+        int index = ex.queue.front();
+        ex.queue.pop_front();
+        ReadbackSlot& slot = ex.slots[index];
+        lock.unlock();
+
+        const uint8_t* pixels = slot.mapped ? slot.mapped : slot.staging.data();
+        bool ok = ex.failed || writeFrame(slot.frame, pixels);
+
+        lock.lock();
+        if (!ok && !ex.failed) {
+            std::cerr << "Export: writing frame " << slot.frame << " failed\n";
+            ex.failed = true;
+        }
+        slot.busy = false;
+        ex.cv.notify_all();
+    }
+}
+
+static bool openOutput(const ExportOptions& opts) {
+    ex.output = opts.output;
+    std::string out = ex.output;
+    auto endsWith = [&](const char* s) {
+        size_t n = std::strlen(s);
+        return out.size() >= n && out.compare(out.size() - n, n, s) == 0;
+    };
+
+    if (out.find('%') != std::string::npos && endsWith(".png")) {
+        ex.format = ExportFormat::PNG;
+        return true;
+    }
+
+    // rational frame rate, e.g. 60000:1001 for 59.94
+    long num = std::lround(opts.fps * 1000.0), den = 1000;
+    long g = std::gcd(num, den);
+    num /= g; den /= g;
+
+    if (endsWith(".y4m")) {
+        ex.format = ExportFormat::Y4M;
+        ex.file = fopen(out.c_str(), "wb");
+        if (!ex.file) { std::cerr << "Cannot write " << out << "\n"; return false; }
+        fprintf(ex.file, "YUV4MPEG2 W%d H%d F%ld:%ld Ip A1:1 C444 XCOLORRANGE=LIMITED\n", ex.w, ex.h, num, den);
+        return true;
+    }
+
+    ex.format = ExportFormat::FFmpeg;
+    char cmd[2048];
+    snprintf(cmd, sizeof(cmd),
+        "ffmpeg -y -loglevel error -f rawvideo -pix_fmt rgba -s %dx%d -r %ld/%ld -i - %s \"%s\"",
+        ex.w, ex.h, num, den, opts.ffmpegArgs, out.c_str());
+    ex.file = popen(cmd, pipeMode);
+    if (!ex.file) { std::cerr << "Cannot start: " << cmd << "\n"; return false; }
+    std::cout << "Export: " << cmd << "\n";
+    return true;
+}
+
+static bool closeOutput() {
+    if (!ex.file) return true;
+    bool ok = ex.format == ExportFormat::FFmpeg ? pclose(ex.file) == 0 : fclose(ex.file) == 0;
+    if (!ok) std::cerr << "Export: closing " << ex.output << " failed\n";
+    ex.file = nullptr;
+    return ok;
+}
+
+static void createSlots() {
+    GLsizeiptr size = (GLsizeiptr)ex.w * ex.h * 4;
+    PFNBUFFERSTORAGE bufferStorage = nullptr;
+    if (SDL_GL_ExtensionSupported("GL_ARB_buffer_storage"))
+        bufferStorage = (PFNBUFFERSTORAGE)SDL_GL_GetProcAddress("glBufferStorage");
+    for (ReadbackSlot& slot : ex.slots) {
+        glGenBuffers(1, &slot.pbo);
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.pbo);
+        if (bufferStorage) {
+            // the writer reads straight from the mapping; nothing is copied on the render thread
+            const GLbitfield flags = GL_MAP_READ_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+            bufferStorage(GL_PIXEL_PACK_BUFFER, size, nullptr, flags);
+            slot.mapped = (const uint8_t*)glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, size, flags);
+        }
+        if (!slot.mapped) {
+            if (bufferStorage) {
+                glDeleteBuffers(1, &slot.pbo);
+                glGenBuffers(1, &slot.pbo);
+                glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.pbo);
+            }
+            glBufferData(GL_PIXEL_PACK_BUFFER, size, nullptr, GL_STREAM_READ);
+            slot.staging.resize((size_t)size);
+        }
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    std::cout << "Export: " << readbackSlots << " readback buffers, "
+        << (ex.slots[0].mapped ? "persistent mapped" : "map and copy") << "\n";
+}
+
+static void destroySlots() {
+    for (ReadbackSlot& slot : ex.slots) {
+        if (slot.fence) glDeleteSync(slot.fence);
+        if (slot.mapped) {
+            glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.pbo);
+            glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+        }
+        glDeleteBuffers(1, &slot.pbo);
+        slot = ReadbackSlot{};
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+}
+
+// Waits for the slot's readback and queues it for the writer
+static double submitSlot(int index) {
+    ReadbackSlot& slot = ex.slots[index];
+    auto t0 = std::chrono::high_resolution_clock::now();
+    glClientWaitSync(slot.fence, GL_SYNC_FLUSH_COMMANDS_BIT, GL_TIMEOUT_IGNORED);
+    glDeleteSync(slot.fence);
+    slot.fence = nullptr;
+    if (!slot.mapped) {
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.pbo);
+        const void* p = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, (GLsizeiptr)slot.staging.size(), GL_MAP_READ_BIT);
+        if (p) std::memcpy(slot.staging.data(), p, slot.staging.size());
+        glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    }
+    std::chrono::duration<double, std::milli> waited = std::chrono::high_resolution_clock::now() - t0;
+
+    std::lock_guard<std::mutex> lock(ex.mutex);
+    slot.busy = true;
+    ex.queue.push_back(index);
+    ex.cv.notify_all();
+    return waited.count();
+}
+
+int runExport(const ExportOptions& opts) {
+    if (SDL_Init(SDL_INIT_VIDEO) != 0) {
+        std::cerr << "SDL_Init failed: " << SDL_GetError() << "\n";
+        return 1;
+    }
+    SDL_GLContext ctx = nullptr;
+    SDL_Window* win = createGLWindow("timewarp export", 64, 64, SDL_WINDOW_HIDDEN, &ctx);
+    if (!win) return 1;
+    SDL_GL_SetSwapInterval(0);
+
+    GLint maxTex = 0, maxDims[2] = {};
+    glGetIntegerv(GL_MAX_TEXTURE_SIZE, &maxTex);
+    glGetIntegerv(GL_MAX_VIEWPORT_DIMS, maxDims);
+    int limit = std::min(maxTex, std::min(maxDims[0], maxDims[1]));
+    ex.w = opts.width; ex.h = opts.height;
+    if (ex.w <= 0 || ex.h <= 0 || ex.w > limit || ex.h > limit) {
+        std::cerr << "Export size " << ex.w << "x" << ex.h << " not supported, this GPU renders up to " << limit << "\n";
+        return 1;
+    }
+    if (!openOutput(opts)) return 1;
+
+    initShaderCompiler(win, ctx, opts.shaderCache);
+    std::vector<Effect> effects;
+    registerEffects(effects);
+    FullscreenTriangle tri;
+    createFullscreenTriangle(tri);
+    initNoiseTexture();
+    initFrameParams();
+    initChromaticAberration(ex.w, ex.h);
+    initTonemap(ex.w, ex.h, false);
+    initBloom(ex.w, ex.h);
+    int index = opts.effect ? findEffect(effects, opts.effect) : 0;
+    if (index >= 0) requestEffect(effects[index]);
+    while (updateEffects(effects, tri) > 0) finishShaderCompiler();
+
+    RenderTarget rt;
+    if (index < 0 || !effects[index].prog || !createRenderTarget(rt, ex.w, ex.h)) {
+        std::cerr << "Export: " << (index < 0 ? "unknown effect" : "effect or framebuffer unavailable") << "\n";
+        index = -1;
+    }
+
+    int frames = std::max(1, (int)std::lround(opts.seconds * opts.fps));
+    double gpuWaitMs = 0.0, writerWaitMs = 0.0;
+    auto start = std::chrono::high_resolution_clock::now();
+    if (index >= 0) {
+        Effect& fx = effects[index];
+        float aberration = effectAberration(fx);
+        std::cout << "Export: '" << fx.desc->name << "' " << frames << " frames at "
+            << ex.w << "x" << ex.h << ", " << opts.fps << " fps -> " << ex.output << "\n";
+        createSlots();
+        ex.quit = false;
+        ex.writer = std::thread(writerMain);
+        glPixelStorei(GL_PACK_ALIGNMENT, 4);
+
+        auto lastReport = start;
+        for (int i = 0; i < frames && !ex.failed; ++i) {
+            if (i >= readbackLag) gpuWaitMs += submitSlot((i - readbackLag) % readbackSlots);
+            // the frame this buffer held was queued a while ago; it must be written before reuse
+            ReadbackSlot& slot = ex.slots[i % readbackSlots];
+            {
+                auto t0 = std::chrono::high_resolution_clock::now();
+                std::unique_lock<std::mutex> lock(ex.mutex);
+                ex.cv.wait(lock, [&] { return !slot.busy; });
+                writerWaitMs += std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - t0).count();
+            }
+
+            glBindFramebuffer(GL_FRAMEBUFFER, rt.fbo);
+            glViewport(0, 0, ex.w, ex.h);
+            double time = opts.start + i / opts.fps;
+            if (timelineLoaded()) {
+                // keyed params may need another variant; build it before drawing
+                applyTimeline(time, fx.params);
+                while (updateEffects(effects, tri) > 0) finishShaderCompiler();
+                aberration = effectAberration(fx);
+            }
+            updateEffectFrame(fx, time, ex.w, ex.h, i);
+            beginTonemap(ex.w, ex.h);
+            if (aberration > 0.0f) beginChromaticAberration(ex.w, ex.h);
+            useEffect(fx);
+            drawFullscreenTriangle(tri);
+            if (aberration > 0.0f) endChromaticAberration(tri, aberration);
+            endTonemap(tri, fx.desc->tone, i);
+
+            glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.pbo);
+            glReadPixels(0, 0, ex.w, ex.h, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+            glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+            slot.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+            slot.frame = i;
+            glFlush();
+
+            auto now = std::chrono::high_resolution_clock::now();
+            if (std::chrono::duration<double>(now - lastReport).count() >= 1.0) {
+                double secs = std::chrono::duration<double>(now - start).count();
+                std::cout << "Export: " << i + 1 << "/" << frames << " frames, " << (i + 1) / secs << " fps\n";
+                lastReport = now;
+            }
+        }
+        // drain the readbacks still in flight, oldest first
+        for (int i = std::max(0, frames - readbackLag); i < frames; ++i) {
+            int s = i % readbackSlots;
+            if (ex.slots[s].fence) gpuWaitMs += submitSlot(s);
+        }
+        {
+            std::lock_guard<std::mutex> lock(ex.mutex);
+            ex.quit = true;
+        }
+        ex.cv.notify_all();
+        ex.writer.join();
+        destroySlots();
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        destroyRenderTarget(rt);
+    }
+    std::chrono::duration<double> wall = std::chrono::high_resolution_clock::now() - start;
+    bool ok = closeOutput() && index >= 0 && !ex.failed;
+    if (ok) {
+        // waiting on the writer means encoding is the bottleneck, on fences means shading
+        std::cout << "Export: " << frames << " frames in " << wall.count() << " s (" << frames / wall.count()
+            << " fps), waited " << gpuWaitMs << " ms on the GPU and " << writerWaitMs << " ms on the writer\n";
+    }
+
+    shutdownBloom();
+    shutdownTonemap();
+    shutdownChromaticAberration();
+    shutdownFrameParams();
+    shutdownNoiseTexture();
+    shutdownShaderCompiler();
+    destroyFullscreenTriangle(tri);
+    destroyEffects(effects);
+    SDL_GL_DeleteContext(ctx);
+    SDL_DestroyWindow(win);
+    SDL_Quit();
+    return ok ? 0 : 2;
+}
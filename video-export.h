@@ -0,0 +1,20 @@
+// video-export.h
+// Offline video export: renders one effect into an offscreen framebuffer at
+// any size with a fixed time step, reads frames back through a ring of pixel
+// buffer objects guarded by fences and hands them to a writer thread, so the
+// GPU keeps shading while earlier frames are encoded.
+#pragma once
+
+struct ExportOptions {
+    const char* output = nullptr;     // .y4m, a PNG pattern with %d (frames/%05d.png), or anything ffmpeg writes
+    const char* effect = nullptr;     // first effect if null
+    int width = 1920;
+    int height = 1080;
+    double fps = 60.0;
+    double seconds = 10.0;
+    double start = 0.0;               // effect time of the first frame
+    const char* ffmpegArgs = "-c:v libx264 -preset medium -crf 16 -pix_fmt yuv420p";
+    const char* shaderCache = nullptr;
+};
+
+int runExport(const ExportOptions& opts);
@@ -0,0 +1,946 @@
+// vulkan-backend.cpp
+// The Vulkan side of render-backend.h: effects compiled to SPIR-V by shaderc
+// and cached on disk, a pipeline cache, an RGBA16F scene pass and the
+// tonemap pass into the swapchain, with several frames in flight.
+
+#include "render-backend.h"
+
+#ifndef TIMEWARP_VULKAN
+
+const RenderBackend* vulkanBackend() { return nullptr; }
+
+#else
+
+#include <vulkan/vulkan.h>
+#include <SDL2/SDL_vulkan.h>
+#include <shaderc/shaderc.h>
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <vector>
+
+#ifdef _WIN32
+#pragma comment(lib, "vulkan-1.lib")
+#pragma comment(lib, "shaderc_combined.lib")
+#endif
+
+static const int maxFramesInFlight = 3;
+static const VkFormat sceneFormat = VK_FORMAT_R16G16B16A16_SFLOAT;
+
+// The GL host's triangle, from the vertex index instead of a buffer
+static const char* vulkanVertexSrc = R"glsl(
+#version 450
+layout(location = 0) out vec2 uv;
+void main(){
+    vec2 pos = vec2(gl_VertexIndex == 1 ? 3.0 : -1.0, gl_VertexIndex == 2 ? 3.0 : -1.0);
+    uv = pos * 0.5 + 0.5;
+    gl_Position = vec4(pos, 0.0, 1.0);
+}
+)glsl";
+
+// tonemap.cpp's resolve without bloom: there is no bloom chain on this
+// backend, and the bare host zeroes ToneDesc::bloom on GL too so the two
+// compare. Porting the downsample/blur chain is what closes the gap with the
+// full host. Clip y = -1 is the top row here and the bottom one in GL, so the
+// scene is stored bottom row first like a GL texture (uv and gl_FragCoord
+// match what the effects expect) and this pass flips it while reading.
+static const char* vulkanToneSrc = R"glsl(
+#version 450
+layout(location = 0) out vec4 fragColor;
+layout(set = 0, binding = 0) uniform sampler2D uScene;
+layout(push_constant) uniform Tone {
+    float exposure;
+    float gamma;
+    float knee;
+    float dither;
+    int frame;
+    int linearOut;
+    int height;
+} tone;
+
+vec3 shoulder(vec3 c){
+    float soft = max(1.0 - tone.knee, 1e-5);
+    vec3 over = max(c - tone.knee, 0.0);
+    return min(c, tone.knee) + soft * (1.0 - exp(-over / soft));
+}
+
+float hash(vec2 p){
+    vec3 q = fract(vec3(p.xyx) * 0.1031);
+    q += dot(q, q.yzx + 33.33);
+    return fract((q.x + q.y) * q.z);
+}
+
+vec3 srgbToLinear(vec3 c){
+    return mix(c / 12.92, pow((c + 0.055) / 1.055, vec3(2.4)), step(0.04045, c));
+}
+
+void main(){
+    ivec2 texel = ivec2(int(gl_FragCoord.x), tone.height - 1 - int(gl_FragCoord.y));
+    vec3 c = texelFetch(uScene, texel, 0).rgb;
+    c = shoulder(max(c * tone.exposure, 0.0));
+    c = pow(c, vec3(tone.gamma));
+    vec2 p = vec2(texel) + 0.5 + float(tone.frame & 63) * vec2(47.0, 17.0);
+    c += (hash(p) + hash(p + 0.5) - 1.0) * tone.dither;
+    c = clamp(c, 0.0, 1.0);
+    fragColor = vec4(tone.linearOut != 0 ? srgbToLinear(c) : c, 1.0);
+}
+)glsl";
+
+// Mirrors the push constant block above
+struct TonePush {
+    float exposure;
+    float gamma;
+    float knee;
+    float dither;
+    int32_t frame;
+    int32_t linearOut;
+    int32_t height;
+};
+
+struct FrameSlot {
+    VkCommandBuffer cmd = VK_NULL_HANDLE;
+    VkSemaphore acquired = VK_NULL_HANDLE;
+    VkFence done = VK_NULL_HANDLE;
+};
+
+static struct {
+    SDL_Window* win = nullptr;
+    BackendOptions opts;
+    std::filesystem::path cacheDir;
+    VkInstance instance = VK_NULL_HANDLE;
+    VkSurfaceKHR surface = VK_NULL_HANDLE;
+    VkPhysicalDevice gpu = VK_NULL_HANDLE;
+    VkPhysicalDeviceProperties gpuProps = {};
+    VkDevice device = VK_NULL_HANDLE;
+    uint32_t queueFamily = 0;
+    VkQueue queue = VK_NULL_HANDLE;
+    VkSurfaceFormatKHR surfaceFormat = {};
+    VkPresentModeKHR presentMode = VK_PRESENT_MODE_FIFO_KHR;
+
+    // swapchain and everything sized by it
+    VkSwapchainKHR swapchain = VK_NULL_HANDLE;
+    VkExtent2D extent = {};
+    std::vector<VkImage> images;
+    std::vector<VkImageView> views;
+    std::vector<VkFramebuffer> framebuffers;
+    std::vector<VkSemaphore> rendered;  // per swapchain image: a present waits on its own
+    VkImage scene = VK_NULL_HANDLE;
+    VkDeviceMemory sceneMemory = VK_NULL_HANDLE;
+    VkImageView sceneView = VK_NULL_HANDLE;
+    VkFramebuffer sceneFramebuffer = VK_NULL_HANDLE;
+    bool recreate = false;
+
+    VkRenderPass scenePass = VK_NULL_HANDLE;
+    VkRenderPass tonePass = VK_NULL_HANDLE;
+    VkDescriptorSetLayout effectSetLayout = VK_NULL_HANDLE, toneSetLayout = VK_NULL_HANDLE;
+    VkPipelineLayout effectLayout = VK_NULL_HANDLE, toneLayout = VK_NULL_HANDLE;
+    VkDescriptorPool descriptorPool = VK_NULL_HANDLE;
+    VkDescriptorSet effectSet = VK_NULL_HANDLE, toneSet = VK_NULL_HANDLE;
+    VkSampler sampler = VK_NULL_HANDLE;
+    VkPipelineCache pipelineCache = VK_NULL_HANDLE;
+    VkShaderModule vertexModule = VK_NULL_HANDLE;
+    VkPipeline tonePipeline = VK_NULL_HANDLE;
+    std::vector<VkPipeline> programs;
+
+    // FrameParams, one slot per frame in flight, persistently mapped
+    VkBuffer ubo = VK_NULL_HANDLE;
+    VkDeviceMemory uboMemory = VK_NULL_HANDLE;
+    char* uboMapped = nullptr;
+    VkDeviceSize uboStride = 0;
+
+    VkCommandPool commandPool = VK_NULL_HANDLE;
+    FrameSlot frames[maxFramesInFlight];
+    int framesInFlight = 2;
+    int slot = 0;
+    int w = 0, h = 0;
+} vk;
+
+// ---- SPIR-V: shaderc at run time, cached by source hash ----
+
+// FNV-1a, as shader-compiler.cpp keys its binaries
+static uint64_t hashSource(const std::string& s) {
+    uint64_t h = 14695981039346656037ull;
+    for (char c : s) {
+        h ^= (uint8_t)c;
+        h *= 1099511628211ull;
+    }
+    return h;
+}
+
+static std::filesystem::path spirvPath(uint64_t key) {
+    char name[32];
+    snprintf(name, sizeof(name), "%016llx.spv", (unsigned long long)key);
+    return vk.cacheDir / name;
+}
+
+static bool loadSpirv(uint64_t key, std::vector<uint32_t>& code) {
+    if (vk.cacheDir.empty()) return false;
+    std::ifstream in(spirvPath(key), std::ios::binary | std::ios::ate);
+    if (!in) return false;
+    std::streamsize size = in.tellg();
+    if (size <= 0 || size % 4 != 0) return false;
+    code.resize((size_t)size / 4);
+    in.seekg(0);
+    in.read((char*)code.data(), size);
+    return (bool)in && code[0] == 0x07230203u; // SPIR-V magic
+}
+
+static void storeSpirv(uint64_t key, const std::vector<uint32_t>& code) {
+    if (vk.cacheDir.empty()) return;
+    // temp file and rename, so a concurrent launch never reads half a module
+    std::filesystem::path path = spirvPath(key);
+    std::filesystem::path tmp = path;
+    tmp += ".tmp";
+    {
+        std::ofstream out(tmp, std::ios::binary | std::ios::trunc);
+        if (!out) return;
+        out.write((const char*)code.data(), (std::streamsize)(code.size() * 4));
+        if (!out) return;
+    }
+    std::error_code ec;
+    std::filesystem::rename(tmp, path, ec);
+}
+
+static bool compileSpirv(const char* label, const std::string& source, shaderc_shader_kind kind, std::vector<uint32_t>& code) {
+    uint64_t key = hashSource(source) ^ (uint64_t)kind;
+    if (loadSpirv(key, code)) return true;
+
+    shaderc_compiler_t compiler = shaderc_compiler_initialize();
+    shaderc_compile_options_t options = shaderc_compile_options_initialize();
+    shaderc_compile_options_set_target_env(options, shaderc_target_env_vulkan, shaderc_env_version_vulkan_1_0);
+    shaderc_compile_options_set_optimization_level(options, shaderc_optimization_level_performance);
+    // the effects leave their in/out locations and sampler bindings to GL
+    shaderc_compile_options_set_auto_map_locations(options, true);
+    shaderc_compile_options_set_auto_bind_uniforms(options, true);
+    shaderc_compilation_result_t result = shaderc_compile_into_spv(compiler, source.c_str(), source.size(), kind, label, "main", options);
+    bool ok = shaderc_result_get_compilation_status(result) == shaderc_compilation_status_success;
+    if (ok) {
+        const char* bytes = shaderc_result_get_bytes(result);
+        code.assign((const uint32_t*)bytes, (const uint32_t*)bytes + shaderc_result_get_length(result) / 4);
+        storeSpirv(key, code);
+    } else {
+        std::cerr << "Vulkan: " << label << " failed to compile:\n" << shaderc_result_get_error_message(result) << "\n";
+    }
+    shaderc_result_release(result);
+    shaderc_compile_options_release(options);
+    shaderc_compiler_release(compiler);
+    return ok;
+}
+
+static VkShaderModule createModule(const char* label, const std::string& source, shaderc_shader_kind kind) {
+    std::vector<uint32_t> code;
+    if (!compileSpirv(label, source, kind, code)) return VK_NULL_HANDLE;
+    VkShaderModuleCreateInfo ci = { VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO };
+    ci.codeSize = code.size() * 4;
+    ci.pCode = code.data();
+    VkShaderModule module = VK_NULL_HANDLE;
+    vkCreateShaderModule(vk.device, &ci, nullptr, &module);
+    return module;
+}
+
+// An effect as Vulkan GLSL: the same source and block, a newer #version and
+// the block at the binding the effect pipeline layout has
+static std::string vulkanEffectSource(const std::string& source, const std::string& defines) {
+    std::string s = withFrameParams(source, defines);
+    size_t version = s.find("#version");
+    if (version != std::string::npos) s.replace(version, s.find('\n', version) - version, "#version 450");
+    const std::string block = "layout(std140) uniform FrameParams";
+    size_t at = s.find(block);
+    if (at != std::string::npos) s.replace(at, block.size(), "layout(std140, set = 0, binding = 0) uniform FrameParams");
+    return s;
+}
+
+// ---- pipeline cache ----
+
+static std::filesystem::path pipelineCachePath() {
+    return vk.cacheDir / "vulkan-pipelines.bin";
+}
+
+static void createPipelineCache() {
+    std::vector<char> data;
+    if (!vk.cacheDir.empty()) {
+        std::ifstream in(pipelineCachePath(), std::ios::binary);
+        if (in) data.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    }
+    // the driver checks the header (vendor, device, UUID) and ignores a stale cache
+    VkPipelineCacheCreateInfo ci = { VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO };
+    ci.initialDataSize = data.size();
+    ci.pInitialData = data.empty() ? nullptr : data.data();
+    if (vkCreatePipelineCache(vk.device, &ci, nullptr, &vk.pipelineCache) != VK_SUCCESS) {
+        ci.initialDataSize = 0;
+        ci.pInitialData = nullptr;
+        vkCreatePipelineCache(vk.device, &ci, nullptr, &vk.pipelineCache);
+    }
+}
+
+static void storePipelineCache() {
+    if (vk.cacheDir.empty() || !vk.pipelineCache) return;
+    size_t size = 0;
+    if (vkGetPipelineCacheData(vk.device, vk.pipelineCache, &size, nullptr) != VK_SUCCESS || size == 0) return;
+    std::vector<char> data(size);
+    if (vkGetPipelineCacheData(vk.device, vk.pipelineCache, &size, data.data()) != VK_SUCCESS) return;
+    std::filesystem::path path = pipelineCachePath();
+    std::filesystem::path tmp = path;
+    tmp += ".tmp";
+    {
+        std::ofstream out(tmp, std::ios::binary | std::ios::trunc);
+        if (!out) return;
+        out.write(data.data(), (std::streamsize)size);
+        if (!out) return;
+    }
+    std::error_code ec;
+    std::filesystem::rename(tmp, path, ec);
+}
+
+// ---- device ----
+
+static bool createInstance() {
+    unsigned count = 0;
+    if (!SDL_Vulkan_GetInstanceExtensions(vk.win, &count, nullptr)) return false;
+    std::vector<const char*> extensions(count);
+    SDL_Vulkan_GetInstanceExtensions(vk.win, &count, extensions.data());
+
+    VkApplicationInfo app = { VK_STRUCTURE_TYPE_APPLICATION_INFO };
+    app.pApplicationName = "timewarp";
+    app.apiVersion = VK_API_VERSION_1_0;
+    VkInstanceCreateInfo ci = { VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO };
+    ci.pApplicationInfo = &app;
+    ci.enabledExtensionCount = count;
+    ci.ppEnabledExtensionNames = extensions.data();
+    return vkCreateInstance(&ci, nullptr, &vk.instance) == VK_SUCCESS;
+}
+
+static bool hasSwapchain(VkPhysicalDevice gpu) {
+    uint32_t count = 0;
+    vkEnumerateDeviceExtensionProperties(gpu, nullptr, &count, nullptr);
+    std::vector<VkExtensionProperties> exts(count);
+    vkEnumerateDeviceExtensionProperties(gpu, nullptr, &count, exts.data());
+    for (const auto& e : exts)
+        if (std::strcmp(e.extensionName, VK_KHR_SWAPCHAIN_EXTENSION_NAME) == 0) return true;
+    return false;
+}
+
+// A GPU with one queue family that draws and presents; discrete ones first
+static bool pickDevice() {
+    uint32_t count = 0;
+    vkEnumeratePhysicalDevices(vk.instance, &count, nullptr);
+    std::vector<VkPhysicalDevice> gpus(count);
+    vkEnumeratePhysicalDevices(vk.instance, &count, gpus.data());
+    for (int pass = 0; pass < 2 && !vk.gpu; ++pass) {
+        for (VkPhysicalDevice gpu : gpus) {
+            VkPhysicalDeviceProperties props;
+            vkGetPhysicalDeviceProperties(gpu, &props);
+            if (pass == 0 && props.deviceType != VK_PHYSICAL_DEVICE_TYPE_DISCRETE_GPU) continue;
+            if (!hasSwapchain(gpu)) continue;
+            uint32_t families = 0;
+            vkGetPhysicalDeviceQueueFamilyProperties(gpu, &families, nullptr);
+            std::vector<VkQueueFamilyProperties> fams(families);
+            vkGetPhysicalDeviceQueueFamilyProperties(gpu, &families, fams.data());
+            for (uint32_t i = 0; i < families; ++i) {
+                VkBool32 present = VK_FALSE;
+                vkGetPhysicalDeviceSurfaceSupportKHR(gpu, i, vk.surface, &present);
+                if ((fams[i].queueFlags & VK_QUEUE_GRAPHICS_BIT) && present) {
+                    vk.gpu = gpu;
+                    vk.gpuProps = props;
+                    vk.queueFamily = i;
+                    break;
+                }
+            }
+            if (vk.gpu) break;
+        }
+    }
+    return vk.gpu != VK_NULL_HANDLE;
+}
+
+static bool createDevice() {
+    float priority = 1.0f;
+    VkDeviceQueueCreateInfo queue = { VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO };
+    queue.queueFamilyIndex = vk.queueFamily;
+    queue.queueCount = 1;
+    queue.pQueuePriorities = &priority;
+    const char* extensions[] = { VK_KHR_SWAPCHAIN_EXTENSION_NAME };
+    VkDeviceCreateInfo ci = { VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO };
+    ci.queueCreateInfoCount = 1;
+    ci.pQueueCreateInfos = &queue;
+    ci.enabledExtensionCount = 1;
+    ci.ppEnabledExtensionNames = extensions;
+    if (vkCreateDevice(vk.gpu, &ci, nullptr, &vk.device) != VK_SUCCESS) return false;
+    vkGetDeviceQueue(vk.device, vk.queueFamily, 0, &vk.queue);
+    return true;
+}
+
+static uint32_t findMemoryType(uint32_t typeBits, VkMemoryPropertyFlags flags) {
+    VkPhysicalDeviceMemoryProperties props;
+    vkGetPhysicalDeviceMemoryProperties(vk.gpu, &props);
+    for (uint32_t i = 0; i < props.memoryTypeCount; ++i)
+        if ((typeBits & (1u << i)) && (props.memoryTypes[i].propertyFlags & flags) == flags) return i;
+    return UINT32_MAX;
+}
+
+// 8-bit UNORM if offered, so the tonemap encodes exactly as on GL; an sRGB
+// format makes it write linear values instead
+static void chooseSurface() {
+    uint32_t count = 0;
+    vkGetPhysicalDeviceSurfaceFormatsKHR(vk.gpu, vk.surface, &count, nullptr);
+    std::vector<VkSurfaceFormatKHR> formats(count);
+    vkGetPhysicalDeviceSurfaceFormatsKHR(vk.gpu, vk.surface, &count, formats.data());
+    vk.surfaceFormat = formats.empty() ? VkSurfaceFormatKHR{ VK_FORMAT_B8G8R8A8_UNORM, VK_COLOR_SPACE_SRGB_NONLINEAR_KHR } : formats[0];
+    for (const auto& f : formats) {
+        if ((f.format == VK_FORMAT_B8G8R8A8_UNORM || f.format == VK_FORMAT_R8G8B8A8_UNORM) && f.colorSpace == VK_COLOR_SPACE_SRGB_NONLINEAR_KHR) {
+            vk.surfaceFormat = f;
+            break;
+        }
+    }
+
+    const VkPresentModeKHR wanted[] = { VK_PRESENT_MODE_FIFO_KHR, VK_PRESENT_MODE_MAILBOX_KHR, VK_PRESENT_MODE_IMMEDIATE_KHR };
+    VkPresentModeKHR want = wanted[(int)vk.opts.present];
+    vkGetPhysicalDeviceSurfacePresentModesKHR(vk.gpu, vk.surface, &count, nullptr);
+    std::vector<VkPresentModeKHR> modes(count);
+    vkGetPhysicalDeviceSurfacePresentModesKHR(vk.gpu, vk.surface, &count, modes.data());
+    // FIFO is the one mode every implementation has
+    vk.presentMode = std::find(modes.begin(), modes.end(), want) != modes.end() ? want : VK_PRESENT_MODE_FIFO_KHR;
+    if (vk.presentMode != want) std::cerr << "Vulkan: no " << presentModeName(vk.opts.present) << " present mode, using fifo\n";
+}
+
+static bool sceneIsSrgb() {
+    return vk.surfaceFormat.format == VK_FORMAT_B8G8R8A8_SRGB || vk.surfaceFormat.format == VK_FORMAT_R8G8B8A8_SRGB;
+}
+
+// ---- passes and pipelines ----
+
+static VkRenderPass createRenderPass(VkFormat format, VkAttachmentLoadOp load, VkImageLayout finalLayout,
+                                     const VkSubpassDependency* deps, uint32_t depCount) {
+    VkAttachmentDescription color = {};
+    color.format = format;
+    color.samples = VK_SAMPLE_COUNT_1_BIT;
+    color.loadOp = load;
+    color.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
+    color.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+    color.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+    color.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    color.finalLayout = finalLayout;
+    VkAttachmentReference ref = { 0, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL };
+    VkSubpassDescription subpass = {};
+    subpass.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
+    subpass.colorAttachmentCount = 1;
+    subpass.pColorAttachments = &ref;
+    VkRenderPassCreateInfo ci = { VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO };
+    ci.attachmentCount = 1;
+    ci.pAttachments = &color;
+    ci.subpassCount = 1;
+    ci.pSubpasses = &subpass;
+    ci.dependencyCount = depCount;
+    ci.pDependencies = deps;
+    VkRenderPass pass = VK_NULL_HANDLE;
+    vkCreateRenderPass(vk.device, &ci, nullptr, &pass);
+    return pass;
+}
+
+static bool createPasses() {
+    // the previous frame's tonemap read of the scene finishes before this
+    // frame overwrites it, and the write finishes before this frame reads it
+    VkSubpassDependency sceneDeps[2] = {};
+    sceneDeps[0].srcSubpass = VK_SUBPASS_EXTERNAL;
+    sceneDeps[0].dstSubpass = 0;
+    sceneDeps[0].srcStageMask = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+    sceneDeps[0].dstStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+    sceneDeps[0].dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+    sceneDeps[1].srcSubpass = 0;
+    sceneDeps[1].dstSubpass = VK_SUBPASS_EXTERNAL;
+    sceneDeps[1].srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+    sceneDeps[1].srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+    sceneDeps[1].dstStageMask = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+    sceneDeps[1].dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+    vk.scenePass = createRenderPass(sceneFormat, VK_ATTACHMENT_LOAD_OP_CLEAR, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, sceneDeps, 2);
+
+    // the swapchain image is written once the acquire semaphore has been waited on
+    VkSubpassDependency toneDep = {};
+    toneDep.srcSubpass = VK_SUBPASS_EXTERNAL;
+    toneDep.dstSubpass = 0;
+    toneDep.srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+    toneDep.dstStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+    toneDep.dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+    vk.tonePass = createRenderPass(vk.surfaceFormat.format, VK_ATTACHMENT_LOAD_OP_DONT_CARE, VK_IMAGE_LAYOUT_PRESENT_SRC_KHR, &toneDep, 1);
+    return vk.scenePass && vk.tonePass;
+}
+
+static VkDescriptorSetLayout createSetLayout(VkDescriptorType type) {
+    VkDescriptorSetLayoutBinding binding = {};
+    binding.binding = 0;
+    binding.descriptorType = type;
+    binding.descriptorCount = 1;
+    binding.stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
+    VkDescriptorSetLayoutCreateInfo ci = { VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO };
+    ci.bindingCount = 1;
+    ci.pBindings = &binding;
+    VkDescriptorSetLayout layout = VK_NULL_HANDLE;
+    vkCreateDescriptorSetLayout(vk.device, &ci, nullptr, &layout);
+    return layout;
+}
+
+static VkPipelineLayout createPipelineLayout(VkDescriptorSetLayout set, uint32_t pushBytes) {
+    VkPushConstantRange push = { VK_SHADER_STAGE_FRAGMENT_BIT, 0, pushBytes };
+    VkPipelineLayoutCreateInfo ci = { VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO };
+    ci.setLayoutCount = 1;
+    ci.pSetLayouts = &set;
+    ci.pushConstantRangeCount = pushBytes ? 1 : 0;
+    ci.pPushConstantRanges = pushBytes ? &push : nullptr;
+    VkPipelineLayout layout = VK_NULL_HANDLE;
+    vkCreatePipelineLayout(vk.device, &ci, nullptr, &layout);
+    return layout;
+}
+
+// The fullscreen triangle with fs; viewport and scissor are set per frame,
+// so a resize rebuilds no pipeline
+static VkPipeline createPipeline(VkShaderModule fs, VkPipelineLayout layout, VkRenderPass pass) {
+    VkPipelineShaderStageCreateInfo stages[2] = {};
+    stages[0].sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+    stages[0].stage = VK_SHADER_STAGE_VERTEX_BIT;
+    stages[0].module = vk.vertexModule;
+    stages[0].pName = "main";
+    stages[1].sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+    stages[1].stage = VK_SHADER_STAGE_FRAGMENT_BIT;
+    stages[1].module = fs;
+    stages[1].pName = "main";
+
+    VkPipelineVertexInputStateCreateInfo vertexInput = { VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO };
+    VkPipelineInputAssemblyStateCreateInfo assembly = { VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO };
+    assembly.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
+    VkPipelineViewportStateCreateInfo viewport = { VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO };
+    viewport.viewportCount = 1;
+    viewport.scissorCount = 1;
+    VkPipelineRasterizationStateCreateInfo raster = { VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO };
+    raster.polygonMode = VK_POLYGON_MODE_FILL;
+    raster.cullMode = VK_CULL_MODE_NONE;
+    raster.lineWidth = 1.0f;
+    VkPipelineMultisampleStateCreateInfo multisample = { VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO };
+    multisample.rasterizationSamples = VK_SAMPLE_COUNT_1_BIT;
+    VkPipelineColorBlendAttachmentState attachment = {};
+    attachment.colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT;
+    VkPipelineColorBlendStateCreateInfo blend = { VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO };
+    blend.attachmentCount = 1;
+    blend.pAttachments = &attachment;
+    const VkDynamicState dynamicStates[] = { VK_DYNAMIC_STATE_VIEWPORT, VK_DYNAMIC_STATE_SCISSOR };
+    VkPipelineDynamicStateCreateInfo dynamic = { VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO };
+    dynamic.dynamicStateCount = 2;
+    dynamic.pDynamicStates = dynamicStates;
+
+    VkGraphicsPipelineCreateInfo ci = { VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO };
+    ci.stageCount = 2;
+    ci.pStages = stages;
+    ci.pVertexInputState = &vertexInput;
+    ci.pInputAssemblyState = &assembly;
+    ci.pViewportState = &viewport;
+    ci.pRasterizationState = &raster;
+    ci.pMultisampleState = &multisample;
+    ci.pColorBlendState = &blend;
+    ci.pDynamicState = &dynamic;
+    ci.layout = layout;
+    ci.renderPass = pass;
+    ci.subpass = 0;
+    VkPipeline pipeline = VK_NULL_HANDLE;
+    if (vkCreateGraphicsPipelines(vk.device, vk.pipelineCache, 1, &ci, nullptr, &pipeline) != VK_SUCCESS) return VK_NULL_HANDLE;
+    return pipeline;
+}
+
+static bool createResources() {
+    vk.effectSetLayout = createSetLayout(VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC);
+    vk.toneSetLayout = createSetLayout(VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER);
+    vk.effectLayout = createPipelineLayout(vk.effectSetLayout, 0);
+    vk.toneLayout = createPipelineLayout(vk.toneSetLayout, sizeof(TonePush));
+
+    VkDescriptorPoolSize sizes[2] = {
+        { VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, 1 },
+        { VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1 },
+    };
+    VkDescriptorPoolCreateInfo pool = { VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO };
+    pool.maxSets = 2;
+    pool.poolSizeCount = 2;
+    pool.pPoolSizes = sizes;
+    if (vkCreateDescriptorPool(vk.device, &pool, nullptr, &vk.descriptorPool) != VK_SUCCESS) return false;
+    VkDescriptorSetLayout layouts[2] = { vk.effectSetLayout, vk.toneSetLayout };
+    VkDescriptorSet sets[2];
+    VkDescriptorSetAllocateInfo alloc = { VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO };
+    alloc.descriptorPool = vk.descriptorPool;
+    alloc.descriptorSetCount = 2;
+    alloc.pSetLayouts = layouts;
+    if (vkAllocateDescriptorSets(vk.device, &alloc, sets) != VK_SUCCESS) return false;
+    vk.effectSet = sets[0];
+    vk.toneSet = sets[1];
+
+    // one FrameParams slot per frame in flight, each at the device's UBO alignment
+    VkDeviceSize align = std::max<VkDeviceSize>(vk.gpuProps.limits.minUniformBufferOffsetAlignment, 16);
+    vk.uboStride = (sizeof(FrameParams) + align - 1) / align * align;
+    VkBufferCreateInfo buffer = { VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO };
+    buffer.size = vk.uboStride * vk.framesInFlight;
+    buffer.usage = VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT;
+    buffer.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+    if (vkCreateBuffer(vk.device, &buffer, nullptr, &vk.ubo) != VK_SUCCESS) return false;
+    VkMemoryRequirements req;
+    vkGetBufferMemoryRequirements(vk.device, vk.ubo, &req);
+    VkMemoryAllocateInfo mem = { VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO };
+    mem.allocationSize = req.size;
+    mem.memoryTypeIndex = findMemoryType(req.memoryTypeBits, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+    if (mem.memoryTypeIndex == UINT32_MAX || vkAllocateMemory(vk.device, &mem, nullptr, &vk.uboMemory) != VK_SUCCESS) return false;
+    vkBindBufferMemory(vk.device, vk.ubo, vk.uboMemory, 0);
+    vkMapMemory(vk.device, vk.uboMemory, 0, VK_WHOLE_SIZE, 0, (void**)&vk.uboMapped);
+
+    VkDescriptorBufferInfo uboInfo = { vk.ubo, 0, sizeof(FrameParams) };
+    VkWriteDescriptorSet write = { VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET };
+    write.dstSet = vk.effectSet;
+    write.dstBinding = 0;
+    write.descriptorCount = 1;
+    write.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
+    write.pBufferInfo = &uboInfo;
+    vkUpdateDescriptorSets(vk.device, 1, &write, 0, nullptr);
+
+    VkSamplerCreateInfo sampler = { VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO };
+    sampler.magFilter = VK_FILTER_NEAREST;
+    sampler.minFilter = VK_FILTER_NEAREST;
+    sampler.addressModeU = sampler.addressModeV = sampler.addressModeW = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+    if (vkCreateSampler(vk.device, &sampler, nullptr, &vk.sampler) != VK_SUCCESS) return false;
+
+    VkCommandPoolCreateInfo cmdPool = { VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO };
+    cmdPool.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+    cmdPool.queueFamilyIndex = vk.queueFamily;
+    if (vkCreateCommandPool(vk.device, &cmdPool, nullptr, &vk.commandPool) != VK_SUCCESS) return false;
+    for (int i = 0; i < vk.framesInFlight; ++i) {
+        FrameSlot& f = vk.frames[i];
+        VkCommandBufferAllocateInfo cmd = { VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO };
+        cmd.commandPool = vk.commandPool;
+        cmd.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+        cmd.commandBufferCount = 1;
+        VkSemaphoreCreateInfo sem = { VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO };
+        VkFenceCreateInfo fence = { VK_STRUCTURE_TYPE_FENCE_CREATE_INFO };
+        fence.flags = VK_FENCE_CREATE_SIGNALED_BIT;  // the first wait passes
+        if (vkAllocateCommandBuffers(vk.device, &cmd, &f.cmd) != VK_SUCCESS ||
+            vkCreateSemaphore(vk.device, &sem, nullptr, &f.acquired) != VK_SUCCESS ||
+            vkCreateFence(vk.device, &fence, nullptr, &f.done) != VK_SUCCESS) return false;
+    }
+
+    vk.vertexModule = createModule("fullscreen triangle", vulkanVertexSrc, shaderc_vertex_shader);
+    VkShaderModule toneModule = createModule("tonemap", vulkanToneSrc, shaderc_fragment_shader);
+    if (vk.vertexModule && toneModule) vk.tonePipeline = createPipeline(toneModule, vk.toneLayout, vk.tonePass);
+    if (toneModule) vkDestroyShaderModule(vk.device, toneModule, nullptr);
+    return vk.tonePipeline != VK_NULL_HANDLE;
+}
+
+// ---- swapchain ----
+
+static void destroySwapchainTargets() {
+    for (VkFramebuffer fb : vk.framebuffers) vkDestroyFramebuffer(vk.device, fb, nullptr);
+    for (VkImageView view : vk.views) vkDestroyImageView(vk.device, view, nullptr);
+    for (VkSemaphore sem : vk.rendered) vkDestroySemaphore(vk.device, sem, nullptr);
+    vk.framebuffers.clear();
+    vk.views.clear();
+    vk.rendered.clear();
+    if (vk.sceneFramebuffer) vkDestroyFramebuffer(vk.device, vk.sceneFramebuffer, nullptr);
+    if (vk.sceneView) vkDestroyImageView(vk.device, vk.sceneView, nullptr);
+    if (vk.scene) vkDestroyImage(vk.device, vk.scene, nullptr);
+    if (vk.sceneMemory) vkFreeMemory(vk.device, vk.sceneMemory, nullptr);
+    vk.sceneFramebuffer = VK_NULL_HANDLE;
+    vk.sceneView = VK_NULL_HANDLE;
+    vk.scene = VK_NULL_HANDLE;
+    vk.sceneMemory = VK_NULL_HANDLE;
+}
+
+static VkImageView createView(VkImage image, VkFormat format) {
+    VkImageViewCreateInfo ci = { VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO };
+    ci.image = image;
+    ci.viewType = VK_IMAGE_VIEW_TYPE_2D;
+    ci.format = format;
+    ci.subresourceRange = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1 };
+    VkImageView view = VK_NULL_HANDLE;
+    vkCreateImageView(vk.device, &ci, nullptr, &view);
+    return view;
+}
+
+static VkFramebuffer createFramebuffer(VkRenderPass pass, VkImageView view) {
+    VkFramebufferCreateInfo ci = { VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO };
+    ci.renderPass = pass;
+    ci.attachmentCount = 1;
+    ci.pAttachments = &view;
+    ci.width = vk.extent.width;
+    ci.height = vk.extent.height;
+    ci.layers = 1;
+    VkFramebuffer fb = VK_NULL_HANDLE;
+    vkCreateFramebuffer(vk.device, &ci, nullptr, &fb);
+    return fb;
+}
+
+static bool createSceneTarget() {
+    VkImageCreateInfo ci = { VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO };
+    ci.imageType = VK_IMAGE_TYPE_2D;
+    ci.format = sceneFormat;
+    ci.extent = { vk.extent.width, vk.extent.height, 1 };
+    ci.mipLevels = 1;
+    ci.arrayLayers = 1;
+    ci.samples = VK_SAMPLE_COUNT_1_BIT;
+    ci.tiling = VK_IMAGE_TILING_OPTIMAL;
+    ci.usage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
+    ci.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+    ci.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    if (vkCreateImage(vk.device, &ci, nullptr, &vk.scene) != VK_SUCCESS) return false;
+    VkMemoryRequirements req;
+    vkGetImageMemoryRequirements(vk.device, vk.scene, &req);
+    VkMemoryAllocateInfo mem = { VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO };
+    mem.allocationSize = req.size;
+    mem.memoryTypeIndex = findMemoryType(req.memoryTypeBits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+    if (mem.memoryTypeIndex == UINT32_MAX || vkAllocateMemory(vk.device, &mem, nullptr, &vk.sceneMemory) != VK_SUCCESS) return false;
+    vkBindImageMemory(vk.device, vk.scene, vk.sceneMemory, 0);
+    vk.sceneView = createView(vk.scene, sceneFormat);
+    vk.sceneFramebuffer = createFramebuffer(vk.scenePass, vk.sceneView);
+
+    VkDescriptorImageInfo image = { vk.sampler, vk.sceneView, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL };
+    VkWriteDescriptorSet write = { VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET };
+    write.dstSet = vk.toneSet;
+    write.dstBinding = 0;
+    write.descriptorCount = 1;
+    write.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+    write.pImageInfo = &image;
+    vkUpdateDescriptorSets(vk.device, 1, &write, 0, nullptr);
+    return vk.sceneFramebuffer != VK_NULL_HANDLE;
+}
+
+// (Re)creates the swapchain at the window's size; false while the window
+// has no area (minimized), in which case frames are skipped
+static bool createSwapchain() {
+    VkSurfaceCapabilitiesKHR caps;
+    vkGetPhysicalDeviceSurfaceCapabilitiesKHR(vk.gpu, vk.surface, &caps);
+    VkExtent2D extent = caps.currentExtent;
+    if (extent.width == UINT32_MAX) {
+        int dw = vk.w, dh = vk.h;
+        SDL_Vulkan_GetDrawableSize(vk.win, &dw, &dh);
+        extent.width = std::clamp((uint32_t)dw, caps.minImageExtent.width, caps.maxImageExtent.width);
+        extent.height = std::clamp((uint32_t)dh, caps.minImageExtent.height, caps.maxImageExtent.height);
+    }
+    if (extent.width == 0 || extent.height == 0) return false;
+
+    vkDeviceWaitIdle(vk.device);
+    destroySwapchainTargets();
+    uint32_t images = caps.minImageCount + 1;
+    if (caps.maxImageCount > 0) images = std::min(images, caps.maxImageCount);
+    VkSwapchainCreateInfoKHR ci = { VK_STRUCTURE_TYPE_SWAPCHAIN_CREATE_INFO_KHR };
+    ci.surface = vk.surface;
+    ci.minImageCount = images;
+    ci.imageFormat = vk.surfaceFormat.format;
+    ci.imageColorSpace = vk.surfaceFormat.colorSpace;
+    ci.imageExtent = extent;
+    ci.imageArrayLayers = 1;
+    ci.imageUsage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT;
+    ci.imageSharingMode = VK_SHARING_MODE_EXCLUSIVE;
+    ci.preTransform = caps.currentTransform;
+    ci.compositeAlpha = VK_COMPOSITE_ALPHA_OPAQUE_BIT_KHR;
+    ci.presentMode = vk.presentMode;
+    ci.clipped = VK_TRUE;
+    ci.oldSwapchain = vk.swapchain;
+    VkSwapchainKHR swapchain = VK_NULL_HANDLE;
+    VkResult result = vkCreateSwapchainKHR(vk.device, &ci, nullptr, &swapchain);
+    if (vk.swapchain) vkDestroySwapchainKHR(vk.device, vk.swapchain, nullptr);
+    vk.swapchain = swapchain;
+    if (result != VK_SUCCESS) {
+        vk.swapchain = VK_NULL_HANDLE;
+        return false;
+    }
+    vk.extent = extent;
+
+    uint32_t count = 0;
+    vkGetSwapchainImagesKHR(vk.device, vk.swapchain, &count, nullptr);
+    vk.images.resize(count);
+    vkGetSwapchainImagesKHR(vk.device, vk.swapchain, &count, vk.images.data());
+    for (VkImage image : vk.images) {
+        VkSemaphoreCreateInfo sem = { VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO };
+        VkSemaphore rendered = VK_NULL_HANDLE;
+        vkCreateSemaphore(vk.device, &sem, nullptr, &rendered);
+        vk.rendered.push_back(rendered);
+        vk.views.push_back(createView(image, vk.surfaceFormat.format));
+        vk.framebuffers.push_back(createFramebuffer(vk.tonePass, vk.views.back()));
+    }
+    vk.recreate = false;
+    return createSceneTarget();
+}
+
+// ---- the backend ----
+
+static void shutdownVulkan();
+
+static SDL_Window* initVulkan(const char* title, int w, int h, const BackendOptions& opts) {
+    vk.opts = opts;
+    vk.framesInFlight = std::clamp(opts.framesInFlight, 1, maxFramesInFlight);
+    vk.w = w; vk.h = h;
+    if (opts.cacheDir) {
+        std::error_code ec;
+        std::filesystem::create_directories(opts.cacheDir, ec);
+        if (!ec) vk.cacheDir = opts.cacheDir;
+    }
+    vk.win = SDL_CreateWindow(title, SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED, w, h, SDL_WINDOW_VULKAN | SDL_WINDOW_RESIZABLE);
+    const char* failed = nullptr;
+    if (!vk.win) failed = "window";
+    else if (!createInstance()) failed = "instance";
+    else if (!SDL_Vulkan_CreateSurface(vk.win, vk.instance, &vk.surface)) failed = "surface";
+    else if (!pickDevice()) failed = "a GPU that can present";
+    else if (!createDevice()) failed = "device";
+    if (!failed) {
+        chooseSurface();
+        createPipelineCache();
+        if (!createPasses() || !createResources()) failed = "pipelines";
+        // a minimized start gets its swapchain at the first drawable frame
+        else if (!createSwapchain()) vk.recreate = true;
+    }
+    if (failed) {
+        std::cerr << "Vulkan: cannot create " << failed;
+        if (!vk.win) std::cerr << ": " << SDL_GetError();
+        std::cerr << "\n";
+        shutdownVulkan();
+        return nullptr;
+    }
+    std::cout << "Vulkan: " << vk.gpuProps.deviceName << ", " << presentModeName(vk.opts.present) << " present, "
+              << vk.framesInFlight << " frames in flight\n";
+    return vk.win;
+}
+
+static void shutdownVulkan() {
+    if (vk.device) {
+        vkDeviceWaitIdle(vk.device);
+        storePipelineCache();
+        destroySwapchainTargets();
+        if (vk.swapchain) vkDestroySwapchainKHR(vk.device, vk.swapchain, nullptr);
+        for (VkPipeline p : vk.programs) if (p) vkDestroyPipeline(vk.device, p, nullptr);
+        vk.programs.clear();
+        if (vk.tonePipeline) vkDestroyPipeline(vk.device, vk.tonePipeline, nullptr);
+        if (vk.vertexModule) vkDestroyShaderModule(vk.device, vk.vertexModule, nullptr);
+        if (vk.pipelineCache) vkDestroyPipelineCache(vk.device, vk.pipelineCache, nullptr);
+        for (FrameSlot& f : vk.frames) {
+            if (f.acquired) vkDestroySemaphore(vk.device, f.acquired, nullptr);
+            if (f.done) vkDestroyFence(vk.device, f.done, nullptr);
+            f = FrameSlot{};
+        }
+        if (vk.commandPool) vkDestroyCommandPool(vk.device, vk.commandPool, nullptr);
+        if (vk.sampler) vkDestroySampler(vk.device, vk.sampler, nullptr);
+        if (vk.ubo) vkDestroyBuffer(vk.device, vk.ubo, nullptr);
+        if (vk.uboMemory) vkFreeMemory(vk.device, vk.uboMemory, nullptr);
+        if (vk.descriptorPool) vkDestroyDescriptorPool(vk.device, vk.descriptorPool, nullptr);
+        if (vk.effectLayout) vkDestroyPipelineLayout(vk.device, vk.effectLayout, nullptr);
+        if (vk.toneLayout) vkDestroyPipelineLayout(vk.device, vk.toneLayout, nullptr);
+        if (vk.effectSetLayout) vkDestroyDescriptorSetLayout(vk.device, vk.effectSetLayout, nullptr);
+        if (vk.toneSetLayout) vkDestroyDescriptorSetLayout(vk.device, vk.toneSetLayout, nullptr);
+        if (vk.scenePass) vkDestroyRenderPass(vk.device, vk.scenePass, nullptr);
+        if (vk.tonePass) vkDestroyRenderPass(vk.device, vk.tonePass, nullptr);
+        vkDestroyDevice(vk.device, nullptr);
+    }
+    if (vk.surface) vkDestroySurfaceKHR(vk.instance, vk.surface, nullptr);
+    if (vk.instance) vkDestroyInstance(vk.instance, nullptr);
+    if (vk.win) SDL_DestroyWindow(vk.win);
+    vk = {};
+}
+
+static int createVulkanProgram(const char* label, const std::string& source, const std::string& defines) {
+    VkShaderModule fs = createModule(label, vulkanEffectSource(source, defines), shaderc_fragment_shader);
+    if (!fs) return -1;
+    VkPipeline pipeline = createPipeline(fs, vk.effectLayout, vk.scenePass);
+    vkDestroyShaderModule(vk.device, fs, nullptr);
+    if (!pipeline) return -1;
+    vk.programs.push_back(pipeline);
+    return (int)vk.programs.size() - 1;
+}
+
+static bool drawVulkanFrame(int program, const FrameParams& params, const ToneDesc& tone, int frame) {
+    if (vk.recreate && !createSwapchain()) {
+        SDL_Delay(10);  // minimized: nothing to draw into
+        return true;
+    }
+    FrameSlot& f = vk.frames[vk.slot];
+    // the slot's previous frame is done with its command buffer and UBO slot
+    vkWaitForFences(vk.device, 1, &f.done, VK_TRUE, UINT64_MAX);
+    uint32_t image = 0;
+    VkResult result = vkAcquireNextImageKHR(vk.device, vk.swapchain, UINT64_MAX, f.acquired, VK_NULL_HANDLE, &image);
+    if (result == VK_ERROR_OUT_OF_DATE_KHR) {
+        vk.recreate = true;
+        return true;
+    }
+    if (result != VK_SUCCESS && result != VK_SUBOPTIMAL_KHR) return false;
+    vkResetFences(vk.device, 1, &f.done);
+
+    uint32_t uboOffset = (uint32_t)(vk.uboStride * vk.slot);
+    std::memcpy(vk.uboMapped + uboOffset, &params, sizeof(params));
+
+    VkCommandBuffer cmd = f.cmd;
+    vkResetCommandBuffer(cmd, 0);
+    VkCommandBufferBeginInfo begin = { VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO };
+    begin.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+    vkBeginCommandBuffer(cmd, &begin);
+    VkViewport viewport = { 0.0f, 0.0f, (float)vk.extent.width, (float)vk.extent.height, 0.0f, 1.0f };
+    VkRect2D area = { { 0, 0 }, vk.extent };
+
+    VkClearValue black = {};
+    VkRenderPassBeginInfo pass = { VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO };
+    pass.renderPass = vk.scenePass;
+    pass.framebuffer = vk.sceneFramebuffer;
+    pass.renderArea = area;
+    pass.clearValueCount = 1;
+    pass.pClearValues = &black;
+    vkCmdBeginRenderPass(cmd, &pass, VK_SUBPASS_CONTENTS_INLINE);
+    vkCmdSetViewport(cmd, 0, 1, &viewport);
+    vkCmdSetScissor(cmd, 0, 1, &area);
+    if (program >= 0) {
+        vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, vk.programs[program]);
+        vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, vk.effectLayout, 0, 1, &vk.effectSet, 1, &uboOffset);
+        vkCmdDraw(cmd, 3, 1, 0, 0);
+    }
+    vkCmdEndRenderPass(cmd);
+
+    TonePush push = { tone.exposure, tone.gamma, tone.knee, 1.0f / 255.0f, frame, sceneIsSrgb() ? 1 : 0, (int32_t)vk.extent.height };
+    pass.renderPass = vk.tonePass;
+    pass.framebuffer = vk.framebuffers[image];
+    pass.clearValueCount = 0;
+    pass.pClearValues = nullptr;
+    vkCmdBeginRenderPass(cmd, &pass, VK_SUBPASS_CONTENTS_INLINE);
+    vkCmdSetViewport(cmd, 0, 1, &viewport);
+    vkCmdSetScissor(cmd, 0, 1, &area);
+    vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, vk.tonePipeline);
+    vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, vk.toneLayout, 0, 1, &vk.toneSet, 0, nullptr);
+    vkCmdPushConstants(cmd, vk.toneLayout, VK_SHADER_STAGE_FRAGMENT_BIT, 0, sizeof(push), &push);
+    vkCmdDraw(cmd, 3, 1, 0, 0);
+    vkCmdEndRenderPass(cmd);
+    vkEndCommandBuffer(cmd);
+
+    VkPipelineStageFlags waitStage = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+    VkSubmitInfo submit = { VK_STRUCTURE_TYPE_SUBMIT_INFO };
+    submit.waitSemaphoreCount = 1;
+    submit.pWaitSemaphores = &f.acquired;
+    submit.pWaitDstStageMask = &waitStage;
+    submit.commandBufferCount = 1;
+    submit.pCommandBuffers = &cmd;
+    submit.signalSemaphoreCount = 1;
+    submit.pSignalSemaphores = &vk.rendered[image];
+    if (vkQueueSubmit(vk.queue, 1, &submit, f.done) != VK_SUCCESS) return false;
+
+    VkPresentInfoKHR present = { VK_STRUCTURE_TYPE_PRESENT_INFO_KHR };
+    present.waitSemaphoreCount = 1;
+    present.pWaitSemaphores = &vk.rendered[image];
+    present.swapchainCount = 1;
+    present.pSwapchains = &vk.swapchain;
+    present.pImageIndices = &image;
+    result = vkQueuePresentKHR(vk.queue, &present);
+    if (result == VK_ERROR_OUT_OF_DATE_KHR || result == VK_SUBOPTIMAL_KHR) vk.recreate = true;
+    else if (result != VK_SUCCESS) return false;
+    vk.slot = (vk.slot + 1) % vk.framesInFlight;
+    return true;
+}
+
+static void resizeVulkan(int w, int h) {
+    vk.w = w; vk.h = h;
+    vk.recreate = true;
+}
+
+const RenderBackend* vulkanBackend() {
+    static const RenderBackend backend = { "vulkan", initVulkan, shutdownVulkan, createVulkanProgram, drawVulkanFrame, resizeVulkan };
+    return &backend;
+}
+
+#endif